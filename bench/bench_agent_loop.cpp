@@ -0,0 +1,76 @@
+// End-to-end agent loop benchmark against the mock provider (no network).
+// Usage: agent_bench_loop [sessions] [tokens_per_second]
+#include <cstdlib>
+#include <memory>
+#include "bench_common.hpp"
+#include "core/loop/agent_loop.hpp"
+#include "providers/mock_provider.hpp"
+
+using namespace agent;
+
+namespace {
+
+    // A trivial read-only tool so that we measure the loop, not the tool
+    class EchoTool : public core::tools::Tool {
+    public:
+        const protocol::ToolSchema& schema() const override { return schema_; }
+        bool is_side_effect_free() const override { return true; }
+        protocol::ToolResult execute(const protocol::ToolCall& call) override {
+            return protocol::ToolResult{call.id, true, call.arguments, "", 0.0};
+        }
+
+    private:
+        protocol::ToolSchema schema_{"read_file", "echo", "{}"};
+    };
+
+    std::vector<providers::ScriptedTurn> make_script(int tool_turns) {
+        std::vector<providers::ScriptedTurn> script;
+        for (int i = 0; i < tool_turns; ++i) {
+            providers::ScriptedTurn turn;
+            turn.text = "Let me look at the next file before I change anything in it.";
+            turn.tool_calls.push_back(protocol::ToolCall{
+                "call-" + std::to_string(i), "read_file",
+                "{\"path\": \"src/file_" + std::to_string(i) + ".cpp\"}"});
+            turn.stop_reason = protocol::StopReason::ToolCall;
+            script.push_back(std::move(turn));
+        }
+        script.push_back(providers::ScriptedTurn{"All done.", {}, protocol::StopReason::Finished,
+                                                 std::nullopt});
+        return script;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int sessions = argc > 1 ? std::atoi(argv[1]) : 200;
+    double tokens_per_second = argc > 2 ? std::atof(argv[2]) : 0.0;
+    constexpr int kToolTurns = 10;
+
+    core::tools::ToolDispatcher dispatcher;
+    dispatcher.register_tool(std::make_unique<EchoTool>());
+
+    providers::MockTiming timing;
+    timing.tokens_per_second = tokens_per_second;
+
+    std::vector<double> session_ms;
+    std::size_t events = 0;
+    bench::Stopwatch total;
+    for (int s = 0; s < sessions; ++s) {
+        providers::MockProvider provider(make_script(kToolTurns), timing);
+        core::loop::AgentLoop loop(provider, dispatcher, core::loop::LoopOptions{});
+
+        std::vector<protocol::Message> history{
+            protocol::Message{protocol::Role::User, "Refactor the module.", {}, std::nullopt}};
+
+        bench::Stopwatch watch;
+        loop.run(history, [&](const protocol::AgentEvent&) { ++events; });
+        session_ms.push_back(watch.elapsed_ms());
+    }
+
+    double seconds = total.elapsed_ms() / 1000.0;
+    auto turns_per_second = static_cast<long long>(sessions * (kToolTurns + 1) / seconds);
+    bench::report("agent_loop/session", session_ms,
+                  "events/s=" + std::to_string(static_cast<long long>(events / seconds)) +
+                      " turns/s=" + std::to_string(turns_per_second));
+    return 0;
+}
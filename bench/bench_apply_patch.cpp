@@ -0,0 +1,93 @@
+// apply_patch with one call for an edit across many files, against one call
+// per file, with and without syncing to disk.
+// Usage: agent_bench_apply_patch [files] [directory]
+//   The directory (default: the system temp directory) decides which
+//   filesystem the fsyncs hit.
+#include <unistd.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "bench_common.hpp"
+#include "core/diff/line_diff.hpp"
+#include "core/fs/file_cache.hpp"
+#include "core/tools/apply_patch_tool.hpp"
+
+using namespace agent;
+
+namespace {
+
+    std::string source(std::size_t file, bool edited) {
+        std::string text;
+        for (std::size_t line = 0; line < 2000; ++line) {
+            text.append("int value_").append(std::to_string(file)).append("_");
+            text.append(std::to_string(line)).append(" = ").append(std::to_string(line * 7));
+            text += ';';
+            if (edited && line % 500 == 250) text += "  // reviewed";
+            text += '\n';
+        }
+        return text;
+    }
+
+    bool run(core::tools::ApplyPatchTool& tool, const std::string& patch) {
+        nlohmann::json args = {{"patch", patch}};
+        auto result = tool.execute({"b", "apply_patch", args.dump()});
+        if (!result.success) std::fprintf(stderr, "%s\n", result.error_message.c_str());
+        return result.success;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const std::size_t files = argc > 1 ? std::stoul(argv[1]) : 50;
+    std::filesystem::path root = argc > 2 ? std::filesystem::path(argv[2])
+                                          : std::filesystem::temp_directory_path();
+    root /= std::string("agent_bench_apply_patch_").append(std::to_string(::getpid()));
+    std::filesystem::create_directories(root);
+
+    // Forward and reverse patches per file, so each run undoes the last
+    std::vector<std::string> forward, reverse;
+    for (std::size_t i = 0; i < files; ++i) {
+        std::string name = std::string("f").append(std::to_string(i)).append(".cpp");
+        std::string old_label = std::string("a/").append(name);
+        std::string new_label = std::string("b/").append(name);
+        std::ofstream(root / name) << source(i, false);
+        forward.push_back(
+            core::diff::unified_diff(source(i, false), source(i, true), old_label, new_label).text);
+        reverse.push_back(
+            core::diff::unified_diff(source(i, true), source(i, false), old_label, new_label).text);
+    }
+    std::string all_forward, all_reverse;
+    for (std::size_t i = 0; i < files; ++i) {
+        all_forward += forward[i];
+        all_reverse += reverse[i];
+    }
+
+    core::fs::FileCache cache;
+    const int iterations = 10;
+    for (bool sync : {true, false}) {
+        core::tools::ApplyPatchTool tool({root.string(), &cache, sync, false});
+        std::vector<double> batched, one_by_one;
+        for (int i = 0; i < iterations; ++i) {
+            bench::Stopwatch watch;
+            if (!run(tool, i % 2 == 0 ? all_forward : all_reverse)) return 1;
+            batched.push_back(watch.elapsed_ms());
+        }
+        for (int i = 0; i < iterations; ++i) {
+            bench::Stopwatch watch;
+            for (std::size_t f = 0; f < files; ++f) {
+                if (!run(tool, i % 2 == 0 ? forward[f] : reverse[f])) return 1;
+            }
+            one_by_one.push_back(watch.elapsed_ms());
+        }
+        std::string mode = sync ? "sync    " : "no sync ";
+        std::string extra =
+            std::string("files=").append(std::to_string(files)).append(" hunks/file=4");
+        bench::report(std::string("apply_patch one call      ").append(mode), batched, extra);
+        bench::report(std::string("apply_patch call per file ").append(mode), one_by_one, extra);
+    }
+    std::filesystem::remove_all(root);
+    return 0;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace agent::bench {
+
+    // Wall-clock stopwatch in milliseconds
+    class Stopwatch {
+    public:
+        Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+        double elapsed_ms() const {
+            std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start_;
+            return elapsed.count();
+        }
+
+        void reset() { start_ = std::chrono::steady_clock::now(); }
+
+    private:
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // Nearest-rank percentile (p in 0..100); sorts the samples in place
+    inline double percentile(std::vector<double>& samples, double p) {
+        if (samples.empty()) return 0.0;
+        std::sort(samples.begin(), samples.end());
+        auto rank = static_cast<std::size_t>(p / 100.0 * static_cast<double>(samples.size() - 1));
+        return samples[rank];
+    }
+
+    // One line per benchmark so that runs are easy to diff
+    inline void report(const std::string& name, std::vector<double> samples_ms,
+                       const std::string& extra = "") {
+        std::printf("%-36s n=%-6zu p50=%9.3fms p90=%9.3fms p99=%9.3fms %s\n", name.c_str(),
+                    samples_ms.size(), percentile(samples_ms, 50), percentile(samples_ms, 90),
+                    percentile(samples_ms, 99), extra.c_str());
+    }
+
+    // Stops the optimizer from deleting work whose result we ignore
+    template <typename T>
+    inline void do_not_optimize(const T& value) {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+} // namespace agent::bench
@@ -0,0 +1,135 @@
+// Compaction policies replayed over a long session, one message at a time,
+// the way the agent loop sees it. Reports the cost of each maybe_compact()
+// call early and late in the session (they should match: compaction work
+// must not grow with history) and how small each policy set keeps the history.
+// Usage: agent_bench_compaction [session.jsonl] [context_limit]
+//   session.jsonl holds one message per line in the response-cache message format;
+//   without it a synthetic 2000-turn read/edit/build session is used.
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <string>
+#include "bench_common.hpp"
+#include "core/context/compaction_policies.hpp"
+#include "core/context/compactor.hpp"
+#include "providers/canonical_request.hpp"
+#include "providers/mock_provider.hpp"
+
+using namespace agent;
+using core::context::BpeTokenizer;
+
+namespace {
+
+    BpeTokenizer tokenizer() {
+        std::vector<std::pair<std::string, std::uint32_t>> ranks;
+        for (int byte = 0; byte < 256; ++byte) {
+            ranks.emplace_back(std::string(1, static_cast<char>(byte)), byte);
+        }
+        std::uint32_t next = 256;
+        for (const char* word : {" the", " int", " return", " std", "::", "    ", " const"}) {
+            ranks.emplace_back(word, next++);
+        }
+        return std::move(std::get<BpeTokenizer>(BpeTokenizer::from_ranks(ranks, "bench")));
+    }
+
+    std::vector<protocol::Message> synthetic_session(int turns) {
+        std::vector<protocol::Message> session{
+            {protocol::Role::User, "Make the test suite pass.", {}, std::nullopt}};
+        std::string file_body;
+        for (int line = 0; line < 150; ++line) file_body += "    int value = compute(42);\n";
+        std::string build_log;
+        for (int line = 0; line < 400; ++line) build_log += "[ 42%] Building CXX object x.o\n";
+
+        for (int turn = 0; turn < turns; ++turn) {
+            std::string id = "call-";
+            id += std::to_string(turn);
+            std::string path = "src/file_" + std::to_string(turn % 40) + ".cpp";
+            bool build = turn % 5 == 4;
+            std::string tool = build             ? "run_command"
+                               : turn % 5 == 3 ? "apply_patch"
+                                               : "read_file";
+            session.push_back(protocol::Message{protocol::Role::Assistant, "Next step.",
+                                                {{id, tool, "{\"path\":\"" + path + "\"}"}},
+                                                std::nullopt});
+            session.push_back(protocol::Message{protocol::Role::Tool,
+                                                build ? build_log : file_body, {}, id});
+        }
+        return session;
+    }
+
+    bool load_session(const std::string& path, std::vector<protocol::Message>& session) {
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line)) {
+            auto json = nlohmann::json::parse(line, nullptr, false);
+            if (json.is_discarded()) return false;
+            auto message = providers::message_from_json(json);
+            if (core::errors::is_error(message)) return false;
+            session.push_back(core::errors::get_value(message));
+        }
+        return !session.empty();
+    }
+
+    using PolicySet = std::function<void(core::context::Compactor&)>;
+
+    void replay(const std::string& name, const std::vector<protocol::Message>& session,
+                const BpeTokenizer& tok, std::size_t limit, const PolicySet& install) {
+        core::context::CompactionOptions options;
+        options.context_limit = limit;
+        core::context::Compactor compactor(tok, options);
+        install(compactor);
+
+        std::vector<protocol::Message> history;
+        std::vector<double> early_ms, late_ms;
+        std::size_t passes = 0, peak = 0;
+        for (std::size_t i = 0; i < session.size(); ++i) {
+            history.push_back(session[i]);
+            bench::Stopwatch watch;
+            auto report = compactor.maybe_compact(history);
+            (i < session.size() / 2 ? early_ms : late_ms).push_back(watch.elapsed_ms());
+            passes += report.ran;
+            peak = std::max(peak, compactor.ledger().total());
+        }
+
+        std::string extra = "passes=" + std::to_string(passes) + " peak_tokens=" +
+                            std::to_string(peak) + " final_messages=" +
+                            std::to_string(history.size());
+        bench::report("compaction/" + name + "/early", early_ms);
+        bench::report("compaction/" + name + "/late", late_ms, extra);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<protocol::Message> session;
+    if (argc > 1 && !load_session(argv[1], session)) {
+        std::fprintf(stderr, "Cannot read session %s\n", argv[1]);
+        return 1;
+    }
+    if (session.empty()) session = synthetic_session(2000);
+    std::size_t limit = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 100000;
+
+    auto tok = tokenizer();
+    replay("truncate", session, tok, limit, [](core::context::Compactor& compactor) {
+        compactor.add_policy(std::make_unique<core::context::TruncateToolOutputs>());
+    });
+    replay("stale+truncate", session, tok, limit, [](core::context::Compactor& compactor) {
+        compactor.add_policy(std::make_unique<core::context::ElideStaleReads>());
+        compactor.add_policy(std::make_unique<core::context::TruncateToolOutputs>());
+    });
+
+    // The mock answers instantly, so this measures our side of summarization only
+    providers::MockProvider summarizer(
+        {providers::ScriptedTurn{"Read and patched files; the build is still failing.", {},
+                                 protocol::StopReason::Finished, std::nullopt}},
+        providers::MockTiming{}, true);
+    replay("stale+truncate+summarize", session, tok, limit,
+           [&](core::context::Compactor& compactor) {
+               compactor.add_policy(std::make_unique<core::context::ElideStaleReads>());
+               compactor.add_policy(std::make_unique<core::context::TruncateToolOutputs>());
+               compactor.add_policy(std::make_unique<core::context::SummarizeOldTurns>(
+                   summarizer, providers::ModelParams{}));
+           });
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Line diffs of 100k-line files: Myers and histogram, against diff -u and
+// git diff --no-index on the same pairs.
+// Usage: agent_bench_diff [lines]
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/diff/line_diff.hpp"
+
+using namespace agent;
+
+namespace {
+
+    // Code-like lines: mostly distinct statements, with the braces, blank
+    // lines and returns that repeat through real sources
+    std::vector<std::string> make_source(std::size_t lines, std::mt19937& random) {
+        std::vector<std::string> out;
+        out.reserve(lines);
+        std::size_t function = 0;
+        while (out.size() < lines) {
+            out.push_back("int function_" + std::to_string(function++) + "(int x, int y) {");
+            std::size_t body = 3 + random() % 12;
+            for (std::size_t i = 0; i < body; ++i) {
+                out.push_back("    auto v" + std::to_string(i) + " = compute(x, " +
+                              std::to_string(random() % 1000) + ", y);");
+            }
+            out.push_back("    return 0;");
+            out.push_back("}");
+            out.push_back("");
+        }
+        out.resize(lines);
+        return out;
+    }
+
+    std::string join(const std::vector<std::string>& lines) {
+        std::string text;
+        for (const auto& line : lines) text.append(line).append("\n");
+        return text;
+    }
+
+    std::vector<std::string> edit(std::vector<std::string> lines, std::size_t edits,
+                                  std::mt19937& random) {
+        for (std::size_t i = 0; i < edits; ++i) {
+            std::size_t at = random() % lines.size();
+            switch (random() % 3) {
+            case 0: lines[at] += " // changed"; break;
+            case 1:
+                lines.insert(lines.begin() + static_cast<long>(at), "    log(\"added\");");
+                break;
+            default: lines.erase(lines.begin() + static_cast<long>(at)); break;
+            }
+        }
+        return lines;
+    }
+
+    void write(const char* path, const std::string& text) { std::ofstream(path) << text; }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t lines = argc > 1 ? std::stoul(argv[1]) : 100000;
+    std::mt19937 random(42);
+    auto base = make_source(lines, random);
+
+    // A 400-line block moved from the first quarter to the last
+    auto moved = base;
+    std::vector<std::string> block(moved.begin() + static_cast<long>(lines / 4),
+                                   moved.begin() + static_cast<long>(lines / 4 + 400));
+    moved.erase(moved.begin() + static_cast<long>(lines / 4),
+                moved.begin() + static_cast<long>(lines / 4 + 400));
+    moved.insert(moved.begin() + static_cast<long>(3 * lines / 4), block.begin(), block.end());
+
+    struct Case {
+        const char* name;
+        std::string old_text;
+        std::string new_text;
+    };
+    std::mt19937 other(7);
+    std::vector<Case> cases = {
+        {"identical", join(base), join(base)},
+        {"10 edits", join(base), join(edit(base, 10, random))},
+        {"1% lines edited", join(base), join(edit(base, lines / 100, random))},
+        {"10% lines edited", join(base), join(edit(base, lines / 10, random))},
+        {"block moved", join(base), join(moved)},
+        {"unrelated", join(base), join(make_source(lines, other))},
+    };
+
+    for (const auto& c : cases) {
+        std::size_t edited = 0;
+        for (auto algorithm : {core::diff::Algorithm::Myers, core::diff::Algorithm::Histogram}) {
+            core::diff::DiffOptions options;
+            options.algorithm = algorithm;
+            std::vector<double> samples;
+            std::size_t bytes = 0;
+            for (int i = 0; i < 5; ++i) {
+                bench::Stopwatch watch;
+                auto diff = core::diff::unified_diff(c.old_text, c.new_text, "a/f", "b/f", options);
+                samples.push_back(watch.elapsed_ms());
+                bytes = diff.text.size();
+                edited = diff.insertions + diff.deletions;
+            }
+            bool myers = algorithm == core::diff::Algorithm::Myers;
+            bench::report(std::string(myers ? "myers      " : "histogram  ") + c.name, samples,
+                          "+/- lines=" + std::to_string(edited) +
+                              " output=" + std::to_string(bytes));
+        }
+
+        // The same pair through the usual tools, process start included
+        write("/tmp/agent_bench_diff_old", c.old_text);
+        write("/tmp/agent_bench_diff_new", c.new_text);
+        const char* commands[][2] = {
+            {"diff -u      ", "diff -u /tmp/agent_bench_diff_old /tmp/agent_bench_diff_new"},
+            {"git --myers  ", "git diff --no-index --diff-algorithm=myers "
+                              "/tmp/agent_bench_diff_old /tmp/agent_bench_diff_new"},
+            {"git --histogram ", "git diff --no-index --histogram /tmp/agent_bench_diff_old "
+                                 "/tmp/agent_bench_diff_new"},
+        };
+        for (const auto& [label, command] : commands) {
+            std::vector<double> samples;
+            std::string quiet = std::string(command) + " > /dev/null 2>&1";
+            for (int i = 0; i < 3; ++i) {
+                bench::Stopwatch watch;
+                if (std::system(quiet.c_str()) == -1) return 1;
+                samples.push_back(watch.elapsed_ms());
+            }
+            bench::report(std::string(label) + c.name, samples);
+        }
+    }
+    std::remove("/tmp/agent_bench_diff_old");
+    std::remove("/tmp/agent_bench_diff_new");
+    return 0;
+}
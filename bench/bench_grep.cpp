@@ -0,0 +1,105 @@
+// The search engine against `grep -rn` over a synthetic source tree.
+// Usage: agent_bench_grep [megabytes] [directory]
+//   The tree (files of ~16 KiB of C-like code) is built on the first run and reused.
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/search/grep.hpp"
+
+using namespace agent;
+namespace stdfs = std::filesystem;
+
+namespace {
+
+    void build_tree(const stdfs::path& root, std::size_t megabytes) {
+        std::mt19937 rng(5);
+        const char* words[] = {"value", "index", "count", "buffer", "state", "result", "node"};
+        std::size_t written = 0;
+        for (int file = 0; written < megabytes << 20; ++file) {
+            stdfs::path dir = root / ("mod" + std::to_string(file / 50));
+            stdfs::create_directories(dir);
+            std::ofstream out(dir / ("file" + std::to_string(file) + ".c"));
+            std::string body;
+            while (body.size() < 16 * 1024) {
+                const char* a = words[rng() % 7];
+                const char* b = words[rng() % 7];
+                body += "    int " + std::string(a) + "_" + std::to_string(rng() % 100) +
+                        " = update_" + b + "(" + a + ", " + std::to_string(rng() % 1000) + ");\n";
+                if (rng() % 500 == 0) body += "    // TODO: handle overflow in compute_total\n";
+            }
+            out << body;
+            written += body.size();
+        }
+    }
+
+    double run_grep(const stdfs::path& root, const std::string& pattern, const char* flags) {
+        // Not /dev/null: GNU grep notices that and stops at the first match
+        std::string command = std::string("grep -rn ") + flags + " -e '" + pattern + "' '" +
+                              root.string() + "' > '" + root.string() + ".out'";
+        bench::Stopwatch watch;
+        int status = std::system(command.c_str());
+        bench::do_not_optimize(status);
+        return watch.elapsed_ms();
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t megabytes = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 256;
+    stdfs::path root = argc > 2 ? stdfs::path(argv[2])
+                                : stdfs::temp_directory_path() /
+                                      ("agent_bench_grep_" + std::to_string(megabytes));
+    if (!stdfs::exists(root / ".complete")) {
+        stdfs::remove_all(root);
+        stdfs::remove(root.string() + ".out");
+        build_tree(root, megabytes);
+        std::ofstream(root / ".complete");
+    }
+    const int iterations = 5;
+
+    struct Case {
+        const char* name;
+        std::string pattern;
+        bool icase;
+    };
+    std::vector<Case> cases = {
+        {"rare literal", "compute_total", false},
+        {"common literal", "update_state", false},
+        {"regex with literal", "count_[0-9]+ = update_node", false},
+        {"regex, common literal", "[a-z]+_9[0-9] = update_[a-z]+\\(index", false},
+        {"regex without literal", "\\b9[0-9]{2}\\)", false},
+        {"case-insensitive", "todo: handle", true},
+    };
+
+    for (const auto& c : cases) {
+        std::vector<double> grep_ms;
+        for (int i = 0; i < iterations; ++i) {
+            grep_ms.push_back(run_grep(root, c.pattern, c.icase ? "-E -i" : "-E"));
+        }
+        bench::report(std::string("grep -rn   ") + c.name, grep_ms);
+
+        core::search::RegexOptions options;
+        options.case_insensitive = c.icase;
+        auto compiled = core::search::Regex::compile(c.pattern, options);
+        auto regex = std::get<core::search::Regex>(std::move(compiled));
+        core::search::GrepOptions grep_options;
+        grep_options.max_matches = static_cast<std::size_t>(-1);
+        std::vector<double> engine_ms;
+        std::atomic<std::size_t> matches{0};
+        for (int i = 0; i < iterations; ++i) {
+            matches = 0;
+            bench::Stopwatch watch;
+            core::search::grep(root.string(), regex, grep_options, {},
+                               [&](core::search::GrepMatch&&) { ++matches; });
+            engine_ms.push_back(watch.elapsed_ms());
+        }
+        bench::report(std::string("engine     ") + c.name, engine_ms,
+                      "matches=" + std::to_string(matches.load()));
+    }
+    return 0;
+}
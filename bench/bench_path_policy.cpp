@@ -0,0 +1,104 @@
+// Path policy checks: allows() on canonical paths (the per-argument cost
+// every tool call pays), and resolve(), which canonicalizes with openat()
+// first, against realpath(3) followed by the same check.
+// Usage: agent_bench_path_policy [workspace]   (default: the current directory)
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/fs/path_policy.hpp"
+
+using namespace agent;
+
+int main(int argc, char** argv) {
+    std::string root = std::filesystem::canonical(argc > 1 ? argv[1] : ".").string();
+    auto compiled = core::fs::PathPolicy::compile(
+        {{root},
+         {"third_party", "vendor", "/usr/include", "/usr/lib", "**/*.lock", "docs/generated/**"},
+         {".env*", "*.pem", "*.key", ".git/**", "/etc", "/root/.ssh", "**/secrets/**"}});
+    if (core::errors::is_error(compiled)) {
+        std::fprintf(stderr, "%s\n", core::errors::get_error(compiled).message.c_str());
+        return 1;
+    }
+    const auto& policy = core::errors::get_value(compiled);
+
+    // Existing files where there are some, so that resolve() has work to do
+    std::vector<std::string> relative;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+        if (relative.size() == 200) break;
+        std::string path = std::filesystem::relative(entry.path(), root).string();
+        if (path.starts_with(".git/") || path.starts_with("_")) continue;
+        relative.push_back(path);
+    }
+    for (const char* path : {"src/../../etc/passwd", "deep/a/b/c/d/e/f/new.cpp", ".env",
+                             "config/prod.pem", "vendor/lib/x.h", "Cargo.lock"}) {
+        relative.emplace_back(path);
+    }
+    std::vector<std::string> absolute;
+    for (const auto& path : relative) absolute.push_back(root + "/" + path);
+    absolute.emplace_back("/usr/include/stdio.h");
+    absolute.emplace_back("/etc/shadow");
+
+    const int rounds = 20;
+    const int repeat = 200;
+    // Mean over the rounds, per path checked
+    auto per_op = [&](double ms, std::size_t paths, int passes) {
+        char extra[64];
+        std::snprintf(extra, sizeof(extra), "paths=%zu %.1fns/path", paths,
+                      ms * 1e6 / static_cast<double>(paths * static_cast<std::size_t>(passes)));
+        return std::string(extra);
+    };
+
+    std::vector<double> checks;
+    double total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        bench::Stopwatch watch;
+        std::size_t allowed = 0;
+        for (int k = 0; k < repeat; ++k) {
+            for (const auto& path : absolute) {
+                allowed += policy.allows(path, core::fs::PathAccess::Write);
+            }
+        }
+        bench::do_not_optimize(allowed);
+        checks.push_back(watch.elapsed_ms());
+        total += checks.back();
+    }
+    bench::report("policy allows (canonical)", checks,
+                  per_op(total / rounds, absolute.size(), repeat));
+
+    std::vector<double> resolves;
+    total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        bench::Stopwatch watch;
+        std::size_t allowed = 0;
+        for (const auto& path : relative) {
+            allowed += !core::errors::is_error(policy.resolve(path, core::fs::PathAccess::Read));
+        }
+        bench::do_not_optimize(allowed);
+        resolves.push_back(watch.elapsed_ms());
+        total += resolves.back();
+    }
+    bench::report("policy resolve (openat)", resolves,
+                  per_op(total / rounds, relative.size(), 1));
+
+    std::vector<double> baseline;
+    total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        bench::Stopwatch watch;
+        std::size_t allowed = 0;
+        for (const auto& path : absolute) {
+            char buffer[PATH_MAX];
+            if (::realpath(path.c_str(), buffer)) {
+                allowed += policy.allows(buffer, core::fs::PathAccess::Read);
+            }
+        }
+        bench::do_not_optimize(allowed);
+        baseline.push_back(watch.elapsed_ms());
+        total += baseline.back();
+    }
+    bench::report("realpath + allows", baseline, per_op(total / rounds, absolute.size(), 1));
+    return 0;
+}
@@ -0,0 +1,59 @@
+// read_file on a large file: reading a window deep into it, against the
+// istream + getline loop it replaces.
+// Usage: agent_bench_read_file [megabytes]
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "bench_common.hpp"
+#include "core/tools/read_file_tool.hpp"
+
+using namespace agent;
+
+int main(int argc, char** argv) {
+    std::size_t megabytes = argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : 64;
+    auto path = std::filesystem::temp_directory_path() / "agent_bench_read_file.txt";
+
+    std::size_t lines = 0;
+    {
+        std::ofstream out(path, std::ios::binary);
+        std::string line = "    int value = compute(42); // some typical source line\n";
+        for (std::size_t bytes = 0; bytes < megabytes << 20; bytes += line.size(), ++lines) {
+            out << line;
+        }
+    }
+    std::size_t start = lines * 9 / 10;
+    const int iterations = 20;
+
+    std::vector<double> getline_ms;
+    for (int i = 0; i < iterations; ++i) {
+        bench::Stopwatch watch;
+        std::ifstream in(path);
+        std::string line, window;
+        for (std::size_t n = 1; std::getline(in, line) && n < start + 200; ++n) {
+            if (n >= start) window += line + "\n";
+        }
+        getline_ms.push_back(watch.elapsed_ms());
+        bench::do_not_optimize(window);
+    }
+    bench::report("getline window at 90%", getline_ms);
+
+    core::tools::ReadFileTool tool;
+    nlohmann::json args = {{"path", path.string()},
+                           {"start_line", start},
+                           {"end_line", start + 199}};
+    std::string arguments = args.dump();
+    std::vector<double> tool_ms;
+    for (int i = 0; i < iterations; ++i) {
+        bench::Stopwatch watch;
+        auto result = tool.execute({"c", "read_file", arguments});
+        tool_ms.push_back(watch.elapsed_ms());
+        bench::do_not_optimize(result);
+    }
+    bench::report("read_file window at 90%", tool_ms);
+
+    std::filesystem::remove(path);
+    return 0;
+}
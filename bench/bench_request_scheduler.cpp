@@ -0,0 +1,128 @@
+// Many sessions sharing one provider quota: a provider that enforces the
+// quota itself answers 429 when it is exceeded. Sends with and without the
+// scheduler in front, and reports achieved requests per second against
+// the quota, the 429s, and per-request latency.
+// Usage: agent_bench_request_scheduler [sessions] [requests_per_minute] [seconds]
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_common.hpp"
+#include "providers/request_scheduler.hpp"
+
+using namespace agent;
+
+namespace {
+
+    core::context::BpeTokenizer byte_tokenizer() {
+        std::vector<std::pair<std::string, std::uint32_t>> ranks;
+        for (int byte = 0; byte < 256; ++byte) {
+            ranks.emplace_back(std::string(1, static_cast<char>(byte)), byte);
+        }
+        return std::move(std::get<core::context::BpeTokenizer>(
+            core::context::BpeTokenizer::from_ranks(ranks, "bytes")));
+    }
+
+    // Counts requests in a bucket sized like the real quota and rejects
+    // what does not fit, the way a vendor API does
+    class QuotaProvider : public providers::Provider {
+    public:
+        QuotaProvider(double per_minute, double burst_seconds)
+            : per_second_(per_minute / 60.0), capacity_(per_second_ * burst_seconds),
+              level_(capacity_), refilled_(std::chrono::steady_clock::now()) {}
+
+        core::errors::Result<providers::CompletionResponse> complete(
+            const providers::CompletionRequest&, const providers::EventSink&) override {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                auto now = std::chrono::steady_clock::now();
+                level_ = std::min(capacity_, level_ + per_second_ *
+                                                          std::chrono::duration<double>(
+                                                              now - refilled_).count());
+                refilled_ = now;
+                if (level_ < 1.0) {
+                    ++rejected;
+                    return core::errors::AgentError{core::errors::ErrorCategory::Provider,
+                                                    "HTTP 429: rate limit exceeded"};
+                }
+                level_ -= 1.0;
+            }
+            ++served;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            return providers::CompletionResponse{
+                protocol::Message{protocol::Role::Assistant, "ok", {}, std::nullopt},
+                protocol::StopReason::Finished};
+        }
+
+        std::atomic<std::size_t> served{0};
+        std::atomic<std::size_t> rejected{0};
+
+    private:
+        std::mutex mutex_;
+        double per_second_;
+        double capacity_;
+        double level_;
+        std::chrono::steady_clock::time_point refilled_;
+    };
+
+    void run(const char* name, int sessions, double per_minute, double seconds, bool scheduled,
+             core::context::TokenEstimator& estimator) {
+        constexpr double kBurstSeconds = 1.0;
+        QuotaProvider upstream(per_minute, kBurstSeconds);
+        providers::RateLimits limits;
+        limits.requests_per_minute = per_minute;
+        limits.burst_seconds = kBurstSeconds;
+        providers::RequestScheduler scheduler(limits);
+
+        std::mutex samples_mutex;
+        std::vector<double> samples;
+        auto deadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(seconds));
+        bench::Stopwatch total;
+        std::vector<std::thread> threads;
+        for (int s = 0; s < sessions; ++s) {
+            threads.emplace_back([&, s] {
+                providers::ScheduledProvider gated(upstream, scheduler, estimator,
+                                                   "session-" + std::to_string(s));
+                providers::Provider& provider =
+                    scheduled ? static_cast<providers::Provider&>(gated) : upstream;
+                providers::CompletionRequest request;
+                request.messages.push_back(
+                    {protocol::Role::User, "Summarize the module.", {}, std::nullopt});
+                request.params.max_output_tokens = 256;
+                while (std::chrono::steady_clock::now() < deadline) {
+                    bench::Stopwatch watch;
+                    auto response = provider.complete(request, {});
+                    bench::do_not_optimize(response);
+                    std::lock_guard<std::mutex> lock(samples_mutex);
+                    samples.push_back(watch.elapsed_ms());
+                }
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        double elapsed = total.elapsed_ms() / 1000.0;
+        char extra[128];
+        std::snprintf(extra, sizeof(extra), "served=%.1f/s quota=%.1f/s 429s=%zu",
+                      static_cast<double>(upstream.served.load()) / elapsed, per_minute / 60.0,
+                      upstream.rejected.load());
+        bench::report(name, samples, extra);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int sessions = argc > 1 ? std::atoi(argv[1]) : 32;
+    double per_minute = argc > 2 ? std::atof(argv[2]) : 6000.0;
+    double seconds = argc > 3 ? std::atof(argv[3]) : 3.0;
+
+    auto tokenizer = byte_tokenizer();
+    core::context::TokenEstimator estimator(tokenizer);
+    run("direct", sessions, per_minute, seconds, false, estimator);
+    run("scheduled", sessions, per_minute, seconds, true, estimator);
+    return 0;
+}
@@ -0,0 +1,38 @@
+// Per-command overhead of run_command: a fresh /bin/sh per call against a
+// command written into an already running shell.
+// Usage: agent_bench_shell [iterations]
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/exec/command_runner.hpp"
+#include "core/exec/shell_pool.hpp"
+
+using namespace agent;
+
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 200;
+
+    for (const char* command : {"true", "echo hello", "ls / > /dev/null"}) {
+        std::vector<double> one_shot;
+        for (int i = 0; i < iterations; ++i) {
+            bench::Stopwatch watch;
+            auto result = core::exec::run_command(core::exec::CommandSpec::shell(command));
+            one_shot.push_back(watch.elapsed_ms());
+            bench::do_not_optimize(result);
+        }
+        bench::report(std::string("one-shot  ") + command, one_shot);
+
+        core::exec::ShellPool pool;
+        pool.run("true", 10000);  // Warm-up: the first call pays for the shell start
+        std::vector<double> warm;
+        for (int i = 0; i < iterations; ++i) {
+            bench::Stopwatch watch;
+            auto result = pool.run(command, 10000);
+            warm.push_back(watch.elapsed_ms());
+            bench::do_not_optimize(result);
+        }
+        bench::report(std::string("warm      ") + command, warm);
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+// SSE parsing + delta extraction throughput on a synthetic provider stream.
+// Usage: agent_bench_sse [events] [read_size_bytes]
+#include <cstdlib>
+#include <string>
+#include "bench_common.hpp"
+#include "providers/sse/delta_extractor.hpp"
+#include "providers/sse/sse_parser.hpp"
+
+using namespace agent;
+
+int main(int argc, char** argv) {
+    std::size_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::size_t read_size = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1460;
+
+    // OpenAI-style chunks with a short delta each, like real token streams
+    std::string stream;
+    for (std::size_t i = 0; i < events; ++i) {
+        stream += "data: {\"id\":\"chatcmpl-1\",\"object\":\"chat.completion.chunk\",\"choices\":"
+                  "[{\"index\":0,\"delta\":{\"content\":\" token";
+        stream += std::to_string(i % 100);
+        stream += "\"},\"finish_reason\":null}]}\n\n";
+    }
+    stream += "data: [DONE]\n\n";
+
+    std::vector<double> runs_ms;
+    std::size_t deltas = 0;
+    for (int run = 0; run < 5; ++run) {
+        providers::sse::SseParser parser;
+        providers::sse::DeltaExtractor extractor("content");
+        std::size_t bytes = 0;
+        auto sink = [&](const protocol::AgentEvent& event) {
+            bytes += std::get<protocol::MessageDeltaEvent>(event).delta_text.size();
+        };
+        auto handler = [&](const providers::sse::SseEvent& event) {
+            if (extractor.on_event(event, sink)) ++deltas;
+        };
+
+        bench::Stopwatch watch;
+        for (std::size_t pos = 0; pos < stream.size(); pos += read_size) {
+            parser.feed(std::string_view(stream).substr(pos, read_size), handler);
+        }
+        parser.finish(handler);
+        runs_ms.push_back(watch.elapsed_ms());
+        bench::do_not_optimize(bytes);
+    }
+
+    double best_ms = bench::percentile(runs_ms, 0);
+    double ns_per_event = best_ms * 1e6 / static_cast<double>(events);
+    double mb_per_s = static_cast<double>(stream.size()) / (best_ms / 1000.0) / 1e6;
+    bench::report("sse/parse+extract", runs_ms,
+                  "ns/event=" + std::to_string(ns_per_event) +
+                      " MB/s=" + std::to_string(static_cast<long long>(mb_per_s)));
+    return deltas == 0;
+}
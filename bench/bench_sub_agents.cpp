@@ -0,0 +1,84 @@
+// Sub-agent fan-out against the mock provider: wall time for N children
+// that each take a fixed time to first token, run one at a time and with
+// several at once, plus the cost of forking a long parent history.
+// Usage: agent_bench_sub_agents [children] [first_token_ms]
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/loop/sub_agents.hpp"
+#include "providers/mock_provider.hpp"
+
+using namespace agent;
+
+namespace {
+
+    // One token per byte: the slowest tokenizer we could be handed
+    core::context::BpeTokenizer byte_tokenizer() {
+        std::vector<std::pair<std::string, std::uint32_t>> ranks;
+        for (int byte = 0; byte < 256; ++byte) {
+            ranks.emplace_back(std::string(1, static_cast<char>(byte)), byte);
+        }
+        return std::move(std::get<core::context::BpeTokenizer>(
+            core::context::BpeTokenizer::from_ranks(ranks, "bytes")));
+    }
+
+    std::vector<protocol::Message> long_history(int turns) {
+        std::vector<protocol::Message> history;
+        history.push_back({protocol::Role::System, "You are a careful refactoring agent.", {},
+                           std::nullopt});
+        for (int i = 0; i < turns; ++i) {
+            std::string text(2000, static_cast<char>('a' + i % 26));
+            history.push_back({protocol::Role::User, text, {}, std::nullopt});
+            history.push_back({protocol::Role::Assistant, text, {}, std::nullopt});
+        }
+        return history;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int children = argc > 1 ? std::atoi(argv[1]) : 16;
+    double first_token_ms = argc > 2 ? std::atof(argv[2]) : 20.0;
+
+    auto tokenizer = byte_tokenizer();
+    core::context::TokenEstimator estimator(tokenizer);
+    core::tools::ToolDispatcher dispatcher;
+    providers::MockTiming timing;
+    timing.first_token.mean_ms = first_token_ms;
+    providers::MockProvider provider({{"Summary of the module.", {}, protocol::StopReason::Finished,
+                                       std::nullopt}},
+                                     timing, /*loop=*/true);
+
+    std::vector<core::loop::SubAgentTask> tasks;
+    for (int i = 0; i < children; ++i) {
+        tasks.push_back({"call-" + std::to_string(i), "Refactor src/module_" +
+                                                          std::to_string(i) + ".cpp"});
+    }
+
+    for (std::size_t concurrent : {std::size_t{1}, std::size_t{4}, std::size_t{16}}) {
+        for (int turns : {1, 100}) {
+            core::loop::SubAgentOptions options;
+            options.max_concurrent = concurrent;
+            core::loop::SubAgentPool pool(provider, dispatcher, estimator, options);
+            auto history = long_history(turns);
+
+            std::vector<double> samples;
+            for (int r = 0; r < 3; ++r) {
+                bench::Stopwatch watch;
+                auto results = pool.fan_out(history, tasks);
+                bench::do_not_optimize(results);
+                samples.push_back(watch.elapsed_ms());
+            }
+            char name[64];
+            std::snprintf(name, sizeof(name), "fan-out x%d, %zu at once, %d turns", children,
+                          concurrent, turns);
+            char extra[64];
+            std::snprintf(extra, sizeof(extra), "peak=%zu tokens=%zu",
+                          pool.stats().peak_concurrent, pool.stats().tokens);
+            bench::report(name, samples, extra);
+        }
+    }
+    return 0;
+}
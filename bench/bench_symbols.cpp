@@ -0,0 +1,83 @@
+// Symbol index build and lookups against grepping for a definition.
+// Usage: agent_bench_symbols [directory]
+//   Defaults to /usr/include, which on a typical box is a few million lines
+//   of real C and C++ headers.
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/search/grep.hpp"
+#include "core/search/symbol_index.hpp"
+
+using namespace agent;
+
+int main(int argc, char** argv) {
+    std::string root = argc > 1 ? argv[1] : "/usr/include";
+    const int iterations = 20;
+
+    // 1. Building, three times; the first one also warms the page cache
+    std::vector<double> build_ms;
+    std::unique_ptr<core::search::SymbolIndex> index;
+    for (int i = 0; i < 3; ++i) {
+        bench::Stopwatch watch;
+        auto built = core::search::SymbolIndex::open(root);
+        build_ms.push_back(watch.elapsed_ms());
+        if (core::errors::is_error(built)) {
+            std::fprintf(stderr, "%s\n", core::errors::get_error(built).message.c_str());
+            return 1;
+        }
+        index = std::move(std::get<std::unique_ptr<core::search::SymbolIndex>>(built));
+    }
+    build_ms.erase(build_ms.begin());
+    auto stats = index->stats();
+    bench::report("index build", build_ms,
+                  "files=" + std::to_string(stats.files) +
+                      " symbols=" + std::to_string(stats.symbols) +
+                      " names=" + std::to_string(stats.names));
+
+    // 2. Lookups, and the grep an agent would otherwise run for the same answer
+    struct Case {
+        const char* name;
+        core::search::SymbolQuery query;
+        const char* grep;
+    };
+    auto query = [](std::string name, bool prefix = false) {
+        core::search::SymbolQuery q;
+        q.name = std::move(name);
+        q.prefix = prefix;
+        return q;
+    };
+    std::vector<Case> cases = {
+        {"function", query("memcpy"), "\\bmemcpy\\s*\\("},
+        {"qualified method", query("vector::push_back"), "\\bpush_back\\s*\\("},
+        {"class", query("basic_string"), "(class|struct)\\s+basic_string\\b"},
+        {"macro", query("EINVAL"), "#\\s*define\\s+EINVAL\\b"},
+        {"prefix", query("pthread_mutex_", true), "\\bpthread_mutex_\\w*\\s*\\("},
+    };
+    for (auto& c : cases) {
+        std::vector<double> index_ms, grep_ms;
+        std::size_t found = 0;
+        std::atomic<std::size_t> grepped{0};
+        for (int i = 0; i < iterations; ++i) {
+            bench::Stopwatch watch;
+            found = index->find(c.query).size();
+            index_ms.push_back(watch.elapsed_ms());
+        }
+        auto regex = std::get<core::search::Regex>(core::search::Regex::compile(c.grep));
+        core::search::GrepOptions options;
+        options.max_matches = static_cast<std::size_t>(-1);
+        for (int i = 0; i < 3; ++i) {
+            grepped = 0;
+            bench::Stopwatch watch;
+            core::search::grep(root, regex, options, {},
+                               [&](core::search::GrepMatch&&) { ++grepped; });
+            grep_ms.push_back(watch.elapsed_ms());
+        }
+        bench::report(std::string("find_symbol  ") + c.name, index_ms,
+                      "results=" + std::to_string(found));
+        bench::report(std::string("grep         ") + c.name, grep_ms,
+                      "matches=" + std::to_string(grepped.load()));
+    }
+    return 0;
+}
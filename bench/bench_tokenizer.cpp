@@ -0,0 +1,89 @@
+// Token counting throughput over prose- and code-like text.
+// Usage: agent_bench_tokenizer [megabytes] [tiktoken_file]
+// Without a file, a synthetic vocabulary (bytes + frequent words) is used,
+// which exercises the same code paths with shallower merges.
+#include <cstdlib>
+#include <optional>
+#include <string>
+#include "bench_common.hpp"
+#include "core/context/bpe_tokenizer.hpp"
+
+using namespace agent;
+using core::context::BpeTokenizer;
+
+namespace {
+
+    const char* kWords[] = {"the", "agent", "reads", "file", "and", "returns", "output",
+                            "std", "string", "const", "auto", "for", "if", "return",
+                            "int", "include", "vector", "size", "token", "count"};
+
+    BpeTokenizer synthetic() {
+        std::vector<std::pair<std::string, std::uint32_t>> ranks;
+        for (int byte = 0; byte < 256; ++byte) {
+            ranks.emplace_back(std::string(1, static_cast<char>(byte)), byte);
+        }
+        std::uint32_t next = 256;
+        for (const char* word : kWords) {
+            std::string w = word;
+            for (std::size_t i = 2; i <= w.size(); ++i) ranks.emplace_back(w.substr(0, i), next++);
+            ranks.emplace_back(" " + w, next++);
+        }
+        // Real vocabularies carry every 1-3 digit number, indentation and common punctuation
+        for (int number = 10; number < 1000; ++number) {
+            ranks.emplace_back(std::to_string(number), next++);
+        }
+        for (std::size_t spaces = 2; spaces <= 16; ++spaces) {
+            ranks.emplace_back(std::string(spaces, ' '), next++);
+        }
+        for (const char* punct : {"()", "();", " ("}) ranks.emplace_back(punct, next++);
+        return std::move(std::get<BpeTokenizer>(BpeTokenizer::from_ranks(ranks, "synthetic")));
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 64;
+
+    std::optional<BpeTokenizer> tokenizer;
+    if (argc > 2) {
+        auto loaded = BpeTokenizer::load(argv[2]);
+        if (core::errors::is_error(loaded)) {
+            std::fprintf(stderr, "%s\n", core::errors::get_error(loaded).message.c_str());
+            return 1;
+        }
+        tokenizer.emplace(std::move(std::get<BpeTokenizer>(loaded)));
+    } else {
+        tokenizer.emplace(synthetic());
+    }
+
+    // Mixed prose and code, roughly what tool output looks like
+    std::string text;
+    std::size_t target = megabytes << 20;
+    std::uint32_t state = 1;
+    while (text.size() < target) {
+        state = state * 1664525u + 1013904223u;
+        text += kWords[(state >> 16) % (sizeof(kWords) / sizeof(kWords[0]))];
+        switch ((state >> 8) % 8) {
+            case 0: text += "(); "; break;
+            case 1: text += "\n    "; break;
+            case 2: text += std::to_string(state % 10000) + " "; break;
+            default: text += ' '; break;
+        }
+    }
+
+    std::vector<double> runs_ms;
+    std::size_t tokens = 0;
+    for (int run = 0; run < 5; ++run) {
+        bench::Stopwatch watch;
+        tokens = tokenizer->count(text);
+        runs_ms.push_back(watch.elapsed_ms());
+        bench::do_not_optimize(tokens);
+    }
+
+    double best_ms = bench::percentile(runs_ms, 0);
+    double mb_per_s = static_cast<double>(text.size()) / (best_ms / 1000.0) / 1e6;
+    bench::report("tokenizer/count", runs_ms,
+                  "tokens=" + std::to_string(tokens) +
+                      " MB/s=" + std::to_string(static_cast<long long>(mb_per_s)));
+    return tokens == 0;
+}
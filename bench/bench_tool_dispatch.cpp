@@ -0,0 +1,168 @@
+// Tool dispatch overhead: binding a call's arguments into its struct with
+// bind_arguments() against parsing them into an nlohmann DOM and reading
+// the fields back out, and looking the tool up by name in a
+// PerfectHashMap against an unordered_map keyed by std::string.
+// Usage: agent_bench_tool_dispatch
+#include <array>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "bench_common.hpp"
+#include "core/hash/perfect_hash.hpp"
+#include "core/tools/tool_args.hpp"
+
+using namespace agent;
+
+namespace {
+
+    // The shape of the search tool's arguments
+    struct Args {
+        std::string pattern;
+        std::string path;
+        std::string glob;
+        bool literal = false;
+        bool case_insensitive = false;
+        std::optional<long long> context;
+        std::optional<long long> max_results;
+
+        static constexpr auto fields() {
+            return std::tuple{core::tools::arg("pattern", &Args::pattern).non_empty(),
+                              core::tools::arg("path", &Args::path).optional(),
+                              core::tools::arg("glob", &Args::glob).optional(),
+                              core::tools::arg("literal", &Args::literal).optional(),
+                              core::tools::arg("case_insensitive", &Args::case_insensitive)
+                                  .optional(),
+                              core::tools::arg("context", &Args::context).at_least(0),
+                              core::tools::arg("max_results", &Args::max_results).at_least(1)};
+        }
+    };
+
+    // What a tool did before typed binding
+    bool parse_with_dom(std::string_view json, Args& out) {
+        auto args = nlohmann::json::parse(json, nullptr, false);
+        if (args.is_discarded() || !args.is_object() || !args.contains("pattern")) return false;
+        out.pattern = args["pattern"].get<std::string>();
+        out.path = args.value("path", "");
+        out.glob = args.value("glob", "");
+        out.literal = args.value("literal", false);
+        out.case_insensitive = args.value("case_insensitive", false);
+        if (args.contains("context")) out.context = args["context"].get<long long>();
+        if (args.contains("max_results")) out.max_results = args["max_results"].get<long long>();
+        return true;
+    }
+
+    std::string per_op(double ms, std::size_t ops) {
+        char extra[64];
+        std::snprintf(extra, sizeof(extra), "%.1fns/op", ms * 1e6 / static_cast<double>(ops));
+        return std::string(extra);
+    }
+
+} // namespace
+
+int main() {
+    const std::vector<std::string> calls = {
+        R"({"pattern": "TODO"})",
+        R"({"pattern": "std::(unique|shared)_ptr<\\w+>", "path": "src/core", "glob": "*.cpp",
+            "context": 2, "max_results": 100})",
+        R"({"pattern": "read_file", "literal": true, "case_insensitive": true,
+            "path": "src/core/tools/read_file_tool.cpp"})",
+    };
+    const int rounds = 20;
+    const int repeat = 20000;
+
+    std::vector<double> dom;
+    double total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        bench::Stopwatch watch;
+        std::size_t bound = 0;
+        for (int k = 0; k < repeat; ++k) {
+            for (const auto& call : calls) {
+                Args args;
+                bound += parse_with_dom(call, args);
+                bench::do_not_optimize(args);
+            }
+        }
+        bench::do_not_optimize(bound);
+        dom.push_back(watch.elapsed_ms());
+        total += dom.back();
+    }
+    bench::report("arguments via nlohmann DOM", dom, per_op(total / rounds, repeat * calls.size()));
+
+    std::vector<double> typed;
+    total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        bench::Stopwatch watch;
+        std::size_t bound = 0;
+        for (int k = 0; k < repeat; ++k) {
+            for (const auto& call : calls) {
+                auto args = core::tools::bind_arguments<Args>(call);
+                bound += !core::errors::is_error(args);
+                bench::do_not_optimize(args);
+            }
+        }
+        bench::do_not_optimize(bound);
+        typed.push_back(watch.elapsed_ms());
+        total += typed.back();
+    }
+    bench::report("arguments via bind_arguments", typed,
+                  per_op(total / rounds, repeat * calls.size()));
+
+    // A registry the size of ours, and lookups as the loop makes them
+    const std::array<std::string, 8> names = {"read_file", "search",     "find_symbol",
+                                              "apply_patch", "run_command", "list_dir",
+                                              "web_fetch",  "git_status"};
+    std::unordered_map<std::string, int> by_map;
+    std::vector<std::pair<std::string, int>> entries;
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        by_map.emplace(names[i], static_cast<int>(i));
+        entries.emplace_back(names[i], static_cast<int>(i));
+    }
+    core::hash::PerfectHashMap<int> by_hash(entries);
+    std::vector<std::string_view> lookups;
+    for (int i = 0; i < 64; ++i) lookups.push_back(names[(i * 5) % names.size()]);
+    lookups.push_back("unknown_tool");
+    const int lookup_repeat = 100000;
+
+    std::vector<double> map_samples;
+    total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        bench::Stopwatch watch;
+        long long sum = 0;
+        for (int k = 0; k < lookup_repeat; ++k) {
+            for (auto name : lookups) {
+                auto it = by_map.find(std::string(name));
+                sum += it == by_map.end() ? -1 : it->second;
+            }
+        }
+        bench::do_not_optimize(sum);
+        map_samples.push_back(watch.elapsed_ms());
+        total += map_samples.back();
+    }
+    bench::report("lookup via unordered_map", map_samples,
+                  per_op(total / rounds, lookup_repeat * lookups.size()));
+
+    std::vector<double> hash_samples;
+    total = 0;
+    for (int r = 0; r < rounds; ++r) {
+        bench::Stopwatch watch;
+        long long sum = 0;
+        for (int k = 0; k < lookup_repeat; ++k) {
+            for (auto name : lookups) {
+                const int* found = by_hash.find(name);
+                sum += found ? *found : -1;
+            }
+        }
+        bench::do_not_optimize(sum);
+        hash_samples.push_back(watch.elapsed_ms());
+        total += hash_samples.back();
+    }
+    bench::report("lookup via PerfectHashMap", hash_samples,
+                  per_op(total / rounds, lookup_repeat * lookups.size()));
+    return 0;
+}
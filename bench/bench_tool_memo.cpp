@@ -0,0 +1,90 @@
+// Tool result memoization: the same read_file and search calls dispatched
+// repeatedly, with and without a ToolMemo, as a model re-reading files and
+// re-running searches over an unchanged workspace does.
+// Usage: agent_bench_tool_memo [workspace]   (default: the current directory)
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/tools/read_file_tool.hpp"
+#include "core/tools/search_tool.hpp"
+#include "core/tools/tool_dispatcher.hpp"
+#include "core/tools/tool_memo.hpp"
+
+using namespace agent;
+
+namespace {
+
+    void register_tools(core::tools::ToolDispatcher& dispatcher, const std::string& root) {
+        core::tools::ReadFileOptions read_options;
+        read_options.root = root;
+        core::tools::SearchOptions search_options;
+        search_options.root = root;
+        dispatcher.register_tool(std::make_unique<core::tools::ReadFileTool>(read_options));
+        dispatcher.register_tool(std::make_unique<core::tools::SearchTool>(search_options));
+    }
+
+    void run(const char* name, const core::tools::ToolDispatcher& dispatcher,
+             const std::vector<protocol::ToolCall>& calls, int rounds) {
+        std::vector<double> samples;
+        double total = 0;
+        for (int r = 0; r < rounds; ++r) {
+            bench::Stopwatch watch;
+            std::size_t bytes = 0;
+            for (const auto& call : calls) bytes += dispatcher.dispatch(call).output.size();
+            bench::do_not_optimize(bytes);
+            samples.push_back(watch.elapsed_ms());
+            total += samples.back();
+        }
+        char extra[64];
+        std::snprintf(extra, sizeof(extra), "calls=%zu %.2fus/call", calls.size(),
+                      total * 1e3 / static_cast<double>(calls.size() * rounds));
+        bench::report(name, samples, extra);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string root = std::filesystem::canonical(argc > 1 ? argv[1] : ".").string();
+
+    std::vector<protocol::ToolCall> reads;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(root)) {
+        if (reads.size() == 100) break;
+        std::string path = std::filesystem::relative(entry.path(), root).string();
+        if (!entry.is_regular_file() || path.starts_with(".git/") || path.starts_with("_")) {
+            continue;
+        }
+        std::string arguments = R"({"path": ")";
+        arguments.append(path).append(R"("})");
+        reads.push_back({"call", "read_file", arguments});
+    }
+    std::vector<protocol::ToolCall> searches;
+    for (const char* pattern : {"TODO", "std::mutex", "return nullptr", "errors::Result"}) {
+        std::string arguments = R"({"pattern": ")";
+        arguments.append(pattern).append(R"("})");
+        searches.push_back({"call", "search", arguments});
+    }
+
+    core::tools::ToolDispatcher plain;
+    register_tools(plain, root);
+    core::tools::ToolMemo memo;
+    if (core::errors::is_error(memo.watch(root))) {
+        std::fprintf(stderr, "Cannot watch %s\n", root.c_str());
+        return 1;
+    }
+    core::tools::ToolDispatcher memoized;
+    register_tools(memoized, root);
+    memoized.set_memo(&memo);
+
+    run("read_file, no memo", plain, reads, 20);
+    run("read_file, memo", memoized, reads, 20);
+    run("search, no memo", plain, searches, 5);
+    run("search, memo", memoized, searches, 5);
+
+    auto stats = memo.stats();
+    std::printf("memo: hits=%zu misses=%zu hit_ratio=%.3f entries=%zu bytes=%zu\n", stats.hits,
+                stats.misses, stats.hit_ratio(), stats.entries, stats.bytes);
+    return 0;
+}
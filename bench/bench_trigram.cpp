@@ -0,0 +1,141 @@
+// Trigram-index-narrowed search against a full scan over a synthetic source tree.
+// Usage: agent_bench_trigram [megabytes] [directory]
+//   The tree (files of ~16 KiB of C-like code, each with a few identifiers of
+//   its own) is built on the first run and reused.
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/search/grep.hpp"
+#include "core/search/trigram_index.hpp"
+
+using namespace agent;
+namespace stdfs = std::filesystem;
+
+namespace {
+
+    void build_tree(const stdfs::path& root, std::size_t megabytes) {
+        std::mt19937 rng(9);
+        const char* words[] = {"value", "index", "count", "buffer", "state", "result", "node"};
+        std::size_t written = 0;
+        for (int file = 0; written < megabytes << 20; ++file) {
+            stdfs::path dir = root / ("mod" + std::to_string(file / 50));
+            stdfs::create_directories(dir);
+            std::ofstream out(dir / ("file" + std::to_string(file) + ".c"));
+            std::string body = "// marker_file" + std::to_string(file) + "_end\n";
+            while (body.size() < 16 * 1024) {
+                const char* a = words[rng() % 7];
+                const char* b = words[rng() % 7];
+                body += "    int " + std::string(a) + "_" + std::to_string(rng() % 100) +
+                        " = update_" + b + "(" + a + ", " + std::to_string(rng() % 1000) + ");\n";
+                if (rng() % 50 == 0) {
+                    body += "static int helper_" + std::to_string(rng() % 100000) + "(void);\n";
+                }
+            }
+            out << body;
+            written += body.size();
+        }
+    }
+
+    std::size_t run(const std::string& root, const core::search::Regex& regex,
+                    const std::vector<std::string>* files) {
+        core::search::GrepOptions options;
+        options.max_matches = static_cast<std::size_t>(-1);
+        std::atomic<std::size_t> matches{0};
+        auto count = [&](core::search::GrepMatch&&) { ++matches; };
+        if (files) {
+            core::search::grep_files(root, *files, regex, options, 0, count);
+        } else {
+            core::search::grep(root, regex, options, {}, count);
+        }
+        return matches.load();
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t megabytes = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 256;
+    stdfs::path root = argc > 2 ? stdfs::path(argv[2])
+                                : stdfs::temp_directory_path() /
+                                      ("agent_bench_trigram_" + std::to_string(megabytes));
+    std::string snapshot = root.string() + ".idx";
+    if (!stdfs::exists(root / ".complete")) {
+        stdfs::remove_all(root);
+        build_tree(root, megabytes);
+        std::ofstream(root / ".complete");
+    }
+    const int iterations = 5;
+
+    // 1. Building from scratch, then reopening the saved snapshot
+    std::vector<double> build_ms, reopen_ms;
+    core::search::TrigramIndexOptions options;
+    options.path = snapshot;
+    std::unique_ptr<core::search::TrigramIndex> index;
+    for (int i = 0; i < 3; ++i) {
+        stdfs::remove(snapshot);
+        bench::Stopwatch watch;
+        auto built = core::search::TrigramIndex::open(root.string(), options);
+        build_ms.push_back(watch.elapsed_ms());
+        if (core::errors::is_error(built)) {
+            std::fprintf(stderr, "%s\n", core::errors::get_error(built).message.c_str());
+            return 1;
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        bench::Stopwatch watch;
+        index = std::move(std::get<std::unique_ptr<core::search::TrigramIndex>>(
+            core::search::TrigramIndex::open(root.string(), options)));
+        reopen_ms.push_back(watch.elapsed_ms());
+    }
+    auto stats = index->stats();
+    bench::report("index build", build_ms,
+                  "files=" + std::to_string(stats.files) +
+                      " trigrams=" + std::to_string(stats.trigrams) +
+                      " snapshot_kb=" + std::to_string(stats.snapshot_bytes >> 10));
+    bench::report("index reopen + stat", reopen_ms);
+
+    // 2. Queries
+    struct Case {
+        const char* name;
+        std::string pattern;
+        bool icase;
+    };
+    std::vector<Case> cases = {
+        {"one file's identifier", "marker_file777_end", false},
+        {"rare helper", "helper_4242\\(", false},
+        {"regex with literal", "marker_file12[0-9]_end", false},
+        {"case-insensitive", "MARKER_FILE31_END", true},
+        {"literal in every file", "update_node", false},
+    };
+    for (const auto& c : cases) {
+        core::search::RegexOptions regex_options;
+        regex_options.case_insensitive = c.icase;
+        auto compiled = core::search::Regex::compile(c.pattern, regex_options);
+        auto regex = std::get<core::search::Regex>(std::move(compiled));
+
+        std::vector<double> scan_ms, indexed_ms;
+        std::size_t scanned = 0, indexed = 0, candidates = 0;
+        for (int i = 0; i < iterations; ++i) {
+            bench::Stopwatch watch;
+            scanned = run(root.string(), regex, nullptr);
+            scan_ms.push_back(watch.elapsed_ms());
+
+            watch.reset();
+            auto files = index->candidates(regex.folded_literal());
+            indexed = run(root.string(), regex, files ? &*files : nullptr);
+            indexed_ms.push_back(watch.elapsed_ms());
+            candidates = files ? files->size() : stats.files;
+        }
+        bench::report(std::string("full scan  ") + c.name, scan_ms,
+                      "matches=" + std::to_string(scanned));
+        bench::report(std::string("indexed    ") + c.name, indexed_ms,
+                      "matches=" + std::to_string(indexed) +
+                          " candidates=" + std::to_string(candidates));
+    }
+    return 0;
+}
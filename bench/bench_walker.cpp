@@ -0,0 +1,91 @@
+// Workspace enumeration over a synthetic tree: std::filesystem's recursive
+// iterator against the walker on one thread and on every core.
+// Usage: agent_bench_walker [files] [directory]
+//   The tree (20 files per directory, 10 subdirectories per level, a
+//   .gitignore every few directories) is built on the first run and reused.
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bench_common.hpp"
+#include "core/fs/workspace_walker.hpp"
+
+using namespace agent;
+namespace stdfs = std::filesystem;
+
+namespace {
+
+    void build_tree(const stdfs::path& root, std::size_t files) {
+        std::size_t made = 0;
+        std::vector<stdfs::path> frontier{root};
+        for (std::size_t next = 0; made < files; ++next) {
+            stdfs::path dir = frontier[next];
+            stdfs::create_directories(dir);
+            if (next % 7 == 0) std::ofstream(dir / ".gitignore") << "*.o\nbuild/\n!keep.o\n";
+            for (int f = 0; f < 20 && made < files; ++f, ++made) {
+                std::ofstream(dir / ("file" + std::to_string(f) + (f % 5 == 0 ? ".o" : ".cpp")));
+            }
+            for (int d = 0; d < 10; ++d) {
+                frontier.push_back(dir / ((d == 9 ? "build" : "dir") + std::to_string(d)));
+            }
+        }
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t files = argc > 1 ? static_cast<std::size_t>(std::atoll(argv[1])) : 1000000;
+    stdfs::path root = argc > 2 ? stdfs::path(argv[2])
+                                : stdfs::temp_directory_path() /
+                                      ("agent_bench_walker_" + std::to_string(files));
+    if (!stdfs::exists(root / ".complete")) {
+        bench::Stopwatch watch;
+        stdfs::remove_all(root);
+        build_tree(root, files);
+        std::ofstream(root / ".complete");
+        std::printf("built %zu files in %.0f ms\n", files, watch.elapsed_ms());
+    }
+    const int iterations = 5;
+
+    std::vector<double> samples;
+    std::size_t seen = 0;
+    for (int i = 0; i < iterations; ++i) {
+        bench::Stopwatch watch;
+        seen = 0;
+        for (auto it = stdfs::recursive_directory_iterator(root);
+             it != stdfs::recursive_directory_iterator(); ++it) {
+            ++seen;
+        }
+        samples.push_back(watch.elapsed_ms());
+    }
+    bench::report("std::filesystem (no ignores)", samples, "entries=" + std::to_string(seen));
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> thread_counts{1};
+    if (cores > 1) thread_counts.push_back(cores);
+    for (unsigned threads : thread_counts) {
+        for (bool gitignore : {false, true}) {
+            core::fs::WalkOptions options;
+            options.threads = threads;
+            options.respect_gitignore = gitignore;
+            samples.clear();
+            std::atomic<std::size_t> count{0};
+            for (int i = 0; i < iterations; ++i) {
+                bench::Stopwatch watch;
+                count = 0;
+                core::fs::walk(root.string(), options, [&](const core::fs::WalkEntry&) {
+                    count.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                });
+                samples.push_back(watch.elapsed_ms());
+            }
+            bench::report("walker threads=" + std::to_string(threads) +
+                              (gitignore ? " gitignore" : " no ignores"),
+                          samples, "entries=" + std::to_string(count.load()));
+        }
+    }
+    return 0;
+}
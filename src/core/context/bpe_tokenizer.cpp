@@ -0,0 +1,401 @@
+#include "core/context/bpe_tokenizer.hpp"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include "core/hash/stable_hash.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace agent::core::context {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    namespace {
+
+        // Ranks are dense in real vocabularies; one far beyond the entry count
+        // is a corrupt file, and would size the rank -> bytes table by it
+        constexpr std::size_t kMaxRankSpread = 4;
+
+        enum class CharClass : std::uint8_t { Letter, Digit, Space, Newline, Other };
+
+        constexpr std::array<CharClass, 256> make_classes() {
+            std::array<CharClass, 256> table{};
+            for (int c = 0; c < 256; ++c) {
+                CharClass cls = CharClass::Other;
+                if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80) {
+                    cls = CharClass::Letter;
+                } else if (c >= '0' && c <= '9') {
+                    cls = CharClass::Digit;
+                } else if (c == '\n' || c == '\r') {
+                    cls = CharClass::Newline;
+                } else if (c == ' ' || c == '\t' || c == '\v' || c == '\f') {
+                    cls = CharClass::Space;
+                }
+                table[static_cast<std::size_t>(c)] = cls;
+            }
+            return table;
+        }
+
+        constexpr std::array<CharClass, 256> kClasses = make_classes();
+
+        inline CharClass class_of(char c) { return kClasses[static_cast<unsigned char>(c)]; }
+
+        inline bool is_space(CharClass cls) {
+            return cls == CharClass::Space || cls == CharClass::Newline;
+        }
+
+        // End of the letter run starting at pos
+        std::size_t skip_letters(std::string_view text, std::size_t pos) {
+#if defined(__SSE2__)
+            // 16 bytes per step: ASCII letters (folded to lower case) or any high byte
+            const __m128i case_bit = _mm_set1_epi8(0x20);
+            const __m128i before_a = _mm_set1_epi8('a' - 1);
+            const __m128i after_z = _mm_set1_epi8('z' + 1);
+            for (; pos + 16 <= text.size(); pos += 16) {
+                __m128i block =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i*>(text.data() + pos));
+                __m128i lower = _mm_or_si128(block, case_bit);
+                __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, before_a),
+                                              _mm_cmplt_epi8(lower, after_z));
+                int mask = _mm_movemask_epi8(alpha) | _mm_movemask_epi8(block);
+                if (mask != 0xFFFF) return pos + static_cast<std::size_t>(__builtin_ctz(~mask));
+            }
+#endif
+            while (pos < text.size() && class_of(text[pos]) == CharClass::Letter) ++pos;
+            return pos;
+        }
+
+        // Length of an English contraction suffix ('s 't 're 've 'm 'll 'd) at pos, or 0
+        std::size_t contraction_at(std::string_view text, std::size_t pos) {
+            if (text[pos] != '\'' || pos + 1 >= text.size()) return 0;
+            auto lower = [&](std::size_t i) {
+                return i < text.size() ? static_cast<char>(text[i] | 0x20) : '\0';
+            };
+            char a = lower(pos + 1);
+            if (a == 's' || a == 't' || a == 'm' || a == 'd') return 2;
+            char b = lower(pos + 2);
+            if ((a == 'r' && b == 'e') || (a == 'v' && b == 'e') || (a == 'l' && b == 'l')) {
+                return 3;
+            }
+            return 0;
+        }
+
+        // Order-dependent 64-bit mix over 8-byte words; only used in memory
+        inline std::uint64_t hash_bytes(std::string_view bytes) {
+            std::uint64_t h = 0x9E3779B97F4A7C15ULL ^ bytes.size();
+            std::size_t i = 0;
+            for (; i + 8 <= bytes.size(); i += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, bytes.data() + i, 8);
+                h = (h ^ word) * 0xBF58476D1CE4E5B9ULL;
+                h ^= h >> 31;
+            }
+            if (i < bytes.size()) {
+                // Byte loop rather than a variable-length memcpy, which is a libc call
+                std::uint64_t word = 0;
+                for (std::size_t shift = 0; i < bytes.size(); ++i, shift += 8) {
+                    word |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[i]))
+                            << shift;
+                }
+                h = (h ^ word) * 0x94D049BB133111EBULL;
+                h ^= h >> 29;
+            }
+            return h;
+        }
+
+        int base64_value(char c) {
+            if (c >= 'A' && c <= 'Z') return c - 'A';
+            if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+            if (c >= '0' && c <= '9') return c - '0' + 52;
+            if (c == '+') return 62;
+            if (c == '/') return 63;
+            return -1;
+        }
+
+        bool decode_base64(std::string_view in, std::string& out) {
+            out.clear();
+            std::uint32_t buffer = 0;
+            int bits = 0;
+            for (char c : in) {
+                if (c == '=') break;
+                int value = base64_value(c);
+                if (value < 0) return false;
+                buffer = (buffer << 6) | static_cast<std::uint32_t>(value);
+                bits += 6;
+                if (bits >= 8) {
+                    bits -= 8;
+                    out.push_back(static_cast<char>((buffer >> bits) & 0xFF));
+                }
+            }
+            return true;
+        }
+
+    } // namespace
+
+    // --- PreTokenizer ---
+
+    bool PreTokenizer::next(std::string_view& piece) {
+        if (pos_ >= text_.size()) return false;
+        std::size_t end = piece_end(pos_);
+        if (end - pos_ > kMaxPiece) end = pos_ + kMaxPiece;
+        piece = text_.substr(pos_, end - pos_);
+        pos_ = end;
+        return true;
+    }
+
+    std::size_t PreTokenizer::piece_end(std::size_t pos) const {
+        const std::size_t size = text_.size();
+        CharClass cls = class_of(text_[pos]);
+        CharClass next = pos + 1 < size ? class_of(text_[pos + 1]) : CharClass::Newline;
+
+        // 1. Contractions
+        if (std::size_t length = contraction_at(text_, pos)) return pos + length;
+
+        // 2. Letters, optionally led by one space or punctuation character
+        if (cls == CharClass::Letter) return skip_letters(text_, pos + 1);
+        if ((cls == CharClass::Space || cls == CharClass::Other) && next == CharClass::Letter) {
+            return skip_letters(text_, pos + 2);
+        }
+
+        // 3. Up to three digits
+        if (cls == CharClass::Digit) {
+            std::size_t end = pos + 1;
+            while (end < size && end < pos + 3 && class_of(text_[end]) == CharClass::Digit) ++end;
+            return end;
+        }
+
+        // 4. Punctuation, optionally led by a space, swallowing trailing newlines
+        std::size_t start = pos;
+        if (text_[pos] == ' ' && next == CharClass::Other) start = pos + 1;
+        if (class_of(text_[start]) == CharClass::Other) {
+            std::size_t end = start + 1;
+            while (end < size && class_of(text_[end]) == CharClass::Other) ++end;
+            while (end < size && class_of(text_[end]) == CharClass::Newline) ++end;
+            return end;
+        }
+
+        // 5. Whitespace: up to the last newline in the run, otherwise leave the
+        //    final space to lead the word that follows
+        std::size_t end = pos;
+        std::size_t after_newline = 0;
+        while (end < size && is_space(class_of(text_[end]))) {
+            if (class_of(text_[end]) == CharClass::Newline) after_newline = end + 1;
+            ++end;
+        }
+        if (after_newline != 0) return after_newline;
+        if (end < size && end - pos > 1) return end - 1;
+        return end;
+    }
+
+    // --- RankTable ---
+
+    void RankTable::insert(std::string_view bytes, std::uint32_t rank) {
+        if ((size_ + 1) * 2 > slots_.size()) grow();
+
+        std::uint64_t hash = hash_bytes(bytes);
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            Slot& slot = slots_[i];
+            if (slot.rank == kNone) {
+                slot = Slot{hash, static_cast<std::uint32_t>(arena_.size()),
+                            static_cast<std::uint32_t>(bytes.size()), rank};
+                arena_.append(bytes);
+                ++size_;
+                return;
+            }
+            if (slot.hash == hash && std::string_view(arena_).substr(slot.offset, slot.length) ==
+                                         bytes) {
+                slot.rank = rank;
+                return;
+            }
+        }
+    }
+
+    std::uint32_t RankTable::find(std::string_view bytes) const {
+        if (slots_.empty()) return kNone;
+        std::uint64_t hash = hash_bytes(bytes);
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+            const Slot& slot = slots_[i];
+            if (slot.rank == kNone) return kNone;
+            if (slot.hash == hash && slot.length == bytes.size() &&
+                std::memcmp(arena_.data() + slot.offset, bytes.data(), bytes.size()) == 0) {
+                return slot.rank;
+            }
+        }
+    }
+
+    void RankTable::grow() {
+        std::vector<Slot> old = std::move(slots_);
+        slots_.assign(old.empty() ? 1024 : old.size() * 2, Slot{});
+        std::size_t mask = slots_.size() - 1;
+        for (const Slot& slot : old) {
+            if (slot.rank == kNone) continue;
+            std::size_t i = slot.hash & mask;
+            while (slots_[i].rank != kNone) i = (i + 1) & mask;
+            slots_[i] = slot;
+        }
+    }
+
+    // --- BpeTokenizer ---
+
+    errors::Result<BpeTokenizer> BpeTokenizer::load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return AgentError{ErrorCategory::Input, "Cannot open tokenizer file: " + path};
+        std::stringstream contents;
+        contents << in.rdbuf();
+        std::string text = contents.str();
+
+        std::vector<std::pair<std::string, std::uint32_t>> ranks;
+        std::string token;
+        std::size_t line_no = 0;
+        for (std::size_t pos = 0; pos < text.size();) {
+            std::size_t eol = text.find('\n', pos);
+            if (eol == std::string::npos) eol = text.size();
+            std::string_view line(text.data() + pos, eol - pos);
+            pos = eol + 1;
+            ++line_no;
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.empty()) continue;
+
+            std::size_t space = line.find(' ');
+            std::uint32_t rank = 0;
+            bool valid = space != std::string_view::npos && space + 1 < line.size() &&
+                         decode_base64(line.substr(0, space), token);
+            if (valid) {
+                auto [end, ec] = std::from_chars(line.data() + space + 1,
+                                                 line.data() + line.size(), rank);
+                valid = ec == std::errc() && end == line.data() + line.size();
+            }
+            if (!valid) {
+                return AgentError{ErrorCategory::Input, path + ":" + std::to_string(line_no) +
+                                                            ": expected '<base64> <rank>'"};
+            }
+            ranks.emplace_back(token, rank);
+        }
+
+        std::string name = path.substr(path.find_last_of('/') + 1);
+        return from_ranks(ranks, name + "@" + hash::to_hex(hash::stable_hash(text)));
+    }
+
+    errors::Result<BpeTokenizer> BpeTokenizer::from_ranks(
+        const std::vector<std::pair<std::string, std::uint32_t>>& ranks, std::string id) {
+        BpeTokenizer tokenizer;
+        tokenizer.id_ = std::move(id);
+
+        std::size_t max_rank = std::max<std::size_t>(ranks.size() * kMaxRankSpread, 256);
+        for (const auto& [bytes, rank] : ranks) {
+            if (bytes.empty() || rank == RankTable::kNone || rank >= max_rank) {
+                return AgentError{ErrorCategory::Input, "Invalid tokenizer entry with rank " +
+                                                            std::to_string(rank)};
+            }
+            tokenizer.ranks_.insert(bytes, rank);
+            if (rank >= tokenizer.bytes_of_.size()) tokenizer.bytes_of_.resize(rank + 1, {0, 0});
+            tokenizer.bytes_of_[rank] = {static_cast<std::uint32_t>(tokenizer.token_bytes_.size()),
+                                         static_cast<std::uint32_t>(bytes.size())};
+            tokenizer.token_bytes_ += bytes;
+        }
+
+        for (int byte = 0; byte < 256; ++byte) {
+            char c = static_cast<char>(byte);
+            if (tokenizer.ranks_.find(std::string_view(&c, 1)) == RankTable::kNone) {
+                return AgentError{ErrorCategory::Input,
+                                  "Tokenizer " + tokenizer.id_ + " has no rank for byte " +
+                                      std::to_string(byte)};
+            }
+        }
+        return tokenizer;
+    }
+
+    template <typename Emit>
+    void BpeTokenizer::merge(std::string_view piece, Emit&& emit) const {
+        // Fast path: most words are a single token
+        if (piece.size() == 1 || ranks_.find(piece) != RankTable::kNone) {
+            emit(piece);
+            return;
+        }
+
+        // parts[i] starts a token; rank is that of merging it with its right neighbour
+        struct Part {
+            std::uint32_t start;
+            std::uint32_t rank;
+        };
+        std::array<Part, PreTokenizer::kMaxPiece + 1> parts;
+        std::size_t count = piece.size() + 1;
+
+        auto pair_rank = [&](std::size_t i) {
+            if (i + 2 >= count) return RankTable::kNone;
+            return ranks_.find(piece.substr(parts[i].start, parts[i + 2].start - parts[i].start));
+        };
+
+        for (std::size_t i = 0; i < count; ++i) {
+            parts[i] = Part{static_cast<std::uint32_t>(i), RankTable::kNone};
+        }
+        for (std::size_t i = 0; i + 2 < count; ++i) parts[i].rank = pair_rank(i);
+
+        for (;;) {
+            std::size_t best = 0;
+            std::uint32_t best_rank = RankTable::kNone;
+            for (std::size_t i = 0; i + 2 < count; ++i) {
+                if (parts[i].rank < best_rank) {
+                    best_rank = parts[i].rank;
+                    best = i;
+                }
+            }
+            if (best_rank == RankTable::kNone) break;
+
+            // Merge parts[best] with its neighbour, then refresh the two affected ranks
+            for (std::size_t i = best + 1; i + 1 < count; ++i) parts[i] = parts[i + 1];
+            --count;
+            parts[best].rank = pair_rank(best);
+            if (best > 0) parts[best - 1].rank = pair_rank(best - 1);
+        }
+
+        for (std::size_t i = 0; i + 1 < count; ++i) {
+            emit(piece.substr(parts[i].start, parts[i + 1].start - parts[i].start));
+        }
+    }
+
+    std::size_t BpeTokenizer::count(std::string_view text) const {
+        std::size_t tokens = 0;
+        PreTokenizer pieces(text);
+        std::string_view piece;
+        while (pieces.next(piece)) merge(piece, [&](std::string_view) { ++tokens; });
+        return tokens;
+    }
+
+    std::vector<std::uint32_t> BpeTokenizer::encode(std::string_view text) const {
+        std::vector<std::uint32_t> tokens;
+        tokens.reserve(text.size() / 4 + 1);
+        PreTokenizer pieces(text);
+        std::string_view piece;
+        while (pieces.next(piece)) {
+            merge(piece, [&](std::string_view token) { tokens.push_back(ranks_.find(token)); });
+        }
+        return tokens;
+    }
+
+    std::string BpeTokenizer::decode(const std::vector<std::uint32_t>& tokens) const {
+        std::string out;
+        for (std::uint32_t rank : tokens) {
+            if (rank >= bytes_of_.size()) continue;
+            const auto& [offset, length] = bytes_of_[rank];
+            out.append(token_bytes_, offset, length);
+        }
+        return out;
+    }
+
+    std::size_t BpeTokenizer::count(const protocol::Message& message) const {
+        std::size_t tokens = kMessageOverhead + count(message.content);
+        for (const auto& call : message.tool_calls) {
+            tokens += count(call.name) + count(call.arguments);
+        }
+        return tokens;
+    }
+
+} // namespace agent::core::context
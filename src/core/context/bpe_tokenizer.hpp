@@ -0,0 +1,98 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "protocol/message_contract.hpp"
+
+namespace agent::core::context {
+
+    // Splits text into the pieces that BPE merges never cross, following the
+    // GPT-4 (cl100k) pre-tokenization rules: contractions, optionally prefixed
+    // letter runs, up to three digits, punctuation runs and whitespace.
+    // Classification is exact for ASCII; every byte >= 0x80 counts as a
+    // letter, which keeps UTF-8 words together without a Unicode table.
+    class PreTokenizer {
+    public:
+        // Pieces longer than this are cut, bounding the quadratic merge loop
+        static constexpr std::size_t kMaxPiece = 256;
+
+        explicit PreTokenizer(std::string_view text) : text_(text) {}
+
+        // Returns false once the text is exhausted
+        bool next(std::string_view& piece);
+
+    private:
+        std::string_view text_;
+        std::size_t pos_ = 0;
+
+        std::size_t piece_end(std::size_t pos) const;
+    };
+
+    // Open-addressing map from token bytes to rank, with all keys packed in one arena
+    class RankTable {
+    public:
+        static constexpr std::uint32_t kNone = 0xFFFFFFFFu;
+
+        void insert(std::string_view bytes, std::uint32_t rank);
+        std::uint32_t find(std::string_view bytes) const;
+        std::size_t size() const { return size_; }
+
+    private:
+        struct Slot {
+            std::uint64_t hash = 0;
+            std::uint32_t offset = 0;
+            std::uint32_t length = 0;
+            std::uint32_t rank = kNone;  // kNone marks an empty slot
+        };
+        std::vector<Slot> slots_;
+        std::string arena_;
+        std::size_t size_ = 0;
+
+        void grow();
+    };
+
+    // Byte-level BPE tokenizer for budgeting context locally, without asking
+    // the provider. Ranks double as merge priorities (lower merges first), so
+    // a single rank table is both the vocabulary and the merge list.
+    // Immutable after construction, so one instance can be shared by threads.
+    class BpeTokenizer {
+    public:
+        // Loads a tiktoken-format file: one "<base64 token bytes> <rank>" per line
+        static errors::Result<BpeTokenizer> load(const std::string& path);
+
+        // Every single byte must have a rank so that any input can be encoded
+        static errors::Result<BpeTokenizer> from_ranks(
+            const std::vector<std::pair<std::string, std::uint32_t>>& ranks, std::string id);
+
+        // Identifies the vocabulary; cached counts are only valid for the same id
+        const std::string& id() const { return id_; }
+        std::size_t vocab_size() const { return ranks_.size(); }
+
+        std::size_t count(std::string_view text) const;
+        std::vector<std::uint32_t> encode(std::string_view text) const;
+        std::string decode(const std::vector<std::uint32_t>& tokens) const;
+
+        // Content, tool calls and a fixed per-message framing overhead
+        std::size_t count(const protocol::Message& message) const;
+
+        // Role markers and separators the provider wraps around each message
+        static constexpr std::size_t kMessageOverhead = 4;
+
+    private:
+        std::string id_;
+        RankTable ranks_;
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> bytes_of_;  // rank -> (offset, length)
+        std::string token_bytes_;
+
+        BpeTokenizer() = default;
+
+        // Runs the merge loop over one piece and calls emit(bytes) per token
+        template <typename Emit>
+        void merge(std::string_view piece, Emit&& emit) const;
+    };
+
+} // namespace agent::core::context
@@ -0,0 +1,227 @@
+#include "core/context/compaction_policies.hpp"
+#include <algorithm>
+#include <nlohmann/json.hpp>
+#include "core/logging/logger.hpp"
+#include "providers/canonical_request.hpp"
+
+namespace agent::core::context {
+
+    namespace {
+
+        // Moves pos back to the start of the UTF-8 sequence it falls into
+        std::size_t utf8_floor(const std::string& text, std::size_t pos) {
+            while (pos > 0 && pos < text.size() &&
+                   (static_cast<unsigned char>(text[pos]) & 0xC0) == 0x80) {
+                --pos;
+            }
+            return pos;
+        }
+
+        std::string path_argument(const std::string& arguments) {
+            auto json = nlohmann::json::parse(arguments, nullptr, false);
+            if (!json.is_object()) return "";
+            auto it = json.find("path");
+            return it != json.end() && it->is_string() ? it->get<std::string>() : "";
+        }
+
+        std::string clip(const std::string& text, std::size_t limit) {
+            if (text.size() <= limit) return text;
+            return text.substr(0, utf8_floor(text, limit)) + " [...]";
+        }
+
+        constexpr const char* kSummaryPrompt =
+            "You are compacting the history of a coding agent session. Summarize the "
+            "transcript below for the agent itself: the goal, decisions made, files touched "
+            "and their current state, commands run and their outcomes, and open problems. "
+            "Be specific and terse. Do not invent anything that is not in the transcript.";
+
+    } // namespace
+
+    // --- TruncateToolOutputs ---
+
+    void TruncateToolOutputs::compact(CompactionContext& ctx) {
+        for (; cursor_ < ctx.until && !ctx.satisfied(); ++cursor_) {
+            const auto& message = ctx.history[cursor_];
+            if (message.role != protocol::Role::Tool) continue;
+            const std::string& text = message.content;
+            if (text.size() <= keep_head_ + keep_tail_ + 64) continue;
+
+            std::size_t head = utf8_floor(text, keep_head_);
+            std::size_t tail = utf8_floor(text, text.size() - keep_tail_);
+            ctx.set_content(cursor_, text.substr(0, head) + "\n[... " +
+                                         std::to_string(tail - head) +
+                                         " bytes elided by context compaction ...]\n" +
+                                         text.substr(tail));
+        }
+    }
+
+    void TruncateToolOutputs::on_replaced(std::size_t begin, std::size_t end) {
+        cursor_ = remap(cursor_, begin, end);
+    }
+
+    // --- ElideStaleReads ---
+
+    void ElideStaleReads::mark_stale(const std::string& path) {
+        auto it = latest_read_.find(path);
+        if (it == latest_read_.end()) return;
+        stale_.emplace_back(it->second, path);
+        latest_read_.erase(it);
+    }
+
+    void ElideStaleReads::observe(const std::vector<protocol::Message>& history,
+                                  std::size_t index) {
+        const auto& message = history[index];
+        if (message.role == protocol::Role::Assistant) {
+            for (const auto& call : message.tool_calls) {
+                bool reads = read_tools_.count(call.name) != 0;
+                bool writes = write_tools_.count(call.name) != 0;
+                if (!reads && !writes) continue;
+                std::string path = path_argument(call.arguments);
+                if (path.empty()) continue;
+                if (reads) read_calls_[call.id] = path;
+                if (writes) mark_stale(path);
+            }
+        } else if (message.role == protocol::Role::Tool && message.tool_call_id) {
+            auto it = read_calls_.find(*message.tool_call_id);
+            if (it == read_calls_.end()) return;
+            mark_stale(it->second);
+            latest_read_[it->second] = index;
+            read_calls_.erase(it);
+        }
+    }
+
+    void ElideStaleReads::compact(CompactionContext& ctx) {
+        std::size_t kept = 0;
+        for (auto& entry : stale_) {
+            if (entry.first < ctx.until && !ctx.satisfied()) {
+                ctx.set_content(entry.first, "[Earlier contents of " + entry.second +
+                                                 " elided: the file was read again or modified "
+                                                 "later]");
+            } else {
+                stale_[kept++] = std::move(entry);
+            }
+        }
+        stale_.resize(kept);
+    }
+
+    void ElideStaleReads::on_replaced(std::size_t begin, std::size_t end) {
+        auto gone = [&](std::size_t index) { return index >= begin && index < end; };
+
+        std::size_t kept = 0;
+        for (auto& entry : stale_) {
+            if (gone(entry.first)) continue;
+            entry.first = remap(entry.first, begin, end);
+            stale_[kept++] = std::move(entry);
+        }
+        stale_.resize(kept);
+
+        for (auto it = latest_read_.begin(); it != latest_read_.end();) {
+            if (gone(it->second)) {
+                it = latest_read_.erase(it);
+            } else {
+                it->second = remap(it->second, begin, end);
+                ++it;
+            }
+        }
+    }
+
+    // --- SummarizeOldTurns ---
+
+    void SummarizeOldTurns::compact(CompactionContext& ctx) {
+        auto& history = ctx.history;
+
+        // 1. Pick whole turns: never start on, or cut before, a tool result
+        std::size_t first_user = 0;
+        while (first_user < history.size() && history[first_user].role != protocol::Role::User) {
+            ++first_user;
+        }
+        std::size_t begin = std::max(cursor_, first_user + 1);
+        std::size_t end = ctx.until;
+        while (begin < end && history[begin].role == protocol::Role::Tool) ++begin;
+        while (end > begin && end < history.size() && history[end].role == protocol::Role::Tool) {
+            --end;
+        }
+
+        // 2. Place the summary. Turns must keep alternating (several
+        //    providers reject two user or two assistant messages in a row,
+        //    and a tool result counts as the user's), so the summary takes
+        //    the role the message before it does not have. Messages from
+        //    ctx.until on are protected: when the one after the span has
+        //    that role too, the summary joins the message before instead.
+        //    That is never a tool result; the span grows back over it and
+        //    the call it answers until the message before is not one.
+        auto assistant_side = [](const protocol::Message& m) {
+            return m.role == protocol::Role::Assistant;
+        };
+        enum class Join { None, After, Before } join = Join::None;
+        while (begin < end) {
+            bool after_user = !assistant_side(history[begin - 1]);
+            auto role = after_user ? protocol::Role::Assistant : protocol::Role::User;
+            bool clashes = end < history.size() && assistant_side(history[end]) == after_user;
+            if (!clashes) break;
+            if (end < ctx.until && history[end].role == role) {
+                join = Join::After;
+                break;
+            }
+            if (history[begin - 1].role != protocol::Role::Tool) {
+                join = Join::Before;
+                break;
+            }
+            std::size_t call = begin - 1;
+            while (call > first_user + 1 && history[call].role == protocol::Role::Tool) --call;
+            if (!assistant_side(history[call])) return;
+            begin = call;
+        }
+        if (end < begin + 2) return;
+
+        // 3. Render the span as plain text and ask for a summary
+        std::string transcript;
+        for (std::size_t i = begin; i < end; ++i) {
+            const auto& message = history[i];
+            transcript += std::string(providers::to_string(message.role)) + ": " +
+                          clip(message.content, kMaxRenderedBytes) + "\n";
+            for (const auto& call : message.tool_calls) {
+                transcript += "  -> " + call.name + " " +
+                              clip(call.arguments, kMaxRenderedBytes) + "\n";
+            }
+        }
+
+        providers::CompletionRequest request;
+        request.params = params_;
+        request.messages.push_back(
+            protocol::Message{protocol::Role::System, kSummaryPrompt, {}, std::nullopt});
+        request.messages.push_back(
+            protocol::Message{protocol::Role::User, std::move(transcript), {}, std::nullopt});
+
+        auto response = provider_.complete(request, [](const protocol::AgentEvent&) {});
+        if (errors::is_error(response)) {
+            LOG_WARN("Summarization failed, history left as is: " +
+                     errors::get_error(response).message);
+            return;
+        }
+        const std::string& summary = errors::get_value(response).message.content;
+        if (summary.empty()) return;
+        std::string text = "[Summary of earlier conversation]\n" + summary;
+
+        // 4. Collapse the span into it
+        auto role = assistant_side(history[begin - 1]) ? protocol::Role::User
+                                                       : protocol::Role::Assistant;
+        protocol::Message collapsed{role, text, {}, std::nullopt};
+        if (join == Join::After) {
+            collapsed.content.append("\n\n").append(history[end].content);
+            collapsed.tool_calls = history[end].tool_calls;
+            collapsed.tool_call_id = history[end].tool_call_id;
+            ++end;
+        } else if (join == Join::Before) {
+            collapsed = history[--begin];
+            collapsed.content.append("\n\n").append(text);
+        }
+        ctx.replace_range(begin, end, std::move(collapsed));
+        cursor_ = begin + 1;
+    }
+
+    void SummarizeOldTurns::on_replaced(std::size_t begin, std::size_t end) {
+        cursor_ = remap(cursor_, begin, end);
+    }
+
+} // namespace agent::core::context
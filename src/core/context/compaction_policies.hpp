@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "core/context/compactor.hpp"
+#include "providers/provider.hpp"
+
+namespace agent::core::context {
+
+    // Cuts old tool outputs down to their first and last bytes. Build logs and
+    // test runs matter for a turn or two; after that the verdict is enough.
+    class TruncateToolOutputs : public CompactionPolicy {
+    public:
+        explicit TruncateToolOutputs(std::size_t keep_head = 1024, std::size_t keep_tail = 1024)
+            : keep_head_(keep_head), keep_tail_(keep_tail) {}
+
+        const char* name() const override { return "truncate-tool-outputs"; }
+        void compact(CompactionContext& ctx) override;
+        void on_replaced(std::size_t begin, std::size_t end) override;
+
+    private:
+        std::size_t keep_head_;
+        std::size_t keep_tail_;
+        std::size_t cursor_ = 0;  // Everything before this is already as short as it gets
+    };
+
+    // Replaces a file read with a short reference once the same file has been
+    // read again or edited: the old bytes are either duplicated or wrong.
+    class ElideStaleReads : public CompactionPolicy {
+    public:
+        ElideStaleReads(std::unordered_set<std::string> read_tools = {"read_file"},
+                        std::unordered_set<std::string> write_tools = {"write_file", "apply_patch",
+                                                                       "edit_file"})
+            : read_tools_(std::move(read_tools)), write_tools_(std::move(write_tools)) {}
+
+        const char* name() const override { return "elide-stale-reads"; }
+        void observe(const std::vector<protocol::Message>& history, std::size_t index) override;
+        void compact(CompactionContext& ctx) override;
+        void on_replaced(std::size_t begin, std::size_t end) override;
+
+    private:
+        std::unordered_set<std::string> read_tools_;
+        std::unordered_set<std::string> write_tools_;
+        std::unordered_map<std::string, std::string> read_calls_;  // tool_call_id -> path
+        std::unordered_map<std::string, std::size_t> latest_read_; // path -> message index
+        std::vector<std::pair<std::size_t, std::string>> stale_;   // (message index, path)
+
+        void mark_stale(const std::string& path);
+    };
+
+    // Last resort: asks the provider to summarize the oldest unsummarized
+    // turns and collapses them into one message, keeping user and assistant
+    // turns alternating. The first user message (the task) keeps its text
+    // verbatim, but when the turn after the span is protected and has the
+    // summary's role, the summary is appended to the message before the
+    // span, which may be the task. It is never written into a tool result.
+    class SummarizeOldTurns : public CompactionPolicy {
+    public:
+        SummarizeOldTurns(providers::Provider& provider, providers::ModelParams params)
+            : provider_(provider), params_(std::move(params)) {}
+
+        // Per-message cap when rendering the transcript for the summarizer
+        static constexpr std::size_t kMaxRenderedBytes = 2000;
+
+        const char* name() const override { return "summarize-old-turns"; }
+        void compact(CompactionContext& ctx) override;
+        void on_replaced(std::size_t begin, std::size_t end) override;
+
+    private:
+        providers::Provider& provider_;
+        providers::ModelParams params_;
+        std::size_t cursor_ = 0;  // First message after the last summary
+    };
+
+} // namespace agent::core::context
@@ -0,0 +1,69 @@
+#include "core/context/compactor.hpp"
+#include "core/logging/logger.hpp"
+
+namespace agent::core::context {
+
+    // --- CompactionContext ---
+
+    void CompactionContext::set_content(std::size_t index, std::string content) {
+        history[index].content = std::move(content);
+        ledger_.replace(index, history[index]);
+        ++report_.messages_rewritten;
+    }
+
+    void CompactionContext::replace_range(std::size_t begin, std::size_t end,
+                                          protocol::Message message) {
+        if (begin >= end || end > history.size()) return;
+        ledger_.replace_range(begin, end, message);
+        history[begin] = std::move(message);
+        history.erase(history.begin() + static_cast<std::ptrdiff_t>(begin) + 1,
+                      history.begin() + static_cast<std::ptrdiff_t>(end));
+        report_.messages_rewritten += end - begin;
+        for (auto& policy : policies_) policy->on_replaced(begin, end);
+    }
+
+    // --- Compactor ---
+
+    Compactor::Compactor(const BpeTokenizer& tokenizer, CompactionOptions options)
+        : options_(options), ledger_(tokenizer) {}
+
+    void Compactor::add_policy(std::unique_ptr<CompactionPolicy> policy) {
+        policies_.push_back(std::move(policy));
+    }
+
+    CompactionReport Compactor::maybe_compact(std::vector<protocol::Message>& history) {
+        // 1. Account for what was appended (or marked dirty) since the last call: O(new content)
+        ledger_.sync(history);
+        if (observed_ > history.size()) observed_ = history.size();
+        for (; observed_ < history.size(); ++observed_) {
+            for (auto& policy : policies_) policy->observe(history, observed_);
+        }
+
+        CompactionReport report;
+        report.tokens_before = ledger_.total();
+        report.tokens_after = ledger_.total();
+
+        auto limit = static_cast<double>(options_.context_limit);
+        if (static_cast<double>(ledger_.total()) < limit * options_.trigger_ratio) return report;
+        if (history.size() <= options_.keep_recent) return report;
+
+        // 2. Over budget: let each policy shrink the unprotected prefix in turn
+        report.ran = true;
+        auto target = static_cast<std::size_t>(limit * options_.target_ratio);
+        std::size_t until = history.size() - options_.keep_recent;
+        for (auto& policy : policies_) {
+            CompactionContext ctx(history, until, target, ledger_, policies_, report);
+            if (ctx.satisfied()) break;
+            policy->compact(ctx);
+            // A policy may collapse messages, which moves the protected tail
+            until = history.size() - options_.keep_recent;
+        }
+        observed_ = history.size();
+
+        report.tokens_after = ledger_.total();
+        LOG_INFO("Compacted history from " + std::to_string(report.tokens_before) + " to " +
+                 std::to_string(report.tokens_after) + " tokens");
+        return report;
+    }
+
+} // namespace agent::core::context
@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/context/bpe_tokenizer.hpp"
+#include "core/context/token_ledger.hpp"
+#include "protocol/message_contract.hpp"
+
+namespace agent::core::context {
+
+    struct CompactionOptions {
+        std::size_t context_limit = 128000;  // Tokens the model accepts
+        double trigger_ratio = 0.80;         // Compact once the history crosses this share
+        double target_ratio = 0.60;          // ...and stop once it is back under this one
+        std::size_t keep_recent = 8;         // Trailing messages that are never touched
+    };
+
+    struct CompactionReport {
+        bool ran = false;
+        std::size_t tokens_before = 0;
+        std::size_t tokens_after = 0;
+        std::size_t messages_rewritten = 0;
+    };
+
+    class CompactionPolicy;
+
+    // What a policy may do to the history during one pass. Every change goes
+    // through here so the token ledger and the other policies stay in step.
+    class CompactionContext {
+    public:
+        std::vector<protocol::Message>& history;
+        const std::size_t until;  // Messages at or after this index are protected
+
+        bool satisfied() const { return ledger_.total() <= target_; }
+        std::size_t tokens() const { return ledger_.total(); }
+
+        void set_content(std::size_t index, std::string content);
+
+        // Collapses history[begin, end) into one message at begin
+        void replace_range(std::size_t begin, std::size_t end, protocol::Message message);
+
+    private:
+        friend class Compactor;
+        CompactionContext(std::vector<protocol::Message>& history, std::size_t until,
+                          std::size_t target, TokenLedger& ledger,
+                          std::vector<std::unique_ptr<CompactionPolicy>>& policies,
+                          CompactionReport& report)
+            : history(history), until(until), target_(target), ledger_(ledger),
+              policies_(policies), report_(report) {}
+
+        std::size_t target_;
+        TokenLedger& ledger_;
+        std::vector<std::unique_ptr<CompactionPolicy>>& policies_;
+        CompactionReport& report_;
+    };
+
+    // One way of shrinking old history. Policies keep their own cursors and
+    // indexes so that a pass only looks at what changed since the last one;
+    // the cost of compaction must not grow with the length of the session.
+    class CompactionPolicy {
+    public:
+        virtual ~CompactionPolicy() = default;
+
+        virtual const char* name() const = 0;
+
+        // Sees every message exactly once, in order, as it enters the history
+        virtual void observe(const std::vector<protocol::Message>& history, std::size_t index) {
+            (void)history;
+            (void)index;
+        }
+
+        // Shrinks history[0, ctx.until) until ctx.satisfied() or nothing is left to do
+        virtual void compact(CompactionContext& ctx) = 0;
+
+        // history[begin, end) became a single message at begin; shift stored indexes
+        virtual void on_replaced(std::size_t begin, std::size_t end) {
+            (void)begin;
+            (void)end;
+        }
+
+        // Where an index at or after begin lands after such a replacement
+        static std::size_t remap(std::size_t index, std::size_t begin, std::size_t end) {
+            if (index < begin) return index;
+            if (index < end) return begin;
+            return index - (end - begin - 1);
+        }
+    };
+
+    // Watches the token budget and runs the policies, cheapest first, when it
+    // is exceeded. The agent loop calls maybe_compact() before every request.
+    class Compactor {
+    public:
+        Compactor(const BpeTokenizer& tokenizer, CompactionOptions options = {});
+
+        // Policies run in the order they were added
+        void add_policy(std::unique_ptr<CompactionPolicy> policy);
+
+        CompactionReport maybe_compact(std::vector<protocol::Message>& history);
+
+        // For code outside the policies that rewrites history[index] in
+        // place; appends and truncation need no call
+        void mark_dirty(std::size_t index) { ledger_.mark_dirty(index); }
+
+        const TokenLedger& ledger() const { return ledger_; }
+        const CompactionOptions& options() const { return options_; }
+
+    private:
+        CompactionOptions options_;
+        TokenLedger ledger_;
+        std::vector<std::unique_ptr<CompactionPolicy>> policies_;
+        std::size_t observed_ = 0;
+    };
+
+} // namespace agent::core::context
@@ -0,0 +1,116 @@
+#include "core/context/token_estimator.hpp"
+#include <algorithm>
+#include "core/hash/stable_hash.hpp"
+
+namespace agent::core::context {
+
+    namespace {
+
+        // Separate key spaces, so a text never answers for a message
+        enum : std::uint64_t { kTextKeys = 1, kMessageKeys = 2, kSchemaKeys = 3 };
+
+        // Keeps field boundaries in the key: ("ab", "c") differs from ("a", "bc")
+        std::uint64_t chain(std::uint64_t hash, std::string_view bytes) {
+            return hash::stable_hash(bytes, (hash ^ bytes.size()) * hash::kFnvPrime);
+        }
+
+    } // namespace
+
+    TokenEstimator::TokenEstimator(const BpeTokenizer& tokenizer)
+        : tokenizer_(tokenizer), seed_(hash::stable_hash(tokenizer.id())) {}
+
+    std::uint64_t TokenEstimator::key(const protocol::Message& message) const {
+        // Exactly what BpeTokenizer::count(Message) reads
+        std::uint64_t key = chain(seed_ + kMessageKeys, message.content);
+        for (const auto& call : message.tool_calls) {
+            key = chain(chain(key, call.name), call.arguments);
+        }
+        return key;
+    }
+
+    std::size_t TokenEstimator::count(const protocol::Message& message) {
+        return count(message, key(message));
+    }
+
+    std::size_t TokenEstimator::count(const protocol::Message& message, std::uint64_t key) {
+        return cached(key, [&] {
+            std::size_t tokens = BpeTokenizer::kMessageOverhead + count(message.content);
+            for (const auto& call : message.tool_calls) {
+                tokens += count(call.name) + count(call.arguments);
+            }
+            return tokens;
+        });
+    }
+
+    std::size_t TokenEstimator::count(const protocol::ToolSchema& tool) {
+        std::uint64_t key =
+            chain(chain(chain(seed_ + kSchemaKeys, tool.name), tool.description), tool.parameters);
+        return cached(key, [&] {
+            return count(tool.name) + count(tool.description) + count(tool.parameters);
+        });
+    }
+
+    std::size_t TokenEstimator::count(std::string_view text) {
+        if (text.size() < kCacheThreshold) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.tokenized_bytes += text.size();
+            }
+            return tokenizer_.count(text);
+        }
+        // Hashing is several times cheaper than tokenizing the same bytes
+        return cached(chain(seed_ + kTextKeys, text), [&] {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.tokenized_bytes += text.size();
+            }
+            return tokenizer_.count(text);
+        });
+    }
+
+    std::size_t TokenEstimator::prompt(const std::vector<protocol::Message>& messages,
+                                       const std::vector<protocol::ToolSchema>& tools) {
+        std::size_t tokens = 0;
+        for (const auto& message : messages) tokens += count(message);
+        for (const auto& tool : tools) tokens += count(tool);
+        return tokens;
+    }
+
+    TokenCharge TokenEstimator::charge(const std::vector<protocol::Message>& messages,
+                                       const std::vector<protocol::ToolSchema>& tools,
+                                       int max_output_tokens) {
+        TokenCharge charge;
+        charge.prompt = prompt(messages, tools);
+        charge.reserved = charge.prompt + static_cast<std::size_t>(std::max(max_output_tokens, 0));
+        return charge;
+    }
+
+    std::size_t TokenEstimator::used(const TokenCharge& charge, const protocol::Message& reply) {
+        return charge.prompt + count(reply);
+    }
+
+    EstimatorStats TokenEstimator::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    std::size_t TokenEstimator::cached(std::uint64_t key,
+                                       const std::function<std::size_t()>& count) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = counts_.find(key);
+            if (it != counts_.end()) {
+                ++stats_.cache_hits;
+                return it->second;
+            }
+        }
+        // Tokenize outside the lock; two threads may both count a new text,
+        // which costs time but gives the same answer
+        std::size_t tokens = count();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (counts_.size() >= kMaxCacheEntries) counts_.clear();
+        counts_.emplace(key, tokens);
+        return tokens;
+    }
+
+} // namespace agent::core::context
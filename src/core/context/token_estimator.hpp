@@ -0,0 +1,79 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "core/context/bpe_tokenizer.hpp"
+#include "protocol/message_contract.hpp"
+#include "protocol/tool_contract.hpp"
+
+namespace agent::core::context {
+
+    struct EstimatorStats {
+        std::size_t tokenized_bytes = 0;  // Bytes actually run through the tokenizer
+        std::size_t cache_hits = 0;       // Counts answered from the content-hash cache
+    };
+
+    // What one provider request is charged against a token budget: its
+    // prompt plus the whole output allowance before the reply is known,
+    // and the prompt plus the actual reply once it is (see used()).
+    struct TokenCharge {
+        std::size_t prompt = 0;
+        std::size_t reserved = 0;
+    };
+
+    // The one place token counts for budgets come from: the context
+    // ledger, the sub-agent budgets and the request scheduler all estimate
+    // through it.
+    //
+    // Counts of messages and tool schemas are remembered by a hash of
+    // exactly what they count (seeded with the tokenizer id), so a history
+    // that is sent again each turn is only tokenized where it changed, and
+    // an edited message is never answered with its old count. Texts of at
+    // least kCacheThreshold bytes are remembered on their own as well, so
+    // counting a tool output and then the Tool message carrying it
+    // tokenizes it once. Safe to share between threads.
+    class TokenEstimator {
+    public:
+        static constexpr std::size_t kCacheThreshold = 256;
+        static constexpr std::size_t kMaxCacheEntries = 16384;
+
+        explicit TokenEstimator(const BpeTokenizer& tokenizer);
+
+        TokenEstimator(const TokenEstimator&) = delete;
+        TokenEstimator& operator=(const TokenEstimator&) = delete;
+
+        // Content key of a message: equal keys mean equal counts
+        std::uint64_t key(const protocol::Message& message) const;
+
+        std::size_t count(const protocol::Message& message);
+        std::size_t count(const protocol::Message& message, std::uint64_t key);
+        std::size_t count(const protocol::ToolSchema& tool);
+        std::size_t count(std::string_view text);
+
+        // Prompt tokens of a request: its messages and tool schemas
+        std::size_t prompt(const std::vector<protocol::Message>& messages,
+                           const std::vector<protocol::ToolSchema>& tools);
+
+        TokenCharge charge(const std::vector<protocol::Message>& messages,
+                           const std::vector<protocol::ToolSchema>& tools, int max_output_tokens);
+        std::size_t used(const TokenCharge& charge, const protocol::Message& reply);
+
+        const BpeTokenizer& tokenizer() const { return tokenizer_; }
+        EstimatorStats stats() const;
+
+    private:
+        const BpeTokenizer& tokenizer_;
+        std::uint64_t seed_;  // Hash of the tokenizer id: counts never leak across vocabularies
+
+        mutable std::mutex mutex_;
+        std::unordered_map<std::uint64_t, std::size_t> counts_;  // Content hash -> tokens
+        EstimatorStats stats_;
+
+        std::size_t cached(std::uint64_t key, const std::function<std::size_t()>& count);
+    };
+
+} // namespace agent::core::context
@@ -0,0 +1,40 @@
+#include "core/context/token_ledger.hpp"
+
+namespace agent::core::context {
+
+    TokenLedger::TokenLedger(const BpeTokenizer& tokenizer) : estimator_(tokenizer) {}
+
+    void TokenLedger::sync(const std::vector<protocol::Message>& history) {
+        while (counts_.size() > history.size()) {
+            total_ -= counts_.back();
+            counts_.pop_back();
+        }
+        for (std::size_t index : dirty_) {
+            if (index < counts_.size()) replace(index, history[index]);
+        }
+        dirty_.clear();
+        for (std::size_t i = counts_.size(); i < history.size(); ++i) {
+            std::size_t tokens = estimator_.count(history[i]);
+            counts_.push_back(tokens);
+            total_ += tokens;
+        }
+    }
+
+    void TokenLedger::replace(std::size_t index, const protocol::Message& message) {
+        if (index >= counts_.size()) return;
+        std::size_t tokens = estimator_.count(message);
+        total_ = total_ - counts_[index] + tokens;
+        counts_[index] = tokens;
+    }
+
+    void TokenLedger::replace_range(std::size_t begin, std::size_t end,
+                                    const protocol::Message& message) {
+        if (begin >= end || end > counts_.size()) return;
+        for (std::size_t i = begin; i < end; ++i) total_ -= counts_[i];
+        counts_.erase(counts_.begin() + static_cast<std::ptrdiff_t>(begin) + 1,
+                      counts_.begin() + static_cast<std::ptrdiff_t>(end));
+        counts_[begin] = estimator_.count(message);
+        total_ += counts_[begin];
+    }
+
+} // namespace agent::core::context
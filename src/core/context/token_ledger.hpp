@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+#include "core/context/bpe_tokenizer.hpp"
+#include "core/context/token_estimator.hpp"
+#include "protocol/message_contract.hpp"
+
+namespace agent::core::context {
+
+    // Running token count of a conversation history, so that checking the
+    // context budget is O(1) per turn and an append costs tokenizing what
+    // was appended.
+    //
+    // sync() only looks at how long the history is: messages past the last
+    // sync are counted and ones gone from the end dropped. It never rehashes
+    // earlier messages to look for edits; a writer that rewrites a message
+    // in place says so, through replace() and replace_range() (which the
+    // compactor uses) or mark_dirty() ahead of the next sync().
+    class TokenLedger {
+    public:
+        explicit TokenLedger(const BpeTokenizer& tokenizer);
+
+        void sync(const std::vector<protocol::Message>& history);
+        void replace(std::size_t index, const protocol::Message& message);
+
+        // The message at index was changed in place; the next sync() recounts it
+        void mark_dirty(std::size_t index) { dirty_.push_back(index); }
+
+        // Mirrors history.erase(begin, end) followed by inserting one message at begin
+        void replace_range(std::size_t begin, std::size_t end, const protocol::Message& message);
+
+        std::size_t total() const { return total_; }
+        std::size_t size() const { return counts_.size(); }
+        std::size_t at(std::size_t index) const { return counts_[index]; }
+
+        // Token count of a bare text such as a tool output; see TokenEstimator
+        std::size_t count(std::string_view text) { return estimator_.count(text); }
+
+        EstimatorStats stats() const { return estimator_.stats(); }
+
+    private:
+        TokenEstimator estimator_;
+        std::vector<std::size_t> counts_;
+        std::vector<std::size_t> dirty_;  // Indices to recount at the next sync()
+        std::size_t total_ = 0;
+    };
+
+} // namespace agent::core::context
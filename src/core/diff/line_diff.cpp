@@ -0,0 +1,665 @@
+#include "core/diff/line_diff.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include "core/fs/text_scan.hpp"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <nmmintrin.h>
+#define AGENT_HAVE_CRC32_DISPATCH 1
+#endif
+
+namespace agent::core::diff {
+
+    namespace {
+
+        using Index = std::ptrdiff_t;
+
+        struct Line {
+            std::string_view text;  // With its '\n', if it has one
+            std::uint64_t hash = 0;
+        };
+
+        // --- Splitting and hashing ---
+
+        // The last 1-7 bytes of a line as a word. Lines end inside the text,
+        // so one whole load usually stays inside it too; only the tail of
+        // the text itself needs the byte copy.
+        inline std::uint64_t tail_word(const char* at, std::size_t count, const char* end) {
+            std::uint64_t word = 0;
+            if (end - at >= 8) {
+                std::memcpy(&word, at, 8);
+                return word & (~std::uint64_t{0} >> (64 - 8 * count));
+            }
+            std::memcpy(&word, at, count);
+            return word;
+        }
+
+        std::uint64_t hash_words(const char* data, std::size_t size, const char* end) {
+            constexpr std::uint64_t kMultiplier = 0x9E3779B97F4A7C15ull;
+            std::uint64_t hash = size * kMultiplier;
+            std::size_t i = 0;
+            for (; i + 8 <= size; i += 8) {
+                std::uint64_t word;
+                std::memcpy(&word, data + i, 8);
+                hash = (hash ^ word) * kMultiplier;
+                hash ^= hash >> 29;
+            }
+            if (i < size) {
+                hash = (hash ^ tail_word(data + i, size - i, end)) * kMultiplier;
+                hash ^= hash >> 29;
+            }
+            return hash;
+        }
+
+#if defined(AGENT_HAVE_CRC32_DISPATCH)
+        // Two CRC32C lanes over alternate words: each crc32 waits three
+        // cycles for the one before it in its lane, but a new one issues
+        // every cycle
+        __attribute__((target("sse4.2"))) std::uint64_t hash_crc32(const char* data,
+                                                                   std::size_t size,
+                                                                   const char* end) {
+            std::uint64_t low = size;
+            std::uint64_t high = 0x9E3779B9u;
+            std::size_t i = 0;
+            for (; i + 16 <= size; i += 16) {
+                std::uint64_t first;
+                std::uint64_t second;
+                std::memcpy(&first, data + i, 8);
+                std::memcpy(&second, data + i + 8, 8);
+                low = _mm_crc32_u64(low, first);
+                high = _mm_crc32_u64(high, second);
+            }
+            if (i + 8 <= size) {
+                std::uint64_t word;
+                std::memcpy(&word, data + i, 8);
+                low = _mm_crc32_u64(low, word);
+                i += 8;
+            }
+            if (i < size) high = _mm_crc32_u64(high, tail_word(data + i, size - i, end));
+            // The table slot comes from the low half, which must see every byte
+            return (high << 32) | _mm_crc32_u64(low, high);
+        }
+#endif
+
+        using HashFunction = std::uint64_t (*)(const char*, std::size_t, const char*);
+
+        HashFunction pick_hash() {
+#if defined(AGENT_HAVE_CRC32_DISPATCH)
+            if (__builtin_cpu_supports("sse4.2")) return hash_crc32;
+#endif
+            return hash_words;
+        }
+
+        // Newlines are found 16 bytes at a time; each line is hashed as it is cut
+        std::vector<Line> split_lines(std::string_view text) {
+            static const HashFunction hash = pick_hash();
+            std::vector<Line> lines;
+            lines.reserve(fs::count_newlines(text) + 1);
+            const char* data = text.data();
+            const char* end = data + text.size();
+            std::size_t start = 0;
+            auto cut = [&](std::size_t stop) {
+                lines.push_back(
+                    Line{text.substr(start, stop - start), hash(data + start, stop - start, end)});
+                start = stop;
+            };
+            std::size_t i = 0;
+#if defined(__SSE2__)
+            const __m128i newline = _mm_set1_epi8('\n');
+            for (; i + 16 <= text.size(); i += 16) {
+                __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                auto mask =
+                    static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+                while (mask != 0) {
+                    cut(i + static_cast<std::size_t>(__builtin_ctz(mask)) + 1);
+                    mask &= mask - 1;
+                }
+            }
+#endif
+            for (; i < text.size(); ++i) {
+                if (data[i] == '\n') cut(i + 1);
+            }
+            if (start < text.size()) cut(text.size());
+            return lines;
+        }
+
+        // Numbers each distinct line, by hash and then by content
+        class LineClasses {
+        public:
+            explicit LineClasses(std::size_t lines) {
+                std::size_t capacity = 16;
+                while (capacity < lines * 2) capacity <<= 1;
+                hashes_.resize(capacity);
+                slots_.resize(capacity);
+                mask_ = capacity - 1;
+            }
+
+            std::uint32_t id(const Line& line) {
+                for (std::size_t slot = line.hash & mask_;; slot = (slot + 1) & mask_) {
+                    std::uint32_t entry = slots_[slot];
+                    if (entry == 0) {
+                        texts_.push_back(line.text);
+                        hashes_[slot] = line.hash;
+                        slots_[slot] = static_cast<std::uint32_t>(texts_.size());
+                        return entry_id(slots_[slot]);
+                    }
+                    if (hashes_[slot] == line.hash && texts_[entry - 1] == line.text) {
+                        return entry_id(entry);
+                    }
+                }
+            }
+
+            std::size_t size() const { return texts_.size(); }
+
+        private:
+            static std::uint32_t entry_id(std::uint32_t entry) { return entry - 1; }
+
+            std::vector<std::uint64_t> hashes_;
+            std::vector<std::uint32_t> slots_;  // Class + 1; 0 is free
+            std::vector<std::string_view> texts_;
+            std::size_t mask_ = 0;
+        };
+
+        bool is_blank(std::string_view line) {
+            return line.find_first_not_of(" \t\r\n\f\v") == std::string_view::npos;
+        }
+
+        // --- The diff ---
+
+        // Histogram diff anchors on lines occurring at most this often in the
+        // old text; a part of the input with only commoner lines goes to Myers
+        constexpr std::uint32_t kMaxChain = 64;
+
+        class LineDiff {
+        public:
+            LineDiff(std::string_view old_text, std::string_view new_text,
+                     const DiffOptions& options);
+
+            std::vector<Change> changes() const;
+            const std::vector<Line>& old_lines() const { return a_.lines; }
+            const std::vector<Line>& new_lines() const { return b_.lines; }
+
+        private:
+            struct Side {
+                std::vector<Line> lines;
+                std::vector<std::uint32_t> ids;  // Class of each line
+                std::vector<char> changed;       // Per line
+                // What the algorithms see: the classes of the lines that
+                // also occur in the other text, and where each one came from
+                std::vector<std::uint32_t> seq;
+                std::vector<Index> origin;
+            };
+
+            struct Split {
+                Index i1, i2;
+                bool min_lo, min_hi;  // Whether each half must still be diffed minimally
+            };
+
+            struct Region {
+                Index a_begin = 0, a_end = 0, b_begin = 0, b_end = 0;
+            };
+
+            enum class Anchor { Found, NoCommonLine, TooCommon };
+
+            void mark_a(Index from, Index to) {
+                for (; from < to; ++from) a_.changed[static_cast<std::size_t>(a_.origin[from])] = 1;
+            }
+            void mark_b(Index from, Index to) {
+                for (; from < to; ++from) b_.changed[static_cast<std::size_t>(b_.origin[from])] = 1;
+            }
+            // Drops the common head and tail of a box; true when that leaves
+            // one side empty, with the other side marked
+            bool trim(Index& off1, Index& lim1, Index& off2, Index& lim2);
+
+            void myers(Index off1, Index lim1, Index off2, Index lim2, bool need_min);
+            Split split(Index off1, Index lim1, Index off2, Index lim2, bool need_min);
+            void histogram(Index off1, Index lim1, Index off2, Index lim2);
+            Anchor find_anchor(Index off1, Index lim1, Index off2, Index lim2, Region& best);
+            void slide(std::vector<Change>& changes) const;
+
+            Side a_, b_;
+            const std::uint32_t* a_seq_ = nullptr;
+            const std::uint32_t* b_seq_ = nullptr;
+
+            // Myers: furthest reaching x per diagonal, forward and backward
+            std::vector<Index> kv_;
+            Index* kvdf_ = nullptr;
+            Index* kvdb_ = nullptr;
+            Index max_cost_ = 0;
+
+            // Histogram: occurrences in the old side of the current box, by class
+            std::vector<std::uint32_t> stamp_;  // Which box the entries below belong to
+            std::vector<std::uint32_t> count_;
+            std::vector<Index> head_;  // First occurrence
+            std::vector<Index> next_;  // Per old position: the next occurrence of that line
+            std::uint32_t round_ = 0;
+        };
+
+        LineDiff::LineDiff(std::string_view old_text, std::string_view new_text,
+                           const DiffOptions& options) {
+            a_.lines = split_lines(old_text);
+            b_.lines = split_lines(new_text);
+            LineClasses classes(a_.lines.size() + b_.lines.size());
+            for (Side* side : {&a_, &b_}) {
+                side->ids.reserve(side->lines.size());
+                for (const Line& line : side->lines) side->ids.push_back(classes.id(line));
+                side->changed.assign(side->lines.size(), 0);
+            }
+
+            // The usual edit touches a few lines in the middle: drop the rest
+            const std::size_t na = a_.ids.size();
+            const std::size_t nb = b_.ids.size();
+            std::size_t head = 0;
+            while (head < na && head < nb && a_.ids[head] == b_.ids[head]) ++head;
+            std::size_t tail = 0;
+            while (tail < na - head && tail < nb - head &&
+                   a_.ids[na - 1 - tail] == b_.ids[nb - 1 - tail]) {
+                ++tail;
+            }
+
+            std::vector<char> in_a(classes.size()), in_b(classes.size());
+            for (std::size_t i = head; i < na - tail; ++i) in_a[a_.ids[i]] = 1;
+            for (std::size_t i = head; i < nb - tail; ++i) in_b[b_.ids[i]] = 1;
+            auto keep = [](Side& side, std::size_t from, std::size_t to,
+                           const std::vector<char>& in_other) {
+                for (std::size_t i = from; i < to; ++i) {
+                    if (in_other[side.ids[i]]) {
+                        side.seq.push_back(side.ids[i]);
+                        side.origin.push_back(static_cast<Index>(i));
+                    } else {
+                        side.changed[i] = 1;
+                    }
+                }
+            };
+            keep(a_, head, na - tail, in_b);
+            keep(b_, head, nb - tail, in_a);
+            a_seq_ = a_.seq.data();
+            b_seq_ = b_.seq.data();
+
+            const auto n1 = static_cast<Index>(a_.seq.size());
+            const auto n2 = static_cast<Index>(b_.seq.size());
+            if (n1 == 0 && n2 == 0) return;
+            if (options.algorithm == Algorithm::Histogram) {
+                stamp_.assign(classes.size(), 0);
+                count_.resize(classes.size());
+                head_.resize(classes.size());
+                next_.resize(static_cast<std::size_t>(n1));
+            }
+            // Diagonals run from -n2 - 1 to n1 + 1 in both directions
+            const Index diagonals = n1 + n2 + 3;
+            kv_.resize(static_cast<std::size_t>(2 * diagonals));
+            kvdf_ = kv_.data() + n2 + 1;
+            kvdb_ = kvdf_ + diagonals;
+            max_cost_ = std::max<Index>(256, static_cast<Index>(std::sqrt(diagonals)));
+
+            if (options.algorithm == Algorithm::Histogram) {
+                histogram(0, n1, 0, n2);
+            } else {
+                myers(0, n1, 0, n2, options.minimal);
+            }
+        }
+
+        bool LineDiff::trim(Index& off1, Index& lim1, Index& off2, Index& lim2) {
+            while (off1 < lim1 && off2 < lim2 && a_seq_[off1] == b_seq_[off2]) {
+                ++off1;
+                ++off2;
+            }
+            while (off1 < lim1 && off2 < lim2 && a_seq_[lim1 - 1] == b_seq_[lim2 - 1]) {
+                --lim1;
+                --lim2;
+            }
+            if (off1 < lim1 && off2 < lim2) return false;
+            mark_a(off1, lim1);
+            mark_b(off2, lim2);
+            return true;
+        }
+
+        // Myers' O((N+M)D) algorithm in linear space: find the middle snake of
+        // the box's shortest edit script, searching from both ends at once,
+        // and recurse into the boxes before and after it. Kept on an explicit
+        // stack, as lopsided splits can nest deeply.
+        void LineDiff::myers(Index off1, Index lim1, Index off2, Index lim2, bool need_min) {
+            struct Box {
+                Index off1, lim1, off2, lim2;
+                bool need_min;
+            };
+            std::vector<Box> pending{{off1, lim1, off2, lim2, need_min}};
+            while (!pending.empty()) {
+                Box box = pending.back();
+                pending.pop_back();
+                if (trim(box.off1, box.lim1, box.off2, box.lim2)) continue;
+                Split middle = split(box.off1, box.lim1, box.off2, box.lim2, box.need_min);
+                pending.push_back({middle.i1, box.lim1, middle.i2, box.lim2, middle.min_hi});
+                pending.push_back({box.off1, middle.i1, box.off2, middle.i2, middle.min_lo});
+            }
+        }
+
+        // Diagonal d holds the points with x - y == d, x in the old sequence
+        LineDiff::Split LineDiff::split(Index off1, Index lim1, Index off2, Index lim2,
+                                        bool need_min) {
+            constexpr Index kFar = std::numeric_limits<Index>::max();
+            Index* kvdf = kvdf_;
+            Index* kvdb = kvdb_;
+            const Index dmin = off1 - lim2;
+            const Index dmax = lim1 - off2;
+            const Index fmid = off1 - off2;
+            const Index bmid = lim1 - lim2;
+            const bool odd = ((fmid - bmid) & 1) != 0;
+            Index fmin = fmid, fmax = fmid;
+            Index bmin = bmid, bmax = bmid;
+            kvdf[fmid] = off1;
+            kvdb[bmid] = lim1;
+
+            for (Index cost = 1;; ++cost) {
+                // One more edit forward: each diagonal extends from a neighbour
+                if (fmin > dmin) {
+                    kvdf[--fmin - 1] = -1;
+                } else {
+                    ++fmin;
+                }
+                if (fmax < dmax) {
+                    kvdf[++fmax + 1] = -1;
+                } else {
+                    --fmax;
+                }
+                for (Index d = fmax; d >= fmin; d -= 2) {
+                    Index i1 = kvdf[d - 1] >= kvdf[d + 1] ? kvdf[d - 1] + 1 : kvdf[d + 1];
+                    Index i2 = i1 - d;
+                    while (i1 < lim1 && i2 < lim2 && a_seq_[i1] == b_seq_[i2]) {
+                        ++i1;
+                        ++i2;
+                    }
+                    kvdf[d] = i1;
+                    if (odd && bmin <= d && d <= bmax && kvdb[d] <= i1) {
+                        return {i1, i2, true, true};
+                    }
+                }
+
+                // And backward
+                if (bmin > dmin) {
+                    kvdb[--bmin - 1] = kFar;
+                } else {
+                    ++bmin;
+                }
+                if (bmax < dmax) {
+                    kvdb[++bmax + 1] = kFar;
+                } else {
+                    --bmax;
+                }
+                for (Index d = bmax; d >= bmin; d -= 2) {
+                    Index i1 = kvdb[d - 1] < kvdb[d + 1] ? kvdb[d - 1] : kvdb[d + 1] - 1;
+                    Index i2 = i1 - d;
+                    while (i1 > off1 && i2 > off2 && a_seq_[i1 - 1] == b_seq_[i2 - 1]) {
+                        --i1;
+                        --i2;
+                    }
+                    kvdb[d] = i1;
+                    if (!odd && fmin <= d && d <= fmax && i1 <= kvdf[d]) {
+                        return {i1, i2, true, true};
+                    }
+                }
+
+                if (need_min || cost < max_cost_) continue;
+                // Too costly to finish: cut at the point either search got
+                // furthest to, so the cost stays linear. The half that search
+                // crossed is still diffed minimally, the other need not be.
+                Index fbest = -1, fbest1 = -1;
+                for (Index d = fmax; d >= fmin; d -= 2) {
+                    Index i1 = std::min(kvdf[d], lim1);
+                    Index i2 = i1 - d;
+                    if (lim2 < i2) {
+                        i1 = lim2 + d;
+                        i2 = lim2;
+                    }
+                    if (fbest < i1 + i2) {
+                        fbest = i1 + i2;
+                        fbest1 = i1;
+                    }
+                }
+                Index bbest = kFar, bbest1 = kFar;
+                for (Index d = bmax; d >= bmin; d -= 2) {
+                    Index i1 = std::max(off1, kvdb[d]);
+                    Index i2 = i1 - d;
+                    if (i2 < off2) {
+                        i1 = off2 + d;
+                        i2 = off2;
+                    }
+                    if (i1 + i2 < bbest) {
+                        bbest = i1 + i2;
+                        bbest1 = i1;
+                    }
+                }
+                if ((lim1 + lim2) - bbest < fbest - (off1 + off2)) {
+                    return {fbest1, fbest - fbest1, true, false};
+                }
+                return {bbest1, bbest - bbest1, false, true};
+            }
+        }
+
+        // Histogram diff, as in git and JGit: anchor on the longest common run
+        // among those holding the rarest line, then diff the boxes either side
+        void LineDiff::histogram(Index off1, Index lim1, Index off2, Index lim2) {
+            std::vector<Region> pending{{off1, lim1, off2, lim2}};
+            while (!pending.empty()) {
+                Region box = pending.back();
+                pending.pop_back();
+                if (trim(box.a_begin, box.a_end, box.b_begin, box.b_end)) continue;
+                Region anchor;
+                switch (find_anchor(box.a_begin, box.a_end, box.b_begin, box.b_end, anchor)) {
+                case Anchor::TooCommon:
+                    myers(box.a_begin, box.a_end, box.b_begin, box.b_end, false);
+                    break;
+                case Anchor::NoCommonLine:
+                    mark_a(box.a_begin, box.a_end);
+                    mark_b(box.b_begin, box.b_end);
+                    break;
+                case Anchor::Found:
+                    pending.push_back({anchor.a_end, box.a_end, anchor.b_end, box.b_end});
+                    pending.push_back({box.a_begin, anchor.a_begin, box.b_begin, anchor.b_begin});
+                    break;
+                }
+            }
+        }
+
+        LineDiff::Anchor LineDiff::find_anchor(Index off1, Index lim1, Index off2, Index lim2,
+                                               Region& best) {
+            // Chain each old line's occurrences, back to front so they run forward
+            const std::uint32_t round = ++round_;
+            for (Index i = lim1 - 1; i >= off1; --i) {
+                std::uint32_t id = a_seq_[i];
+                if (stamp_[id] != round) {
+                    stamp_[id] = round;
+                    count_[id] = 0;
+                    head_[id] = -1;
+                }
+                next_[static_cast<std::size_t>(i)] = head_[id];
+                head_[id] = i;
+                ++count_[id];
+            }
+
+            std::uint32_t best_count = kMaxChain + 1;
+            bool common = false;
+            for (Index bi = off2; bi < lim2;) {
+                std::uint32_t id = b_seq_[bi];
+                Index b_next = bi + 1;
+                if (stamp_[id] == round) {
+                    common = true;
+                    if (count_[id] <= best_count) {
+                        for (Index ai = head_[id]; ai >= 0;) {
+                            // Grow the run around this pair both ways
+                            Index as = ai, bs = bi, ae = ai + 1, be = bi + 1;
+                            std::uint32_t rarest = count_[id];
+                            while (as > off1 && bs > off2 && a_seq_[as - 1] == b_seq_[bs - 1]) {
+                                --as;
+                                --bs;
+                                rarest = std::min(rarest, count_[a_seq_[as]]);
+                            }
+                            while (ae < lim1 && be < lim2 && a_seq_[ae] == b_seq_[be]) {
+                                rarest = std::min(rarest, count_[a_seq_[ae]]);
+                                ++ae;
+                                ++be;
+                            }
+                            b_next = std::max(b_next, be);
+                            if (best.a_end - best.a_begin < ae - as || rarest < best_count) {
+                                best = {as, ae, bs, be};
+                                best_count = rarest;
+                            }
+                            // Later occurrences inside this run would only find it again
+                            Index next = next_[static_cast<std::size_t>(ai)];
+                            while (next >= 0 && next < ae) {
+                                next = next_[static_cast<std::size_t>(next)];
+                            }
+                            ai = next;
+                        }
+                    }
+                }
+                bi = b_next;
+            }
+            if (!common) return Anchor::NoCommonLine;
+            return best_count > kMaxChain ? Anchor::TooCommon : Anchor::Found;
+        }
+
+        std::vector<Change> LineDiff::changes() const {
+            std::vector<Change> changes;
+            const std::size_t na = a_.changed.size();
+            const std::size_t nb = b_.changed.size();
+            std::size_t i = 0, j = 0;
+            while (i < na || j < nb) {
+                if ((i < na && a_.changed[i]) || (j < nb && b_.changed[j])) {
+                    Change change{i, 0, j, 0};
+                    while (i < na && a_.changed[i]) ++i;
+                    while (j < nb && b_.changed[j]) ++j;
+                    change.old_count = i - change.old_start;
+                    change.new_count = j - change.new_start;
+                    changes.push_back(change);
+                } else {
+                    ++i;
+                    ++j;
+                }
+            }
+            slide(changes);
+            return changes;
+        }
+
+        // A pure insertion or deletion next to lines equal to its own can sit
+        // anywhere along them ("}\n\nf() {\n" inserted after "}\n\n" or before
+        // it). Put it where it ends on a blank line, if such a place exists,
+        // so whole blocks show as added; otherwise as low as it goes.
+        void LineDiff::slide(std::vector<Change>& changes) const {
+            for (std::size_t k = 0; k < changes.size(); ++k) {
+                Change& change = changes[k];
+                if ((change.old_count == 0) == (change.new_count == 0)) continue;
+                const bool inserted = change.old_count == 0;
+                const Side& side = inserted ? b_ : a_;
+                std::size_t start = inserted ? change.new_start : change.old_start;
+                const std::size_t count = inserted ? change.new_count : change.old_count;
+                auto start_of = [&](const Change& c) {
+                    return inserted ? c.new_start : c.old_start;
+                };
+                auto end_of = [&](const Change& c) {
+                    return inserted ? c.new_start + c.new_count : c.old_start + c.old_count;
+                };
+                // The lines it moves across must stay unchanged
+                const std::size_t low = k > 0 ? end_of(changes[k - 1]) : 0;
+                const std::size_t high =
+                    k + 1 < changes.size() ? start_of(changes[k + 1]) : side.ids.size();
+
+                const std::size_t original = start;
+                while (start > low && side.ids[start - 1] == side.ids[start + count - 1]) --start;
+                std::size_t best = std::string_view::npos;
+                if (is_blank(side.lines[start + count - 1].text)) best = start;
+                while (start + count < high && side.ids[start] == side.ids[start + count]) {
+                    ++start;
+                    if (is_blank(side.lines[start + count - 1].text)) best = start;
+                }
+                if (best != std::string_view::npos) start = best;
+
+                const std::size_t moved = start - original;  // Wraps when moved up; so does +=
+                change.old_start += moved;
+                change.new_start += moved;
+            }
+        }
+
+        void append_range(std::string& out, std::size_t start, std::size_t count) {
+            // 1-based; an empty range names the line before it
+            out += std::to_string(count == 0 ? start : start + 1);
+            if (count != 1) {
+                out += ',';
+                out += std::to_string(count);
+            }
+        }
+
+        void append_line(std::string& out, char mark, std::string_view line) {
+            out += mark;
+            out.append(line);
+            if (line.back() != '\n') out += "\n\\ No newline at end of file\n";
+        }
+
+    } // namespace
+
+    std::vector<Change> diff_lines(std::string_view old_text, std::string_view new_text,
+                                   const DiffOptions& options) {
+        return LineDiff(old_text, new_text, options).changes();
+    }
+
+    UnifiedDiff unified_diff(std::string_view old_text, std::string_view new_text,
+                             std::string_view old_label, std::string_view new_label,
+                             const DiffOptions& options) {
+        LineDiff diff(old_text, new_text, options);
+        std::vector<Change> changes = diff.changes();
+        UnifiedDiff result;
+        if (changes.empty()) return result;
+        const auto& old_lines = diff.old_lines();
+        const auto& new_lines = diff.new_lines();
+        auto old_end = [](const Change& c) { return c.old_start + c.old_count; };
+
+        std::string& out = result.text;
+        out.append("--- ").append(old_label).append("\n+++ ").append(new_label).append("\n");
+        const std::size_t context = options.context;
+        for (std::size_t first = 0; first < changes.size();) {
+            // Changes closer than twice the context share a hunk
+            std::size_t last = first;
+            while (last + 1 < changes.size() &&
+                   changes[last + 1].old_start - old_end(changes[last]) <= 2 * context) {
+                ++last;
+            }
+            const Change& head = changes[first];
+            const Change& tail = changes[last];
+            const std::size_t lead = std::min(context, head.old_start);
+            const std::size_t trail = std::min(context, old_lines.size() - old_end(tail));
+            const std::size_t old_from = head.old_start - lead;
+            const std::size_t old_to = old_end(tail) + trail;
+            const std::size_t new_from = head.new_start - lead;
+            const std::size_t new_to = tail.new_start + tail.new_count + trail;
+
+            out += "@@ -";
+            append_range(out, old_from, old_to - old_from);
+            out += " +";
+            append_range(out, new_from, new_to - new_from);
+            out += " @@\n";
+            std::size_t at = old_from;
+            for (std::size_t k = first; k <= last; ++k) {
+                const Change& change = changes[k];
+                for (; at < change.old_start; ++at) append_line(out, ' ', old_lines[at].text);
+                for (std::size_t i = 0; i < change.old_count; ++i) {
+                    append_line(out, '-', old_lines[change.old_start + i].text);
+                }
+                for (std::size_t i = 0; i < change.new_count; ++i) {
+                    append_line(out, '+', new_lines[change.new_start + i].text);
+                }
+                at = old_end(change);
+                result.deletions += change.old_count;
+                result.insertions += change.new_count;
+            }
+            for (; at < old_to; ++at) append_line(out, ' ', old_lines[at].text);
+            first = last + 1;
+        }
+        return result;
+    }
+
+} // namespace agent::core::diff
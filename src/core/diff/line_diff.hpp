@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agent::core::diff {
+
+    enum class Algorithm {
+        Myers,      // Fewest changed lines
+        Histogram,  // Anchors on lines that are rare in both texts; follows code blocks better
+    };
+
+    struct DiffOptions {
+        Algorithm algorithm = Algorithm::Myers;
+        std::size_t context = 3;  // Unchanged lines shown around each change
+        // Myers gives up on the shortest edit script for a part of the input
+        // once it costs more than about sqrt(lines) edits, and settles for a
+        // longer one found in linear time; set this to always search it out
+        bool minimal = false;
+    };
+
+    // Lines [old_start, old_start + old_count) of the old text were replaced
+    // by lines [new_start, new_start + new_count) of the new one; 0-based,
+    // either count may be 0
+    struct Change {
+        std::size_t old_start = 0;
+        std::size_t old_count = 0;
+        std::size_t new_start = 0;
+        std::size_t new_count = 0;
+    };
+
+    // What changed between two texts, line by line, in order. A line
+    // includes its '\n', so a missing newline at the end is a change too.
+    //
+    // Lines are found and hashed with SIMD and numbered by content, so the
+    // algorithms compare integers; lines that do not occur in the other text
+    // at all are set aside first, as no algorithm could match them. Each run
+    // of changed lines is then slid, where it can be, to end on a blank line.
+    std::vector<Change> diff_lines(std::string_view old_text, std::string_view new_text,
+                                   const DiffOptions& options = {});
+
+    struct UnifiedDiff {
+        std::string text;  // Empty when the texts are equal
+        std::size_t insertions = 0;
+        std::size_t deletions = 0;
+    };
+
+    // The changes as a unified diff ("--- old_label", "+++ new_label", then
+    // "@@ -l,n +l,n @@" hunks), the way diff -u and git print them
+    UnifiedDiff unified_diff(std::string_view old_text, std::string_view new_text,
+                             std::string_view old_label, std::string_view new_label,
+                             const DiffOptions& options = {});
+
+} // namespace agent::core::diff
@@ -0,0 +1,296 @@
+#include "core/diff/patch.hpp"
+#include <algorithm>
+#include <charconv>
+
+namespace agent::core::diff {
+
+    namespace {
+
+        constexpr std::size_t kNone = std::string_view::npos;
+
+        // Lines without their '\n' (patch) or with it (file)
+        std::vector<std::string_view> split(std::string_view text, bool keep_newline) {
+            std::vector<std::string_view> lines;
+            std::size_t start = 0;
+            while (start < text.size()) {
+                std::size_t end = text.find('\n', start);
+                if (end == kNone) {
+                    lines.push_back(text.substr(start));
+                    break;
+                }
+                lines.push_back(text.substr(start, end - start + (keep_newline ? 1 : 0)));
+                start = end + 1;
+            }
+            return lines;
+        }
+
+        std::string_view trim(std::string_view text) {
+            std::size_t first = text.find_first_not_of(" \t\r");
+            if (first == kNone) return {};
+            return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+        }
+
+        // Whitespace at the end of a line, '\n' included, does not count
+        std::string_view trim_end(std::string_view line) {
+            std::size_t last = line.find_last_not_of(" \t\r\n");
+            return last == kNone ? std::string_view{} : line.substr(0, last + 1);
+        }
+
+        // "a/src/x.cpp\t2024-05-01 ..." -> "a/src/x.cpp"; "/dev/null" -> ""
+        std::string header_path(std::string_view field) {
+            field = trim(field.substr(0, field.find('\t')));
+            if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+                field = field.substr(1, field.size() - 2);
+            }
+            return field == "/dev/null" ? std::string() : std::string(field);
+        }
+
+        // "-12,3" -> 12 and 3; "+12" -> 12 and 1
+        bool parse_range(std::string_view field, char sign, std::size_t& start,
+                         std::size_t& count) {
+            if (field.empty() || field[0] != sign) return false;
+            field.remove_prefix(1);
+            auto number = [](std::string_view digits, std::size_t& value) {
+                auto [end, error] =
+                    std::from_chars(digits.data(), digits.data() + digits.size(), value);
+                return error == std::errc() && end == digits.data() + digits.size() &&
+                       !digits.empty();
+            };
+            std::size_t comma = field.find(',');
+            count = 1;
+            return number(field.substr(0, comma), start) &&
+                   (comma == kNone || number(field.substr(comma + 1), count));
+        }
+
+        // "@@ -12,3 +12,4 @@ int main()"; a bare "@@" gives no position and no counts
+        bool parse_hunk_header(std::string_view line, Hunk& hunk, bool& counted,
+                               std::size_t& old_left, std::size_t& new_left) {
+            counted = false;
+            std::string_view ranges = line.substr(2);
+            ranges = trim(ranges.substr(0, ranges.find("@@")));
+            if (ranges.empty()) return true;
+            std::size_t space = ranges.find(' ');
+            if (space == kNone) return false;
+            counted = parse_range(ranges.substr(0, space), '-', hunk.old_start, old_left) &&
+                      parse_range(trim(ranges.substr(space + 1)), '+', hunk.new_start, new_left);
+            return counted;
+        }
+
+        bool is_file_header(const std::vector<std::string_view>& lines, std::size_t i) {
+            return lines[i].starts_with("--- ") && i + 1 < lines.size() &&
+                   lines[i + 1].starts_with("+++ ");
+        }
+
+        errors::AgentError malformed(std::string message) {
+            return errors::AgentError{errors::ErrorCategory::Input, std::move(message)};
+        }
+
+        std::string quote(std::string_view line) {
+            line = trim_end(line);
+            std::string quoted = "\"";
+            if (line.size() > 120) {
+                quoted.append(line.substr(0, 117)).append("...");
+            } else {
+                quoted.append(line);
+            }
+            quoted += '"';
+            return quoted;
+        }
+
+    } // namespace
+
+    errors::Result<std::vector<FilePatch>> parse_patch(std::string_view patch) {
+        auto lines = split(patch, false);
+        std::vector<FilePatch> files;
+        Hunk* hunk = nullptr;
+        std::size_t bare_blanks = 0;  // Empty lines at the end of the hunk so far
+        // Lines the header's counts still promise. While any are owed, a
+        // removed "-- x" and added "++ y" are body lines, not a file header,
+        // unless a hunk header follows them.
+        bool counted = false;
+        std::size_t old_left = 0, new_left = 0;
+        auto close_hunk = [&] {
+            // Trailing empty lines separate files rather than belong to the hunk
+            if (hunk) hunk->lines.resize(hunk->lines.size() - bare_blanks);
+            hunk = nullptr;
+            bare_blanks = 0;
+        };
+
+        for (std::size_t i = 0; i < lines.size(); ++i) {
+            std::string_view line = lines[i];
+            // Counts are often wrong in patches models write: a ---/+++ pair
+            // followed by a hunk header is a file header whatever they say
+            bool owed = counted && (old_left > 0 || new_left > 0) &&
+                        !(is_file_header(lines, i) && i + 2 < lines.size() &&
+                          lines[i + 2].starts_with("@@"));
+            if (hunk && (owed || (!is_file_header(lines, i) && !line.starts_with("@@") &&
+                                  !line.starts_with("diff ")))) {
+                if (line.empty() || line == "\r") {
+                    hunk->lines.push_back({' ', "\n"});
+                    if (owed) {
+                        // A context line whose space was stripped, counted like any other
+                        old_left -= old_left > 0;
+                        new_left -= new_left > 0;
+                    } else {
+                        ++bare_blanks;
+                    }
+                    continue;
+                }
+                if (line[0] == ' ' || line[0] == '-' || line[0] == '+') {
+                    std::string text(line.substr(1));
+                    text += '\n';
+                    hunk->lines.push_back({line[0], std::move(text)});
+                    bare_blanks = 0;
+                    if (line[0] != '+') old_left -= old_left > 0;
+                    if (line[0] != '-') new_left -= new_left > 0;
+                    continue;
+                }
+                if (line[0] == '\\') {
+                    // "\ No newline at end of file", about the line before
+                    if (!hunk->lines.empty() && bare_blanks == 0) {
+                        hunk->lines.back().text.pop_back();
+                    }
+                    continue;
+                }
+            }
+            close_hunk();
+
+            if (is_file_header(lines, i)) {
+                FilePatch file;
+                file.old_path = header_path(line.substr(4));
+                file.new_path = header_path(lines[++i].substr(4));
+                if (file.old_path.empty() && file.new_path.empty()) {
+                    return malformed("Both sides of a file header are /dev/null");
+                }
+                bool git_prefixes = (file.old_path.empty() || file.old_path.starts_with("a/")) &&
+                                    (file.new_path.empty() || file.new_path.starts_with("b/"));
+                if (git_prefixes) {
+                    if (!file.old_path.empty()) file.old_path.erase(0, 2);
+                    if (!file.new_path.empty()) file.new_path.erase(0, 2);
+                }
+                files.push_back(std::move(file));
+            } else if (line.starts_with("@@")) {
+                if (files.empty()) return malformed("Hunk before any ---/+++ file header");
+                Hunk next;
+                if (!parse_hunk_header(line, next, counted, old_left, new_left)) {
+                    return malformed("Malformed hunk header: " + std::string(line));
+                }
+                files.back().hunks.push_back(std::move(next));
+                hunk = &files.back().hunks.back();
+            }
+        }
+        close_hunk();
+
+        if (files.empty()) return malformed("No ---/+++ file headers in the patch");
+        for (const auto& file : files) {
+            const std::string& path = file.deletes() ? file.old_path : file.new_path;
+            if (file.hunks.empty() && !file.deletes()) return malformed(path + ": no hunks");
+            for (const auto& each : file.hunks) {
+                if (each.lines.empty()) return malformed(path + ": empty hunk");
+            }
+        }
+        return files;
+    }
+
+    errors::Result<std::string> apply_hunks(std::string_view text,
+                                            const std::vector<Hunk>& hunks) {
+        auto file = split(text, true);
+        std::vector<std::string_view> pieces;
+        pieces.reserve(file.size() + 16);
+        std::string problems;
+        std::size_t at = 0;  // File lines before this are placed
+
+        for (std::size_t k = 0; k < hunks.size(); ++k) {
+            const Hunk& hunk = hunks[k];
+            std::vector<std::string_view> block;  // What the hunk expects to find
+            for (const auto& line : hunk.lines) {
+                if (line.kind != '+') block.push_back(line.text);
+            }
+            std::size_t hint = at;
+            if (hunk.old_start > 0) hint = block.empty() ? hunk.old_start : hunk.old_start - 1;
+
+            auto matches = [&](std::size_t pos, std::size_t count, bool loose) {
+                for (std::size_t j = 0; j < count; ++j) {
+                    bool same = loose ? trim_end(file[pos + j]) == trim_end(block[j])
+                                      : file[pos + j] == block[j];
+                    if (!same) return false;
+                }
+                return true;
+            };
+            // Nearest hint first, exact before loose; never before `at`
+            auto locate = [&](std::size_t count) -> std::size_t {
+                if (file.size() < at + count) return kNone;
+                const std::size_t last = file.size() - count;
+                const std::size_t from = std::clamp(hint, at, last);
+                for (bool loose : {false, true}) {
+                    for (std::size_t d = 0; from + d <= last || from >= at + d; ++d) {
+                        if (from + d <= last && matches(from + d, count, loose)) return from + d;
+                        if (d > 0 && from >= at + d && matches(from - d, count, loose)) {
+                            return from - d;
+                        }
+                    }
+                }
+                return kNone;
+            };
+
+            std::size_t pos = block.empty() ? std::min(std::max(hint, at), file.size())
+                                            : locate(block.size());
+            if (pos == kNone) {
+                // Say where it went wrong, at the likeliest place for it
+                problems += "hunk " + std::to_string(k + 1);
+                if (hunk.old_start > 0) {
+                    problems += " (line " + std::to_string(hunk.old_start) + ")";
+                }
+                std::size_t near = locate(1);
+                if (near == kNone) {
+                    problems += ": " + quote(block[0]) + " is not in the file";
+                } else {
+                    std::size_t j = 0;
+                    while (near + j < file.size() && j < block.size() &&
+                           trim_end(file[near + j]) == trim_end(block[j])) {
+                        ++j;
+                    }
+                    if (near + j >= file.size()) {
+                        problems += ": the file ends before " + quote(block[j]);
+                    } else {
+                        problems += ": line " + std::to_string(near + j + 1) + " reads " +
+                                    quote(file[near + j]) + " where the patch has " +
+                                    quote(block[j]);
+                    }
+                }
+                problems += '\n';
+                continue;
+            }
+
+            pieces.insert(pieces.end(), file.begin() + static_cast<std::ptrdiff_t>(at),
+                          file.begin() + static_cast<std::ptrdiff_t>(pos));
+            std::size_t cursor = pos;
+            for (const auto& line : hunk.lines) {
+                if (line.kind == '+') {
+                    pieces.push_back(line.text);
+                } else {
+                    if (line.kind == ' ') pieces.push_back(file[cursor]);
+                    ++cursor;
+                }
+            }
+            at = cursor;
+        }
+        if (!problems.empty()) {
+            problems.pop_back();
+            return errors::AgentError{errors::ErrorCategory::Execution, std::move(problems)};
+        }
+        pieces.insert(pieces.end(), file.begin() + static_cast<std::ptrdiff_t>(at), file.end());
+
+        std::string out;
+        out.reserve(text.size() + text.size() / 8);
+        for (std::size_t i = 0; i < pieces.size(); ++i) {
+            out.append(pieces[i]);
+            // A line that ended the file no longer does
+            if (i + 1 < pieces.size() && (pieces[i].empty() || pieces[i].back() != '\n')) {
+                out += '\n';
+            }
+        }
+        return out;
+    }
+
+} // namespace agent::core::diff
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+
+namespace agent::core::diff {
+
+    struct HunkLine {
+        char kind = ' ';   // ' ' context, '-' removed, '+' added
+        std::string text;  // With its '\n', unless "\ No newline at end of file" followed
+    };
+
+    struct Hunk {
+        // From the "@@ -old_start,n +new_start,m @@" header, 1-based. Only
+        // a hint of where to look: the lines themselves decide where the
+        // hunk goes. 0 when the header gave no numbers (a bare "@@").
+        std::size_t old_start = 0;
+        std::size_t new_start = 0;
+        std::vector<HunkLine> lines;
+    };
+
+    struct FilePatch {
+        std::string old_path;  // Empty for a file the patch creates (--- /dev/null)
+        std::string new_path;  // Empty for a file the patch deletes (+++ /dev/null)
+        std::vector<Hunk> hunks;
+
+        bool creates() const { return old_path.empty(); }
+        bool deletes() const { return new_path.empty(); }
+    };
+
+    // Reads a multi-file unified diff, as diff -u, git diff or a model
+    // writes one. Anything outside the file headers and hunks ("diff --git",
+    // "index", prose) is skipped and git's a/ and b/ prefixes are dropped.
+    // The line counts in a hunk header only keep lines such as "-- x" and
+    // "++ y" in the hunk while they are owed; a ---/+++ pair followed by an
+    // "@@" line still starts the next file, as models miscount. Past its
+    // counts, or without them, a hunk runs until a line that cannot be part
+    // of it. Blank lines inside a hunk count as blank context lines, since
+    // editors and models strip the space.
+    errors::Result<std::vector<FilePatch>> parse_patch(std::string_view patch);
+
+    // Applies the hunks of one file to its text, in order. Each hunk goes
+    // where its context and removed lines match exactly, nearest the line
+    // its header names; failing that, where they match ignoring whitespace
+    // at line ends. Context lines keep the file's own text. Every hunk that
+    // fits nowhere is described in the error.
+    errors::Result<std::string> apply_hunks(std::string_view text,
+                                            const std::vector<Hunk>& hunks);
+
+} // namespace agent::core::diff
@@ -24,6 +24,9 @@ namespace agent::core::errors {
     template <typename T>
     using Result = std::variant<T, AgentError>;
 
+    // For functions that only report success or failure
+    using Status = Result<std::monostate>;
+
     // --- Beginner-friendly helpers to work with std::variant ---
 
     template <typename T>
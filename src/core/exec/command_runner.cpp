@@ -0,0 +1,177 @@
+#include "core/exec/command_runner.hpp"
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <array>
+#include <cerrno>
+#include <thread>
+#include "core/exec/process_util.hpp"
+
+namespace agent::core::exec {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+    using detail::Clock;
+    using detail::Fd;
+
+    namespace {
+
+        // Tags for epoll_event::data.u32
+        constexpr std::uint32_t kStdout = 0;
+        constexpr std::uint32_t kStderr = 1;
+        constexpr std::uint32_t kExited = 2;
+
+        // Wraps argv in `sh -c 'ulimit ...; exec "$@"'` when limits are requested
+        std::vector<std::string> with_limits(const CommandSpec& spec) {
+            std::string script = detail::ulimit_prefix(spec.limits);
+            if (script.empty()) return spec.argv;
+
+            std::vector<std::string> argv{"/bin/sh", "-c", script + "exec \"$@\"", "sh"};
+            argv.insert(argv.end(), spec.argv.begin(), spec.argv.end());
+            return argv;
+        }
+
+    } // namespace
+
+    CommandSpec CommandSpec::shell(std::string command) {
+        CommandSpec spec;
+        spec.argv = {"/bin/sh", "-c", std::move(command)};
+        return spec;
+    }
+
+    errors::Result<CommandResult> run_command(const CommandSpec& spec) {
+        if (spec.argv.empty()) return AgentError{ErrorCategory::Input, "Empty command"};
+        auto start = Clock::now();
+
+        // 1. Pipes: the child's ends are dup2'ed onto 1 and 2, ours are non-blocking
+        Fd out_read, out_write, err_read, err_write;
+        auto piped = detail::make_pipe(out_read, out_write);
+        if (!errors::is_error(piped)) piped = detail::make_pipe(err_read, err_write);
+        if (errors::is_error(piped)) return errors::get_error(piped);
+        Fd epoll(::epoll_create1(EPOLL_CLOEXEC));
+        if (epoll.fd < 0) return detail::errno_error("epoll_create1");
+
+        // 2. Spawn in its own process group
+        auto spawned = detail::spawn(with_limits(spec), spec.env, spec.cwd, -1, out_write.fd,
+                                     err_write.fd);
+        if (errors::is_error(spawned)) return errors::get_error(spawned);
+        pid_t pid = errors::get_value(spawned);
+        out_write.reset();
+        err_write.reset();
+
+        // 3. Multiplex both pipes and the exit notification
+        tools::OutputCollector out(spec.stdout_limits), err(spec.stderr_limits);
+        auto to_out = [&](std::string_view bytes) { out.write(bytes); };
+        auto to_err = [&](std::string_view bytes) { err.write(bytes); };
+        if (spec.spill) {
+            out.spill_to(*spec.spill);
+            err.spill_to(*spec.spill);
+        }
+
+        // Out of descriptors the child could neither be watched nor timed
+        // out, so it does not get to run unwatched
+        auto abandon = [&](const std::string& what) {
+            AgentError error = detail::errno_error(what);
+            ::kill(-pid, SIGKILL);
+            ::waitpid(pid, nullptr, 0);
+            return error;
+        };
+        Fd pidfd(detail::open_pidfd(pid));
+        if (pidfd.fd < 0 && (errno == EMFILE || errno == ENFILE || errno == ENOMEM)) {
+            return abandon("pidfd_open");  // Other errors: no pidfd support, reap by polling
+        }
+        auto watch = [&](int fd, std::uint32_t tag) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u32 = tag;
+            return ::epoll_ctl(epoll.fd, EPOLL_CTL_ADD, fd, &event) == 0;
+        };
+        for (int fd : {out_read.fd, err_read.fd}) ::fcntl(fd, F_SETFL, O_NONBLOCK);
+        if (!watch(out_read.fd, kStdout) || !watch(err_read.fd, kStderr) ||
+            (pidfd.fd >= 0 && !watch(pidfd.fd, kExited))) {
+            return abandon("epoll_ctl");
+        }
+
+        CommandResult result;
+        int open_pipes = 2;
+        bool exited = false;
+        bool killed = false;
+        auto deadline = start + std::chrono::milliseconds(spec.timeout_ms);
+
+        auto on_deadline = [&]() {
+            if (!result.timed_out) {
+                result.timed_out = true;
+                ::kill(-pid, SIGTERM);
+                deadline = Clock::now() + std::chrono::milliseconds(spec.kill_grace_ms);
+            } else if (!killed) {
+                killed = true;
+                ::kill(-pid, SIGKILL);
+                deadline = Clock::now() + std::chrono::milliseconds(spec.kill_grace_ms);
+            } else {
+                return false;  // Something outside the group still holds a pipe
+            }
+            return true;
+        };
+
+        while (open_pipes > 0 && !exited) {
+            std::array<epoll_event, 3> events;
+            int n = ::epoll_wait(epoll.fd, events.data(), static_cast<int>(events.size()),
+                                 detail::remaining_ms(deadline));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                if (!on_deadline()) break;
+                continue;
+            }
+            for (int i = 0; i < n; ++i) {
+                std::uint32_t tag = events[static_cast<std::size_t>(i)].data.u32;
+                if (tag == kExited) {
+                    exited = true;
+                    continue;
+                }
+                Fd& fd = tag == kStdout ? out_read : err_read;
+                bool open = tag == kStdout ? detail::drain(fd.fd, to_out)
+                                           : detail::drain(fd.fd, to_err);
+                if (!open) {
+                    ::epoll_ctl(epoll.fd, EPOLL_CTL_DEL, fd.fd, nullptr);
+                    fd.reset();
+                    --open_pipes;
+                }
+            }
+        }
+
+        // The child is gone: take what is already buffered, but do not wait on
+        // background jobs it left behind that still hold the pipes open
+        if (out_read.fd >= 0) detail::drain(out_read.fd, to_out);
+        if (err_read.fd >= 0) detail::drain(err_read.fd, to_err);
+
+        // 4. Reap, still honouring the deadline when no pidfd told us it exited
+        int status = 0;
+        while (::waitpid(pid, &status, WNOHANG) == 0) {
+            if (detail::remaining_ms(deadline) == 0 && !on_deadline()) {
+                ::waitpid(pid, &status, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (WIFEXITED(status)) {
+            result.exit_code = WEXITSTATUS(status);
+        } else if (WIFSIGNALED(status)) {
+            result.term_signal = WTERMSIG(status);
+            result.exit_code = 128 + result.term_signal;
+        }
+
+        result.stdout_bytes = out.total_bytes();
+        result.stderr_bytes = err.total_bytes();
+        result.stdout_text = out.finish();
+        result.stderr_text = err.finish();
+        result.stdout_blob = out.blob_id();
+        result.stderr_blob = err.blob_id();
+
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        result.duration_ms = elapsed.count();
+        return result;
+    }
+
+} // namespace agent::core::exec
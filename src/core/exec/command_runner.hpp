@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/storage/blob_store.hpp"
+#include "core/tools/output_collector.hpp"
+
+namespace agent::core::exec {
+
+    // Applied with `ulimit` in the child before exec; 0 leaves a limit inherited
+    struct ResourceLimits {
+        std::uint64_t cpu_seconds = 0;
+        std::uint64_t address_space_mb = 0;
+        std::uint64_t open_files = 0;
+    };
+
+    struct CommandSpec {
+        std::vector<std::string> argv;  // argv[0] is looked up on PATH
+        std::string cwd;                // Empty: inherit
+        std::vector<std::string> env;   // "KEY=VALUE" entries added to or replacing ours
+        int timeout_ms = 120000;
+        int kill_grace_ms = 2000;       // SIGTERM to SIGKILL
+        ResourceLimits limits;
+        tools::CaptureLimits stdout_limits;
+        tools::CaptureLimits stderr_limits{4 * 1024, 12 * 1024};
+        const storage::BlobStore* spill = nullptr;  // Keep full stdout/stderr as blobs
+
+        // Runs `command` through /bin/sh -c
+        static CommandSpec shell(std::string command);
+    };
+
+    struct CommandResult {
+        int exit_code = -1;     // 128 + signal when killed by a signal
+        int term_signal = 0;
+        bool timed_out = false;
+        double duration_ms = 0.0;
+        std::string stdout_text;  // Bounded: head + marker + tail
+        std::string stderr_text;
+        std::uint64_t stdout_bytes = 0;
+        std::uint64_t stderr_bytes = 0;
+        std::optional<std::string> stdout_blob;
+        std::optional<std::string> stderr_blob;
+    };
+
+    // Runs one command to completion. The child is started with posix_spawn
+    // (no page-table copy of a large agent process) in its own process
+    // group, and stdout/stderr are read concurrently through epoll into
+    // bounded collectors. On timeout the whole group gets SIGTERM, then
+    // SIGKILL after the grace period.
+    //
+    // A command that runs and fails is a CommandResult with a non-zero
+    // exit code; only failing to start it at all is an AgentError.
+    errors::Result<CommandResult> run_command(const CommandSpec& spec);
+
+} // namespace agent::core::exec
@@ -0,0 +1,161 @@
+#include "core/exec/process_util.hpp"
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/syscall.h>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+extern char** environ;
+
+namespace agent::core::exec::detail {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    namespace {
+
+        std::vector<std::string> merged_environment(const std::vector<std::string>& overrides) {
+            std::vector<std::string> env;
+            for (char** entry = environ; entry && *entry; ++entry) {
+                std::string_view current(*entry);
+                std::string_view key = current.substr(0, current.find('='));
+                bool replaced = false;
+                for (const auto& item : overrides) {
+                    if (item.size() > key.size() && item.compare(0, key.size(), key) == 0 &&
+                        item[key.size()] == '=') {
+                        replaced = true;
+                        break;
+                    }
+                }
+                if (!replaced) env.emplace_back(current);
+            }
+            env.insert(env.end(), overrides.begin(), overrides.end());
+            return env;
+        }
+
+        std::vector<char*> c_strings(std::vector<std::string>& strings) {
+            std::vector<char*> out;
+            out.reserve(strings.size() + 1);
+            for (auto& s : strings) out.push_back(s.data());
+            out.push_back(nullptr);
+            return out;
+        }
+
+    } // namespace
+
+    AgentError errno_error(const std::string& what) {
+        return AgentError{ErrorCategory::Execution, what + ": " + std::strerror(errno)};
+    }
+
+    errors::Status make_pipe(Fd& read_end, Fd& write_end) {
+        int fds[2];
+        if (::pipe2(fds, O_CLOEXEC) != 0) return errno_error("pipe");
+        read_end = Fd(fds[0]);
+        write_end = Fd(fds[1]);
+        return std::monostate{};
+    }
+
+    errors::Result<pid_t> spawn(const std::vector<std::string>& argv,
+                                const std::vector<std::string>& env_overrides,
+                                const std::string& cwd, int stdin_fd, int stdout_fd,
+                                int stderr_fd) {
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        if (stdin_fd >= 0) {
+            posix_spawn_file_actions_adddup2(&actions, stdin_fd, 0);
+        } else {
+            posix_spawn_file_actions_addopen(&actions, 0, "/dev/null", O_RDONLY, 0);
+        }
+        posix_spawn_file_actions_adddup2(&actions, stdout_fd, 1);
+        posix_spawn_file_actions_adddup2(&actions, stderr_fd, 2);
+        if (!cwd.empty()) posix_spawn_file_actions_addchdir_np(&actions, cwd.c_str());
+
+        // Own process group (so a timeout kills the whole tree), clean signal state
+        posix_spawnattr_t attr;
+        posix_spawnattr_init(&attr);
+        sigset_t empty, defaults;
+        sigemptyset(&empty);
+        sigemptyset(&defaults);
+        sigaddset(&defaults, SIGPIPE);
+        sigaddset(&defaults, SIGINT);
+        sigaddset(&defaults, SIGTERM);
+        posix_spawnattr_setsigmask(&attr, &empty);
+        posix_spawnattr_setsigdefault(&attr, &defaults);
+        posix_spawnattr_setpgroup(&attr, 0);
+        posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP | POSIX_SPAWN_SETSIGMASK |
+                                            POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_USEVFORK);
+
+        std::vector<std::string> argv_strings = argv;
+        auto env_strings = merged_environment(env_overrides);
+        auto c_argv = c_strings(argv_strings);
+        auto c_envp = c_strings(env_strings);
+
+        pid_t pid = -1;
+        int rc = ::posix_spawnp(&pid, c_argv[0], &actions, &attr, c_argv.data(), c_envp.data());
+        posix_spawn_file_actions_destroy(&actions);
+        posix_spawnattr_destroy(&attr);
+        if (rc != 0) {
+            return AgentError{ErrorCategory::Execution,
+                              "Cannot start " + argv[0] + ": " + std::strerror(rc)};
+        }
+        return pid;
+    }
+
+    std::string ulimit_prefix(const ResourceLimits& limits) {
+        std::string script;
+        if (limits.cpu_seconds) {
+            script += "ulimit -t " + std::to_string(limits.cpu_seconds) + " && ";
+        }
+        if (limits.address_space_mb) {
+            script += "ulimit -v " + std::to_string(limits.address_space_mb * 1024) + " && ";
+        }
+        if (limits.open_files) {
+            script += "ulimit -n " + std::to_string(limits.open_files) + " && ";
+        }
+        return script;
+    }
+
+    bool drain(int fd, const std::function<void(std::string_view)>& sink) {
+        std::array<char, 64 * 1024> buffer;
+        while (true) {
+            ssize_t n = ::read(fd, buffer.data(), buffer.size());
+            if (n > 0) {
+                sink(std::string_view(buffer.data(), static_cast<std::size_t>(n)));
+                continue;
+            }
+            if (n == 0) return false;
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+    }
+
+    int open_pidfd(pid_t pid) {
+#if defined(SYS_pidfd_open)
+        return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#else
+        (void)pid;
+        errno = ENOSYS;
+        return -1;
+#endif
+    }
+
+    int remaining_ms(Clock::time_point deadline) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now());
+        return left.count() < 0 ? 0 : static_cast<int>(left.count());
+    }
+
+    std::string shell_quote(std::string_view text) {
+        std::string out = "'";
+        for (char c : text) {
+            if (c == '\'') {
+                out += "'\\''";
+            } else {
+                out += c;
+            }
+        }
+        return out + "'";
+    }
+
+} // namespace agent::core::exec::detail
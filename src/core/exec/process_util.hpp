@@ -0,0 +1,67 @@
+#pragma once
+#include <sys/types.h>
+#include <unistd.h>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/exec/command_runner.hpp"
+
+// Plumbing shared by the one-shot runner and the warm shell sessions
+namespace agent::core::exec::detail {
+
+    using Clock = std::chrono::steady_clock;
+
+    // Closes the descriptor it owns
+    struct Fd {
+        int fd = -1;
+        Fd() = default;
+        explicit Fd(int value) : fd(value) {}
+        Fd(Fd&& other) noexcept : fd(other.fd) { other.fd = -1; }
+        Fd& operator=(Fd&& other) noexcept {
+            if (this != &other) {
+                reset();
+                fd = other.fd;
+                other.fd = -1;
+            }
+            return *this;
+        }
+        Fd(const Fd&) = delete;
+        Fd& operator=(const Fd&) = delete;
+        ~Fd() { reset(); }
+        void reset() {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+    };
+
+    // The failure of the system call just made, as an Execution error
+    errors::AgentError errno_error(const std::string& what);
+
+    // A pipe with both ends close-on-exec
+    errors::Status make_pipe(Fd& read_end, Fd& write_end);
+
+    // posix_spawnp in a new process group with a clean signal state.
+    // stdin_fd < 0 means /dev/null. The caller closes its copies of the child's ends.
+    errors::Result<pid_t> spawn(const std::vector<std::string>& argv,
+                                const std::vector<std::string>& env_overrides,
+                                const std::string& cwd, int stdin_fd, int stdout_fd,
+                                int stderr_fd);
+
+    // "ulimit -t N && ..." for the limits that are set; empty when none are
+    std::string ulimit_prefix(const ResourceLimits& limits);
+
+    // Reads everything available right now into sink; returns false at EOF or error
+    bool drain(int fd, const std::function<void(std::string_view)>& sink);
+
+    // pidfd for epoll-able exit notification, or -1 where unsupported
+    int open_pidfd(pid_t pid);
+
+    int remaining_ms(Clock::time_point deadline);
+
+    // Single-quotes text for /bin/sh
+    std::string shell_quote(std::string_view text);
+
+} // namespace agent::core::exec::detail
@@ -0,0 +1,377 @@
+#include "core/exec/shell_pool.hpp"
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <ctime>
+#include <functional>
+#include <random>
+#include <thread>
+#include <utility>
+#include "core/exec/process_util.hpp"
+#include "core/hash/stable_hash.hpp"
+
+namespace agent::core::exec {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+    using detail::Clock;
+    using detail::Fd;
+
+    namespace {
+
+        constexpr std::uint32_t kStdout = 0;
+        constexpr std::uint32_t kStderr = 1;
+
+        // Passes bytes through to sink until the marker shows up, holding back
+        // just enough to recognise a marker split across reads
+        class SentinelScanner {
+        public:
+            explicit SentinelScanner(std::string_view marker) : marker_(marker) {}
+
+            void feed(std::string_view chunk, const std::function<void(std::string_view)>& sink) {
+                if (found_) {
+                    after_.append(chunk);
+                    return;
+                }
+                std::string joined;
+                std::string_view data = chunk;
+                if (!carry_.empty()) {
+                    joined = carry_ + std::string(chunk);
+                    data = joined;
+                }
+
+                std::size_t pos = data.find(marker_);
+                if (pos != std::string_view::npos) {
+                    sink(data.substr(0, pos));
+                    after_.assign(data.substr(pos + marker_.size()));
+                    carry_.clear();
+                    found_ = true;
+                    return;
+                }
+                std::size_t keep = std::min(data.size(), marker_.size() - 1);
+                sink(data.substr(0, data.size() - keep));
+                carry_ = std::string(data.substr(data.size() - keep));
+            }
+
+            // No marker is coming: release what was held back
+            void flush(const std::function<void(std::string_view)>& sink) {
+                if (!found_) sink(carry_);
+                carry_.clear();
+            }
+
+            // The marker and the rest of its line have arrived
+            bool complete() const { return found_ && after_.find('\n') != std::string::npos; }
+            const std::string& after() const { return after_; }
+
+        private:
+            std::string_view marker_;
+            std::string carry_;
+            std::string after_;
+            bool found_ = false;
+        };
+
+        // write() to a pipe whose reader may be gone, without taking SIGPIPE
+        bool write_all(int fd, std::string_view bytes) {
+            sigset_t pipe_only, previous;
+            sigemptyset(&pipe_only);
+            sigaddset(&pipe_only, SIGPIPE);
+            pthread_sigmask(SIG_BLOCK, &pipe_only, &previous);
+
+            bool ok = true;
+            while (!bytes.empty()) {
+                ssize_t n = ::write(fd, bytes.data(), bytes.size());
+                if (n < 0 && errno == EINTR) continue;
+                if (n < 0) {
+                    ok = false;
+                    break;
+                }
+                bytes.remove_prefix(static_cast<std::size_t>(n));
+            }
+
+            if (!ok && errno == EPIPE) {
+                // Consume the SIGPIPE we just raised so unblocking does not deliver it
+                timespec zero{0, 0};
+                sigtimedwait(&pipe_only, nullptr, &zero);
+            }
+            pthread_sigmask(SIG_SETMASK, &previous, nullptr);
+            return ok;
+        }
+
+        std::string make_nonce() {
+            std::random_device device;
+            std::uint64_t value = (static_cast<std::uint64_t>(device()) << 32) ^ device();
+            return hash::to_hex(value);
+        }
+
+    } // namespace
+
+    // --- ShellSession ---
+
+    errors::Result<std::unique_ptr<ShellSession>> ShellSession::start(
+        const ShellOptions& options) {
+        Fd in_read, in_write, out_read, out_write, err_read, err_write;
+        auto piped = detail::make_pipe(in_read, in_write);
+        if (!errors::is_error(piped)) piped = detail::make_pipe(out_read, out_write);
+        if (!errors::is_error(piped)) piped = detail::make_pipe(err_read, err_write);
+        if (errors::is_error(piped)) return errors::get_error(piped);
+
+        // Watch the output pipes before there is a shell to clean up on failure
+        Fd epoll(::epoll_create1(EPOLL_CLOEXEC));
+        if (epoll.fd < 0) return detail::errno_error("epoll_create1");
+        for (auto [fd, tag] : {std::pair{out_read.fd, kStdout}, std::pair{err_read.fd, kStderr}}) {
+            ::fcntl(fd, F_SETFL, O_NONBLOCK);
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.u32 = tag;
+            if (::epoll_ctl(epoll.fd, EPOLL_CTL_ADD, fd, &event) != 0) {
+                return detail::errno_error("epoll_ctl");
+            }
+        }
+
+        std::vector<std::string> argv{"/bin/sh"};
+        if (::access(options.shell.c_str(), X_OK) == 0) {
+            argv = {options.shell};
+            if (options.shell.find("bash") != std::string::npos) {
+                argv.insert(argv.end(), {"--noprofile", "--norc"});
+            }
+        }
+
+        auto spawned = detail::spawn(argv, options.env, options.cwd, in_read.fd, out_write.fd,
+                                     err_write.fd);
+        if (errors::is_error(spawned)) return errors::get_error(spawned);
+
+        std::unique_ptr<ShellSession> session(new ShellSession());
+        session->pid_ = errors::get_value(spawned);
+        session->alive_ = true;
+        session->kill_grace_ms_ = options.kill_grace_ms;
+        session->nonce_ = make_nonce();
+        session->stdin_ = std::exchange(in_write.fd, -1);
+        session->stdout_ = std::exchange(out_read.fd, -1);
+        session->stderr_ = std::exchange(err_read.fd, -1);
+        session->epoll_ = std::exchange(epoll.fd, -1);
+
+        // Limits set in the shell itself apply to every command it runs
+        std::string limits = detail::ulimit_prefix(options.limits);
+        if (!limits.empty() && !write_all(session->stdin_, limits + "true\n")) {
+            return AgentError{ErrorCategory::Execution, "Shell exited during startup"};
+        }
+        return session;
+    }
+
+    ShellSession::~ShellSession() {
+        if (stdin_ >= 0) ::close(stdin_);  // EOF: an idle shell exits on its own
+        if (pid_ > 0) {
+            auto deadline = Clock::now() + std::chrono::milliseconds(100);
+            while (::waitpid(pid_, nullptr, WNOHANG) == 0) {
+                if (Clock::now() >= deadline) {
+                    kill_group();
+                    break;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+        for (int fd : {stdout_, stderr_, epoll_}) {
+            if (fd >= 0) ::close(fd);
+        }
+    }
+
+    int ShellSession::kill_group() {
+        if (pid_ <= 0) return 0;
+        int used = SIGTERM;
+        ::kill(-pid_, SIGTERM);
+        auto deadline = Clock::now() + std::chrono::milliseconds(kill_grace_ms_);
+        while (::waitpid(pid_, nullptr, WNOHANG) == 0) {
+            if (Clock::now() >= deadline) {
+                used = SIGKILL;
+                ::kill(-pid_, SIGKILL);
+                ::waitpid(pid_, nullptr, 0);
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        pid_ = -1;
+        alive_ = false;
+        return used;
+    }
+
+    bool ShellSession::reap(int& status) {
+        if (pid_ <= 0) return false;
+        auto deadline = Clock::now() + std::chrono::milliseconds(kill_grace_ms_);
+        while (::waitpid(pid_, &status, WNOHANG) == 0) {
+            if (Clock::now() >= deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        pid_ = -1;
+        alive_ = false;
+        return true;
+    }
+
+    errors::Result<CommandResult> ShellSession::run(const std::string& command, int timeout_ms,
+                                                    const tools::CaptureLimits& stdout_limits,
+                                                    const storage::BlobStore* spill) {
+        if (!alive_) return AgentError{ErrorCategory::Execution, "Shell session has exited"};
+        auto start = Clock::now();
+
+        // 1. eval keeps a malformed command from desynchronising the control stream
+        std::string marker = "__agent_done_" + nonce_ + "_" + std::to_string(++sequence_) + "__";
+        std::string script = "eval " + detail::shell_quote(command) +
+                             " </dev/null\n"
+                             "__agent_rc=$?; printf '%s %d\\n' '" + marker +
+                             "' \"$__agent_rc\"; printf '%s %d\\n' '" + marker +
+                             "' \"$__agent_rc\" >&2\n";
+
+        CommandResult result;
+        tools::OutputCollector out(stdout_limits), err(CommandSpec{}.stderr_limits);
+        if (spill) {
+            out.spill_to(*spill);
+            err.spill_to(*spill);
+        }
+        auto to_out = [&](std::string_view bytes) { out.write(bytes); };
+        auto to_err = [&](std::string_view bytes) { err.write(bytes); };
+        SentinelScanner out_scan(marker), err_scan(marker);
+
+        bool out_open = true, err_open = true;
+        if (!write_all(stdin_, script)) out_open = err_open = false;
+        auto done = [](bool open, const SentinelScanner& scan) {
+            return !open || scan.complete();
+        };
+
+        // 2. Read both streams until each has its sentinel or hit EOF, or time runs out.
+        //    A stream closed early (exec 2>/dev/null) leaves the shell alive but unusable
+        auto deadline = start + std::chrono::milliseconds(timeout_ms);
+        while (!(done(out_open, out_scan) && done(err_open, err_scan))) {
+            std::array<epoll_event, 2> events;
+            int n = ::epoll_wait(epoll_, events.data(), static_cast<int>(events.size()),
+                                 detail::remaining_ms(deadline));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                result.timed_out = true;
+                break;
+            }
+            for (int i = 0; i < n; ++i) {
+                bool is_out = events[static_cast<std::size_t>(i)].data.u32 == kStdout;
+                int fd = is_out ? stdout_ : stderr_;
+                bool open = detail::drain(fd, [&](std::string_view b) {
+                    if (is_out) {
+                        out_scan.feed(b, to_out);
+                    } else {
+                        err_scan.feed(b, to_err);
+                    }
+                });
+                if (!open) {
+                    ::epoll_ctl(epoll_, EPOLL_CTL_DEL, fd, nullptr);
+                    (is_out ? out_open : err_open) = false;
+                }
+            }
+        }
+
+        // 3. Exit status: from a sentinel, or from the shell itself if it went away
+        bool broken = !out_open || !err_open;
+        if (!result.timed_out && broken) {
+            // One stream hit EOF first; the other may still hold the last output
+            if (out_open) {
+                detail::drain(stdout_, [&](std::string_view b) { out_scan.feed(b, to_out); });
+            }
+            if (err_open) {
+                detail::drain(stderr_, [&](std::string_view b) { err_scan.feed(b, to_err); });
+            }
+        }
+        out_scan.flush(to_out);
+        err_scan.flush(to_err);
+        const SentinelScanner* status_line = out_scan.complete()   ? &out_scan
+                                             : err_scan.complete() ? &err_scan
+                                                                   : nullptr;
+
+        if (result.timed_out) {
+            result.term_signal = kill_group();
+            result.exit_code = 128 + result.term_signal;
+        } else if (status_line) {
+            result.exit_code = std::atoi(status_line->after().c_str() + 1);
+            if (broken) kill_group();  // The command finished but the session cannot run another
+        } else {
+            int status = 0;
+            if (reap(status)) {
+                result.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+                if (WIFSIGNALED(status)) result.term_signal = WTERMSIG(status);
+            } else {
+                result.term_signal = kill_group();
+                result.exit_code = 128 + result.term_signal;
+            }
+        }
+
+        result.stdout_bytes = out.total_bytes();
+        result.stderr_bytes = err.total_bytes();
+        result.stdout_text = out.finish();
+        result.stderr_text = err.finish();
+        result.stdout_blob = out.blob_id();
+        result.stderr_blob = err.blob_id();
+        std::chrono::duration<double, std::milli> elapsed = Clock::now() - start;
+        result.duration_ms = elapsed.count();
+        return result;
+    }
+
+    // --- ShellPool ---
+
+    errors::Result<CommandResult> ShellPool::run(const std::string& command, int timeout_ms,
+                                                 const tools::CaptureLimits& stdout_limits,
+                                                 const storage::BlobStore* spill) {
+        std::unique_ptr<ShellSession> session;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            released_.wait(lock, [&] { return !idle_.empty() || live_ < options_.max_sessions; });
+            if (!idle_.empty()) {
+                session = std::move(idle_.back());
+                idle_.pop_back();
+                ++stats_.reused;
+            } else {
+                ++live_;
+            }
+        }
+
+        if (!session) {
+            auto started = ShellSession::start(options_.shell);
+            if (errors::is_error(started)) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --live_;
+                released_.notify_one();
+                return errors::get_error(started);
+            }
+            session = std::move(std::get<std::unique_ptr<ShellSession>>(started));
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.started;
+        }
+
+        auto result = session->run(command, timeout_ms, stdout_limits, spill);
+
+        std::unique_ptr<ShellSession> dead;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (session->alive()) {
+                idle_.push_back(std::move(session));
+            } else {
+                dead = std::move(session);
+                --live_;
+                ++stats_.replaced;
+            }
+        }
+        released_.notify_one();
+        return result;  // `dead` is torn down outside the lock
+    }
+
+    ShellPoolStats ShellPool::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    std::size_t ShellPool::idle_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return idle_.size();
+    }
+
+} // namespace agent::core::exec
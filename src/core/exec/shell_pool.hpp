@@ -0,0 +1,97 @@
+#pragma once
+#include <sys/types.h>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/exec/command_runner.hpp"
+
+namespace agent::core::exec {
+
+    struct ShellOptions {
+        std::string shell = "/bin/bash";  // Falls back to /bin/sh when missing
+        std::string cwd;
+        std::vector<std::string> env;
+        ResourceLimits limits;            // Applied once, when the shell starts
+        int kill_grace_ms = 2000;
+    };
+
+    // One long-lived shell. Commands are written to its stdin and their end is
+    // recognised by a per-command sentinel printed on stdout (with the exit
+    // code) and on stderr, so cwd, exported variables and activated
+    // environments carry over from one command to the next.
+    //
+    // A command that exits the shell, or times out (the whole process group
+    // is killed), leaves the session dead; the pool then starts a new one.
+    class ShellSession {
+    public:
+        static errors::Result<std::unique_ptr<ShellSession>> start(const ShellOptions& options);
+        ~ShellSession();
+
+        ShellSession(const ShellSession&) = delete;
+        ShellSession& operator=(const ShellSession&) = delete;
+
+        // Runs one command; its stdin is /dev/null, not the control pipe
+        errors::Result<CommandResult> run(const std::string& command, int timeout_ms,
+                                          const tools::CaptureLimits& stdout_limits = {},
+                                          const storage::BlobStore* spill = nullptr);
+
+        bool alive() const { return alive_; }
+        pid_t pid() const { return pid_; }
+
+    private:
+        ShellSession() = default;
+
+        pid_t pid_ = -1;
+        int stdin_ = -1;
+        int stdout_ = -1;
+        int stderr_ = -1;
+        int epoll_ = -1;
+        int kill_grace_ms_ = 2000;
+        bool alive_ = false;
+        std::string nonce_;
+        std::uint64_t sequence_ = 0;
+
+        int kill_group();  // SIGTERM, then SIGKILL after the grace; returns the last one sent
+        bool reap(int& status);  // Waits up to the grace for an exiting shell, never blocks
+    };
+
+    struct ShellPoolOptions {
+        ShellOptions shell;
+        std::size_t max_sessions = 4;  // Concurrent commands beyond this wait
+    };
+
+    struct ShellPoolStats {
+        std::size_t started = 0;   // Shell processes launched
+        std::size_t reused = 0;    // Commands that ran in an already warm shell
+        std::size_t replaced = 0;  // Sessions dropped after exit or timeout
+    };
+
+    // Warm shells for run_command. Each concurrent command gets its own
+    // session; the most recently used one is handed out first, so sequential
+    // commands keep landing in the same shell and see each other's state.
+    class ShellPool {
+    public:
+        explicit ShellPool(ShellPoolOptions options = {}) : options_(std::move(options)) {}
+
+        errors::Result<CommandResult> run(const std::string& command, int timeout_ms,
+                                          const tools::CaptureLimits& stdout_limits = {},
+                                          const storage::BlobStore* spill = nullptr);
+
+        ShellPoolStats stats() const;
+        std::size_t idle_count() const;
+
+    private:
+        ShellPoolOptions options_;
+        mutable std::mutex mutex_;
+        std::condition_variable released_;
+        std::vector<std::unique_ptr<ShellSession>> idle_;
+        std::size_t live_ = 0;
+        ShellPoolStats stats_;
+    };
+
+} // namespace agent::core::exec
@@ -0,0 +1,197 @@
+#include "core/fs/file_cache.hpp"
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include "core/fs/mapped_file.hpp"
+
+namespace agent::core::fs {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    namespace {
+
+        // One key per file however the caller spelled the path
+        std::string normalize(const std::string& path) {
+            std::error_code error;
+            auto absolute = std::filesystem::absolute(path, error);
+            return (error ? std::filesystem::path(path) : absolute).lexically_normal().string();
+        }
+
+    } // namespace
+
+    FileStamp FileStamp::of(const struct stat& info) {
+        return FileStamp{true, info.st_mtim, info.st_size, info.st_ino};
+    }
+
+    bool FileStamp::operator==(const FileStamp& other) const {
+        if (exists != other.exists) return false;
+        return !exists ||
+               (mtime.tv_sec == other.mtime.tv_sec && mtime.tv_nsec == other.mtime.tv_nsec &&
+                size == other.size && inode == other.inode);
+    }
+
+    FileStamp stamp(const std::string& path) {
+        struct stat info {};
+        return ::stat(path.c_str(), &info) == 0 ? FileStamp::of(info) : FileStamp{};
+    }
+
+    FileStamp stamp(const ResolvedPath& path) {
+        struct stat info {};
+        std::string name(path.name());
+        return path.parent() >= 0 &&
+                       ::fstatat(path.parent(), name.c_str(), &info, AT_SYMLINK_NOFOLLOW) == 0
+                   ? FileStamp::of(info)
+                   : FileStamp{};
+    }
+
+    FileCache::FileCache(FileCacheOptions options) : options_(options) {}
+
+    FileCache::~FileCache() {
+        watcher_.reset();  // Stops event delivery before the entries go away
+    }
+
+    // --- Reads ---
+
+    errors::Result<FileCache::Content> FileCache::read(const std::string& path) {
+        auto read = snapshot(path);
+        if (errors::is_error(read)) return errors::get_error(read);
+        return errors::get_value(read).content;
+    }
+
+    errors::Result<FileCache::Snapshot> FileCache::snapshot(const std::string& path) {
+        return load(normalize(path), path, nullptr);
+    }
+
+    errors::Result<FileCache::Content> FileCache::read(const ResolvedPath& path) {
+        auto read = snapshot(path);
+        if (errors::is_error(read)) return errors::get_error(read);
+        return errors::get_value(read).content;
+    }
+
+    errors::Result<FileCache::Snapshot> FileCache::snapshot(const ResolvedPath& path) {
+        return load(path.path(), path.path(), &path);
+    }
+
+    errors::Result<FileCache::Snapshot> FileCache::load(const std::string& key,
+                                                        const std::string& shown,
+                                                        const ResolvedPath* resolved) {
+        // 1. stat() before reading: a change that lands after it shows up next time
+        struct stat info {};
+        int error = 0;
+        if (!resolved) {
+            if (::stat(key.c_str(), &info) != 0) error = errno;
+        } else if (resolved->parent() < 0) {
+            error = ENOENT;
+        } else {
+            std::string name(resolved->name());
+            if (::fstatat(resolved->parent(), name.c_str(), &info, AT_SYMLINK_NOFOLLOW) != 0) {
+                error = errno;
+            }
+        }
+        if (error != 0) {
+            invalidate(key);
+            auto category = error == ENOENT || error == ENOTDIR || error == EACCES
+                                ? ErrorCategory::Input
+                                : ErrorCategory::Execution;
+            return AgentError{category, "Cannot read " + shown + ": " + std::strerror(error)};
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end()) {
+                Entry& entry = it->second;
+                if (entry.stamp == FileStamp::of(info)) {
+                    ++stats_.hits;
+                    lru_.splice(lru_.begin(), lru_, entry.lru);
+                    return Snapshot{entry.content, entry.stamp};
+                }
+                ++stats_.stale;
+                drop_locked(it);
+            }
+            ++stats_.misses;
+        }
+
+        // 2. Read outside the lock so that other files stay available meanwhile
+        auto file = resolved ? MappedFile::open(*resolved) : MappedFile::open(key);
+        if (errors::is_error(file)) return errors::get_error(file);
+        auto content = std::make_shared<const std::string>(errors::get_value(file).bytes());
+        if (!keeps(content->size())) return Snapshot{content, FileStamp::of(info)};
+
+        // 3. Insert, then evict from the cold end until we are back in budget
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto existing = entries_.find(key);
+        if (existing != entries_.end()) drop_locked(existing);  // Another reader got here first
+
+        lru_.push_front(key);
+        Entry entry{content, FileStamp::of(info), lru_.begin()};
+        entries_.emplace(key, std::move(entry));
+        stats_.bytes += content->size();
+        while (stats_.bytes > options_.max_bytes) {
+            ++stats_.evictions;
+            drop_locked(entries_.find(lru_.back()));
+        }
+        return Snapshot{content, FileStamp::of(info)};
+    }
+
+    void FileCache::invalidate(const std::string& path) {
+        std::string key = normalize(path);
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = entries_.find(key);
+        if (it != entries_.end()) drop_locked(it);
+    }
+
+    void FileCache::drop_locked(std::unordered_map<std::string, Entry>::iterator it) {
+        stats_.bytes -= it->second.content->size();
+        lru_.erase(it->second.lru);
+        entries_.erase(it);
+    }
+
+    FileCacheStats FileCache::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        FileCacheStats copy = stats_;
+        copy.entries = entries_.size();
+        return copy;
+    }
+
+    // --- inotify ---
+
+    errors::Status FileCache::watch(const std::string& root) {
+        std::lock_guard<std::mutex> lock(watch_mutex_);
+        if (!watcher_) {
+            watcher_ = std::make_unique<TreeWatcher>([this](const TreeEvent& e) { on_changed(e); });
+        }
+        return watcher_->watch(normalize(root));
+    }
+
+    void FileCache::on_changed(const TreeEvent& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (event.kind == TreeEvent::Kind::Overflow) {
+            // Events were lost: nothing cached can be trusted any more
+            stats_.invalidations += entries_.size();
+            while (!entries_.empty()) drop_locked(entries_.begin());
+            return;
+        }
+        if (event.kind == TreeEvent::Kind::File) {
+            auto it = entries_.find(event.path);
+            if (it != entries_.end()) {
+                ++stats_.invalidations;
+                drop_locked(it);
+            }
+            return;
+        }
+        // A directory moved or deleted takes everything cached beneath it along
+        std::string prefix = event.path + "/";
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            auto next = std::next(it);
+            if (it->first.compare(0, prefix.size(), prefix) == 0) {
+                ++stats_.invalidations;
+                drop_locked(it);
+            }
+            it = next;
+        }
+    }
+
+} // namespace agent::core::fs
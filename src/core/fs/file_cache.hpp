@@ -0,0 +1,119 @@
+#pragma once
+#include <sys/stat.h>
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "core/errors/agent_errors.hpp"
+#include "core/fs/path_policy.hpp"
+#include "core/fs/tree_watcher.hpp"
+
+namespace agent::core::fs {
+
+    struct FileCacheOptions {
+        std::size_t max_bytes = 256u << 20;      // Total budget; least recently used go first
+        std::size_t max_file_bytes = 16u << 20;  // Larger files are read but never cached
+    };
+
+    // Which version of a file some content came from: rewriting a file
+    // changes at least one of mtime, size and inode
+    struct FileStamp {
+        bool exists = false;
+        struct timespec mtime {};
+        off_t size = 0;
+        ino_t inode = 0;
+
+        static FileStamp of(const struct stat& info);
+        bool operator==(const FileStamp& other) const;
+    };
+
+    // The file as it is now; exists is false when stat() fails
+    FileStamp stamp(const std::string& path);
+    // Looked up by name in the still-open parent, without following a symlink
+    FileStamp stamp(const ResolvedPath& path);
+
+    struct FileCacheStats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t stale = 0;          // Entries found outdated by the stat check
+        std::size_t invalidations = 0;  // Entries dropped on an inotify event
+        std::size_t evictions = 0;      // Entries dropped for the byte budget
+        std::size_t bytes = 0;          // Currently cached
+        std::size_t entries = 0;
+    };
+
+    // File contents shared by every read-type tool in the process (and every
+    // session, when one process serves several). Safe to use from any thread.
+    //
+    // Two checks keep entries honest. Every hit is stat()ed and compared on
+    // mtime, size and inode, which catches changes the moment they happen.
+    // inotify watches on the workspace (watch()) drop entries as soon as the
+    // file changes, which frees memory early and catches rewrites that keep
+    // both size and a coarse-grained mtime.
+    class FileCache {
+    public:
+        using Content = std::shared_ptr<const std::string>;
+
+        explicit FileCache(FileCacheOptions options = {});
+        ~FileCache();
+
+        FileCache(const FileCache&) = delete;
+        FileCache& operator=(const FileCache&) = delete;
+
+        // Watches every directory under root, including ones created later
+        errors::Status watch(const std::string& root);
+
+        // The whole file. The returned content stays valid after eviction.
+        errors::Result<Content> read(const std::string& path);
+
+        // The whole file, and the version it was read from, for callers
+        // that later write the file back and must notice changes meanwhile
+        struct Snapshot {
+            Content content;
+            FileStamp stamp;
+        };
+        errors::Result<Snapshot> snapshot(const std::string& path);
+
+        // The same for a file a PathPolicy checked: the stat and the read go
+        // through its open parent (see MappedFile::open), not the path again
+        errors::Result<Content> read(const ResolvedPath& path);
+        errors::Result<Snapshot> snapshot(const ResolvedPath& path);
+
+        // For tools that write files: the next read goes to disk
+        void invalidate(const std::string& path);
+
+        // Whether a file of this size would be kept; callers can map larger
+        // ones themselves rather than have read() copy them for nothing
+        bool keeps(std::size_t size) const {
+            return size <= options_.max_file_bytes && size <= options_.max_bytes;
+        }
+
+        FileCacheStats stats() const;
+
+    private:
+        struct Entry {
+            Content content;
+            FileStamp stamp;
+            std::list<std::string>::iterator lru;
+        };
+
+        FileCacheOptions options_;
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Entry> entries_;
+        std::list<std::string> lru_;  // Front is most recent
+        FileCacheStats stats_;
+
+        std::mutex watch_mutex_;
+        std::unique_ptr<TreeWatcher> watcher_;
+
+        // Both spellings of snapshot(); resolved is null for a plain path
+        errors::Result<Snapshot> load(const std::string& key, const std::string& shown,
+                                      const ResolvedPath* resolved);
+        void drop_locked(std::unordered_map<std::string, Entry>::iterator it);
+        void on_changed(const TreeEvent& event);
+    };
+
+} // namespace agent::core::fs
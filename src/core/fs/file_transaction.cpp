@@ -0,0 +1,287 @@
+#include "core/fs/file_transaction.hpp"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <map>
+
+namespace agent::core::fs {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    namespace {
+
+        std::string parent_of(const std::string& path) {
+            std::string parent = std::filesystem::path(path).parent_path().string();
+            return parent.empty() ? "." : parent;
+        }
+
+        // "dir/.name.tag-<pid>-<n>": hidden, beside the target, so that
+        // rename() stays within one filesystem
+        std::string sibling_name(const std::string& path, const char* tag) {
+            static std::atomic<unsigned long> counter{0};
+            std::filesystem::path target(path);
+            std::string name(1, '.');
+            name.append(target.filename().string()).append(1, '.').append(tag);
+            name.append(1, '-').append(std::to_string(::getpid()));
+            name.append(1, '-').append(std::to_string(++counter));
+            return (target.parent_path() / name).string();
+        }
+
+        AgentError os_error(const std::string& what, const std::string& path, int error) {
+            return AgentError{ErrorCategory::Execution,
+                              what + " " + path + ": " + std::strerror(error)};
+        }
+
+        bool write_all(int fd, const std::string& content) {
+            std::size_t done = 0;
+            while (done < content.size()) {
+                ssize_t n = ::write(fd, content.data() + done, content.size() - done);
+                if (n < 0 && errno == EINTR) continue;
+                if (n <= 0) return false;
+                done += static_cast<std::size_t>(n);
+            }
+            return true;
+        }
+
+    } // namespace
+
+    FileTransaction::FileTransaction(FileTransactionOptions options) : options_(options) {}
+
+    FileTransaction::~FileTransaction() {
+        for (auto& operation : operations_) {
+            if (operation.made_dir >= 0) ::close(operation.made_dir);
+        }
+    }
+
+    void FileTransaction::write(std::string path, std::string content, FileStamp based_on) {
+        Operation operation;
+        operation.name = path;
+        operation.path = std::move(path);
+        operation.content = std::move(content);
+        operation.based_on = based_on;
+        operations_.push_back(std::move(operation));
+    }
+
+    void FileTransaction::remove(std::string path, FileStamp based_on) {
+        Operation operation;
+        operation.name = path;
+        operation.path = std::move(path);
+        operation.remove = true;
+        operation.based_on = based_on;
+        operations_.push_back(std::move(operation));
+    }
+
+    void FileTransaction::write(ResolvedPath path, std::string content, FileStamp based_on) {
+        Operation operation;
+        operation.path = path.path();
+        operation.name = std::string(path.name());
+        operation.dir = path.parent();  // -1 until make_parents() creates it
+        operation.resolved.emplace(std::move(path));
+        operation.content = std::move(content);
+        operation.based_on = based_on;
+        operations_.push_back(std::move(operation));
+    }
+
+    void FileTransaction::remove(ResolvedPath path, FileStamp based_on) {
+        Operation operation;
+        operation.path = path.path();
+        operation.name = std::string(path.name());
+        operation.dir = path.parent();
+        operation.resolved.emplace(std::move(path));
+        operation.remove = true;
+        operation.based_on = based_on;
+        operations_.push_back(std::move(operation));
+    }
+
+    errors::Status FileTransaction::make_parents(Operation& operation) {
+        if (!operation.resolved) {
+            // Missing parent directories are made, and removed again on failure
+            std::filesystem::path parent = parent_of(operation.path);
+            std::vector<std::filesystem::path> missing;
+            std::error_code ignored;
+            for (auto dir = parent; !dir.empty() && !std::filesystem::exists(dir, ignored);
+                 dir = dir.parent_path()) {
+                missing.push_back(dir);
+                if (dir == dir.parent_path()) break;
+            }
+            for (auto it = missing.rbegin(); it != missing.rend(); ++it) {
+                if (::mkdir(it->c_str(), 0777) != 0 && errno != EEXIST) {
+                    return os_error("Cannot create directory", it->string(), errno);
+                }
+                created_dirs_.push_back(it->string());
+            }
+            return std::monostate{};
+        }
+        if (operation.dir >= 0) return std::monostate{};
+
+        // The canonical parent, walked from "/" without following symlinks
+        std::string parent = parent_of(operation.path);
+        int dir = ::open("/", O_PATH | O_DIRECTORY | O_CLOEXEC);
+        if (dir < 0) return os_error("Cannot open", "/", errno);
+        std::string walked;
+        for (const auto& part : std::filesystem::path(parent).relative_path()) {
+            walked.append("/").append(part.string());
+            int next = ::openat(dir, part.c_str(), O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (next < 0 && errno == ENOENT) {
+                if (::mkdirat(dir, part.c_str(), 0777) != 0 && errno != EEXIST) {
+                    int error = errno;
+                    ::close(dir);
+                    return os_error("Cannot create directory", walked, error);
+                }
+                created_dirs_.push_back(walked);
+                next = ::openat(dir, part.c_str(), O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            }
+            int error = errno;
+            ::close(dir);
+            if (next < 0) return os_error("Cannot open directory", walked, error);
+            dir = next;
+        }
+        operation.dir = operation.made_dir = dir;
+        return std::monostate{};
+    }
+
+    errors::Status FileTransaction::stage(Operation& operation) {
+        auto made = make_parents(operation);
+        if (errors::is_error(made)) return made;
+
+        // New files get 0666 less the umask, as any editor would make them;
+        // replaced ones keep their mode
+        int follow = operation.resolved ? AT_SYMLINK_NOFOLLOW : 0;
+        struct stat info {};
+        bool replacing = ::fstatat(operation.dir, operation.name.c_str(), &info, follow) == 0;
+        int fd = -1;
+        do {
+            operation.temp = sibling_name(operation.name, "tmp");
+            fd = ::openat(operation.dir, operation.temp.c_str(),
+                          O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC,
+                          replacing ? 0600 : 0666);
+        } while (fd < 0 && errno == EEXIST);
+        if (fd < 0) {
+            int error = errno;
+            operation.temp.clear();
+            return os_error("Cannot write beside", operation.path, error);
+        }
+        bool written = write_all(fd, operation.content) &&
+                       (!replacing || ::fchmod(fd, info.st_mode & 07777) == 0) &&
+                       (!options_.sync || ::fdatasync(fd) == 0);
+        int error = errno;
+        ::close(fd);
+        if (!written) return os_error("Cannot write", operation.path, error);
+        return std::monostate{};
+    }
+
+    errors::Status FileTransaction::link_backup(Operation& operation) {
+        while (true) {
+            operation.backup = sibling_name(operation.name, "orig");
+            if (::linkat(operation.dir, operation.name.c_str(), operation.dir,
+                         operation.backup.c_str(), 0) == 0) {
+                break;
+            }
+            if (errno == EEXIST) continue;
+            int error = errno;
+            operation.backup.clear();
+            return os_error("Cannot keep a copy of", operation.path, error);
+        }
+        return std::monostate{};
+    }
+
+    errors::Status FileTransaction::commit() {
+        // 1. Stage every new content
+        for (auto& operation : operations_) {
+            if (operation.remove) continue;
+            auto staged = stage(operation);
+            if (errors::is_error(staged)) {
+                clean_up();
+                return staged;
+            }
+        }
+
+        // 2. Nothing changed meanwhile; keep links to what is about to go
+        for (auto& operation : operations_) {
+            struct stat info {};
+            int follow = operation.resolved ? AT_SYMLINK_NOFOLLOW : 0;
+            FileStamp now = ::fstatat(operation.dir, operation.name.c_str(), &info, follow) == 0
+                                ? FileStamp::of(info)
+                                : FileStamp{};
+            if (!(now == operation.based_on)) {
+                clean_up();
+                return AgentError{ErrorCategory::Execution,
+                                  operation.path + " changed on disk since it was read"};
+            }
+            if (!operation.based_on.exists) continue;
+            auto linked = link_backup(operation);
+            if (errors::is_error(linked)) {
+                clean_up();
+                return linked;
+            }
+        }
+
+        // 3. The renames
+        for (std::size_t i = 0; i < operations_.size(); ++i) {
+            Operation& operation = operations_[i];
+            int result = operation.remove
+                             ? ::unlinkat(operation.dir, operation.name.c_str(), 0)
+                             : ::renameat(operation.dir, operation.temp.c_str(), operation.dir,
+                                          operation.name.c_str());
+            if (result != 0) {
+                int error = errno;
+                roll_back(i);
+                clean_up();
+                return os_error(operation.remove ? "Cannot remove" : "Cannot replace",
+                                operation.path, error);
+            }
+            operation.temp.clear();
+        }
+
+        // 4. Make the renames themselves durable, one fsync per directory
+        if (options_.sync) {
+            std::map<std::string, int> dirs;  // Directory -> where to open it from
+            for (const auto& operation : operations_) {
+                dirs.emplace(parent_of(operation.path), operation.dir);
+            }
+            for (const auto& dir : created_dirs_) dirs.emplace(parent_of(dir), AT_FDCWD);
+            for (const auto& [path, at] : dirs) {
+                int fd = at == AT_FDCWD ? ::open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)
+                                        : ::openat(at, ".", O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (fd < 0) continue;
+                ::fsync(fd);
+                ::close(fd);
+            }
+        }
+        created_dirs_.clear();
+        clean_up();
+        return std::monostate{};
+    }
+
+    // Undoes operations [0, applied), latest first
+    void FileTransaction::roll_back(std::size_t applied) {
+        while (applied > 0) {
+            Operation& operation = operations_[--applied];
+            if (!operation.backup.empty()) {
+                ::renameat(operation.dir, operation.backup.c_str(), operation.dir,
+                           operation.name.c_str());
+                operation.backup.clear();
+            } else {
+                ::unlinkat(operation.dir, operation.name.c_str(), 0);
+            }
+        }
+    }
+
+    void FileTransaction::clean_up() {
+        for (auto& operation : operations_) {
+            if (!operation.temp.empty()) ::unlinkat(operation.dir, operation.temp.c_str(), 0);
+            if (!operation.backup.empty()) ::unlinkat(operation.dir, operation.backup.c_str(), 0);
+            operation.temp.clear();
+            operation.backup.clear();
+        }
+        for (auto it = created_dirs_.rbegin(); it != created_dirs_.rend(); ++it) {
+            ::rmdir(it->c_str());
+        }
+        created_dirs_.clear();
+    }
+
+} // namespace agent::core::fs
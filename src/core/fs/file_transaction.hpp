@@ -0,0 +1,79 @@
+#pragma once
+#include <fcntl.h>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/fs/file_cache.hpp"
+#include "core/fs/path_policy.hpp"
+
+namespace agent::core::fs {
+
+    struct FileTransactionOptions {
+        // fdatasync() every new file before any rename, and fsync() each
+        // directory once after them all, so that a crash keeps the edits
+        bool sync = true;
+    };
+
+    // Whole-file writes and deletions that are applied together or not at all.
+    //
+    // commit() first writes each new content to a temp file beside its
+    // target, then checks that no target changed since its content was
+    // worked out (every operation carries the FileStamp it started from),
+    // and only then renames the temp files over the targets. Should a
+    // rename fail partway, the files already replaced are put back from
+    // hard links taken just before. A reader sees each file old or new,
+    // never half written; the files do change one rename at a time.
+    //
+    // Files a PathPolicy resolved are handled through their open parent
+    // directory (openat, linkat, renameat, unlinkat) and never through a
+    // symlink, so what changes is the file that was checked even if a path
+    // component is swapped meanwhile. Parents that did not exist yet are
+    // made one component at a time along the canonical path, refusing any
+    // symlink found on the way.
+    class FileTransaction {
+    public:
+        explicit FileTransaction(FileTransactionOptions options = {});
+        ~FileTransaction();
+
+        FileTransaction(const FileTransaction&) = delete;
+        FileTransaction& operator=(const FileTransaction&) = delete;
+
+        // Creates or replaces path; based_on must still describe it at commit
+        void write(std::string path, std::string content, FileStamp based_on);
+        void remove(std::string path, FileStamp based_on);
+        void write(ResolvedPath path, std::string content, FileStamp based_on);
+        void remove(ResolvedPath path, FileStamp based_on);
+
+        // When this fails, no file has changed
+        errors::Status commit();
+
+        std::size_t size() const { return operations_.size(); }
+
+    private:
+        struct Operation {
+            std::string path;  // For messages, and the target itself when dir is AT_FDCWD
+            std::string content;
+            bool remove = false;
+            FileStamp based_on;
+            std::optional<ResolvedPath> resolved;
+            int dir = AT_FDCWD;   // Where name, temp and backup are looked up
+            int made_dir = -1;    // dir, when this transaction had to create it
+            std::string name;
+            std::string temp;    // The staged content
+            std::string backup;  // Hard link to the file being replaced or removed
+        };
+
+        FileTransactionOptions options_;
+        std::vector<Operation> operations_;
+        std::vector<std::string> created_dirs_;  // Parents made for new files, outermost first
+
+        errors::Status make_parents(Operation& operation);
+        errors::Status stage(Operation& operation);
+        errors::Status link_backup(Operation& operation);
+        void roll_back(std::size_t applied);
+        void clean_up();
+    };
+
+} // namespace agent::core::fs
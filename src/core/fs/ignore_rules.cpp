@@ -0,0 +1,220 @@
+#include "core/fs/ignore_rules.hpp"
+#include <algorithm>
+#include <utility>
+
+namespace agent::core::fs {
+
+    namespace {
+
+        // Active automaton states; patterns under 64 tokens (nearly all) fit a word
+        struct MaskStates {
+            std::uint64_t bits = 0;
+            bool test(std::size_t k) const { return (bits >> k) & 1u; }
+            void set(std::size_t k) { bits |= std::uint64_t{1} << k; }
+            void clear() { bits = 0; }
+            bool any() const { return bits != 0; }
+        };
+
+        struct VectorStates {
+            std::vector<std::uint8_t> bits;
+            explicit VectorStates(std::size_t size) : bits(size, 0) {}
+            bool test(std::size_t k) const { return bits[k] != 0; }
+            void set(std::size_t k) { bits[k] = 1; }
+            void clear() { std::fill(bits.begin(), bits.end(), 0); }
+            bool any() const {
+                return std::find(bits.begin(), bits.end(), 1) != bits.end();
+            }
+        };
+
+    } // namespace
+
+    // --- Glob ---
+
+    Glob::Glob(std::string_view pattern) {
+        std::size_t i = 0;
+        while (i < pattern.size()) {
+            char c = pattern[i];
+            if (c == '*') {
+                std::size_t run = pattern.find_first_not_of('*', i);
+                if (run == std::string_view::npos) run = pattern.size();
+                bool whole_segment = (i == 0 || pattern[i - 1] == '/') && run - i == 2;
+                if (whole_segment && run < pattern.size() && pattern[run] == '/') {
+                    tokens_.push_back({Op::DirStart});
+                    tokens_.push_back({Op::DirBody});
+                    i = run + 1;
+                } else if (whole_segment && run == pattern.size()) {
+                    tokens_.push_back({Op::AnyPath});
+                    i = run;
+                } else {
+                    tokens_.push_back({Op::Star});  // Any other run of stars is one '*'
+                    i = run;
+                }
+            } else if (c == '?') {
+                tokens_.push_back({Op::AnyChar});
+                ++i;
+            } else if (c == '\\' && i + 1 < pattern.size()) {
+                tokens_.push_back({Op::Literal, pattern[i + 1]});
+                i += 2;
+            } else if (c == '[') {
+                // A ']' right after '[' or '[!' is a member, not the end
+                std::size_t j = i + 1;
+                bool negate = j < pattern.size() && (pattern[j] == '!' || pattern[j] == '^');
+                if (negate) ++j;
+                std::size_t close = pattern.find(']', j + 1);
+                if (j >= pattern.size() || close == std::string_view::npos) {
+                    tokens_.push_back({Op::Literal, c});  // Unterminated: a plain '['
+                    ++i;
+                    continue;
+                }
+                std::bitset<256> members;
+                for (std::size_t k = j; k < close; ++k) {
+                    auto lo = static_cast<unsigned char>(pattern[k]);
+                    if (k + 2 < close && pattern[k + 1] == '-') {
+                        auto hi = static_cast<unsigned char>(pattern[k + 2]);
+                        for (unsigned v = lo; v <= hi; ++v) members.set(v);
+                        k += 2;
+                    } else {
+                        members.set(lo);
+                    }
+                }
+                if (negate) members.flip();
+                members.reset('/');
+                tokens_.push_back({Op::Class, 0, static_cast<std::uint16_t>(classes_.size())});
+                classes_.push_back(members);
+                i = close + 1;
+            } else {
+                tokens_.push_back({Op::Literal, c});
+                ++i;
+            }
+        }
+
+        auto literal_from = [&](std::size_t first) {
+            for (std::size_t k = first; k < tokens_.size(); ++k) {
+                if (tokens_[k].op != Op::Literal) return false;
+            }
+            for (std::size_t k = first; k < tokens_.size(); ++k) literal_ += tokens_[k].c;
+            return true;
+        };
+        if (literal_from(0)) {
+            shape_ = Shape::Exact;
+        } else if (tokens_[0].op == Op::Star && literal_from(1)) {
+            shape_ = Shape::Suffix;
+        } else {
+            literal_.clear();
+        }
+    }
+
+    bool Glob::matches(std::string_view text) const {
+        if (shape_ == Shape::Exact) return text == literal_;
+        if (shape_ == Shape::Suffix) {
+            return text.size() >= literal_.size() &&
+                   text.compare(text.size() - literal_.size(), literal_.size(), literal_) == 0 &&
+                   text.find('/') == std::string_view::npos;
+        }
+
+        if (tokens_.size() < 64) return simulate(text, MaskStates{});
+        return simulate(text, VectorStates(tokens_.size() + 1));
+    }
+
+    template <typename States>
+    bool Glob::simulate(std::string_view text, States current) const {
+        // State k means "tokens before k have been matched". Wildcards may match
+        // nothing, so a state in front of one also enables the state after it.
+        std::size_t n = tokens_.size();
+        auto close = [&](States& states) {
+            for (std::size_t k = 0; k < n; ++k) {
+                if (!states.test(k)) continue;
+                Op op = tokens_[k].op;
+                if (op == Op::Star || op == Op::AnyPath) states.set(k + 1);
+                if (op == Op::DirStart) states.set(k + 2);
+            }
+        };
+
+        States next = current;
+        current.set(0);
+        close(current);
+        for (char ch : text) {
+            next.clear();
+            for (std::size_t k = 0; k < n; ++k) {
+                if (!current.test(k)) continue;
+                const Token& token = tokens_[k];
+                switch (token.op) {
+                    case Op::Literal: if (ch == token.c) next.set(k + 1); break;
+                    case Op::AnyChar: if (ch != '/') next.set(k + 1); break;
+                    case Op::Star: if (ch != '/') next.set(k); break;
+                    case Op::AnyPath: next.set(k); break;
+                    case Op::DirStart: if (ch != '/') next.set(k + 1); break;
+                    case Op::DirBody: next.set(ch == '/' ? k - 1 : k); break;
+                    case Op::Class:
+                        if (classes_[token.set].test(static_cast<unsigned char>(ch))) {
+                            next.set(k + 1);
+                        }
+                        break;
+                }
+            }
+            close(next);
+            if (!next.any()) return false;
+            std::swap(current, next);
+        }
+        return current.test(n);
+    }
+
+    // --- IgnoreRules ---
+
+    IgnoreRules::IgnoreRules(std::string_view contents, std::string base) : base_(std::move(base)) {
+        while (!contents.empty()) {
+            std::size_t end = contents.find('\n');
+            std::string_view line = contents.substr(0, end);
+            contents.remove_prefix(end == std::string_view::npos ? contents.size() : end + 1);
+
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.empty() || line[0] == '#') continue;
+            // Trailing blanks are dropped unless escaped
+            while (!line.empty() && line.back() == ' ' &&
+                   !(line.size() >= 2 && line[line.size() - 2] == '\\')) {
+                line.remove_suffix(1);
+            }
+
+            bool negate = !line.empty() && line[0] == '!';
+            if (negate) line.remove_prefix(1);
+            bool dir_only = !line.empty() && line.back() == '/';
+            if (dir_only) line.remove_suffix(1);
+            bool anchored = line.find('/') != std::string_view::npos;
+            if (!line.empty() && line[0] == '/') line.remove_prefix(1);
+            if (line.empty()) continue;
+
+            rules_.push_back(Rule{Glob(line), negate, dir_only, anchored});
+        }
+    }
+
+    IgnoreMatch IgnoreRules::match(std::string_view path, bool is_dir) const {
+        std::string_view relative = path;
+        if (!base_.empty()) {
+            if (path.size() <= base_.size() || path.compare(0, base_.size(), base_) != 0 ||
+                path[base_.size()] != '/') {
+                return IgnoreMatch::None;
+            }
+            relative.remove_prefix(base_.size() + 1);
+        }
+        std::size_t slash = relative.rfind('/');
+        std::string_view name =
+            slash == std::string_view::npos ? relative : relative.substr(slash + 1);
+
+        for (auto it = rules_.rbegin(); it != rules_.rend(); ++it) {
+            if (it->dir_only && !is_dir) continue;
+            if (it->glob.matches(it->anchored ? relative : name)) {
+                return it->negate ? IgnoreMatch::Include : IgnoreMatch::Ignore;
+            }
+        }
+        return IgnoreMatch::None;
+    }
+
+    bool IgnoreChain::ignored(const IgnoreChain* chain, std::string_view path, bool is_dir) {
+        for (; chain; chain = chain->parent.get()) {
+            IgnoreMatch match = chain->rules.match(path, is_dir);
+            if (match != IgnoreMatch::None) return match == IgnoreMatch::Ignore;
+        }
+        return false;
+    }
+
+} // namespace agent::core::fs
@@ -0,0 +1,85 @@
+#pragma once
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agent::core::fs {
+
+    // One gitignore-style glob, compiled once into a small automaton and then
+    // matched by simulating all of its states at once: linear in the path
+    // length, with none of the backtracking blowup of recursive glob matchers.
+    //
+    //   *      anything except '/'        ?    one character except '/'
+    //   [a-z]  class ([!...] negates)     \x   literal x
+    //   **/    zero or more directories   /**  everything below
+    class Glob {
+    public:
+        explicit Glob(std::string_view pattern);
+        bool matches(std::string_view text) const;
+
+    private:
+        enum class Op : std::uint8_t {
+            Literal,   // c
+            AnyChar,   // ?
+            Star,      // *
+            AnyPath,   // ** (also crosses '/')
+            DirStart,  // **/ is a DirStart, DirBody pair: either skip both, or
+            DirBody,   // read a name and a '/' and come back to DirStart
+            Class      // [...]
+        };
+        struct Token {
+            Op op;
+            char c = 0;
+            std::uint16_t set = 0;  // Index into classes_
+        };
+
+        // Fast paths for the shapes most ignore files are made of
+        enum class Shape { General, Exact, Suffix };
+
+        template <typename States>
+        bool simulate(std::string_view text, States states) const;
+
+        std::vector<Token> tokens_;
+        std::vector<std::bitset<256>> classes_;
+        Shape shape_ = Shape::General;
+        std::string literal_;  // Exact: the whole pattern; Suffix: what follows the '*'
+    };
+
+    enum class IgnoreMatch { None, Ignore, Include };
+
+    // The rules of one .gitignore file
+    class IgnoreRules {
+    public:
+        // base: directory of the file, relative to the walk root ("" for the root)
+        IgnoreRules(std::string_view contents, std::string base);
+
+        // path: relative to the walk root, and inside base. The last matching rule wins.
+        IgnoreMatch match(std::string_view path, bool is_dir) const;
+
+        bool empty() const { return rules_.empty(); }
+
+    private:
+        struct Rule {
+            Glob glob;
+            bool negate;
+            bool dir_only;
+            bool anchored;  // Had a '/' before its end: matches the path from base, not the name
+        };
+
+        std::string base_;
+        std::vector<Rule> rules_;
+    };
+
+    // The .gitignore files in effect for a directory, innermost first. Shared
+    // read-only between the directories below it.
+    struct IgnoreChain {
+        std::shared_ptr<const IgnoreChain> parent;
+        IgnoreRules rules;
+
+        static bool ignored(const IgnoreChain* chain, std::string_view path, bool is_dir);
+    };
+
+} // namespace agent::core::fs
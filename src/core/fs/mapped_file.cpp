@@ -0,0 +1,110 @@
+#include "core/fs/mapped_file.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace agent::core::fs {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    namespace {
+
+        AgentError open_error(const std::string& path, int error) {
+            // A bad path is the caller's mistake; anything else is the machine's
+            auto category = error == ENOENT || error == ENOTDIR || error == EISDIR ||
+                                    error == EACCES
+                                ? ErrorCategory::Input
+                                : ErrorCategory::Execution;
+            return AgentError{category, "Cannot read " + path + ": " + std::strerror(error)};
+        }
+
+    } // namespace
+
+    errors::Result<MappedFile> MappedFile::open(const std::string& path, Access access) {
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return open_error(path, errno);
+        return read_fd(fd, path, access);
+    }
+
+    errors::Result<MappedFile> MappedFile::open(const ResolvedPath& path, Access access) {
+        if (path.parent() < 0) return open_error(path.path(), ENOENT);
+        std::string name(path.name());
+        int fd = ::openat(path.parent(), name.c_str(), O_RDONLY | O_CLOEXEC | O_NOFOLLOW);
+        if (fd < 0) return open_error(path.path(), errno);
+        return read_fd(fd, path.path(), access);
+    }
+
+    errors::Result<MappedFile> MappedFile::read_fd(int fd, const std::string& path,
+                                                   Access access) {
+        struct stat info {};
+        if (::fstat(fd, &info) != 0) {
+            int error = errno;
+            ::close(fd);
+            return open_error(path, error);
+        }
+        if (!S_ISREG(info.st_mode)) {
+            ::close(fd);
+            return open_error(path, S_ISDIR(info.st_mode) ? EISDIR : EINVAL);
+        }
+
+        MappedFile file;
+        file.size_ = static_cast<std::size_t>(info.st_size);
+
+        if (file.size_ >= kMapThreshold) {
+            void* map = ::mmap(nullptr, file.size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED) {
+                ::madvise(map, file.size_,
+                          access == Access::Sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+                file.map_ = map;
+                ::close(fd);
+                return file;
+            }
+            // Some filesystems cannot be mapped; fall through to read()
+        }
+
+        // Small file, or no mapping: read it, tolerating a file that changes size under us
+        file.buffer_.resize(file.size_);
+        std::size_t filled = 0;
+        while (true) {
+            if (filled == file.buffer_.size()) file.buffer_.resize(filled + 4096);
+            ssize_t n = ::read(fd, file.buffer_.data() + filled, file.buffer_.size() - filled);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) {
+                int error = errno;
+                ::close(fd);
+                return open_error(path, error);
+            }
+            if (n == 0) break;
+            filled += static_cast<std::size_t>(n);
+        }
+        ::close(fd);
+        file.buffer_.resize(filled);
+        file.size_ = filled;
+        return file;
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : map_(std::exchange(other.map_, nullptr)),
+          size_(std::exchange(other.size_, 0)),
+          buffer_(std::move(other.buffer_)) {}
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            if (map_) ::munmap(map_, size_);
+            map_ = std::exchange(other.map_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+            buffer_ = std::move(other.buffer_);
+        }
+        return *this;
+    }
+
+    MappedFile::~MappedFile() {
+        if (map_) ::munmap(map_, size_);
+    }
+
+} // namespace agent::core::fs
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include "core/errors/agent_errors.hpp"
+#include "core/fs/path_policy.hpp"
+
+namespace agent::core::fs {
+
+    // Read-only view of a whole file. Large files are mmap'ed so that reading
+    // a slice of them touches only the pages it needs; small ones are read
+    // into a buffer, which is cheaper than setting up and tearing down a mapping.
+    class MappedFile {
+    public:
+        // Files at least this large are mapped
+        static constexpr std::size_t kMapThreshold = 64 * 1024;
+
+        enum class Access {
+            Sequential,  // Read front to back: aggressive readahead
+            Random       // Point lookups: no readahead
+        };
+
+        static errors::Result<MappedFile> open(const std::string& path,
+                                               Access access = Access::Sequential);
+        // The file a PathPolicy checked, opened by name in its still-open
+        // parent and never through a symlink, so it is the file that was checked
+        static errors::Result<MappedFile> open(const ResolvedPath& path,
+                                               Access access = Access::Sequential);
+
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        ~MappedFile();
+
+        // Valid for the lifetime of this object
+        std::string_view bytes() const {
+            return map_ ? std::string_view(static_cast<const char*>(map_), size_) : buffer_;
+        }
+        std::size_t size() const { return size_; }
+        bool mapped() const { return map_ != nullptr; }
+
+    private:
+        MappedFile() = default;
+
+        // Takes ownership of fd; path is for error messages
+        static errors::Result<MappedFile> read_fd(int fd, const std::string& path, Access access);
+
+        void* map_ = nullptr;
+        std::size_t size_ = 0;
+        std::string buffer_;
+    };
+
+} // namespace agent::core::fs
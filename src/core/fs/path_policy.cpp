@@ -0,0 +1,420 @@
+#include "core/fs/path_policy.hpp"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+namespace agent::core::fs {
+
+    namespace {
+
+        constexpr std::size_t kNone = std::string_view::npos;
+        constexpr int kMaxSymlinks = 40;  // As the kernel allows (ELOOP)
+
+        errors::AgentError error(errors::ErrorCategory category, std::string_view path,
+                                 std::string_view reason) {
+            std::string message(path);
+            message.append(": ").append(reason);
+            return errors::AgentError{category, std::move(message)};
+        }
+
+        // Calls each component of `path`, skipping empty ones
+        template <typename Visit>
+        void for_each_component(std::string_view path, Visit&& visit) {
+            std::size_t pos = 0;
+            while (pos < path.size()) {
+                std::size_t end = std::min(path.find('/', pos), path.size());
+                if (end > pos) visit(path.substr(pos, end - pos));
+                pos = end + 1;
+            }
+        }
+
+        // "/a/./b/../c/" -> "/a/c", without looking at the file system
+        std::string normalize(std::string_view path) {
+            std::vector<std::string_view> parts;
+            for_each_component(path, [&](std::string_view part) {
+                if (part == "..") {
+                    if (!parts.empty()) parts.pop_back();
+                } else if (part != ".") {
+                    parts.push_back(part);
+                }
+            });
+            std::string out;
+            for (auto part : parts) out.append("/").append(part);
+            return out.empty() ? "/" : out;
+        }
+
+        // The real path when it exists, else the normalized one
+        std::string canonical(const std::string& path) {
+            char buffer[PATH_MAX];
+            if (::realpath(path.c_str(), buffer)) return buffer;
+            return normalize(path);
+        }
+
+        // Components still to resolve, next one last
+        void push_components(std::vector<std::string>& pending, std::string_view path) {
+            std::vector<std::string_view> parts;
+            for_each_component(path, [&](std::string_view part) { parts.push_back(part); });
+            for (auto it = parts.rbegin(); it != parts.rend(); ++it) pending.emplace_back(*it);
+        }
+
+        // fds[i] is the directory made of the first i resolved components
+        struct DirChain {
+            std::vector<int> fds;
+            ~DirChain() {
+                for (int fd : fds) {
+                    if (fd >= 0) ::close(fd);
+                }
+            }
+            void truncate(std::size_t size) {
+                while (fds.size() > size) {
+                    ::close(fds.back());
+                    fds.pop_back();
+                }
+            }
+        };
+
+    } // namespace
+
+    // --- ResolvedPath ---
+
+    ResolvedPath::ResolvedPath(ResolvedPath&& other) noexcept
+        : path_(std::move(other.path_)), parent_(std::exchange(other.parent_, -1)) {}
+
+    ResolvedPath& ResolvedPath::operator=(ResolvedPath&& other) noexcept {
+        if (this != &other) {
+            if (parent_ >= 0) ::close(parent_);
+            path_ = std::move(other.path_);
+            parent_ = std::exchange(other.parent_, -1);
+        }
+        return *this;
+    }
+
+    ResolvedPath::~ResolvedPath() {
+        if (parent_ >= 0) ::close(parent_);
+    }
+
+    // --- PathPolicy ---
+
+    void PathPolicy::Verdict::add(Effect effect, std::uint32_t rule) {
+        if (effect == kReadOnly && !(effects & kReadOnly)) read_only_rule = rule;
+        if (effect == kDeny && !(effects & kDeny)) deny_rule = rule;
+        effects |= effect;
+    }
+
+    void PathPolicy::Verdict::merge(const Verdict& other) {
+        if (other.effects & kReadOnly) add(kReadOnly, other.read_only_rule);
+        if (other.effects & kDeny) add(kDeny, other.deny_rule);
+        effects |= other.effects;
+    }
+
+    PathPolicy::GlobRule::GlobRule(std::string_view pattern, Effect effect, std::uint32_t rule)
+        : glob(pattern), effect(effect), rule(rule) {
+        // The runs of plain characters; escapes and classes count as wildcards
+        std::vector<std::string_view> runs;
+        std::size_t i = 0;
+        std::size_t run = 0;
+        auto flush = [&](std::size_t end) {
+            if (end > run) runs.push_back(pattern.substr(run, end - run));
+        };
+        while (i < pattern.size()) {
+            char c = pattern[i];
+            if (c == '*' || c == '?' || c == '\\' || c == '[') {
+                flush(i);
+                if (c == '\\') {
+                    i += 2;
+                } else if (c == '[') {
+                    std::size_t close = i + 2 < pattern.size() ? pattern.find(']', i + 2) : kNone;
+                    i = close == kNone ? pattern.size() : close + 1;
+                } else {
+                    ++i;
+                }
+                i = std::min(i, pattern.size());
+                run = i;
+            } else {
+                ++i;
+            }
+        }
+        flush(pattern.size());
+        if (runs.empty()) return;
+        if (runs.front().data() == pattern.data()) prefix = runs.front();
+        if (runs.back().data() + runs.back().size() == pattern.data() + pattern.size()) {
+            suffix = runs.back();
+        }
+        for (auto each : runs) {
+            if (each.size() > needle.size()) needle = each;
+        }
+        if (needle == prefix || needle == suffix) needle.clear();
+    }
+
+    bool PathPolicy::GlobRule::matches(std::string_view text) const {
+        if (!text.starts_with(prefix) || !text.ends_with(suffix)) return false;
+        if (!needle.empty() && text.find(needle) == kNone) return false;
+        return glob.matches(text);
+    }
+
+    errors::Result<PathPolicy> PathPolicy::compile(const PathPolicyRules& rules) {
+        PathPolicy policy;
+        for (const auto& root : rules.roots) {
+            char buffer[PATH_MAX];
+            struct stat st;
+            if (!::realpath(root.c_str(), buffer) || ::stat(buffer, &st) != 0 ||
+                !S_ISDIR(st.st_mode)) {
+                return error(errors::ErrorCategory::Input, root,
+                             "workspace root is not a directory");
+            }
+            policy.roots_.emplace_back(buffer);
+            policy.rules_key_.append(1, 'w').append(buffer).append(1, '\0');
+            policy.nodes_[policy.node_at(buffer)].verdict.add(kRoot, 0);
+        }
+
+        auto add_rule = [&](const std::string& entry, Effect effect) {
+            if (entry.empty()) return;
+            auto rule = static_cast<std::uint32_t>(policy.rule_text_.size());
+            policy.rule_text_.push_back(entry);
+            policy.rules_key_.append(1, effect == kDeny ? 'd' : 'r').append(entry).append(1, '\0');
+            std::string_view pattern = entry;
+            while (pattern.starts_with("./")) pattern.remove_prefix(2);
+            if (pattern.size() > 1 && pattern.back() == '/') pattern.remove_suffix(1);
+
+            // Plain paths are trie nodes. So are the directories in front of a
+            // glob's first wildcard, which leave the glob less to match.
+            std::size_t wildcard = pattern.find_first_of("*?[\\");
+            std::size_t slash = pattern.rfind('/', wildcard);
+            std::vector<std::string> dirs;
+            std::string_view rest;
+            if (wildcard == kNone || slash != kNone) {
+                std::string_view dir = wildcard == kNone ? pattern : pattern.substr(0, slash);
+                rest = wildcard == kNone ? std::string_view{} : pattern.substr(slash + 1);
+                if (pattern[0] == '/') {
+                    dirs.push_back(canonical(dir.empty() ? "/" : std::string(dir)));
+                } else {
+                    for (const auto& root : policy.roots_) {
+                        std::string path = root;
+                        path.append("/").append(dir);
+                        dirs.push_back(canonical(path));
+                    }
+                }
+            }
+            for (const auto& dir : dirs) {
+                Node& node = policy.nodes_[policy.node_at(dir)];
+                if (wildcard == kNone) {
+                    node.verdict.add(effect, rule);
+                } else {
+                    node.below.emplace_back(rest, effect, rule);
+                }
+            }
+            if (wildcard != kNone && slash == kNone) {
+                auto& globs = pattern.find('/') == kNone ? policy.names_ : policy.relative_;
+                globs.emplace_back(pattern, effect, rule);
+            }
+        };
+        // Deny rules first, so that a match can end the scan
+        for (const auto& entry : rules.deny) add_rule(entry, kDeny);
+        for (const auto& entry : rules.read_only) add_rule(entry, kReadOnly);
+        return policy;
+    }
+
+    std::uint32_t PathPolicy::node_at(std::string_view path) {
+        std::uint32_t node = 0;
+        for_each_component(path, [&](std::string_view part) {
+            for (const auto& [name, child] : nodes_[node].children) {
+                if (name == part) {
+                    node = child;
+                    return;
+                }
+            }
+            auto child = static_cast<std::uint32_t>(nodes_.size());
+            nodes_[node].children.emplace_back(std::string(part), child);
+            nodes_.emplace_back();
+            node = child;
+        });
+        return node;
+    }
+
+    PathPolicy::Verdict PathPolicy::evaluate(std::string_view path) const {
+        // 1. Down the trie, as far as the rules go, with the globs hung on the way
+        Verdict verdict;
+        std::size_t root_end = kNone;
+        std::uint32_t node = 0;
+        std::size_t end = 0;  // Of the path of `node`
+        while (true) {
+            const Node& here = nodes_[node];
+            verdict.merge(here.verdict);
+            if (here.verdict.effects & kRoot) root_end = end;
+            if (end + 1 >= path.size()) break;
+            for (const auto& rule : here.below) {
+                if (rule.matches(path.substr(end + 1))) verdict.add(rule.effect, rule.rule);
+            }
+            if (here.children.empty()) break;
+
+            std::size_t start = end + 1;
+            end = std::min(path.find('/', start), path.size());
+            std::string_view part = path.substr(start, end - start);
+            std::uint32_t next = 0;
+            for (const auto& [name, child] : here.children) {
+                if (name == part) {
+                    next = child;
+                    break;
+                }
+            }
+            if (next == 0) break;
+            node = next;
+        }
+
+        // 2. The globs that can match anywhere inside a root
+        if (root_end == kNone || (verdict.effects & kDeny)) return verdict;
+        std::string_view relative =
+            root_end + 1 < path.size() ? path.substr(root_end + 1) : std::string_view{};
+        for (const auto& rule : relative_) {
+            if (rule.matches(relative)) {
+                verdict.add(rule.effect, rule.rule);
+                if (rule.effect == kDeny) return verdict;
+            }
+        }
+        if (!names_.empty()) {
+            for_each_component(relative, [&](std::string_view part) {
+                for (const auto& rule : names_) {
+                    if (rule.matches(part)) verdict.add(rule.effect, rule.rule);
+                }
+            });
+        }
+        return verdict;
+    }
+
+    std::string PathPolicy::refusal(const Verdict& verdict, PathAccess access) const {
+        std::string reason;
+        if (verdict.effects & kDeny) {
+            reason.append("denied by the rule \"").append(rule_text_[verdict.deny_rule]);
+            reason += '"';
+        } else if (access == PathAccess::Write && (verdict.effects & kReadOnly)) {
+            reason.append("read-only by the rule \"").append(rule_text_[verdict.read_only_rule]);
+            reason += '"';
+        } else if (!(verdict.effects & (kRoot | kReadOnly))) {
+            reason = "outside the workspace";
+        }
+        return reason;
+    }
+
+    bool PathPolicy::allows(std::string_view path, PathAccess access) const {
+        Verdict verdict = evaluate(path);
+        if (verdict.effects & kDeny) return false;
+        if (access == PathAccess::Write) {
+            return (verdict.effects & (kRoot | kReadOnly)) == kRoot;
+        }
+        return (verdict.effects & (kRoot | kReadOnly)) != 0;
+    }
+
+    errors::Status PathPolicy::check(std::string_view path, PathAccess access) const {
+        if (allows(path, access)) return std::monostate{};
+        return error(errors::ErrorCategory::Policy, path, refusal(evaluate(path), access));
+    }
+
+    errors::Result<ResolvedPath> PathPolicy::resolve(std::string_view path, PathAccess access,
+                                                     std::string_view base) const {
+        if (path.empty()) return error(errors::ErrorCategory::Input, "\"\"", "empty path");
+        // 1. Where a relative path starts
+        std::vector<std::string> pending;
+        push_components(pending, path);
+        if (path[0] != '/') {
+            if (base.empty() && !roots_.empty()) base = roots_[0];
+            if (base.empty() || base[0] != '/') {
+                char cwd[PATH_MAX];
+                if (!::getcwd(cwd, sizeof(cwd))) {
+                    return error(errors::ErrorCategory::Execution, path, std::strerror(errno));
+                }
+                push_components(pending, base);
+                push_components(pending, cwd);
+            } else {
+                push_components(pending, base);
+            }
+        }
+
+        // 2. One component at a time, each looked up in the directory before it
+        DirChain dirs;
+        dirs.fds.push_back(::open("/", O_PATH | O_DIRECTORY | O_CLOEXEC));
+        if (dirs.fds[0] < 0) {
+            return error(errors::ErrorCategory::Execution, path, std::strerror(errno));
+        }
+        std::vector<std::string> parts;
+        bool at_file = false;  // The last part is an existing file, not a directory
+        int symlinks = 0;
+        while (!pending.empty()) {
+            std::string part = std::move(pending.back());
+            pending.pop_back();
+            if (part == ".") continue;
+            if (at_file) return error(errors::ErrorCategory::Execution, path, "not a directory");
+            if (part == "..") {
+                if (!parts.empty()) parts.pop_back();
+                if (dirs.fds.size() > parts.size() + 1) dirs.truncate(parts.size() + 1);
+                continue;
+            }
+            // Below a directory that does not exist yet, only the names matter
+            if (dirs.fds.size() != parts.size() + 1) {
+                parts.push_back(std::move(part));
+                continue;
+            }
+
+            // A directory, as nearly every component is, takes one call
+            int dir = dirs.fds.back();
+            int fd = ::openat(dir, part.c_str(), O_PATH | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+            if (fd >= 0) {
+                dirs.fds.push_back(fd);
+                parts.push_back(std::move(part));
+                continue;
+            }
+            if (errno != ENOENT && errno != ENOTDIR && errno != ELOOP) {
+                return error(errors::ErrorCategory::Execution, path, std::strerror(errno));
+            }
+            // Missing, a file or a symlink
+            struct stat st;
+            if (errno == ENOENT || ::fstatat(dir, part.c_str(), &st, AT_SYMLINK_NOFOLLOW) != 0) {
+                if (errno != ENOENT) {
+                    return error(errors::ErrorCategory::Execution, path, std::strerror(errno));
+                }
+                parts.push_back(std::move(part));
+                continue;
+            }
+            if (S_ISLNK(st.st_mode)) {
+                if (++symlinks > kMaxSymlinks) {
+                    return error(errors::ErrorCategory::Execution, path, std::strerror(ELOOP));
+                }
+                char target[PATH_MAX];
+                ssize_t length = ::readlinkat(dir, part.c_str(), target, sizeof(target));
+                if (length < 0 || static_cast<std::size_t>(length) >= sizeof(target)) {
+                    return error(errors::ErrorCategory::Execution, path,
+                                 length < 0 ? std::strerror(errno) : "symlink target too long");
+                }
+                std::string_view link(target, static_cast<std::size_t>(length));
+                push_components(pending, link);
+                if (link.starts_with('/')) {
+                    parts.clear();
+                    dirs.truncate(1);
+                }
+                continue;
+            }
+            at_file = true;
+            parts.push_back(std::move(part));
+        }
+
+        // 3. Keep the parent open, check the canonical path
+        std::string resolved;
+        for (const auto& part : parts) resolved.append("/").append(part);
+        if (resolved.empty()) resolved += '/';
+        int parent = -1;
+        std::size_t parent_index = parts.empty() ? 0 : parts.size() - 1;
+        if (parent_index < dirs.fds.size()) std::swap(parent, dirs.fds[parent_index]);
+        ResolvedPath result(std::move(resolved), parent);
+
+        Verdict verdict = evaluate(result.path());
+        std::string reason = refusal(verdict, access);
+        if (!reason.empty()) return error(errors::ErrorCategory::Policy, path, reason);
+        return result;
+    }
+
+} // namespace agent::core::fs
@@ -0,0 +1,127 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/fs/ignore_rules.hpp"
+
+namespace agent::core::fs {
+
+    enum class PathAccess { Read, Write };
+
+    // Where tools may read and write. Each entry is one of:
+    //   /abs/path      that path and everything below it
+    //   rel/path       the same, below every workspace root
+    //   /abs/*.glob    a glob over the whole absolute path
+    //   rel/**/glob    a glob over the path relative to its workspace root
+    //   name*          a glob without '/': any component of a path inside a root
+    // Deny beats read-only, which beats the roots; anything else is denied.
+    struct PathPolicyRules {
+        std::vector<std::string> roots;      // Workspaces: read and write
+        std::vector<std::string> read_only;  // Read, never write (inside or outside the roots)
+        std::vector<std::string> deny;       // Neither
+    };
+
+    // A path after symlinks, "." and ".." are resolved, with the directory
+    // that holds it still open, so that the caller can openat() the name
+    // without the path being resolved a second time.
+    class ResolvedPath {
+    public:
+        ResolvedPath(ResolvedPath&& other) noexcept;
+        ResolvedPath& operator=(ResolvedPath&& other) noexcept;
+        ResolvedPath(const ResolvedPath&) = delete;
+        ResolvedPath& operator=(const ResolvedPath&) = delete;
+        ~ResolvedPath();
+
+        const std::string& path() const { return path_; }  // Absolute, canonical
+        // O_PATH descriptor of the parent directory; -1 while it does not exist
+        int parent() const { return parent_; }
+        std::string_view name() const {
+            return std::string_view(path_).substr(path_.rfind('/') + 1);
+        }
+
+    private:
+        friend class PathPolicy;
+        ResolvedPath(std::string path, int parent) : path_(std::move(path)), parent_(parent) {}
+
+        std::string path_;
+        int parent_ = -1;
+    };
+
+    // The rules compiled into a trie of path components and glob automata
+    // (hung on the trie node of their leading directories where they have
+    // some), so that checking a canonical path makes no system calls and no
+    // allocations: one walk down the trie, then the globs it cannot place.
+    // Immutable once compiled; share one between threads and tools.
+    class PathPolicy {
+    public:
+        // Fails (Input) when a root is not an existing directory
+        static errors::Result<PathPolicy> compile(const PathPolicyRules& rules);
+
+        // Canonicalizes `path` one component at a time with openat(O_PATH |
+        // O_NOFOLLOW), following symlinks by hand, then checks it. Relative
+        // paths start from `base`, or the first root when it is empty.
+        // Policy errors name `path` as given and the rule that refused it.
+        errors::Result<ResolvedPath> resolve(std::string_view path, PathAccess access,
+                                             std::string_view base = {}) const;
+
+        // For a path that is already canonical
+        bool allows(std::string_view path, PathAccess access) const;
+        errors::Status check(std::string_view path, PathAccess access) const;
+
+        const std::vector<std::string>& roots() const { return roots_; }
+        // The rules it was compiled from, roots canonical: equal keys, equal verdicts
+        const std::string& rules_key() const { return rules_key_; }
+
+    private:
+        enum Effect : std::uint8_t { kRoot = 1, kReadOnly = 2, kDeny = 4 };
+
+        struct Verdict {
+            std::uint8_t effects = 0;
+            std::uint32_t read_only_rule = 0;  // Indexes into rule_text_
+            std::uint32_t deny_rule = 0;
+
+            void add(Effect effect, std::uint32_t rule);
+            void merge(const Verdict& other);
+        };
+
+        struct GlobRule {
+            Glob glob;
+            Effect effect;
+            std::uint32_t rule;
+            // Literal text every match starts with, ends with and contains:
+            // most paths are turned away by these before the automaton runs
+            std::string prefix;
+            std::string suffix;
+            std::string needle;
+
+            GlobRule(std::string_view pattern, Effect effect, std::uint32_t rule);
+            bool matches(std::string_view text) const;
+        };
+
+        struct Node {
+            Verdict verdict;
+            std::vector<std::pair<std::string, std::uint32_t>> children;
+            // Globs whose leading directories are this node's path; they see
+            // only the rest of the path, and only paths that reach this node
+            std::vector<GlobRule> below;
+        };
+
+        PathPolicy() = default;
+
+        std::uint32_t node_at(std::string_view path);  // Adds the nodes it lacks
+        Verdict evaluate(std::string_view path) const;
+        // Why the verdict refuses the access; empty when it allows it
+        std::string refusal(const Verdict& verdict, PathAccess access) const;
+
+        std::vector<Node> nodes_{1};  // nodes_[0] is "/"
+        std::vector<GlobRule> relative_;  // Matched against the path inside its root
+        std::vector<GlobRule> names_;     // Matched against each component inside a root
+        std::vector<std::string> roots_;
+        std::vector<std::string> rule_text_;  // For error messages
+        std::string rules_key_;
+    };
+
+} // namespace agent::core::fs
@@ -0,0 +1,164 @@
+#include "core/fs/text_scan.hpp"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace agent::core::fs {
+
+    namespace {
+
+#if defined(__SSE2__)
+        inline int newline_mask(const char* data) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            return _mm_movemask_epi8(_mm_cmpeq_epi8(block, _mm_set1_epi8('\n')));
+        }
+#endif
+
+        // Length of the UTF-8 sequence led by byte, 0 when it cannot lead one
+        inline std::size_t sequence_length(unsigned char byte) {
+            if (byte < 0x80) return 1;
+            if (byte >= 0xC2 && byte <= 0xDF) return 2;
+            if (byte >= 0xE0 && byte <= 0xEF) return 3;
+            if (byte >= 0xF0 && byte <= 0xF4) return 4;
+            return 0;
+        }
+
+        inline bool is_continuation(unsigned char byte) { return (byte & 0xC0) == 0x80; }
+
+    } // namespace
+
+    std::size_t count_newlines(std::string_view text) {
+        const char* data = text.data();
+        std::size_t size = text.size();
+        std::size_t i = 0;
+        std::size_t count = 0;
+#if defined(__SSE2__)
+        for (; i + 16 <= size; i += 16) {
+            count += static_cast<std::size_t>(__builtin_popcount(newline_mask(data + i)));
+        }
+#endif
+        for (; i < size; ++i) count += data[i] == '\n';
+        return count;
+    }
+
+    std::size_t find_line_start(std::string_view text, std::size_t line) {
+        if (line == 0) return 0;
+        const char* data = text.data();
+        std::size_t size = text.size();
+        std::size_t i = 0;
+        std::size_t remaining = line;  // Newlines still to pass
+#if defined(__SSE2__)
+        // Count whole blocks; the block holding the wanted newline is resolved bit by bit
+        for (; i + 16 <= size; i += 16) {
+            int mask = newline_mask(data + i);
+            auto hits = static_cast<std::size_t>(__builtin_popcount(mask));
+            if (hits < remaining) {
+                remaining -= hits;
+                continue;
+            }
+            while (--remaining > 0) mask &= mask - 1;
+            return i + static_cast<std::size_t>(__builtin_ctz(mask)) + 1;
+        }
+#endif
+        for (; i < size; ++i) {
+            if (data[i] == '\n' && --remaining == 0) return i + 1;
+        }
+        return size;
+    }
+
+    const char* to_string(Encoding encoding) {
+        switch (encoding) {
+            case Encoding::Utf8: return "utf-8";
+            case Encoding::Latin1: return "latin-1";
+            case Encoding::Utf16: return "utf-16";
+            case Encoding::Binary: return "binary";
+        }
+        return "unknown";
+    }
+
+    Encoding sniff_encoding(std::string_view head) {
+        head = head.substr(0, kSniffBytes);
+        if (head.size() >= 2) {
+            auto b0 = static_cast<unsigned char>(head[0]);
+            auto b1 = static_cast<unsigned char>(head[1]);
+            if ((b0 == 0xFF && b1 == 0xFE) || (b0 == 0xFE && b1 == 0xFF)) return Encoding::Utf16;
+        }
+        if (std::memchr(head.data(), '\0', head.size()) != nullptr) return Encoding::Binary;
+
+        // A sniff window can end inside a multi-byte character: leave out a
+        // trailing sequence that is only incomplete because of the cut
+        std::size_t end = head.size();
+        if (end == kSniffBytes) {
+            std::size_t lead = end;
+            while (lead > 0 && end - lead < 3 &&
+                   is_continuation(static_cast<unsigned char>(head[lead - 1]))) {
+                --lead;
+            }
+            if (lead > 0 &&
+                sequence_length(static_cast<unsigned char>(head[lead - 1])) > end - lead + 1) {
+                end = lead - 1;
+            }
+        }
+        return is_valid_utf8(head.substr(0, end)) ? Encoding::Utf8 : Encoding::Latin1;
+    }
+
+    bool is_valid_utf8(std::string_view text) {
+        const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+        std::size_t size = text.size();
+        std::size_t i = 0;
+        while (i < size) {
+#if defined(__SSE2__)
+            // Source code is mostly ASCII: skip 16 bytes at a time while the top bits are clear
+            while (i + 16 <= size &&
+                   _mm_movemask_epi8(_mm_loadu_si128(
+                       reinterpret_cast<const __m128i*>(data + i))) == 0) {
+                i += 16;
+            }
+            if (i >= size) break;
+#endif
+            std::size_t length = sequence_length(data[i]);
+            if (length == 0 || i + length > size) return false;
+            for (std::size_t k = 1; k < length; ++k) {
+                if (!is_continuation(data[i + k])) return false;
+            }
+            // Overlong three/four byte forms, surrogates and code points past U+10FFFF
+            if (length == 3) {
+                if (data[i] == 0xE0 && data[i + 1] < 0xA0) return false;
+                if (data[i] == 0xED && data[i + 1] > 0x9F) return false;
+            } else if (length == 4) {
+                if (data[i] == 0xF0 && data[i + 1] < 0x90) return false;
+                if (data[i] == 0xF4 && data[i + 1] > 0x8F) return false;
+            }
+            i += length;
+        }
+        return true;
+    }
+
+    std::size_t utf8_floor(std::string_view text, std::size_t pos) {
+        while (pos > 0 && pos < text.size() &&
+               is_continuation(static_cast<unsigned char>(text[pos]))) {
+            --pos;
+        }
+        return pos;
+    }
+
+    std::size_t utf8_ceil(std::string_view text, std::size_t pos) {
+        while (pos < text.size() && is_continuation(static_cast<unsigned char>(text[pos]))) ++pos;
+        return pos;
+    }
+
+    void append_latin1_as_utf8(std::string& out, std::string_view text) {
+        out.reserve(out.size() + text.size() + text.size() / 8);
+        for (char c : text) {
+            auto byte = static_cast<unsigned char>(c);
+            if (byte < 0x80) {
+                out.push_back(c);
+            } else {
+                out.push_back(static_cast<char>(0xC0 | (byte >> 6)));
+                out.push_back(static_cast<char>(0x80 | (byte & 0x3F)));
+            }
+        }
+    }
+
+} // namespace agent::core::fs
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Byte-level scanning of file contents: line positions and encoding checks.
+// These run over whole files, so the hot loops look at 16 bytes at a time.
+namespace agent::core::fs {
+
+    // Number of '\n' in text
+    std::size_t count_newlines(std::string_view text);
+
+    // Offset where 0-based line `line` starts, or text.size() when the text
+    // has fewer lines. Reads only as far as it needs to.
+    std::size_t find_line_start(std::string_view text, std::size_t line);
+
+    enum class Encoding {
+        Utf8,    // Including plain ASCII; a UTF-8 BOM is allowed
+        Latin1,  // Text that is not valid UTF-8: shown as ISO-8859-1
+        Utf16,   // Has a UTF-16 byte order mark
+        Binary   // NUL bytes near the start
+    };
+
+    const char* to_string(Encoding encoding);
+
+    // Decides from a prefix of the file (kSniffBytes) whether it is text at
+    // all; whether it is UTF-8 is then checked on the part actually shown.
+    inline constexpr std::size_t kSniffBytes = 8192;
+    Encoding sniff_encoding(std::string_view head);
+
+    bool is_valid_utf8(std::string_view text);
+
+    // Moves a cut point back/forward off a UTF-8 continuation byte
+    std::size_t utf8_floor(std::string_view text, std::size_t pos);
+    std::size_t utf8_ceil(std::string_view text, std::size_t pos);
+
+    void append_latin1_as_utf8(std::string& out, std::string_view text);
+
+} // namespace agent::core::fs
@@ -0,0 +1,125 @@
+#include "core/fs/tree_watcher.hpp"
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include "core/logging/logger.hpp"
+
+namespace agent::core::fs {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    namespace {
+
+        constexpr std::uint32_t kWatchMask = IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB | IN_CREATE |
+                                             IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                             IN_DELETE_SELF | IN_MOVE_SELF;
+
+    } // namespace
+
+    TreeWatcher::~TreeWatcher() {
+        if (thread_.joinable()) {
+            std::uint64_t one = 1;
+            [[maybe_unused]] auto written = ::write(wakeup_, &one, sizeof(one));
+            thread_.join();
+        }
+        if (inotify_ >= 0) ::close(inotify_);
+        if (wakeup_ >= 0) ::close(wakeup_);
+    }
+
+    errors::Status TreeWatcher::watch(const std::string& root) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (inotify_ < 0) {
+            inotify_ = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            wakeup_ = ::eventfd(0, EFD_CLOEXEC);
+            if (inotify_ < 0 || wakeup_ < 0) {
+                return AgentError{ErrorCategory::Execution,
+                                  std::string("inotify: ") + std::strerror(errno)};
+            }
+            thread_ = std::thread([this] { loop(); });
+        }
+        add_watches(root);
+        return std::monostate{};
+    }
+
+    void TreeWatcher::add_watches(const std::string& root) {
+        // Called with mutex_ held
+        auto add = [&](const std::string& directory) {
+            int wd = ::inotify_add_watch(inotify_, directory.c_str(), kWatchMask | IN_ONLYDIR);
+            if (wd >= 0) {
+                watched_[wd] = directory;
+            } else if (errno == ENOSPC) {
+                LOG_WARN("inotify watch limit reached; not watching below " + directory);
+            }
+            return wd >= 0 || errno != ENOSPC;
+        };
+        if (!add(root)) return;
+
+        std::error_code error;
+        auto options = std::filesystem::directory_options::skip_permission_denied;
+        for (std::filesystem::recursive_directory_iterator it(root, options, error), end;
+             !error && it != end; it.increment(error)) {
+            if (!it->is_directory(error) || it->is_symlink(error)) continue;
+            if (it->path().filename() == ".git") {
+                it.disable_recursion_pending();  // Churns constantly and is never read
+                continue;
+            }
+            if (!add(it->path().string())) return;
+        }
+    }
+
+    void TreeWatcher::loop() {
+        alignas(struct inotify_event) char buffer[64 * 1024];
+        while (true) {
+            pollfd fds[2] = {{inotify_, POLLIN, 0}, {wakeup_, POLLIN, 0}};
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) continue;
+                return;
+            }
+            if (fds[1].revents != 0) return;
+
+            ssize_t n = ::read(inotify_, buffer, sizeof(buffer));
+            if (n <= 0) continue;
+            for (char* p = buffer; p < buffer + n;) {
+                auto* event = reinterpret_cast<struct inotify_event*>(p);
+                p += sizeof(struct inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW) {
+                    listener_(TreeEvent{TreeEvent::Kind::Overflow, ""});
+                    continue;
+                }
+
+                std::string directory;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    auto it = watched_.find(event->wd);
+                    if (it == watched_.end()) continue;
+                    directory = it->second;
+                    if (event->mask & IN_IGNORED) {
+                        watched_.erase(it);
+                        continue;
+                    }
+                }
+                if (event->len == 0) continue;  // Event on the directory itself
+
+                std::string path = directory + "/" + event->name;
+                if (!(event->mask & IN_ISDIR)) {
+                    listener_(TreeEvent{TreeEvent::Kind::File, path});
+                    continue;
+                }
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    add_watches(path);
+                }
+                if (event->mask & (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO)) {
+                    listener_(TreeEvent{TreeEvent::Kind::Directory, path});
+                }
+            }
+        }
+    }
+
+} // namespace agent::core::fs
@@ -0,0 +1,50 @@
+#pragma once
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include "core/errors/agent_errors.hpp"
+
+namespace agent::core::fs {
+
+    struct TreeEvent {
+        enum class Kind {
+            File,       // Written, created, deleted or moved in or out
+            Directory,  // Created, deleted or moved in or out, with everything below it
+            Overflow    // The kernel dropped events: anything may have changed
+        };
+        Kind kind;
+        std::string path;  // Absolute; empty for Overflow
+    };
+
+    // inotify watches on every directory of a tree (except .git), including
+    // directories created after watch(). Events are delivered on a background
+    // thread; a new directory is already watched when its event arrives, so a
+    // listener that rescans it misses nothing.
+    class TreeWatcher {
+    public:
+        using Listener = std::function<void(const TreeEvent&)>;
+
+        explicit TreeWatcher(Listener listener) : listener_(std::move(listener)) {}
+        ~TreeWatcher();
+
+        TreeWatcher(const TreeWatcher&) = delete;
+        TreeWatcher& operator=(const TreeWatcher&) = delete;
+
+        // May be called again for more roots
+        errors::Status watch(const std::string& root);
+
+    private:
+        Listener listener_;
+        std::mutex mutex_;
+        int inotify_ = -1;
+        int wakeup_ = -1;  // eventfd that stops the thread
+        std::unordered_map<int, std::string> watched_;  // watch descriptor -> directory
+        std::thread thread_;
+
+        void add_watches(const std::string& root);
+        void loop();
+    };
+
+} // namespace agent::core::fs
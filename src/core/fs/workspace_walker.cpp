@@ -0,0 +1,303 @@
+#include "core/fs/workspace_walker.hpp"
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "core/fs/ignore_rules.hpp"
+
+namespace agent::core::fs {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    namespace {
+
+        // Record layout returned by getdents64
+        struct LinuxDirent64 {
+            std::uint64_t d_ino;
+            std::int64_t d_off;
+            unsigned short d_reclen;
+            unsigned char d_type;
+            char d_name[1];
+        };
+
+        constexpr std::size_t kDirentBuffer = 64 * 1024;
+
+        struct Task {
+            std::string path;  // Relative to the root, "" for the root itself
+            std::shared_ptr<const IgnoreChain> rules;
+        };
+
+        // One per thread: the owner pushes and pops at the back, thieves take the front
+        struct Lane {
+            std::mutex mutex;
+            std::deque<Task> tasks;
+        };
+
+        std::string read_small_file(int dir_fd, const char* name) {
+            int fd = ::openat(dir_fd, name, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return "";
+            std::string contents;
+            char buffer[8192];
+            ssize_t n;
+            while ((n = ::read(fd, buffer, sizeof(buffer))) > 0) {
+                contents.append(buffer, static_cast<std::size_t>(n));
+            }
+            ::close(fd);
+            return contents;
+        }
+
+        std::string trim_slash(const std::string& root) {
+            return root.size() > 1 && root.back() == '/' ? root.substr(0, root.size() - 1) : root;
+        }
+
+        // Patterns that apply from the top: the caller's, then .git/info/exclude
+        std::shared_ptr<const IgnoreChain> top_rules(const std::string& top,
+                                                     const WalkOptions& options) {
+            std::string patterns;
+            for (const auto& pattern : options.ignore) patterns += pattern + "\n";
+            if (options.respect_gitignore) {
+                int git = ::open((top + "/.git/info").c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+                if (git >= 0) {
+                    patterns += read_small_file(git, "exclude");
+                    ::close(git);
+                }
+            }
+            IgnoreRules rules(patterns, "");
+            if (rules.empty()) return nullptr;
+            return std::make_shared<IgnoreChain>(IgnoreChain{nullptr, std::move(rules)});
+        }
+
+        class Walker {
+        public:
+            Walker(std::string root, const WalkOptions& options, const WalkSink& sink,
+                   std::size_t threads)
+                : root_(std::move(root)), options_(options), sink_(sink) {
+                for (std::size_t i = 0; i < threads; ++i) {
+                    lanes_.push_back(std::make_unique<Lane>());
+                }
+            }
+
+            void push(std::size_t lane, Task task) {
+                pending_.fetch_add(1, std::memory_order_relaxed);
+                std::lock_guard<std::mutex> lock(lanes_[lane]->mutex);
+                lanes_[lane]->tasks.push_back(std::move(task));
+            }
+
+            // Runs until every directory has been read (or the sink asked to stop)
+            void run(std::size_t lane, WalkStats& stats) {
+                std::vector<char> buffer(kDirentBuffer);
+                std::size_t idle = 0;
+                Task task;
+                while (pending_.load(std::memory_order_acquire) > 0 &&
+                       !stop_.load(std::memory_order_relaxed)) {
+                    if (!pop(lane, task)) {
+                        // Others still hold work that may fan out: back off, then look again
+                        if (++idle < 64) {
+                            std::this_thread::yield();
+                        } else {
+                            std::this_thread::sleep_for(std::chrono::microseconds(50));
+                        }
+                        continue;
+                    }
+                    idle = 0;
+                    read_directory(lane, task, buffer, stats);
+                    pending_.fetch_sub(1, std::memory_order_acq_rel);
+                }
+            }
+
+        private:
+            std::string root_;
+            const WalkOptions& options_;
+            const WalkSink& sink_;
+            std::vector<std::unique_ptr<Lane>> lanes_;
+            std::atomic<std::size_t> pending_{0};  // Queued or being read
+            std::atomic<bool> stop_{false};
+
+            bool pop(std::size_t lane, Task& task) {
+                {
+                    Lane& own = *lanes_[lane];
+                    std::lock_guard<std::mutex> lock(own.mutex);
+                    if (!own.tasks.empty()) {
+                        task = std::move(own.tasks.back());
+                        own.tasks.pop_back();
+                        return true;
+                    }
+                }
+                for (std::size_t step = 1; step < lanes_.size(); ++step) {
+                    Lane& victim = *lanes_[(lane + step) % lanes_.size()];
+                    std::lock_guard<std::mutex> lock(victim.mutex);
+                    if (!victim.tasks.empty()) {
+                        task = std::move(victim.tasks.front());
+                        victim.tasks.pop_front();
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            void read_directory(std::size_t lane, const Task& task, std::vector<char>& buffer,
+                                WalkStats& stats) {
+                std::string full = task.path.empty() ? root_ : root_ + "/" + task.path;
+                int fd = ::open(full.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC | O_NOFOLLOW);
+                if (fd < 0) {
+                    ++stats.unreadable;
+                    return;
+                }
+
+                // 1. Slurp the names first: a .gitignore here applies to its siblings
+                struct Name {
+                    std::size_t offset;  // Into names
+                    unsigned char type;
+                };
+                std::string names;
+                std::vector<Name> entries;
+                bool has_gitignore = false;
+                while (true) {
+                    long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+                    if (n <= 0) break;
+                    for (long pos = 0; pos < n;) {
+                        auto* entry = reinterpret_cast<LinuxDirent64*>(buffer.data() + pos);
+                        pos += entry->d_reclen;
+                        const char* name = entry->d_name;
+                        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && !name[2]))) {
+                            continue;
+                        }
+                        if (std::strcmp(name, ".gitignore") == 0) has_gitignore = true;
+                        entries.push_back({names.size(), entry->d_type});
+                        names.append(name);
+                        names.push_back('\0');
+                    }
+                }
+
+                std::shared_ptr<const IgnoreChain> rules = task.rules;
+                if (has_gitignore && options_.respect_gitignore) {
+                    IgnoreRules local(read_small_file(fd, ".gitignore"), task.path);
+                    if (!local.empty()) {
+                        rules = std::make_shared<IgnoreChain>(IgnoreChain{rules, std::move(local)});
+                    }
+                }
+
+                // 2. Filter, report, and queue subdirectories
+                std::string path = task.path;
+                std::size_t prefix = path.empty() ? 0 : path.size() + 1;
+                if (!path.empty()) path += '/';
+                for (const Name& entry : entries) {
+                    const char* name = names.data() + entry.offset;
+                    if (std::strcmp(name, ".git") == 0 ||
+                        (!options_.include_hidden && name[0] == '.')) {
+                        ++stats.ignored;
+                        continue;
+                    }
+                    unsigned char type = entry.type;
+                    if (type == DT_UNKNOWN) {
+                        struct stat info {};
+                        if (::fstatat(fd, name, &info, AT_SYMLINK_NOFOLLOW) == 0) {
+                            type = S_ISDIR(info.st_mode) ? DT_DIR : DT_REG;
+                        }
+                    }
+                    bool is_dir = type == DT_DIR;
+
+                    path.resize(prefix);
+                    path += name;
+                    if (IgnoreChain::ignored(rules.get(), path, is_dir)) {
+                        ++stats.ignored;
+                        continue;
+                    }
+                    if (!sink_(WalkEntry{path, is_dir})) {
+                        stop_.store(true, std::memory_order_relaxed);
+                        break;
+                    }
+                    if (is_dir) {
+                        ++stats.directories;
+                        push(lane, Task{path, rules});
+                    } else {
+                        ++stats.files;
+                    }
+                }
+                ::close(fd);
+            }
+        };
+
+    } // namespace
+
+    errors::Result<WalkStats> walk(const std::string& root, const WalkOptions& options,
+                                   const WalkSink& sink) {
+        struct stat info {};
+        if (::stat(root.c_str(), &info) != 0 || !S_ISDIR(info.st_mode)) {
+            return AgentError{ErrorCategory::Input, "Not a directory: " + root};
+        }
+
+        std::string top = trim_slash(root);
+        std::shared_ptr<const IgnoreChain> base = top_rules(top, options);
+
+        std::size_t threads = options.threads;
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+        Walker walker(top, options, sink, threads);
+        walker.push(0, Task{"", base});
+
+        std::vector<WalkStats> per_thread(threads);
+        std::vector<std::thread> helpers;
+        for (std::size_t i = 1; i < threads; ++i) {
+            helpers.emplace_back([&, i] { walker.run(i, per_thread[i]); });
+        }
+        walker.run(0, per_thread[0]);
+        for (auto& helper : helpers) helper.join();
+
+        WalkStats total;
+        for (const auto& stats : per_thread) {
+            total.directories += stats.directories;
+            total.files += stats.files;
+            total.ignored += stats.ignored;
+            total.unreadable += stats.unreadable;
+        }
+        return total;
+    }
+
+    bool walk_skips(const std::string& root, std::string_view path, bool is_dir,
+                    const WalkOptions& options) {
+        std::string top = trim_slash(root);
+        std::shared_ptr<const IgnoreChain> rules = top_rules(top, options);
+        auto enter = [&](std::string_view dir) {
+            if (!options.respect_gitignore) return;
+            std::string full = dir.empty() ? top : top + "/" + std::string(dir);
+            int fd = ::open(full.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (fd < 0) return;
+            IgnoreRules local(read_small_file(fd, ".gitignore"), std::string(dir));
+            ::close(fd);
+            if (!local.empty()) {
+                rules = std::make_shared<IgnoreChain>(IgnoreChain{rules, std::move(local)});
+            }
+        };
+
+        // Same decisions as the walk, one path component at a time
+        enter("");
+        std::size_t begin = 0;
+        while (begin < path.size()) {
+            std::size_t slash = path.find('/', begin);
+            bool last = slash == std::string_view::npos;
+            std::size_t end = last ? path.size() : slash;
+            std::string_view name = path.substr(begin, end - begin);
+            std::string_view prefix = path.substr(0, end);
+
+            if (name == ".git" || (!options.include_hidden && name.starts_with('.'))) return true;
+            if (IgnoreChain::ignored(rules.get(), prefix, last ? is_dir : true)) return true;
+            if (last) break;
+            enter(prefix);
+            begin = end + 1;
+        }
+        return false;
+    }
+
+} // namespace agent::core::fs
@@ -0,0 +1,49 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+
+namespace agent::core::fs {
+
+    struct WalkOptions {
+        std::size_t threads = 0;          // 0: one per hardware thread
+        bool respect_gitignore = true;    // .gitignore files and .git/info/exclude
+        bool include_hidden = true;       // Names starting with '.'; .git itself is always skipped
+        std::vector<std::string> ignore;  // Extra gitignore-style patterns, relative to the root
+    };
+
+    struct WalkEntry {
+        std::string_view path;  // Relative to the root, '/'-separated; valid during the call only
+        bool is_dir;
+    };
+
+    struct WalkStats {
+        std::size_t directories = 0;
+        std::size_t files = 0;
+        std::size_t ignored = 0;     // Entries skipped by ignore rules or the hidden filter
+        std::size_t unreadable = 0;  // Directories that could not be opened
+    };
+
+    // Called for every file and directory that is not ignored, from several
+    // walker threads at once. Return false to stop the walk early.
+    using WalkSink = std::function<bool(const WalkEntry&)>;
+
+    // Enumerates a tree with a pool of threads. Each thread owns a deque of
+    // directories: it works depth-first off its own end and, when that runs
+    // dry, steals the oldest (and so usually largest) subtree from another.
+    // Directories are read with getdents64 into a large buffer, so a
+    // directory costs a handful of system calls; d_type saves a stat per
+    // entry. Symbolic links are reported as files and never followed.
+    errors::Result<WalkStats> walk(const std::string& root, const WalkOptions& options,
+                                   const WalkSink& sink);
+
+    // Whether walk(root, options) would leave out path (relative to root).
+    // For single paths learned about outside a walk, e.g. from inotify; it
+    // reads the .gitignore files on the way down each time.
+    bool walk_skips(const std::string& root, std::string_view path, bool is_dir,
+                    const WalkOptions& options);
+
+} // namespace agent::core::fs
@@ -0,0 +1,80 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "core/hash/stable_hash.hpp"
+
+namespace agent::core::hash {
+
+    // A read-only map over a fixed set of string keys. Building it searches
+    // for a hash seed under which no two keys share a slot, so a lookup is
+    // one hash, one slot and one comparison: no probing, no allocation.
+    // Meant for small sets known at startup (tool names, field names).
+    template <typename Value>
+    class PerfectHashMap {
+    public:
+        PerfectHashMap() = default;
+
+        // Keys must be distinct
+        explicit PerfectHashMap(std::vector<std::pair<std::string, Value>> entries) {
+            if (entries.empty()) return;
+            std::size_t size = std::bit_ceil(entries.size() * 2);
+            std::vector<std::uint8_t> taken;
+            for (;; size *= 2) {
+                taken.assign(size, 0);
+                for (std::uint64_t seed = 1; seed <= 256; ++seed) {
+                    bool clash = false;
+                    for (const auto& entry : entries) {
+                        std::uint8_t& slot = taken[slot_of(entry.first, seed, size - 1)];
+                        if (slot) {
+                            clash = true;
+                            break;
+                        }
+                        slot = 1;
+                    }
+                    if (!clash) {
+                        seed_ = seed;
+                        mask_ = size - 1;
+                        slots_.resize(size);
+                        for (auto& [key, value] : entries) {
+                            Slot& slot = slots_[slot_of(key, seed, mask_)];
+                            slot.key = std::move(key);
+                            slot.value = std::move(value);
+                            slot.used = true;
+                        }
+                        return;
+                    }
+                    std::fill(taken.begin(), taken.end(), 0);
+                }
+            }
+        }
+
+        const Value* find(std::string_view key) const {
+            if (slots_.empty()) return nullptr;
+            const Slot& slot = slots_[slot_of(key, seed_, mask_)];
+            return slot.used && slot.key == key ? &slot.value : nullptr;
+        }
+
+    private:
+        struct Slot {
+            std::string key;
+            Value value{};
+            bool used = false;
+        };
+
+        static std::size_t slot_of(std::string_view key, std::uint64_t seed, std::size_t mask) {
+            std::uint64_t h = stable_hash(key, kFnvOffset ^ (seed * 0x9e3779b97f4a7c15ULL));
+            return static_cast<std::size_t>(h ^ (h >> 32)) & mask;
+        }
+
+        std::vector<Slot> slots_;
+        std::uint64_t seed_ = 0;
+        std::size_t mask_ = 0;
+    };
+
+} // namespace agent::core::hash
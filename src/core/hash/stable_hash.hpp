@@ -0,0 +1,30 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace agent::core::hash {
+
+    // 64-bit FNV-1a. Not cryptographic, but byte-for-byte stable across runs,
+    // compilers and machines (unlike std::hash), so it is safe to persist.
+    constexpr std::uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+    constexpr std::uint64_t kFnvPrime = 0x100000001b3ULL;
+
+    constexpr std::uint64_t stable_hash(std::string_view bytes, std::uint64_t seed = kFnvOffset) {
+        std::uint64_t h = seed;
+        for (char c : bytes) {
+            h ^= static_cast<unsigned char>(c);
+            h *= kFnvPrime;
+        }
+        return h;
+    }
+
+    // Fixed-width lower-case hex, handy for file names and log lines
+    inline std::string to_hex(std::uint64_t value) {
+        char buf[17];
+        std::snprintf(buf, sizeof(buf), "%016llx", static_cast<unsigned long long>(value));
+        return std::string(buf, 16);
+    }
+
+} // namespace agent::core::hash
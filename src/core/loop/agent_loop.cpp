@@ -0,0 +1,101 @@
+#include "core/loop/agent_loop.hpp"
+#include "core/logging/logger.hpp"
+
+namespace agent::core::loop {
+
+    errors::Result<protocol::StopReason> AgentLoop::run(std::vector<protocol::Message>& history,
+                                                        const providers::EventSink& on_event) {
+        speculation_stats_ = SpeculationStats{};
+        on_event(protocol::AgentStartEvent{options_.run_id});
+
+        for (int turn = 0; turn < options_.max_turns; ++turn) {
+            on_event(protocol::TurnStartEvent{});
+
+            // Shrink old history before it can push the model into MaxTokens
+            if (options_.compactor) {
+                auto report = options_.compactor->maybe_compact(history);
+                if (report.ran) {
+                    on_event(protocol::ContextCompactedEvent{report.tokens_before,
+                                                             report.tokens_after});
+                }
+            }
+
+            providers::CompletionRequest request{history, dispatcher_.schemas(), options_.params};
+            check_prefix(request, on_event);
+            SpeculativeExecutor speculative(dispatcher_);
+
+            // 1. Stream the next assistant message, speculating on read-only tools
+            auto response = provider_.complete(request, [&](const protocol::AgentEvent& event) {
+                on_event(event);
+                if (options_.speculative_tools) speculative.on_event(event);
+            });
+            if (errors::is_error(response)) {
+                on_event(protocol::AgentEndEvent{protocol::StopReason::Error});
+                return errors::get_error(response);
+            }
+
+            const auto& completion = errors::get_value(response);
+            history.push_back(completion.message);
+
+            // 2. Anything other than a tool request ends the run
+            if (completion.stop_reason != protocol::StopReason::ToolCall) {
+                finish_turn(speculative);
+                on_event(protocol::AgentEndEvent{completion.stop_reason});
+                return completion.stop_reason;
+            }
+
+            // 3. Execute the tools and loop back to the provider with their output
+            run_tools(completion.message, speculative, history, on_event);
+            finish_turn(speculative);
+        }
+
+        LOG_WARN("Agent loop hit max_turns (" + std::to_string(options_.max_turns) + ")");
+        on_event(protocol::AgentEndEvent{protocol::StopReason::Error});
+        return errors::AgentError{errors::ErrorCategory::Execution,
+                                  "Turn limit reached: " + std::to_string(options_.max_turns)};
+    }
+
+    void AgentLoop::check_prefix(const providers::CompletionRequest& request,
+                                 const providers::EventSink& on_event) {
+        auto broken = prefix_tracker_.observe(providers::canonicalize(request));
+        if (!broken) return;
+
+        // History is append-only between turns; anything else means some
+        // earlier message was rewritten and the provider re-reads from there.
+        LOG_WARN(broken->header_changed
+                     ? std::string("Prompt cache break: tools or model parameters changed")
+                     : "Prompt cache break at message " + std::to_string(broken->message_index));
+        on_event(protocol::PrefixCacheBreakEvent{broken->header_changed, broken->message_index});
+    }
+
+    void AgentLoop::finish_turn(SpeculativeExecutor& speculative) {
+        speculative.discard_unclaimed();
+
+        const auto& stats = speculative.stats();
+        speculation_stats_.launched += stats.launched;
+        speculation_stats_.hits += stats.hits;
+        speculation_stats_.discarded += stats.discarded;
+    }
+
+    void AgentLoop::run_tools(const protocol::Message& assistant, SpeculativeExecutor& speculative,
+                              std::vector<protocol::Message>& history,
+                              const providers::EventSink& on_event) {
+        for (const auto& call : assistant.tool_calls) {
+            on_event(protocol::ToolExecutionStartEvent{call.name});
+
+            // Reads speculated past a mutating call may have seen the files before it ran
+            const tools::Tool* tool = dispatcher_.find(call.name);
+            if (tool != nullptr && !tool->is_side_effect_free()) speculative.discard_unclaimed();
+
+            auto speculated = speculative.claim(call);
+            protocol::ToolResult result =
+                speculated ? std::move(*speculated) : dispatcher_.dispatch(call);
+
+            on_event(protocol::ToolExecutionEndEvent{result.success});
+            history.push_back(protocol::Message{
+                protocol::Role::Tool, result.success ? result.output : result.error_message, {},
+                call.id});
+        }
+    }
+
+} // namespace agent::core::loop
@@ -0,0 +1,58 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "core/context/compactor.hpp"
+#include "core/errors/agent_errors.hpp"
+#include "core/loop/speculative_executor.hpp"
+#include "core/tools/tool_dispatcher.hpp"
+#include "protocol/event_contract.hpp"
+#include "protocol/message_contract.hpp"
+#include "providers/canonical_request.hpp"
+#include "providers/provider.hpp"
+
+namespace agent::core::loop {
+
+    struct LoopOptions {
+        std::string run_id;
+        int max_turns = 32;              // Hard stop so a confused model cannot loop forever
+        bool speculative_tools = true;   // Run read-only tools while the model is streaming
+        providers::ModelParams params;
+        context::Compactor* compactor = nullptr;  // Optional, owned by the caller
+    };
+
+    // The core Agent Loop: ask the provider, run the requested tools,
+    // feed the results back, repeat until the model is finished.
+    // It only speaks the canonical protocol; vendors live behind Provider.
+    class AgentLoop {
+    public:
+        AgentLoop(providers::Provider& provider, const tools::ToolDispatcher& dispatcher,
+                  LoopOptions options)
+            : provider_(provider), dispatcher_(dispatcher), options_(std::move(options)) {}
+
+        // Appends every assistant and tool message to history.
+        // Returns the StopReason of the last turn, or the error that ended the run.
+        errors::Result<protocol::StopReason> run(std::vector<protocol::Message>& history,
+                                                 const providers::EventSink& on_event);
+
+        // Totals across all turns of the last run()
+        const SpeculationStats& speculation_stats() const { return speculation_stats_; }
+
+        // Prefix-cache continuity across every turn this loop has sent
+        const providers::PrefixCacheTracker& prefix_tracker() const { return prefix_tracker_; }
+
+    private:
+        providers::Provider& provider_;
+        const tools::ToolDispatcher& dispatcher_;
+        LoopOptions options_;
+        SpeculationStats speculation_stats_;
+        providers::PrefixCacheTracker prefix_tracker_;
+
+        void run_tools(const protocol::Message& assistant, SpeculativeExecutor& speculative,
+                       std::vector<protocol::Message>& history,
+                       const providers::EventSink& on_event);
+        void check_prefix(const providers::CompletionRequest& request,
+                          const providers::EventSink& on_event);
+        void finish_turn(SpeculativeExecutor& speculative);
+    };
+
+} // namespace agent::core::loop
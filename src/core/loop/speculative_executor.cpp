@@ -0,0 +1,83 @@
+#include "core/loop/speculative_executor.hpp"
+#include <nlohmann/json.hpp>
+
+namespace agent::core::loop {
+
+    namespace {
+
+        // Two argument strings are "the same call" if they parse to the same JSON.
+        // Whitespace or key-order drift between the stream and the final message
+        // should not cost us a hit.
+        bool same_arguments(const std::string& a, const std::string& b) {
+            if (a == b) return true;
+            auto ja = nlohmann::json::parse(a, nullptr, false);
+            auto jb = nlohmann::json::parse(b, nullptr, false);
+            if (ja.is_discarded() || jb.is_discarded()) return false;
+            return ja == jb;
+        }
+
+    } // namespace
+
+    void SpeculativeExecutor::on_event(const protocol::AgentEvent& event) {
+        const auto* delta = std::get_if<protocol::ToolCallDeltaEvent>(&event);
+        if (delta == nullptr) return;
+
+        if (auto call = assembler_.feed(*delta)) launch(std::move(*call));
+    }
+
+    void SpeculativeExecutor::launch(protocol::ToolCall call) {
+        const tools::Tool* tool = dispatcher_.find(call.name);
+        if (tool == nullptr || !tool->is_side_effect_free()) return;
+        if (speculations_.size() >= max_inflight_) return;
+
+        const tools::ToolDispatcher* dispatcher = &dispatcher_;
+        Speculation speculation;
+        speculation.call = call;
+        speculation.result = std::async(std::launch::async, [dispatcher, call]() {
+            return dispatcher->dispatch(call);
+        });
+        speculations_.push_back(std::move(speculation));
+        ++stats_.launched;
+    }
+
+    std::optional<protocol::ToolResult> SpeculativeExecutor::claim(
+        const protocol::ToolCall& final_call) {
+        for (auto& speculation : speculations_) {
+            if (speculation.claimed) continue;
+
+            // Prefer matching by id; fall back to content when the stream had no id
+            bool same_slot = speculation.call.id.empty() || final_call.id.empty() ||
+                             speculation.call.id == final_call.id;
+            if (!same_slot) continue;
+            if (speculation.call.name != final_call.name ||
+                !same_arguments(speculation.call.arguments, final_call.arguments)) {
+                if (!speculation.call.id.empty() && !final_call.id.empty()) {
+                    // Same id but the model changed its mind: this slot is dead
+                    speculation.claimed = true;
+                    ++stats_.discarded;
+                    return std::nullopt;
+                }
+                continue;
+            }
+
+            speculation.claimed = true;
+            ++stats_.hits;
+            protocol::ToolResult result = speculation.result.get();
+            result.tool_call_id = final_call.id;
+            return result;
+        }
+        return std::nullopt;
+    }
+
+    void SpeculativeExecutor::discard_unclaimed() {
+        for (auto& speculation : speculations_) {
+            if (speculation.claimed) continue;
+            speculation.claimed = true;
+            ++stats_.discarded;
+            if (speculation.result.valid()) speculation.result.wait();
+        }
+        speculations_.clear();
+        assembler_.reset();
+    }
+
+} // namespace agent::core::loop
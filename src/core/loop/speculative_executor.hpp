@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <future>
+#include <optional>
+#include <vector>
+#include "core/streaming/argument_parser.hpp"
+#include "core/tools/tool_dispatcher.hpp"
+#include "protocol/event_contract.hpp"
+#include "protocol/tool_contract.hpp"
+
+namespace agent::core::loop {
+
+    // Counters so that we can see whether speculation is paying off
+    struct SpeculationStats {
+        std::size_t launched = 0;   // Calls started before the message finished
+        std::size_t hits = 0;       // Speculative results we actually used
+        std::size_t discarded = 0;  // Results thrown away (final message differed)
+    };
+
+    // Starts side-effect-free tools while the model is still streaming.
+    //
+    // 1. on_event() feeds ToolCallDeltaEvents through a ToolCallAssembler.
+    // 2. As soon as a call's JSON arguments close, and the tool is marked
+    //    side-effect-free, it is launched on a background thread.
+    // 3. When the final message arrives, claim() hands back the result only
+    //    if the final call is identical (same name and arguments).
+    //
+    // One instance is used per assistant turn.
+    class SpeculativeExecutor {
+    public:
+        explicit SpeculativeExecutor(const tools::ToolDispatcher& dispatcher,
+                                     std::size_t max_inflight = 8)
+            : dispatcher_(dispatcher), max_inflight_(max_inflight) {}
+
+        // Waits for any speculative work still running (the tools are read-only,
+        // so letting them finish is always safe).
+        ~SpeculativeExecutor() { discard_unclaimed(); }
+
+        SpeculativeExecutor(const SpeculativeExecutor&) = delete;
+        SpeculativeExecutor& operator=(const SpeculativeExecutor&) = delete;
+
+        void on_event(const protocol::AgentEvent& event);
+
+        // Returns the speculative result for this final call, if there is a matching one
+        std::optional<protocol::ToolResult> claim(const protocol::ToolCall& final_call);
+
+        // Drops every speculation that was not claimed
+        void discard_unclaimed();
+
+        const SpeculationStats& stats() const { return stats_; }
+
+    private:
+        struct Speculation {
+            protocol::ToolCall call;
+            std::future<protocol::ToolResult> result;
+            bool claimed = false;
+        };
+
+        const tools::ToolDispatcher& dispatcher_;
+        std::size_t max_inflight_;
+        streaming::ToolCallAssembler assembler_;
+        std::vector<Speculation> speculations_;
+        SpeculationStats stats_;
+
+        void launch(protocol::ToolCall call);
+    };
+
+} // namespace agent::core::loop
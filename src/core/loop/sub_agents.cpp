@@ -0,0 +1,182 @@
+#include "core/loop/sub_agents.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "core/logging/logger.hpp"
+#include "core/loop/agent_loop.hpp"
+
+namespace agent::core::loop {
+
+    namespace {
+
+        // Stands in for the parent's request when it had calls but no text
+        constexpr const char* kHandoffText = "Handing part of this work to a sub-agent.";
+
+    } // namespace
+
+    // Charges each request of one child against the pool's budgets
+    class SubAgentPool::BudgetedProvider : public providers::Provider {
+    public:
+        explicit BudgetedProvider(SubAgentPool& pool) : pool_(pool) {}
+
+        errors::Result<providers::CompletionResponse> complete(
+            const providers::CompletionRequest& request,
+            const providers::EventSink& on_event) override {
+            // The fork and earlier turns are already in the estimator's
+            // cache, so only what is new gets tokenized
+            auto charge = pool_.estimator_.charge(request.messages, request.tools,
+                                                  request.params.max_output_tokens);
+            auto admitted = pool_.reserve(charge.reserved, used_);
+            if (errors::is_error(admitted)) return errors::get_error(admitted);
+
+            auto response = pool_.provider_.complete(request, on_event);
+            // A failed request is not billed
+            std::size_t used = 0;
+            if (!errors::is_error(response)) {
+                used = pool_.estimator_.used(charge, errors::get_value(response).message);
+            }
+            pool_.settle(charge.reserved, used);
+            used_ += used;
+            return response;
+        }
+
+    private:
+        SubAgentPool& pool_;
+        std::size_t used_ = 0;  // This child's share of the pool's tokens
+    };
+
+    SubAgentPool::SubAgentPool(providers::Provider& provider,
+                               const tools::ToolDispatcher& dispatcher,
+                               context::TokenEstimator& estimator, SubAgentOptions options)
+        : provider_(provider), dispatcher_(dispatcher), estimator_(estimator),
+          options_(std::move(options)) {
+        options_.max_concurrent = std::max<std::size_t>(options_.max_concurrent, 1);
+    }
+
+    std::vector<protocol::Message> SubAgentPool::fan_out(
+        const std::vector<protocol::Message>& parent, const std::vector<SubAgentTask>& tasks) {
+        // 1. The fork: the parent's conversation, without its request for this fan-out
+        std::size_t end = parent.size();
+        if (end > 0 && parent[end - 1].role == protocol::Role::Assistant &&
+            !parent[end - 1].tool_calls.empty()) {
+            --end;
+        }
+        std::vector<protocol::Message> fork(parent.begin(),
+                                            parent.begin() + static_cast<long>(end));
+        // After earlier tool use the fork ends on a tool result, which counts
+        // as the user's turn; the request stays, without its calls, as the
+        // assistant turn between that result and the child's task
+        if (end < parent.size() && !fork.empty() && fork.back().role == protocol::Role::Tool) {
+            protocol::Message handoff{protocol::Role::Assistant, parent[end].content, {},
+                                      std::nullopt};
+            if (handoff.content.empty()) handoff.content = kHandoffText;
+            fork.push_back(std::move(handoff));
+        }
+        const std::vector<protocol::Message> prefix = std::move(fork);
+
+        // 2. Workers take tasks in order; the pool's slots bound how many run at once
+        std::vector<protocol::Message> results(tasks.size());
+        std::atomic<std::size_t> next{0};
+        auto work = [&] {
+            for (std::size_t i = next++; i < tasks.size(); i = next++) {
+                results[i] = run_child(prefix, tasks[i]);
+            }
+        };
+        std::size_t workers = std::min(tasks.size(), options_.max_concurrent);
+        std::vector<std::thread> threads;
+        for (std::size_t w = 1; w < workers; ++w) threads.emplace_back(work);
+        work();
+        for (auto& thread : threads) thread.join();
+        return results;
+    }
+
+    protocol::Message SubAgentPool::run_child(const std::vector<protocol::Message>& prefix,
+                                              const SubAgentTask& task) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            slot_freed_.wait(lock, [&] { return running_ < options_.max_concurrent; });
+            ++running_;
+            ++stats_.spawned;
+            stats_.peak_concurrent = std::max(stats_.peak_concurrent, running_);
+        }
+
+        // A fork that ends on the parent's user turn takes the task into it,
+        // so that the child's history still alternates
+        std::vector<protocol::Message> history = prefix;
+        if (!history.empty() && history.back().role == protocol::Role::User) {
+            history.back().content.append("\n\n").append(task.prompt);
+        } else {
+            history.push_back(
+                protocol::Message{protocol::Role::User, task.prompt, {}, std::nullopt});
+        }
+        const std::size_t forked = history.size();
+
+        BudgetedProvider provider(*this);
+        LoopOptions loop_options;
+        loop_options.run_id = std::string("sub-").append(task.tool_call_id);
+        loop_options.max_turns = options_.max_turns;
+        loop_options.speculative_tools = options_.speculative_tools;
+        loop_options.params = options_.params;
+        AgentLoop loop(provider, dispatcher_, std::move(loop_options));
+        auto outcome = loop.run(history, [](const protocol::AgentEvent&) {});
+
+        // 3. The child's last assistant message is its answer to the parent.
+        //    A turn limit or an error can leave tool results after it, or
+        //    stop the child before it says anything at all.
+        const protocol::Message* answer = nullptr;
+        for (std::size_t i = history.size(); i > forked && !answer; --i) {
+            if (history[i - 1].role == protocol::Role::Assistant) answer = &history[i - 1];
+        }
+        bool finished = !errors::is_error(outcome) &&
+                        errors::get_value(outcome) == protocol::StopReason::Finished;
+        std::string content;
+        if (errors::is_error(outcome)) {
+            const std::string& reason = errors::get_error(outcome).message;
+            LOG_WARN(std::string("Sub-agent ").append(task.tool_call_id).append(" failed: ")
+                         .append(reason));
+            content = answer ? answer->content + "\n[Truncated: " + reason + "]"
+                             : std::string("Sub-agent failed: ").append(reason);
+        } else {
+            if (answer) content = answer->content;
+            if (!finished) content += "\n[Truncated: the sub-agent stopped before finishing]";
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            --running_;
+            ++(finished ? stats_.finished : stats_.failed);
+        }
+        slot_freed_.notify_one();
+        return protocol::Message{protocol::Role::Tool, std::move(content), {}, task.tool_call_id};
+    }
+
+    errors::Status SubAgentPool::reserve(std::size_t tokens, std::size_t child_tokens) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool child_over = options_.child_token_budget > 0 &&
+                          child_tokens + tokens > options_.child_token_budget;
+        bool pool_over = options_.token_budget > 0 &&
+                         stats_.tokens + reserved_ + tokens > options_.token_budget;
+        if (child_over || pool_over) {
+            ++stats_.refused;
+            std::string message(child_over ? "Sub-agent" : "Sub-agent pool");
+            message.append(" token budget exhausted; the next request needs about ")
+                .append(std::to_string(tokens))
+                .append(" tokens");
+            return errors::AgentError{errors::ErrorCategory::Policy, std::move(message)};
+        }
+        reserved_ += tokens;
+        return std::monostate{};
+    }
+
+    void SubAgentPool::settle(std::size_t reserved, std::size_t used) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        reserved_ -= reserved;
+        stats_.tokens += used;
+    }
+
+    SubAgentStats SubAgentPool::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+} // namespace agent::core::loop
@@ -0,0 +1,99 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "core/context/token_estimator.hpp"
+#include "core/errors/agent_errors.hpp"
+#include "core/tools/tool_dispatcher.hpp"
+#include "protocol/message_contract.hpp"
+#include "providers/provider.hpp"
+
+namespace agent::core::loop {
+
+    struct SubAgentOptions {
+        std::size_t max_concurrent = 4;      // Children running at once, across every fan_out()
+        std::size_t token_budget = 0;        // Prompt plus output tokens of all children; 0: none
+        std::size_t child_token_budget = 0;  // The same for each child; 0: none
+        int max_turns = 16;
+        bool speculative_tools = true;
+        providers::ModelParams params;
+    };
+
+    // One piece of delegated work
+    struct SubAgentTask {
+        std::string tool_call_id;  // The parent's call that the child's result answers
+        std::string prompt;        // What the child is asked to do
+    };
+
+    struct SubAgentStats {
+        std::size_t spawned = 0;
+        std::size_t finished = 0;         // Ended with StopReason::Finished
+        std::size_t failed = 0;           // Anything else: errors, turn limit, budget
+        std::size_t refused = 0;          // Requests turned away by a token budget
+        std::size_t tokens = 0;           // Charged against token_budget so far
+        std::size_t peak_concurrent = 0;
+    };
+
+    // Runs sub-agents for the main agent: each child gets a fork of the
+    // parent's conversation plus its own task (folded into the fork's
+    // trailing user message, or after the parent's request when the fork
+    // ends on a tool result, so roles keep alternating), runs its own
+    // AgentLoop, and answers with its last assistant message.
+    //
+    // Children share what the parent has: the provider (and so its
+    // connection pool), and the dispatcher's tools with their file cache,
+    // indexes and memo. All of these are safe to call from several threads.
+    // Forking copies the parent's history once per child, and every child
+    // sends the same leading bytes, so the provider's prompt cache serves
+    // the shared part for all of them.
+    //
+    // The pool, not each fan_out(), owns the limits: max_concurrent and
+    // token_budget hold across every fan_out() running at the same time.
+    // Each request is charged its estimated prompt tokens (messages and
+    // tool schemas, through the shared TokenEstimator) plus
+    // params.max_output_tokens up front and settled once the reply is in,
+    // so the budget is never overrun; a child whose next request does not
+    // fit stops with an ErrorCategory::Policy error.
+    class SubAgentPool {
+    public:
+        SubAgentPool(providers::Provider& provider, const tools::ToolDispatcher& dispatcher,
+                     context::TokenEstimator& estimator, SubAgentOptions options);
+
+        SubAgentPool(const SubAgentPool&) = delete;
+        SubAgentPool& operator=(const SubAgentPool&) = delete;
+
+        // Runs one child per task and returns one Role::Tool message per
+        // task, in task order, ready to append to the parent's history. A
+        // trailing assistant message of `parent` that makes tool calls (the
+        // one asking for the fan-out) is not part of the fork, except that
+        // its text stays when the fork would otherwise end on a tool result.
+        std::vector<protocol::Message> fan_out(const std::vector<protocol::Message>& parent,
+                                               const std::vector<SubAgentTask>& tasks);
+
+        SubAgentStats stats() const;
+
+    private:
+        class BudgetedProvider;
+
+        providers::Provider& provider_;
+        const tools::ToolDispatcher& dispatcher_;
+        context::TokenEstimator& estimator_;
+        SubAgentOptions options_;
+
+        mutable std::mutex mutex_;
+        std::condition_variable slot_freed_;
+        std::size_t running_ = 0;
+        std::size_t reserved_ = 0;  // Charged up front for requests still in flight
+        SubAgentStats stats_;
+
+        protocol::Message run_child(const std::vector<protocol::Message>& prefix,
+                                    const SubAgentTask& task);
+
+        // Budget accounting for one request; reserve() fails when it does not fit
+        errors::Status reserve(std::size_t tokens, std::size_t child_tokens);
+        void settle(std::size_t reserved, std::size_t used);
+    };
+
+} // namespace agent::core::loop
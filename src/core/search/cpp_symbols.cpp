@@ -0,0 +1,811 @@
+#include "core/search/cpp_symbols.hpp"
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <unordered_set>
+#include <utility>
+
+namespace agent::core::search {
+
+    namespace {
+
+        constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        constexpr std::array<std::string_view, 8> kKindNames = {
+            "namespace", "class", "struct", "union", "enum", "function", "macro", "alias"};
+
+        // Words that are never the name of a function being declared
+        bool reserved(std::string_view word) {
+            static const std::unordered_set<std::string_view> kWords = {
+                "alignas", "alignof", "asm", "auto", "bool", "break", "case", "catch", "char",
+                "char8_t", "char16_t", "char32_t", "class", "const", "const_cast", "consteval",
+                "constexpr", "constinit", "continue", "co_await", "co_return", "co_yield",
+                "decltype", "default", "delete", "do", "double", "dynamic_cast", "else", "enum",
+                "explicit", "extern", "float", "for", "friend", "goto", "if", "inline", "int",
+                "long", "mutable", "namespace", "new", "noexcept", "private", "protected",
+                "public", "register", "reinterpret_cast", "requires", "return", "short",
+                "signed", "sizeof", "static", "static_assert", "static_cast", "struct",
+                "switch", "template", "this", "thread_local", "throw", "try", "typedef",
+                "typeid", "typename", "union", "unsigned", "using", "virtual", "void",
+                "volatile", "wchar_t", "while", "_Alignas", "_Static_assert", "__asm__",
+                "__attribute__", "__declspec", "__typeof__", "typeof"};
+            return kWords.count(word) > 0;
+        }
+
+        // Words followed by a parenthesized group that is not a parameter list
+        bool group_word(std::string_view word) {
+            return word == "__attribute__" || word == "__declspec" || word == "alignas" ||
+                   word == "_Alignas" || word == "decltype" || word == "sizeof" ||
+                   word == "alignof" || word == "noexcept" || word == "requires" ||
+                   word == "typeof" || word == "__typeof__" || word == "throw" ||
+                   word == "asm" || word == "__asm__";
+        }
+
+        bool identifier_byte(char c) {
+            auto u = static_cast<unsigned char>(c);
+            return (u >= 'a' && u <= 'z') || (u >= 'A' && u <= 'Z') || (u >= '0' && u <= '9') ||
+                   u == '_' || u == '$' || u >= 0x80;
+        }
+
+        bool digit(char c) { return c >= '0' && c <= '9'; }
+
+        std::string join(std::string_view outer, std::string_view inner) {
+            if (outer.empty()) return std::string(inner);
+            if (inner.empty()) return std::string(outer);
+            std::string joined;
+            joined.reserve(outer.size() + 2 + inner.size());
+            joined.append(outer).append("::").append(inner);
+            return joined;
+        }
+
+        enum class TokenKind { Identifier, Punct, Literal, End };
+
+        struct Token {
+            TokenKind kind = TokenKind::End;
+            std::string_view text;  // "::" is one token; every other punctuator is one byte
+            std::uint32_t line = 0;
+        };
+
+        // Splits source into identifiers, literals and punctuation, dropping
+        // comments and preprocessor lines. #define names are reported to
+        // macros as they go by.
+        class Lexer {
+        public:
+            Lexer(std::string_view text, std::vector<Symbol>& macros)
+                : text_(text), macros_(macros) {}
+
+            Token next() {
+                while (pos_ < text_.size()) {
+                    char c = text_[pos_];
+                    if (c == '\n') {
+                        ++line_;
+                        ++pos_;
+                        line_start_ = true;
+                    } else if (c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v') {
+                        ++pos_;
+                    } else if (c == '\\' && peek(1) == '\n') {
+                        pos_ += 2;
+                        ++line_;
+                    } else if (c == '#' && line_start_) {
+                        directive();
+                    } else if (c == '/' && peek(1) == '/') {
+                        skip_line_comment();
+                    } else if (c == '/' && peek(1) == '*') {
+                        skip_block_comment();
+                    } else {
+                        line_start_ = false;
+                        return token();
+                    }
+                }
+                return Token{TokenKind::End, {}, line_};
+            }
+
+        private:
+            std::string_view text_;
+            std::vector<Symbol>& macros_;
+            std::size_t pos_ = 0;
+            std::uint32_t line_ = 1;
+            bool line_start_ = true;
+            int braces_ = 0;                // Opened minus closed so far
+            std::vector<int> conditions_;   // braces_ at each open #if
+
+            char peek(std::size_t ahead) const {
+                return pos_ + ahead < text_.size() ? text_[pos_ + ahead] : '\0';
+            }
+
+            Token token() {
+                std::size_t start = pos_;
+                std::uint32_t line = line_;
+                auto literal = [&] {
+                    return Token{TokenKind::Literal, text_.substr(start, pos_ - start), line};
+                };
+                char c = text_[pos_];
+                if (identifier_byte(c) && !digit(c)) {
+                    while (pos_ < text_.size() && identifier_byte(text_[pos_])) ++pos_;
+                    std::string_view word = text_.substr(start, pos_ - start);
+                    char quote = peek(0);
+                    if (quote == '"' && (word == "R" || word == "LR" || word == "uR" ||
+                                         word == "UR" || word == "u8R")) {
+                        raw_string();
+                        return literal();
+                    }
+                    if ((quote == '"' || quote == '\'') &&
+                        (word == "L" || word == "u" || word == "U" || word == "u8")) {
+                        quoted(quote);
+                        return literal();
+                    }
+                    return Token{TokenKind::Identifier, word, line};
+                }
+                if (digit(c) || (c == '.' && digit(peek(1)))) {
+                    ++pos_;
+                    while (pos_ < text_.size()) {
+                        char d = text_[pos_];
+                        char previous = static_cast<char>(text_[pos_ - 1] | 0x20);
+                        if (identifier_byte(d) || d == '.') {
+                            ++pos_;
+                        } else if (d == '\'' && identifier_byte(peek(1))) {
+                            ++pos_;  // Digit separator
+                        } else if ((d == '+' || d == '-') && (previous == 'e' || previous == 'p')) {
+                            ++pos_;
+                        } else {
+                            break;
+                        }
+                    }
+                    return literal();
+                }
+                if (c == '"' || c == '\'') {
+                    quoted(c);
+                    return literal();
+                }
+                pos_ += c == ':' && peek(1) == ':' ? 2 : 1;
+                if (c == '{') ++braces_;
+                if (c == '}') --braces_;
+                return Token{TokenKind::Punct, text_.substr(start, pos_ - start), line};
+            }
+
+            void quoted(char quote) {
+                ++pos_;
+                while (pos_ < text_.size()) {
+                    char c = text_[pos_];
+                    if (c == '\\') {
+                        if (peek(1) == '\n') ++line_;
+                        pos_ = std::min(pos_ + 2, text_.size());
+                    } else if (c == '\n') {
+                        return;  // Unterminated: give up at the end of the line
+                    } else {
+                        ++pos_;
+                        if (c == quote) return;
+                    }
+                }
+            }
+
+            // R"delimiter( ... )delimiter"
+            void raw_string() {
+                std::size_t open = text_.find('(', pos_ + 1);
+                if (open == std::string_view::npos || open - pos_ - 1 > 16) {
+                    quoted('"');
+                    return;
+                }
+                std::string closing(1, ')');
+                closing.append(text_.substr(pos_ + 1, open - pos_ - 1)).push_back('"');
+                std::size_t end = text_.find(closing, open + 1);
+                std::size_t stop = end == std::string_view::npos ? text_.size()
+                                                                  : end + closing.size();
+                line_ += static_cast<std::uint32_t>(
+                    std::count(text_.begin() + static_cast<std::ptrdiff_t>(pos_),
+                               text_.begin() + static_cast<std::ptrdiff_t>(stop), '\n'));
+                pos_ = stop;
+            }
+
+            void skip_line_comment() {
+                while (pos_ < text_.size() && text_[pos_] != '\n') {
+                    if (text_[pos_] == '\\' && peek(1) == '\n') {
+                        pos_ += 2;
+                        ++line_;
+                    } else {
+                        ++pos_;
+                    }
+                }
+            }
+
+            void skip_block_comment() {
+                std::size_t end = text_.find("*/", pos_ + 2);
+                std::size_t stop = end == std::string_view::npos ? text_.size() : end + 2;
+                line_ += static_cast<std::uint32_t>(
+                    std::count(text_.begin() + static_cast<std::ptrdiff_t>(pos_),
+                               text_.begin() + static_cast<std::ptrdiff_t>(stop), '\n'));
+                pos_ = stop;
+            }
+
+            void skip_blanks() {
+                while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t')) ++pos_;
+            }
+
+            std::string_view word() {
+                std::size_t start = pos_;
+                while (pos_ < text_.size() && identifier_byte(text_[pos_])) ++pos_;
+                return text_.substr(start, pos_ - start);
+            }
+
+            void directive() {
+                ++pos_;
+                skip_blanks();
+                std::string_view name = word();
+                if (name == "define") {
+                    skip_blanks();
+                    std::string_view macro = word();
+                    if (!macro.empty()) {
+                        macros_.push_back(
+                            Symbol{std::string(macro), "", SymbolKind::Macro, line_, true});
+                    }
+                } else if (name.starts_with("if")) {
+                    conditions_.push_back(braces_);
+                    skip_blanks();
+                    if (name == "if" && peek(0) == '0' && !identifier_byte(peek(1))) {
+                        skip_directive_rest();
+                        if (!skip_conditional(true)) conditions_.pop_back();
+                        return;
+                    }
+                } else if (name == "else" || name.starts_with("elif")) {
+                    // Every branch is read, unless the first one opened or closed
+                    // braces: then the others most likely do the same again
+                    // (#ifdef X / void f() { / #else / void f(int) { / #endif)
+                    if (!conditions_.empty() && conditions_.back() != braces_) {
+                        skip_directive_rest();
+                        skip_conditional(false);
+                        conditions_.pop_back();
+                        return;
+                    }
+                } else if (name == "endif") {
+                    if (!conditions_.empty()) conditions_.pop_back();
+                }
+                skip_directive_rest();
+            }
+
+            // Up to the newline ending the directive, across continuations
+            void skip_directive_rest() {
+                while (pos_ < text_.size()) {
+                    char c = text_[pos_];
+                    if (c == '\n') return;
+                    if (c == '\\' && peek(1) == '\n') {
+                        pos_ += 2;
+                        ++line_;
+                    } else if (c == '\\' && peek(1) == '\r' && peek(2) == '\n') {
+                        pos_ += 3;
+                        ++line_;
+                    } else if (c == '/' && peek(1) == '*') {
+                        skip_block_comment();
+                    } else if (c == '/' && peek(1) == '/') {
+                        skip_line_comment();
+                    } else if (c == '"' || c == '\'') {
+                        quoted(c);
+                    } else {
+                        ++pos_;
+                    }
+                }
+            }
+
+            // Skips lines up to the #endif closing the current conditional or,
+            // with stop_at_else, its next #else or #elif, whichever comes first;
+            // true when it stopped at the latter. Leaves pos_ on the newline
+            // ending that directive.
+            bool skip_conditional(bool stop_at_else) {
+                int depth = 0;
+                while (pos_ < text_.size()) {
+                    std::size_t end = text_.find('\n', pos_);
+                    std::string_view line = text_.substr(
+                        pos_, end == std::string_view::npos ? std::string_view::npos : end - pos_);
+                    std::size_t hash = line.find_first_not_of(" \t");
+                    if (hash != std::string_view::npos && line[hash] == '#') {
+                        std::size_t start = line.find_first_not_of(" \t", hash + 1);
+                        std::string_view name =
+                            start == std::string_view::npos ? "" : line.substr(start);
+                        bool endif = false, other = false;
+                        if (name.starts_with("if")) {
+                            ++depth;
+                        } else if (name.starts_with("endif")) {
+                            endif = depth-- == 0;
+                        } else if (name.starts_with("el")) {
+                            other = depth == 0 && stop_at_else;
+                        }
+                        if (endif || other) {
+                            pos_ = end == std::string_view::npos ? text_.size() : end;
+                            return other;
+                        }
+                    }
+                    if (end == std::string_view::npos) break;
+                    pos_ = end + 1;
+                    ++line_;
+                }
+                pos_ = text_.size();
+                return false;
+            }
+        };
+
+        // Reads declarations off a token stream one statement at a time. A
+        // statement runs up to ';' or to a '{' opening a scope or a body;
+        // initializer braces and function bodies are skipped whole.
+        class Extractor {
+        public:
+            explicit Extractor(std::string_view text) : lexer_(text, symbols_) {}
+
+            std::vector<Symbol> run() {
+                for (Token token = lexer_.next(); token.kind != TokenKind::End;
+                     token = lexer_.next()) {
+                    if (token.kind == TokenKind::Punct) {
+                        if (token.text == ";") {
+                            declaration();
+                            statement_.clear();
+                            continue;
+                        }
+                        if (token.text == "{") {
+                            open_brace(token);
+                            continue;
+                        }
+                        if (token.text == "}") {
+                            close_brace(token);
+                            continue;
+                        }
+                        if (token.text == ":" && access_specifier()) {
+                            statement_.clear();
+                            continue;
+                        }
+                    }
+                    // Nothing this long is a declaration worth reading
+                    if (statement_.size() == kMaxStatement) statement_.clear();
+                    statement_.push_back(token);
+                }
+                return std::move(symbols_);
+            }
+
+        private:
+            static constexpr std::size_t kMaxStatement = 1024;
+
+            struct Scope {
+                std::string qualified;      // Of everything declared inside
+                std::string_view name;      // A class's own name, for its constructors
+                bool typedef_name = false;  // typedef struct { ... } name;
+            };
+
+            // Where the parts of a statement are, by token index
+            struct Shape {
+                std::size_t begin = 0;      // After any template<...> headers
+                std::size_t key = npos;     // class, struct, union or enum
+                std::size_t op = npos;      // operator
+                std::size_t paren = npos;   // The first '(' that may open a parameter list
+                bool assign = false;        // An '=' came before it
+                bool is_friend = false;
+            };
+
+            struct Name {
+                std::string name;
+                std::string qualifier;  // From a qualified name: Lexer::next -> "Lexer"
+                std::size_t first = 0;  // Where the qualified name starts
+                std::uint32_t line = 0;
+            };
+
+            std::vector<Symbol> symbols_;
+            Lexer lexer_;
+            std::vector<Scope> scopes_;
+            std::vector<Token> statement_;
+
+            std::string_view text(std::size_t i) const {
+                return i < statement_.size() ? statement_[i].text : std::string_view();
+            }
+
+            std::string_view scope() const {
+                if (scopes_.empty()) return {};
+                return scopes_.back().qualified;
+            }
+
+            void add(std::string name, std::string_view qualifier, SymbolKind kind,
+                     std::uint32_t line, bool definition) {
+                symbols_.push_back(
+                    Symbol{std::move(name), join(scope(), qualifier), kind, line, definition});
+            }
+
+            void skip_block() {
+                int depth = 1;
+                for (Token token = lexer_.next(); token.kind != TokenKind::End;
+                     token = lexer_.next()) {
+                    if (token.kind != TokenKind::Punct) continue;
+                    if (token.text == "{") {
+                        ++depth;
+                    } else if (token.text == "}" && --depth == 0) {
+                        return;
+                    }
+                }
+            }
+
+            // Stands in for a skipped initializer so the statement goes on
+            static Token braces(const Token& at) { return Token{TokenKind::Punct, "{}", at.line}; }
+
+            bool access_specifier() const {
+                std::string_view first = text(0);
+                return statement_.size() <= 2 &&
+                       (first == "public" || first == "protected" || first == "private");
+            }
+
+            std::size_t closing_paren(std::size_t open) const {
+                int depth = 0;
+                for (std::size_t i = open; i < statement_.size(); ++i) {
+                    if (statement_[i].text == "(") ++depth;
+                    if (statement_[i].text == ")" && --depth == 0) return i;
+                }
+                return npos;
+            }
+
+            std::size_t skip_template_headers(std::size_t i) const {
+                while (i < statement_.size()) {
+                    if (text(i) == "export") {
+                        ++i;
+                        continue;
+                    }
+                    if (text(i) != "template" || text(i + 1) != "<") break;
+                    int angles = 0, parens = 0;
+                    std::size_t j = i + 1;
+                    for (; j < statement_.size(); ++j) {
+                        std::string_view t = text(j);
+                        if (t == "(") ++parens;
+                        if (t == ")") --parens;
+                        if (parens > 0) continue;
+                        if (t == "<") ++angles;
+                        if (t == ">" && --angles == 0) break;
+                    }
+                    i = j + 1;
+                }
+                return i;
+            }
+
+            Shape shape(std::size_t begin) const {
+                Shape s;
+                s.begin = skip_template_headers(begin);
+                int parens = 0, angles = 0;
+                for (std::size_t i = s.begin; i < statement_.size(); ++i) {
+                    const Token& token = statement_[i];
+                    std::string_view t = token.text;
+                    if (token.kind == TokenKind::Identifier) {
+                        if (parens > 0) continue;
+                        if (t == "friend") {
+                            s.is_friend = true;
+                        } else if (s.key == npos && angles == 0 &&
+                                   (t == "class" || t == "struct" || t == "union" ||
+                                    t == "enum")) {
+                            s.key = i;
+                        } else if (t == "operator" && angles == 0) {
+                            // The parameter list follows the operator's symbol,
+                            // which for operator() is itself "()"
+                            s.op = i;
+                            std::size_t j = i + 1;
+                            if (text(j) == "(" && text(j + 1) == ")") j += 2;
+                            while (j < statement_.size() && text(j) != "(") ++j;
+                            if (j < statement_.size()) s.paren = j;
+                            return s;
+                        }
+                        continue;
+                    }
+                    if (token.kind != TokenKind::Punct) continue;
+                    if (t == "(" || t == "[") {
+                        bool parameters = t == "(" && parens == 0 && angles == 0 &&
+                                          !(i > s.begin && group_word(text(i - 1)));
+                        if (parameters) {
+                            s.paren = i;
+                            return s;
+                        }
+                        ++parens;
+                    } else if (t == ")" || t == "]") {
+                        if (parens > 0) --parens;
+                    } else if (parens > 0) {
+                        continue;
+                    } else if (t == "<") {
+                        if (i > s.begin && statement_[i - 1].kind == TokenKind::Identifier) {
+                            ++angles;
+                        }
+                    } else if (t == ">") {
+                        if (angles > 0) --angles;
+                    } else if (t == "=" && angles == 0) {
+                        s.assign = true;
+                        return s;
+                    } else if (t == ":" && s.key != npos && angles == 0) {
+                        return s;  // A base clause
+                    }
+                }
+                return s;
+            }
+
+            // Adds ns::Class<T>:: qualifiers ahead of the name at i to name
+            void qualify(Name& name, std::size_t i, std::size_t begin) const {
+                while (i >= begin + 2 && text(i - 1) == "::") {
+                    std::size_t q = i - 2;
+                    if (text(q) == ">") {
+                        int depth = 0;
+                        while (true) {
+                            if (text(q) == ">") ++depth;
+                            if (text(q) == "<" && --depth == 0) break;
+                            if (q == begin) return;
+                            --q;
+                        }
+                        if (q == begin) break;
+                        --q;
+                    }
+                    if (statement_[q].kind != TokenKind::Identifier) break;
+                    name.qualifier = join(statement_[q].text, name.qualifier);
+                    i = q;
+                }
+                if (i > begin && text(i - 1) == "::") --i;  // ::global
+                name.first = i;
+            }
+
+            std::optional<Name> function_name(const Shape& s) const {
+                if (s.paren == npos) return std::nullopt;
+                Name name;
+                std::size_t i;
+                if (s.op != npos) {
+                    i = s.op;
+                    name.name = "operator";
+                    for (std::size_t j = s.op + 1; j < s.paren; ++j) {
+                        if (statement_[j].kind == TokenKind::Identifier &&
+                            identifier_byte(name.name.back())) {
+                            name.name += ' ';  // operator const char*
+                        }
+                        name.name += statement_[j].text;
+                    }
+                } else {
+                    if (s.paren == s.begin) return std::nullopt;
+                    i = s.paren - 1;
+                    const Token& token = statement_[i];
+                    if (token.kind != TokenKind::Identifier || reserved(token.text)) {
+                        return std::nullopt;
+                    }
+                    if (i > s.begin && text(i - 1) == "~") {
+                        name.name = '~';
+                        --i;
+                    }
+                    name.name += token.text;
+                }
+                name.line = statement_[s.op != npos ? s.op : s.paren - 1].line;
+                qualify(name, i, s.begin);
+                return name;
+            }
+
+            // A name with nothing ahead of it is a constructor, a destructor or
+            // a conversion operator; anything else there is a macro call.
+            bool declares(const Name& name, const Shape& s) const {
+                if (name.first != s.begin || s.op != npos) return true;
+                std::string_view bare = name.name;
+                if (bare.starts_with("~")) bare.remove_prefix(1);
+                if (!name.qualifier.empty()) {
+                    std::size_t last = name.qualifier.rfind("::");
+                    return name.qualifier.substr(last == std::string::npos ? 0 : last + 2) == bare;
+                }
+                return !scopes_.empty() && scopes_.back().name == bare && !bare.empty();
+            }
+
+            // The function a statement declares, if any; looks past leading
+            // macro calls such as EXPORT(x) void f()
+            std::optional<Name> find_function(Shape& s) const {
+                std::size_t begin = 0;
+                while (begin < statement_.size()) {
+                    s = shape(begin);
+                    if (s.assign || s.paren == npos) return std::nullopt;
+                    auto name = function_name(s);
+                    if (name && declares(*name, s)) return name;
+                    if (s.paren != s.begin + 1 || s.op != npos) return std::nullopt;
+                    std::size_t close = closing_paren(s.paren);
+                    if (close == npos) return std::nullopt;
+                    begin = close + 1;
+                }
+                return std::nullopt;
+            }
+
+            void declaration() {
+                std::size_t begin = skip_template_headers(0);
+                if (begin >= statement_.size()) return;
+                std::string_view first = text(begin);
+                if (first == "using") {
+                    if (statement_.size() > begin + 2 &&
+                        statement_[begin + 1].kind == TokenKind::Identifier &&
+                        text(begin + 2) == "=") {
+                        add(std::string(text(begin + 1)), "", SymbolKind::Alias,
+                            statement_[begin + 1].line, true);
+                    }
+                    return;
+                }
+                if (first == "typedef") {
+                    typedef_name(begin);
+                    return;
+                }
+                Shape s;
+                auto name = find_function(s);
+                if (name && !s.is_friend) {
+                    add(std::move(name->name), name->qualifier, SymbolKind::Function, name->line,
+                        false);
+                }
+            }
+
+            // typedef unsigned long size_type; typedef struct {...} point;
+            // typedef void (*handler)(int);
+            void typedef_name(std::size_t begin) {
+                std::size_t found = npos;
+                int depth = 0;
+                for (std::size_t i = begin + 1; i < statement_.size(); ++i) {
+                    std::string_view t = text(i);
+                    if (t == "(" && depth == 0 && (text(i + 1) == "*" || text(i + 1) == "^")) {
+                        std::size_t j = i + 1;
+                        while (text(j) == "*" || text(j) == "^") ++j;
+                        if (j < statement_.size() &&
+                            statement_[j].kind == TokenKind::Identifier) {
+                            found = j;
+                        }
+                        break;
+                    }
+                    if (t == "(" || t == "[" || t == "<") {
+                        ++depth;
+                    } else if (t == ")" || t == "]" || t == ">") {
+                        if (depth > 0) --depth;
+                    } else if (depth == 0 && statement_[i].kind == TokenKind::Identifier &&
+                               !reserved(t)) {
+                        found = i;
+                    }
+                }
+                if (found != npos) {
+                    add(std::string(text(found)), "", SymbolKind::Alias, statement_[found].line,
+                        true);
+                }
+            }
+
+            void open_brace(const Token& brace) {
+                if (statement_.empty()) {
+                    skip_block();  // A bare block
+                    return;
+                }
+                std::size_t first = text(0) == "inline" ? 1 : 0;
+                if (text(first) == "namespace") {
+                    open_namespace(first + 1);
+                    return;
+                }
+                if (statement_.size() == 2 && text(0) == "extern" &&
+                    statement_[1].kind == TokenKind::Literal) {
+                    scopes_.push_back(Scope{std::string(scope()), {}, false});  // extern "C"
+                    statement_.clear();
+                    return;
+                }
+
+                Shape s = shape(0);
+                if (s.key != npos && s.paren == npos && !s.assign) {
+                    open_class(s, brace);
+                    return;
+                }
+                if (s.paren != npos && !s.assign) {
+                    if (member_initializer(s)) {
+                        skip_block();
+                        statement_.push_back(braces(brace));
+                        return;
+                    }
+                    if (auto name = find_function(s)) {
+                        add(std::move(name->name), name->qualifier, SymbolKind::Function,
+                            name->line, true);
+                    }
+                    skip_block();  // The body
+                    statement_.clear();
+                    return;
+                }
+                // An initializer: int table[] = {...}, Point p{1, 2}, a lambda
+                skip_block();
+                statement_.push_back(braces(brace));
+            }
+
+            // Foo(int x) : a_(x), b_{x} { -- the brace after b_ initializes a member
+            bool member_initializer(const Shape& s) const {
+                std::size_t close = closing_paren(s.paren);
+                if (close == npos) return false;
+                bool colon = false;
+                for (std::size_t i = close + 1; i < statement_.size() && !colon; ++i) {
+                    colon = text(i) == ":";
+                }
+                const Token& last = statement_.back();
+                return colon && (last.kind == TokenKind::Identifier || last.text == ">");
+            }
+
+            // namespace [[attr]] a::inline b MACRO(x) {: the name is what "::"
+            // joins; anything after it is an attribute or a macro
+            void open_namespace(std::size_t i) {
+                std::string qualified(scope());
+                int brackets = 0;
+                bool more = true;
+                for (; i < statement_.size(); ++i) {
+                    const Token& token = statement_[i];
+                    if (token.text == "[") ++brackets;
+                    if (token.text == "]") --brackets;
+                    if (token.text == "::") more = true;
+                    if (token.kind != TokenKind::Identifier || brackets > 0 ||
+                        token.text == "inline") {
+                        continue;
+                    }
+                    if (!more) break;
+                    more = false;
+                    symbols_.push_back(Symbol{std::string(token.text), qualified,
+                                              SymbolKind::Namespace, token.line, true});
+                    qualified = join(qualified, token.text);
+                }
+                scopes_.push_back(Scope{std::move(qualified), {}, false});
+                statement_.clear();
+            }
+
+            void open_class(const Shape& s, const Token& brace) {
+                std::string_view keyword = text(s.key);
+                SymbolKind kind = keyword == "class"    ? SymbolKind::Class
+                                  : keyword == "struct" ? SymbolKind::Struct
+                                  : keyword == "union"  ? SymbolKind::Union
+                                                        : SymbolKind::Enum;
+                std::size_t i = s.key + 1;
+                if (kind == SymbolKind::Enum && (text(i) == "class" || text(i) == "struct")) ++i;
+
+                // The name is the last identifier before any base clause, past
+                // attributes, export macros and template arguments:
+                // class [[nodiscard]] API Foo<T> final : public Base
+                std::size_t found = npos;
+                int depth = 0;
+                for (; i < statement_.size(); ++i) {
+                    std::string_view t = text(i);
+                    if (t == "(" || t == "[" || t == "<") {
+                        ++depth;
+                    } else if (t == ")" || t == "]" || t == ">") {
+                        if (depth > 0) --depth;
+                    } else if (depth == 0 && t == ":") {
+                        break;
+                    } else if (depth == 0 && statement_[i].kind == TokenKind::Identifier &&
+                               t != "final" && t != "sealed" && !group_word(t)) {
+                        found = i;
+                    }
+                }
+
+                Name name;
+                if (found != npos) {
+                    name.name = text(found);
+                    qualify(name, found, s.key + 1);
+                    add(name.name, name.qualifier, kind, statement_[found].line, true);
+                }
+                if (kind == SymbolKind::Enum) {
+                    skip_block();  // Enumerators are not indexed
+                    statement_.push_back(braces(brace));
+                    return;
+                }
+                std::string qualified = found == npos
+                                            ? std::string(scope())
+                                            : join(join(scope(), name.qualifier), name.name);
+                std::string_view bare = found == npos ? std::string_view() : text(found);
+                scopes_.push_back(Scope{std::move(qualified), bare, text(0) == "typedef"});
+                statement_.clear();
+            }
+
+            void close_brace(const Token& brace) {
+                statement_.clear();
+                if (scopes_.empty()) return;  // Unbalanced, e.g. by a macro
+                bool typedef_name = scopes_.back().typedef_name;
+                scopes_.pop_back();
+                if (typedef_name) {
+                    statement_.push_back(Token{TokenKind::Identifier, "typedef", brace.line});
+                    statement_.push_back(braces(brace));
+                }
+            }
+        };
+
+    } // namespace
+
+    std::string_view to_string(SymbolKind kind) {
+        return kKindNames[static_cast<std::size_t>(kind)];
+    }
+
+    std::optional<SymbolKind> symbol_kind_from(std::string_view name) {
+        for (std::size_t i = 0; i < kKindNames.size(); ++i) {
+            if (kKindNames[i] == name) return static_cast<SymbolKind>(i);
+        }
+        return std::nullopt;
+    }
+
+    std::vector<Symbol> extract_cpp_symbols(std::string_view text) {
+        return Extractor(text).run();
+    }
+
+} // namespace agent::core::search
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace agent::core::search {
+
+    enum class SymbolKind { Namespace, Class, Struct, Union, Enum, Function, Macro, Alias };
+
+    std::string_view to_string(SymbolKind kind);
+    std::optional<SymbolKind> symbol_kind_from(std::string_view name);
+
+    struct Symbol {
+        std::string name;    // Unqualified: "parse", "~Lexer", "operator=="
+        std::string scope;   // Enclosing namespaces and classes: "agent::core::Lexer"
+        SymbolKind kind = SymbolKind::Function;
+        std::uint32_t line = 0;   // 1-based
+        bool definition = true;   // false for a function declared but not defined here
+    };
+
+    // Namespaces, classes (structs, unions, enums), functions, macros and type
+    // aliases declared in C or C++ source, in source order.
+    //
+    // This works on tokens, not a parse: it follows braces to know which
+    // namespace or class it is in, skips function bodies and initializers
+    // without looking inside, and reads declarations off the shape of each
+    // statement. Every branch of an #if is read unless the first one leaves
+    // braces unbalanced, in which case only that one is (so that two
+    // versions of a function header do not open two bodies); #if 0 blocks
+    // are skipped. Unusual code (macros that expand to declarations, say) is
+    // missed or misreported rather than rejected.
+    std::vector<Symbol> extract_cpp_symbols(std::string_view text);
+
+} // namespace agent::core::search
@@ -0,0 +1,231 @@
+#include "core/search/grep.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include "core/fs/ignore_rules.hpp"
+#include "core/fs/mapped_file.hpp"
+#include "core/fs/text_scan.hpp"
+#include "core/search/literal_finder.hpp"
+
+namespace agent::core::search {
+
+    namespace {
+
+        std::size_t line_start(std::string_view text, std::size_t pos) {
+            if (pos == 0) return 0;
+            const void* hit = ::memrchr(text.data(), '\n', pos);
+            return hit ? static_cast<std::size_t>(static_cast<const char*>(hit) - text.data()) + 1
+                       : 0;
+        }
+
+        std::size_t line_end(std::string_view text, std::size_t pos) {
+            const void* hit = std::memchr(text.data() + pos, '\n', text.size() - pos);
+            return hit ? static_cast<std::size_t>(static_cast<const char*>(hit) - text.data())
+                       : text.size();
+        }
+
+        std::string clip(std::string_view line, std::size_t limit) {
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (line.size() <= limit) return std::string(line);
+            return std::string(line.substr(0, fs::utf8_floor(line, limit))) + " [...]";
+        }
+
+        // After this many candidate lines, the prefilter must have skipped at
+        // least kMinCandidateGap bytes per candidate to stay on
+        constexpr std::size_t kPrefilterProbe = 64;
+        constexpr std::size_t kMinCandidateGap = 256;
+
+        // Prefilter worth running: a short or missing literal rejects too few lines
+        std::unique_ptr<LiteralFinder> prefilter(const Regex& regex) {
+            if (regex.is_literal() ? regex.required_literal().empty()
+                                   : regex.required_literal().size() < 2) {
+                return nullptr;
+            }
+            return std::make_unique<LiteralFinder>(regex.required_literal());
+        }
+
+    } // namespace
+
+    bool grep_buffer(std::string_view text, const Regex& regex, Regex::Matcher& matcher,
+                     const GrepOptions& options,
+                     const std::function<bool(GrepMatch&&)>& on_match) {
+        auto finder = prefilter(regex);
+        std::size_t counted_to = 0;  // Newlines before here are in line_number
+        std::size_t line_number = 1;
+
+        auto report = [&](std::size_t begin, std::size_t end, std::size_t column) {
+            line_number += fs::count_newlines(text.substr(counted_to, begin - counted_to));
+            counted_to = begin;
+
+            GrepMatch match;
+            match.line = line_number;
+            match.column = column + 1;
+            match.text = clip(text.substr(begin, end - begin), options.max_line_bytes);
+
+            std::size_t cursor = begin;
+            for (std::size_t i = 0; i < options.context && cursor > 0; ++i) {
+                std::size_t prev = line_start(text, cursor - 1);
+                match.before.insert(match.before.begin(),
+                                    clip(text.substr(prev, cursor - 1 - prev),
+                                         options.max_line_bytes));
+                cursor = prev;
+            }
+            cursor = end;
+            for (std::size_t i = 0; i < options.context && cursor < text.size(); ++i) {
+                std::size_t next = line_end(text, cursor + 1);
+                match.after.push_back(
+                    clip(text.substr(cursor + 1, next - cursor - 1), options.max_line_bytes));
+                cursor = next;
+            }
+            return on_match(std::move(match));
+        };
+
+        std::size_t pos = 0;
+        std::size_t candidates = 0;
+        while (pos < text.size()) {
+            // 1. Next candidate line: from the prefilter, or a DFA pass over the buffer.
+            // A literal on nearly every line only adds per-line overhead, so drop it
+            if (finder && !regex.is_literal() && ++candidates == kPrefilterProbe &&
+                pos < kPrefilterProbe * kMinCandidateGap) {
+                finder.reset();
+            }
+            std::size_t hit = finder ? finder->find(text, pos) : matcher.scan(text, pos);
+            if (hit == std::string_view::npos) break;
+            std::size_t begin = line_start(text, hit);
+            std::size_t end = line_end(text, hit);
+            std::string_view line = text.substr(begin, end - begin);
+
+            // 2. Confirm it (a literal pattern already is) and find the column
+            std::size_t column = regex.is_literal() && finder ? hit - begin : matcher.find(line);
+            if (column != std::string_view::npos && !report(begin, end, column)) return false;
+            pos = end + 1;
+        }
+        return true;
+    }
+
+    namespace {
+
+        // Per-file work shared by grep() and grep_files(); safe to call from many threads
+        class FileSearch {
+        public:
+            FileSearch(const std::string& root, const Regex& regex, const GrepOptions& options,
+                       const std::function<void(GrepMatch&&)>& on_match)
+                : regex_(regex), options_(options), on_match_(on_match) {
+                top_ = root.size() > 1 && root.back() == '/' ? root.substr(0, root.size() - 1)
+                                                             : root;
+                if (!options.file_glob.empty()) glob_.emplace(options.file_glob);
+                glob_on_path_ = options.file_glob.find('/') != std::string::npos;
+            }
+
+            const std::string& top() const { return top_; }
+            bool done() const { return truncated_.load(std::memory_order_relaxed); }
+
+            // path is relative to the root. Returns false once max_matches is hit.
+            bool search(std::string_view path) {
+                if (done()) return false;
+                if (glob_) {
+                    std::string_view name = path;
+                    std::size_t slash = name.rfind('/');
+                    if (!glob_on_path_ && slash != std::string_view::npos) {
+                        name.remove_prefix(slash + 1);
+                    }
+                    if (!glob_->matches(name)) return true;
+                }
+
+                std::string relative(path);
+                auto file = fs::MappedFile::open(top_ + "/" + relative);
+                if (errors::is_error(file) ||
+                    errors::get_value(file).size() > options_.max_file_bytes ||
+                    fs::sniff_encoding(errors::get_value(file).bytes()) == fs::Encoding::Binary) {
+                    skipped_.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+                searched_.fetch_add(1, std::memory_order_relaxed);
+
+                grep_buffer(errors::get_value(file).bytes(), regex_, matcher_for_this_thread(),
+                            options_, [&](GrepMatch&& match) {
+                                if (found_.fetch_add(1) >= options_.max_matches) {
+                                    truncated_.store(true);
+                                    return false;
+                                }
+                                match.path = relative;
+                                std::lock_guard<std::mutex> lock(mutex_);
+                                on_match_(std::move(match));
+                                return true;
+                            });
+                return !done();
+            }
+
+            GrepStats stats() const {
+                GrepStats stats;
+                stats.files_searched = searched_.load();
+                stats.files_skipped = skipped_.load();
+                stats.matches = std::min(found_.load(), options_.max_matches);
+                stats.truncated = truncated_.load();
+                return stats;
+            }
+
+        private:
+            const Regex& regex_;
+            const GrepOptions& options_;
+            const std::function<void(GrepMatch&&)>& on_match_;
+            std::string top_;
+            std::optional<fs::Glob> glob_;
+            bool glob_on_path_ = false;
+
+            std::atomic<std::size_t> searched_{0}, skipped_{0}, found_{0};
+            std::atomic<bool> truncated_{false};
+            std::mutex mutex_;  // Serializes on_match
+
+            // One lazy DFA per thread, reused for every file that thread searches
+            std::mutex matchers_mutex_;
+            std::unordered_map<std::thread::id, std::unique_ptr<Regex::Matcher>> matchers_;
+
+            Regex::Matcher& matcher_for_this_thread() {
+                std::lock_guard<std::mutex> lock(matchers_mutex_);
+                auto& matcher = matchers_[std::this_thread::get_id()];
+                if (!matcher) matcher = std::make_unique<Regex::Matcher>(regex_);
+                return *matcher;
+            }
+        };
+
+    } // namespace
+
+    errors::Result<GrepStats> grep(const std::string& root, const Regex& regex,
+                                   const GrepOptions& options, const fs::WalkOptions& walk,
+                                   const std::function<void(GrepMatch&&)>& on_match) {
+        FileSearch search(root, regex, options, on_match);
+        auto walked = fs::walk(search.top(), walk, [&](const fs::WalkEntry& entry) {
+            return entry.is_dir ? !search.done() : search.search(entry.path);
+        });
+        if (errors::is_error(walked)) return errors::get_error(walked);
+        return search.stats();
+    }
+
+    GrepStats grep_files(const std::string& root, const std::vector<std::string>& files,
+                         const Regex& regex, const GrepOptions& options, std::size_t threads,
+                         const std::function<void(GrepMatch&&)>& on_match) {
+        FileSearch search(root, regex, options, on_match);
+        if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+        threads = std::max<std::size_t>(1, std::min(threads, files.size() / 8));
+
+        std::atomic<std::size_t> next{0};
+        auto work = [&] {
+            while (true) {
+                std::size_t i = next.fetch_add(1);
+                if (i >= files.size() || !search.search(files[i])) return;
+            }
+        };
+        std::vector<std::thread> helpers;
+        for (std::size_t i = 1; i < threads; ++i) helpers.emplace_back(work);
+        work();
+        for (auto& helper : helpers) helper.join();
+        return search.stats();
+    }
+
+} // namespace agent::core::search
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/fs/workspace_walker.hpp"
+#include "core/search/regex.hpp"
+
+namespace agent::core::search {
+
+    struct GrepOptions {
+        std::size_t context = 0;              // Lines of context before and after each match
+        std::size_t max_matches = 1000;       // The search stops once this many are found
+        std::size_t max_line_bytes = 300;     // Longer lines are clipped in the result
+        std::size_t max_file_bytes = 64u << 20;  // Larger files are skipped
+        std::string file_glob;                // e.g. "*.cpp"; matched against the name, or the
+                                              // relative path when it contains '/'
+    };
+
+    struct GrepMatch {
+        std::string path;         // Relative to the search root
+        std::size_t line = 0;     // 1-based
+        std::size_t column = 0;   // 1-based, in bytes
+        std::string text;
+        std::vector<std::string> before;
+        std::vector<std::string> after;
+    };
+
+    struct GrepStats {
+        std::size_t files_searched = 0;
+        std::size_t files_skipped = 0;  // Binary, too large, or unreadable
+        std::size_t matches = 0;
+        bool truncated = false;         // Hit max_matches
+    };
+
+    // Reports matches in one file's contents. Returns false when on_match asked to stop.
+    bool grep_buffer(std::string_view text, const Regex& regex, Regex::Matcher& matcher,
+                     const GrepOptions& options,
+                     const std::function<bool(GrepMatch&&)>& on_match);
+
+    // Searches every file the walker yields, on the walker's threads. on_match
+    // is called concurrently and in no particular order.
+    errors::Result<GrepStats> grep(const std::string& root, const Regex& regex,
+                                   const GrepOptions& options, const fs::WalkOptions& walk,
+                                   const std::function<void(GrepMatch&&)>& on_match);
+
+    // Searches just the given files (relative to root), e.g. the candidates a
+    // TrigramIndex narrowed a query down to. Threads as for grep().
+    GrepStats grep_files(const std::string& root, const std::vector<std::string>& files,
+                         const Regex& regex, const GrepOptions& options, std::size_t threads,
+                         const std::function<void(GrepMatch&&)>& on_match);
+
+} // namespace agent::core::search
@@ -0,0 +1,98 @@
+#include "core/search/literal_finder.hpp"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define AGENT_HAVE_AVX2_DISPATCH 1
+#endif
+
+namespace agent::core::search {
+
+    namespace {
+
+        // Candidates are verified in full: the first and last bytes already matched
+        inline bool verify(const char* at, std::string_view needle) {
+            return std::memcmp(at + 1, needle.data() + 1, needle.size() - 2) == 0;
+        }
+
+        std::size_t find_scalar(std::string_view hay, std::size_t from, std::string_view needle) {
+            return hay.find(needle, from);
+        }
+
+#if defined(__SSE2__)
+        std::size_t find_sse2(std::string_view hay, std::size_t from, std::string_view needle) {
+            const std::size_t n = needle.size();
+            const __m128i first = _mm_set1_epi8(needle.front());
+            const __m128i last = _mm_set1_epi8(needle.back());
+            const char* data = hay.data();
+            std::size_t i = from;
+            for (; i + n - 1 + 16 <= hay.size(); i += 16) {
+                __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+                __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + n - 1));
+                int mask = _mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(a, first), _mm_cmpeq_epi8(b, last)));
+                while (mask != 0) {
+                    std::size_t at = i + static_cast<std::size_t>(__builtin_ctz(mask));
+                    if (n <= 2 || verify(data + at, needle)) return at;
+                    mask &= mask - 1;
+                }
+            }
+            return find_scalar(hay, i, needle);
+        }
+#endif
+
+#if defined(AGENT_HAVE_AVX2_DISPATCH)
+        __attribute__((target("avx2"))) std::size_t find_avx2(std::string_view hay,
+                                                              std::size_t from,
+                                                              std::string_view needle) {
+            const std::size_t n = needle.size();
+            const __m256i first = _mm256_set1_epi8(needle.front());
+            const __m256i last = _mm256_set1_epi8(needle.back());
+            const char* data = hay.data();
+            std::size_t i = from;
+            for (; i + n - 1 + 32 <= hay.size(); i += 32) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+                __m256i b =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + n - 1));
+                auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(a, first), _mm256_cmpeq_epi8(b, last))));
+                while (mask != 0) {
+                    std::size_t at = i + static_cast<std::size_t>(__builtin_ctz(mask));
+                    if (n <= 2 || verify(data + at, needle)) return at;
+                    mask &= mask - 1;
+                }
+            }
+            return find_scalar(hay, i, needle);
+        }
+#endif
+
+    } // namespace
+
+    LiteralFinder::LiteralFinder(std::string needle) : needle_(std::move(needle)) {
+#if defined(AGENT_HAVE_AVX2_DISPATCH)
+        avx2_ = __builtin_cpu_supports("avx2");
+#endif
+    }
+
+    std::size_t LiteralFinder::find(std::string_view haystack, std::size_t from) const {
+        if (needle_.empty()) return from <= haystack.size() ? from : std::string_view::npos;
+        if (from >= haystack.size()) return std::string_view::npos;
+        if (needle_.size() == 1) {
+            const void* hit = std::memchr(haystack.data() + from, needle_[0],
+                                          haystack.size() - from);
+            return hit ? static_cast<std::size_t>(static_cast<const char*>(hit) - haystack.data())
+                       : std::string_view::npos;
+        }
+#if defined(AGENT_HAVE_AVX2_DISPATCH)
+        if (avx2_) return find_avx2(haystack, from, needle_);
+#endif
+#if defined(__SSE2__)
+        return find_sse2(haystack, from, needle_);
+#else
+        return find_scalar(haystack, from, needle_);
+#endif
+    }
+
+} // namespace agent::core::search
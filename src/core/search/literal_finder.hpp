@@ -0,0 +1,29 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace agent::core::search {
+
+    // Substring search for one fixed needle, 16 or 32 candidate positions at
+    // a time: a position is only compared in full when both the needle's
+    // first and last byte are in place. Far fewer false candidates than a
+    // memchr on the first byte alone, as source code is full of common bytes.
+    //
+    // The AVX2 path is chosen at run time, so the binary still runs on CPUs
+    // (and builds with flags) that only have SSE2.
+    class LiteralFinder {
+    public:
+        explicit LiteralFinder(std::string needle);
+
+        // Offset of the first occurrence at or after from, or npos
+        std::size_t find(std::string_view haystack, std::size_t from = 0) const;
+
+        const std::string& needle() const { return needle_; }
+
+    private:
+        std::string needle_;
+        bool avx2_ = false;
+    };
+
+} // namespace agent::core::search
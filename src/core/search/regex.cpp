@@ -0,0 +1,767 @@
+#include "core/search/regex.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+namespace agent::core::search {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+    using Op = Regex::Inst::Op;
+
+    namespace {
+
+        constexpr int kUnknownByte = -1;  // Assertions that look ahead stay pending
+        constexpr int kEndOfLine = 256;
+        constexpr int kMaxRepeat = 1000;
+
+        inline bool is_word(int byte) {
+            return byte >= 0 && byte < 256 && (std::isalnum(byte) || byte == '_');
+        }
+
+        struct Node {
+            enum class Kind { Empty, Set, Concat, Alt, Repeat, Assert } kind = Kind::Empty;
+            std::bitset<256> set;
+            int literal = -1;  // The byte, when the set is one case-sensitive byte
+            int folded = -1;   // The lowercased byte, when the set is one byte up to case
+            Op assertion = Op::Match;
+            int min = 0;
+            int max = -1;  // -1: unbounded
+            std::vector<Node> kids;
+        };
+
+        // What the longest fixed strings inside a subpattern are
+        struct LiteralInfo {
+            bool exact = false;  // Matches exactly `text` and nothing else
+            std::string text;
+            std::string prefix;  // Every match starts with this
+            std::string suffix;  // ... and ends with this
+            std::string best;    // ... and contains this somewhere
+        };
+
+        const std::string& longer(const std::string& a, const std::string& b) {
+            return b.size() > a.size() ? b : a;
+        }
+
+        // folded: treat sets that are one letter in either case as that letter
+        LiteralInfo literal_info(const Node& node, bool folded) {
+            LiteralInfo info;
+            int byte = folded ? node.folded : node.literal;
+            switch (node.kind) {
+                case Node::Kind::Empty:
+                    info.exact = true;
+                    break;
+                case Node::Kind::Set:
+                    if (byte >= 0) {
+                        info.exact = true;
+                        info.text = info.prefix = info.suffix = info.best =
+                            std::string(1, static_cast<char>(byte));
+                    }
+                    break;
+                case Node::Kind::Concat:
+                    info.exact = true;
+                    for (const auto& kid : node.kids) {
+                        LiteralInfo next = literal_info(kid, folded);
+                        std::string joined = info.suffix + next.prefix;
+                        info.best = longer(longer(info.best, next.best), joined);
+                        info.prefix = info.exact ? info.text + next.prefix : info.prefix;
+                        info.suffix = next.exact ? info.suffix + next.text : next.suffix;
+                        info.text = info.exact && next.exact ? info.text + next.text : "";
+                        info.exact = info.exact && next.exact;
+                        info.best = longer(longer(info.best, info.prefix), info.suffix);
+                    }
+                    break;
+                case Node::Kind::Repeat:
+                    if (node.min >= 1) {
+                        LiteralInfo inner = literal_info(node.kids[0], folded);
+                        if (node.min == 1 && node.max == 1) return inner;
+                        info.prefix = inner.prefix;
+                        info.suffix = inner.suffix;
+                        info.best = inner.best;
+                    }
+                    break;
+                case Node::Kind::Alt:
+                case Node::Kind::Assert:
+                    break;
+            }
+            return info;
+        }
+
+    } // namespace
+
+    // Recursive-descent parser to an AST, then Thompson construction
+    class RegexCompiler {
+    public:
+        RegexCompiler(std::string_view pattern, const RegexOptions& options, Regex& out)
+            : pattern_(pattern), options_(options), out_(out) {}
+
+        errors::Status compile() {
+            Node root;
+            if (options_.literal) {
+                root.kind = Node::Kind::Concat;
+                for (char c : pattern_) root.kids.push_back(byte_node(c));
+            } else {
+                auto parsed = parse_alt();
+                if (errors::is_error(parsed)) return errors::get_error(parsed);
+                if (pos_ < pattern_.size()) return fail("Unmatched ')'");
+                root = std::move(std::get<Node>(parsed));
+            }
+
+            LiteralInfo info = literal_info(root, false);
+            out_.is_literal_ = info.exact;
+            out_.required_ = info.exact ? info.text : info.best;
+            LiteralInfo folded = literal_info(root, true);
+            out_.folded_ = folded.exact ? folded.text : folded.best;
+
+            int match = emit({Op::Match});
+            auto fragment = build(root);
+            if (errors::is_error(fragment)) return errors::get_error(fragment);
+            auto& frag = std::get<Fragment>(fragment);
+            patch(frag.holes, match);
+            out_.start_ = frag.start;
+            return std::monostate{};
+        }
+
+    private:
+        struct Hole {
+            int inst;
+            bool second;  // out1 rather than out
+        };
+        struct Fragment {
+            int start;
+            std::vector<Hole> holes;
+        };
+
+        std::string_view pattern_;
+        RegexOptions options_;
+        Regex& out_;
+        std::size_t pos_ = 0;
+
+        AgentError fail(const std::string& what) const {
+            return AgentError{ErrorCategory::Input, "Invalid regex at offset " +
+                                                        std::to_string(pos_) + ": " + what};
+        }
+
+        bool more() const { return pos_ < pattern_.size(); }
+        char peek() const { return pattern_[pos_]; }
+
+        Node byte_node(char c) const {
+            Node node;
+            node.kind = Node::Kind::Set;
+            auto byte = static_cast<unsigned char>(c);
+            node.set.set(byte);
+            if (options_.case_insensitive && std::isalpha(byte)) {
+                node.set.set(static_cast<unsigned char>(std::tolower(byte)));
+                node.set.set(static_cast<unsigned char>(std::toupper(byte)));
+            } else {
+                node.literal = byte;
+            }
+            node.folded = std::tolower(byte);
+            return node;
+        }
+
+        Node set_node(std::bitset<256> set) const {
+            if (options_.case_insensitive) {
+                for (int c = 'a'; c <= 'z'; ++c) {
+                    if (set.test(c) || set.test(c - 32)) {
+                        set.set(c);
+                        set.set(c - 32);
+                    }
+                }
+            }
+            Node node;
+            node.kind = Node::Kind::Set;
+            node.set = set;
+            return node;
+        }
+
+        static std::bitset<256> class_set(char name) {
+            std::bitset<256> set;
+            for (int c = 0; c < 256; ++c) {
+                bool in = false;
+                switch (std::tolower(name)) {
+                    case 'd': in = c >= '0' && c <= '9'; break;
+                    case 'w': in = is_word(c); break;
+                    case 's': in = c == ' ' || (c >= '\t' && c <= '\r'); break;
+                }
+                if (in) set.set(static_cast<std::size_t>(c));
+            }
+            return std::isupper(static_cast<unsigned char>(name)) ? ~set : set;
+        }
+
+        // Single escaped byte: \n \t \. \\ ...
+        static int escaped_byte(char c) {
+            switch (c) {
+                case 'n': return '\n';
+                case 't': return '\t';
+                case 'r': return '\r';
+                case 'f': return '\f';
+                case 'v': return '\v';
+                case '0': return '\0';
+                default:
+                    return std::isalnum(static_cast<unsigned char>(c))
+                               ? -1
+                               : static_cast<unsigned char>(c);
+            }
+        }
+
+        errors::Result<Node> parse_alt() {
+            std::vector<Node> branches;
+            while (true) {
+                auto branch = parse_concat();
+                if (errors::is_error(branch)) return branch;
+                branches.push_back(std::move(std::get<Node>(branch)));
+                if (!more() || peek() != '|') break;
+                ++pos_;
+            }
+            if (branches.size() == 1) return std::move(branches[0]);
+            Node node;
+            node.kind = Node::Kind::Alt;
+            node.kids = std::move(branches);
+            return node;
+        }
+
+        errors::Result<Node> parse_concat() {
+            Node node;
+            node.kind = Node::Kind::Concat;
+            while (more() && peek() != '|' && peek() != ')') {
+                auto item = parse_repeat();
+                if (errors::is_error(item)) return item;
+                node.kids.push_back(std::move(std::get<Node>(item)));
+            }
+            return node;
+        }
+
+        errors::Result<Node> parse_repeat() {
+            auto atom = parse_atom();
+            if (errors::is_error(atom)) return atom;
+            Node node = std::move(std::get<Node>(atom));
+
+            while (more()) {
+                int min = 0, max = -1;
+                char c = peek();
+                if (c == '*') {
+                    ++pos_;
+                } else if (c == '+') {
+                    min = 1;
+                    ++pos_;
+                } else if (c == '?') {
+                    max = 1;
+                    ++pos_;
+                } else if (c == '{' && parse_counts(min, max)) {
+                    if (min > kMaxRepeat || max > kMaxRepeat) {
+                        return fail("repetition count above " + std::to_string(kMaxRepeat));
+                    }
+                    if (max >= 0 && max < min) return fail("{m,n} with n < m");
+                } else {
+                    break;
+                }
+                if (node.kind == Node::Kind::Assert) return fail("nothing to repeat");
+                if (more() && peek() == '?') ++pos_;  // Lazy forms match the same lines
+                Node repeat;
+                repeat.kind = Node::Kind::Repeat;
+                repeat.min = min;
+                repeat.max = max;
+                repeat.kids.push_back(std::move(node));
+                node = std::move(repeat);
+            }
+            return node;
+        }
+
+        // {m}, {m,} or {m,n}; anything else leaves '{' as a literal
+        bool parse_counts(int& min, int& max) {
+            std::size_t end = pattern_.find('}', pos_);
+            if (end == std::string_view::npos) return false;
+            std::string_view body = pattern_.substr(pos_ + 1, end - pos_ - 1);
+            std::size_t comma = body.find(',');
+            auto number = [](std::string_view digits, int& value) {
+                if (digits.empty() || digits.size() > 6) return false;
+                value = 0;
+                for (char d : digits) {
+                    if (d < '0' || d > '9') return false;
+                    value = value * 10 + (d - '0');
+                }
+                return true;
+            };
+            if (comma == std::string_view::npos) {
+                if (!number(body, min)) return false;
+                max = min;
+            } else {
+                if (!number(body.substr(0, comma), min)) return false;
+                std::string_view upper = body.substr(comma + 1);
+                if (upper.empty()) {
+                    max = -1;
+                } else if (!number(upper, max)) {
+                    return false;
+                }
+            }
+            pos_ = end + 1;
+            return true;
+        }
+
+        errors::Result<Node> parse_atom() {
+            char c = peek();
+            ++pos_;
+            Node node;
+            switch (c) {
+                case '(': {
+                    if (pattern_.substr(pos_, 2) == "?:") pos_ += 2;
+                    auto inner = parse_alt();
+                    if (errors::is_error(inner)) return inner;
+                    if (!more() || peek() != ')') return fail("missing ')'");
+                    ++pos_;
+                    return inner;
+                }
+                case '[':
+                    return parse_class();
+                case '.': {
+                    std::bitset<256> any;
+                    any.set();
+                    any.reset('\n');
+                    return set_node(any);
+                }
+                case '^':
+                case '$':
+                    node.kind = Node::Kind::Assert;
+                    node.assertion = c == '^' ? Op::LineBegin : Op::LineEnd;
+                    return node;
+                case '*':
+                case '+':
+                case '?':
+                    --pos_;
+                    return fail("nothing to repeat");
+                case '\\': {
+                    if (!more()) return fail("trailing backslash");
+                    char e = peek();
+                    ++pos_;
+                    if (e == 'b' || e == 'B') {
+                        node.kind = Node::Kind::Assert;
+                        node.assertion = e == 'b' ? Op::WordBound : Op::NotWordBound;
+                        return node;
+                    }
+                    if (e != '\0' && std::strchr("dDwWsS", e)) return set_node(class_set(e));
+                    int byte = escaped_byte(e);
+                    if (byte < 0) return fail(std::string("unsupported escape \\") + e);
+                    return byte_node(static_cast<char>(byte));
+                }
+                default:
+                    return byte_node(c);
+            }
+        }
+
+        errors::Result<Node> parse_class() {
+            std::bitset<256> set;
+            bool negate = more() && peek() == '^';
+            if (negate) ++pos_;
+            bool first = true;
+            while (true) {
+                if (!more()) return fail("missing ']'");
+                char c = peek();
+                ++pos_;
+                if (c == ']' && !first) break;
+                first = false;
+
+                int lo = static_cast<unsigned char>(c);
+                if (c == '[' && pattern_.substr(pos_, 1) == ":") {
+                    std::size_t end = pattern_.find(":]", pos_);
+                    if (end == std::string_view::npos) return fail("unterminated [:class:]");
+                    std::string_view name = pattern_.substr(pos_ + 1, end - pos_ - 1);
+                    pos_ = end + 2;
+                    if (!add_posix_class(name, set)) {
+                        return fail("unknown class [:" + std::string(name) + ":]");
+                    }
+                    continue;
+                }
+                if (c == '\\') {
+                    if (!more()) return fail("trailing backslash");
+                    char e = peek();
+                    ++pos_;
+                    if (e != '\0' && std::strchr("dDwWsS", e)) {
+                        set |= class_set(e);
+                        continue;
+                    }
+                    lo = escaped_byte(e);
+                    if (lo < 0) return fail(std::string("unsupported escape \\") + e);
+                }
+                int hi = lo;
+                if (pos_ + 1 < pattern_.size() && peek() == '-' && pattern_[pos_ + 1] != ']') {
+                    ++pos_;
+                    char h = peek();
+                    ++pos_;
+                    hi = static_cast<unsigned char>(h);
+                    if (h == '\\' && more()) {
+                        hi = escaped_byte(peek());
+                        ++pos_;
+                    }
+                    if (hi < lo) return fail("reversed range in class");
+                }
+                for (int b = lo; b <= hi; ++b) set.set(static_cast<std::size_t>(b));
+            }
+            if (negate) {
+                set.flip();
+                set.reset('\n');
+            }
+            return set_node(set);
+        }
+
+        static bool add_posix_class(std::string_view name, std::bitset<256>& set) {
+            int (*test)(int) = nullptr;
+            if (name == "alpha") test = ::isalpha;
+            if (name == "digit") test = ::isdigit;
+            if (name == "alnum") test = ::isalnum;
+            if (name == "space") test = ::isspace;
+            if (name == "upper") test = ::isupper;
+            if (name == "lower") test = ::islower;
+            if (name == "punct") test = ::ispunct;
+            if (name == "xdigit") test = ::isxdigit;
+            if (!test) return false;
+            for (int c = 0; c < 128; ++c) {
+                if (test(c)) set.set(static_cast<std::size_t>(c));
+            }
+            return true;
+        }
+
+        // --- Thompson construction ---
+
+        int emit(Regex::Inst inst) {
+            out_.program_.push_back(inst);
+            return static_cast<int>(out_.program_.size() - 1);
+        }
+
+        void patch(const std::vector<Hole>& holes, int target) {
+            for (const Hole& hole : holes) {
+                auto& inst = out_.program_[static_cast<std::size_t>(hole.inst)];
+                (hole.second ? inst.out1 : inst.out) = target;
+            }
+        }
+
+        errors::Result<Fragment> build(const Node& node) {
+            if (out_.program_.size() > 100000) {
+                return AgentError{ErrorCategory::Input, "Regex is too large"};
+            }
+            switch (node.kind) {
+                case Node::Kind::Empty: {
+                    int jump = emit({Op::Jump});
+                    return Fragment{jump, {{jump, false}}};
+                }
+                case Node::Kind::Set: {
+                    int set = static_cast<int>(out_.sets_.size());
+                    out_.sets_.push_back(node.set);
+                    int consume = emit({Op::Consume, -1, -1, set});
+                    return Fragment{consume, {{consume, false}}};
+                }
+                case Node::Kind::Assert: {
+                    int assert = emit({node.assertion});
+                    return Fragment{assert, {{assert, false}}};
+                }
+                case Node::Kind::Concat: {
+                    if (node.kids.empty()) return build(Node{});
+                    Fragment whole{-1, {}};
+                    for (const auto& kid : node.kids) {
+                        auto built = build(kid);
+                        if (errors::is_error(built)) return built;
+                        auto& part = std::get<Fragment>(built);
+                        if (whole.start < 0) {
+                            whole = std::move(part);
+                        } else {
+                            patch(whole.holes, part.start);
+                            whole.holes = std::move(part.holes);
+                        }
+                    }
+                    return whole;
+                }
+                case Node::Kind::Alt: {
+                    Fragment whole{-1, {}};
+                    for (const auto& kid : node.kids) {
+                        auto built = build(kid);
+                        if (errors::is_error(built)) return built;
+                        auto& part = std::get<Fragment>(built);
+                        if (whole.start < 0) {
+                            whole = std::move(part);
+                            continue;
+                        }
+                        int split = emit({Op::Split, whole.start, part.start});
+                        whole.start = split;
+                        whole.holes.insert(whole.holes.end(), part.holes.begin(),
+                                           part.holes.end());
+                    }
+                    return whole;
+                }
+                case Node::Kind::Repeat:
+                    return build_repeat(node);
+            }
+            return AgentError{ErrorCategory::Internal, "Unknown regex node"};
+        }
+
+        errors::Result<Fragment> build_repeat(const Node& node) {
+            const Node& kid = node.kids[0];
+            Fragment whole{-1, {}};
+            auto append = [&](Fragment part) {
+                if (whole.start < 0) {
+                    whole = std::move(part);
+                } else {
+                    patch(whole.holes, part.start);
+                    whole.holes = std::move(part.holes);
+                }
+            };
+
+            // Mandatory copies
+            for (int i = 0; i < node.min; ++i) {
+                auto built = build(kid);
+                if (errors::is_error(built)) return built;
+                append(std::move(std::get<Fragment>(built)));
+            }
+
+            if (node.max < 0) {
+                // Loop: split -> kid -> back to split
+                auto built = build(kid);
+                if (errors::is_error(built)) return built;
+                auto& body = std::get<Fragment>(built);
+                int split = emit({Op::Split, body.start, -1});
+                patch(body.holes, split);
+                append(Fragment{split, {{split, true}}});
+            } else {
+                // Optional copies: each one may be skipped, which skips the rest too
+                std::vector<Hole> skips;
+                for (int i = node.min; i < node.max; ++i) {
+                    auto built = build(kid);
+                    if (errors::is_error(built)) return built;
+                    auto& body = std::get<Fragment>(built);
+                    int split = emit({Op::Split, body.start, -1});
+                    skips.push_back({split, true});
+                    append(Fragment{split, std::move(body.holes)});
+                }
+                if (whole.start < 0) return build(Node{});
+                whole.holes.insert(whole.holes.end(), skips.begin(), skips.end());
+            }
+            return whole;
+        }
+    };
+
+    errors::Result<Regex> Regex::compile(std::string_view pattern, const RegexOptions& options) {
+        Regex regex;
+        RegexCompiler compiler(pattern, options, regex);
+        auto status = compiler.compile();
+        if (errors::is_error(status)) return errors::get_error(status);
+        return regex;
+    }
+
+    Regex::Matcher Regex::matcher() const { return Matcher(*this); }
+
+    // --- Lazy DFA ---
+
+    Regex::Matcher::Matcher(const Regex& regex) : regex_(&regex) {
+        seen_.assign(regex.program_.size(), 0);
+        starts_.fill(-1);
+    }
+
+    void Regex::Matcher::add_closure(int inst, std::vector<int>& out, bool at_begin,
+                                     int next_byte, bool prev_word) {
+        stack_.clear();
+        stack_.push_back(inst);
+        while (!stack_.empty()) {
+            int i = stack_.back();
+            stack_.pop_back();
+            if (i < 0 || seen_[static_cast<std::size_t>(i)] == generation_) continue;
+            seen_[static_cast<std::size_t>(i)] = generation_;
+
+            const Inst& in = regex_->program_[static_cast<std::size_t>(i)];
+            switch (in.op) {
+                case Op::Consume:
+                case Op::Match:
+                    out.push_back(i);
+                    break;
+                case Op::Jump:
+                    stack_.push_back(in.out);
+                    break;
+                case Op::Split:
+                    stack_.push_back(in.out1);
+                    stack_.push_back(in.out);
+                    break;
+                case Op::LineBegin:
+                    if (at_begin) stack_.push_back(in.out);
+                    break;
+                case Op::LineEnd:
+                case Op::WordBound:
+                case Op::NotWordBound: {
+                    if (next_byte == kUnknownByte) {
+                        out.push_back(i);  // Decided once the next byte is known
+                        break;
+                    }
+                    bool pass;
+                    if (in.op == Op::LineEnd) {
+                        pass = next_byte == kEndOfLine;
+                    } else {
+                        bool boundary = prev_word != is_word(next_byte);
+                        pass = in.op == Op::WordBound ? boundary : !boundary;
+                    }
+                    if (pass) stack_.push_back(in.out);
+                    break;
+                }
+            }
+        }
+    }
+
+    int Regex::Matcher::intern(std::vector<int>& insts, bool prev_word, bool anchored) {
+        std::sort(insts.begin(), insts.end());
+        std::string key(reinterpret_cast<const char*>(insts.data()), insts.size() * sizeof(int));
+        key += static_cast<char>(prev_word);
+        key += static_cast<char>(anchored);
+        auto it = index_.find(key);
+        if (it != index_.end()) return it->second;
+
+        State state;
+        state.insts = insts;
+        state.prev_word = prev_word;
+        state.anchored = anchored;
+        state.match = std::any_of(insts.begin(), insts.end(), [&](int i) {
+            return regex_->program_[static_cast<std::size_t>(i)].op == Op::Match;
+        });
+        states_.push_back(std::move(state));
+        table_.resize(states_.size() * 256, -1);
+        int id = static_cast<int>(states_.size() - 1);
+        index_.emplace(std::move(key), id);
+        return id;
+    }
+
+    void Regex::Matcher::flush() {
+        states_.clear();
+        table_.clear();
+        index_.clear();
+        starts_.fill(-1);
+    }
+
+    int Regex::Matcher::start_state(bool anchored, bool at_begin, bool prev_word) {
+        int& cached = starts_[(anchored ? 4 : 0) | (at_begin ? 2 : 0) | (prev_word ? 1 : 0)];
+        if (cached >= 0) return cached;
+        if (states_.size() >= kMaxStates) flush();
+        std::vector<int> insts;
+        ++generation_;
+        add_closure(regex_->start_, insts, at_begin, kUnknownByte, prev_word);
+        cached = intern(insts, prev_word, anchored);
+        return cached;
+    }
+
+    std::int32_t Regex::Matcher::step(int id, unsigned char byte) {
+        // Copy what we need: interning may grow states_ (or flush it)
+        std::vector<int> current = states_[static_cast<std::size_t>(id)].insts;
+        bool prev_word = states_[static_cast<std::size_t>(id)].prev_word;
+        bool anchored = states_[static_cast<std::size_t>(id)].anchored;
+
+        // Unanchored runs restart at each newline: the line ending here either
+        // matched or it did not, and the next one starts afresh
+        if (byte == '\n' && !anchored) {
+            bool matched = accepts_at_end(id);
+            bool cached = starts_[2] >= 0;  // Otherwise start_state() may flush
+            std::int32_t entry = (start_state(false, true, false) << 8) |
+                                 (matched ? kMatchedBefore : 0);
+            if (cached) remember(id, byte, entry);
+            return entry;
+        }
+
+        // 1. Settle the assertions that were waiting for this byte
+        std::vector<int> settled;
+        ++generation_;
+        for (int i : current) add_closure(i, settled, false, byte, prev_word);
+        bool matched = std::any_of(settled.begin(), settled.end(), [&](int i) {
+            return regex_->program_[static_cast<std::size_t>(i)].op == Op::Match;
+        });
+
+        // 2. Consume the byte; unanchored searches may also start over here
+        std::vector<int> next;
+        bool word = is_word(byte);
+        ++generation_;
+        for (int i : settled) {
+            const Inst& in = regex_->program_[static_cast<std::size_t>(i)];
+            if (in.op == Op::Consume &&
+                regex_->sets_[static_cast<std::size_t>(in.set)].test(byte)) {
+                add_closure(in.out, next, false, kUnknownByte, word);
+            }
+        }
+        if (!anchored) add_closure(regex_->start_, next, false, kUnknownByte, word);
+
+        bool flushed = states_.size() >= kMaxStates;
+        if (flushed) flush();
+        int target = intern(next, word, anchored);
+        const State& to = states_[static_cast<std::size_t>(target)];
+        std::int32_t entry = (target << 8) | (matched ? kMatchedBefore : 0) |
+                             (to.match ? kTargetMatches : 0) |
+                             (to.anchored && to.insts.empty() ? kTargetDead : 0);
+        if (!flushed) remember(id, byte, entry);
+        return entry;
+    }
+
+    void Regex::Matcher::remember(int state, unsigned char byte, std::int32_t entry) {
+        table_[(static_cast<std::size_t>(state) << 8) | byte] = entry & 0xff ? ~entry : entry;
+    }
+
+    std::int32_t Regex::Matcher::transition(int state, unsigned char byte) {
+        std::int32_t entry = table_[(static_cast<std::size_t>(state) << 8) | byte];
+        if (entry == kUnknown) return step(state, byte);
+        return entry < 0 ? ~entry : entry;
+    }
+
+    bool Regex::Matcher::accepts_at_end(int id) {
+        const State& state = states_[static_cast<std::size_t>(id)];
+        if (state.match) return true;
+        std::vector<int> settled;
+        ++generation_;
+        for (int i : state.insts) add_closure(i, settled, false, kEndOfLine, state.prev_word);
+        return std::any_of(settled.begin(), settled.end(), [&](int i) {
+            return regex_->program_[static_cast<std::size_t>(i)].op == Op::Match;
+        });
+    }
+
+    bool Regex::Matcher::run(int state, std::string_view line, std::size_t pos) {
+        if (states_[static_cast<std::size_t>(state)].match) return true;
+        const auto* data = reinterpret_cast<const unsigned char*>(line.data());
+        std::size_t row = static_cast<std::size_t>(state) << 8;
+        for (; pos < line.size(); ++pos) {
+            std::int32_t entry = table_[row | data[pos]];
+            if (entry < 0) {
+                entry = transition(static_cast<int>(row >> 8), data[pos]);
+                if (entry & (kMatchedBefore | kTargetMatches)) return true;
+                if (entry & kTargetDead) return false;
+                entry &= ~0xff;
+            }
+            row = static_cast<std::size_t>(entry);
+        }
+        return accepts_at_end(static_cast<int>(row >> 8));
+    }
+
+    bool Regex::Matcher::matches(std::string_view line) {
+        return run(start_state(false, true, false), line, 0);
+    }
+
+    std::size_t Regex::Matcher::find(std::string_view line) {
+        if (!matches(line)) return std::string_view::npos;
+        for (std::size_t start = 0; start <= line.size(); ++start) {
+            bool prev_word = start > 0 && is_word(static_cast<unsigned char>(line[start - 1]));
+            if (run(start_state(true, start == 0, prev_word), line, start)) return start;
+        }
+        return std::string_view::npos;
+    }
+
+    std::size_t Regex::Matcher::scan(std::string_view text, std::size_t from) {
+        if (from >= text.size()) return std::string_view::npos;
+        int start = start_state(false, true, false);
+        if (states_[static_cast<std::size_t>(start)].match) return from;
+
+        const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+        std::size_t row = static_cast<std::size_t>(start) << 8;
+        for (std::size_t pos = from; pos < text.size(); ++pos) {
+            std::int32_t entry = table_[row | data[pos]];
+            if (entry < 0) {
+                entry = transition(static_cast<int>(row >> 8), data[pos]);
+                if (entry & (kMatchedBefore | kTargetMatches)) return pos;
+                entry &= ~0xff;
+            }
+            row = static_cast<std::size_t>(entry);
+        }
+        // A trailing newline was already settled; it does not open another line
+        if (data[text.size() - 1] == '\n') return std::string_view::npos;
+        return accepts_at_end(static_cast<int>(row >> 8)) ? text.size() - 1
+                                                          : std::string_view::npos;
+    }
+
+} // namespace agent::core::search
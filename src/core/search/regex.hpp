@@ -0,0 +1,129 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+
+namespace agent::core::search {
+
+    struct RegexOptions {
+        bool case_insensitive = false;  // ASCII letters only
+        bool literal = false;           // Treat the whole pattern as a fixed string
+    };
+
+    // Line-oriented regular expressions for code search, in the common
+    // grep/ripgrep dialect: . [] [^] * + ? {m,n} | () (?:) ^ $ \b \B
+    // \d \w \s (and their negations) and the usual escapes. Matching is on
+    // bytes; no backreferences or lookaround, which is what lets every
+    // pattern run as a DFA in time linear in the line.
+    //
+    // A Regex is the compiled NFA and is immutable; each thread searches
+    // with its own Matcher, which builds DFA states lazily as input needs them.
+    class Regex {
+    public:
+        static errors::Result<Regex> compile(std::string_view pattern,
+                                             const RegexOptions& options = {});
+
+        // True when the pattern matches exactly one fixed string (no DFA needed)
+        bool is_literal() const { return is_literal_; }
+        // A substring every match contains: a prefilter for lines worth running the DFA on
+        const std::string& required_literal() const { return required_; }
+        // The same with ASCII letters lowercased, and found for case-insensitive
+        // patterns too: every match contains it up to case
+        const std::string& folded_literal() const { return folded_; }
+
+        class Matcher;
+        Matcher matcher() const;
+
+        // The compiled program; public for the Matcher
+        struct Inst {
+            enum class Op : std::uint8_t {
+                Consume,     // A byte in sets[set], then out
+                Split,       // out and out1
+                Jump,        // out
+                LineBegin,   // ^
+                LineEnd,     // $
+                WordBound,   // \b
+                NotWordBound,  // \B
+                Match
+            };
+            Op op;
+            int out = -1;
+            int out1 = -1;
+            int set = -1;
+        };
+
+    private:
+        friend class RegexCompiler;
+        std::vector<Inst> program_;
+        std::vector<std::bitset<256>> sets_;
+        int start_ = 0;
+        bool is_literal_ = false;
+        std::string required_;
+        std::string folded_;
+    };
+
+    class Regex::Matcher {
+    public:
+        explicit Matcher(const Regex& regex);
+
+        // Whether line (without its '\n') contains a match
+        bool matches(std::string_view line);
+
+        // Byte offset where the leftmost match starts, or npos
+        std::size_t find(std::string_view line);
+
+        // Runs over many '\n'-separated lines at once (from must start a line)
+        // and returns an offset inside the first one that matches, or npos.
+        // Cheaper than matches() per line when most lines do not match.
+        std::size_t scan(std::string_view text, std::size_t from);
+
+        // Cached states; the cache is flushed when it outgrows kMaxStates
+        std::size_t state_count() const { return states_.size(); }
+        static constexpr std::size_t kMaxStates = 2048;
+
+    private:
+        // Transition table entries: kUnknown until computed, target << 8 for a
+        // plain transition, ~((target << 8) | flags) when a flag is set, so the
+        // hot loop only has to test the sign
+        static constexpr std::int32_t kUnknown = -1;
+        static constexpr std::int32_t kMatchedBefore = 1;  // A match ended before this byte
+        static constexpr std::int32_t kTargetMatches = 2;  // ... or ends right after it
+        static constexpr std::int32_t kTargetDead = 4;     // Anchored run that cannot match
+
+        struct State {
+            std::vector<int> insts;  // NFA states: Consume, pending assertions, Match
+            bool prev_word;          // Whether the byte before was a word byte (for \b)
+            bool anchored;
+            bool match;              // Contains Match
+        };
+
+        const Regex* regex_;
+        std::vector<State> states_;
+        std::vector<std::int32_t> table_;  // 256 entries per state, kept apart for the hot loop
+        std::unordered_map<std::string, int> index_;
+        std::vector<int> stack_;
+        std::vector<std::uint32_t> seen_;
+        std::uint32_t generation_ = 0;
+        std::array<int, 8> starts_;  // By (anchored, at line start, previous byte is a word byte)
+
+        void flush();
+        int start_state(bool anchored, bool at_begin, bool prev_word);
+        int intern(std::vector<int>& insts, bool prev_word, bool anchored);
+        std::int32_t step(int state, unsigned char byte);
+        void remember(int state, unsigned char byte, std::int32_t entry);
+        // The decoded entry for state on byte, computing it when needed
+        std::int32_t transition(int state, unsigned char byte);
+        bool accepts_at_end(int state);
+        void add_closure(int inst, std::vector<int>& out, bool at_begin, int next_byte,
+                         bool prev_word);
+        // Runs the DFA over line from pos; returns whether a match was found
+        bool run(int state, std::string_view line, std::size_t pos);
+    };
+
+} // namespace agent::core::search
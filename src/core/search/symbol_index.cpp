@@ -0,0 +1,278 @@
+#include "core/search/symbol_index.hpp"
+#include <sys/stat.h>
+#include <algorithm>
+#include <filesystem>
+#include <mutex>
+#include "core/fs/mapped_file.hpp"
+#include "core/fs/text_scan.hpp"
+
+namespace agent::core::search {
+
+    namespace {
+
+        // A prefix query stops collecting here; it is cut to max_results anyway
+        constexpr std::size_t kMaxCollected = 4096;
+
+        std::string normalize(const std::string& root) {
+            std::error_code error;
+            auto absolute = std::filesystem::absolute(root, error);
+            std::string path =
+                (error ? std::filesystem::path(root) : absolute).lexically_normal().string();
+            if (path.size() > 1 && path.back() == '/') path.pop_back();
+            return path;
+        }
+
+        // Each name once, for the name -> files map
+        std::vector<std::string_view> distinct_names(const std::vector<Symbol>& symbols) {
+            std::vector<std::string_view> names;
+            names.reserve(symbols.size());
+            for (const auto& symbol : symbols) names.push_back(symbol.name);
+            std::sort(names.begin(), names.end());
+            names.erase(std::unique(names.begin(), names.end()), names.end());
+            return names;
+        }
+
+    } // namespace
+
+    SymbolIndex::SymbolIndex(std::string root, SymbolIndexOptions options)
+        : root_(std::move(root)), options_(std::move(options)) {}
+
+    SymbolIndex::~SymbolIndex() {
+        watcher_.reset();  // No events may arrive once members start going away
+    }
+
+    errors::Result<std::unique_ptr<SymbolIndex>> SymbolIndex::open(const std::string& root,
+                                                                   SymbolIndexOptions options) {
+        std::unique_ptr<SymbolIndex> index(new SymbolIndex(normalize(root), std::move(options)));
+        auto built = index->build();
+        if (errors::is_error(built)) return errors::get_error(built);
+        return index;
+    }
+
+    // --- Building ---
+
+    bool SymbolIndex::wanted(std::string_view path) const {
+        std::size_t dot = path.rfind('.');
+        if (dot == std::string_view::npos || path.find('/', dot) != std::string_view::npos) {
+            return false;
+        }
+        std::string_view extension = path.substr(dot);
+        return std::find(options_.extensions.begin(), options_.extensions.end(), extension) !=
+               options_.extensions.end();
+    }
+
+    // Oversized and binary files are kept with no symbols; nullopt when the
+    // file is gone
+    std::optional<std::vector<Symbol>> SymbolIndex::scan(std::string_view path) const {
+        std::string full = root_ + "/" + std::string(path);
+        struct stat info {};
+        if (::stat(full.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return std::nullopt;
+        if (static_cast<std::uint64_t>(info.st_size) > options_.max_file_bytes) {
+            return std::vector<Symbol>{};
+        }
+
+        auto file = fs::MappedFile::open(full);
+        if (errors::is_error(file)) return std::nullopt;
+        std::string_view bytes = errors::get_value(file).bytes();
+        if (fs::sniff_encoding(bytes) == fs::Encoding::Binary) return std::vector<Symbol>{};
+        return extract_cpp_symbols(bytes);
+    }
+
+    errors::Status SymbolIndex::build() {
+        // Files are read and tokenized on the walker threads; only the
+        // name map is filled in under the lock, afterwards
+        std::mutex mutex;
+        std::unordered_map<std::string, std::vector<Symbol>> files;
+        fs::WalkOptions walk = options_.walk;
+        walk.threads = options_.threads;
+        auto walked = fs::walk(root_, walk, [&](const fs::WalkEntry& entry) {
+            if (entry.is_dir || !wanted(entry.path)) return true;
+            auto scanned = scan(entry.path);
+            if (!scanned) return true;
+            std::lock_guard<std::mutex> lock(mutex);
+            files.emplace(entry.path, std::move(*scanned));
+            return true;
+        });
+        if (errors::is_error(walked)) return errors::get_error(walked);
+
+        std::unique_lock lock(mutex_);
+        files_ = std::move(files);
+        names_.clear();
+        symbol_count_ = 0;
+        for (const auto& [path, symbols] : files_) add_names_locked(path, symbols);
+        ++stats_.builds;
+        return std::monostate{};
+    }
+
+    void SymbolIndex::add_names_locked(const std::string& path,
+                                       const std::vector<Symbol>& symbols) {
+        symbol_count_ += symbols.size();
+        for (std::string_view name : distinct_names(symbols)) {
+            auto it = names_.find(name);
+            if (it == names_.end()) {
+                it = names_.emplace(std::string(name), std::vector<const std::string*>{}).first;
+            }
+            it->second.push_back(&path);
+        }
+    }
+
+    void SymbolIndex::drop_names_locked(const std::string& path,
+                                        const std::vector<Symbol>& symbols) {
+        symbol_count_ -= symbols.size();
+        for (std::string_view name : distinct_names(symbols)) {
+            auto it = names_.find(name);
+            if (it == names_.end()) continue;
+            std::erase(it->second, &path);
+            if (it->second.empty()) names_.erase(it);
+        }
+    }
+
+    // --- Incremental updates ---
+
+    void SymbolIndex::replace_locked(const std::string& path,
+                                     std::optional<std::vector<Symbol>> symbols) {
+        if (auto it = files_.find(path); it != files_.end()) {
+            drop_names_locked(it->first, it->second);
+            files_.erase(it);
+        }
+        if (!symbols) return;
+        auto inserted = files_.emplace(path, std::move(*symbols)).first;
+        add_names_locked(inserted->first, inserted->second);
+    }
+
+    void SymbolIndex::update(std::string_view path) {
+        if (!wanted(path)) return;
+        std::optional<std::vector<Symbol>> symbols;
+        if (!fs::walk_skips(root_, path, false, options_.walk)) symbols = scan(path);
+        std::unique_lock lock(mutex_);
+        replace_locked(std::string(path), std::move(symbols));
+        ++stats_.updates;
+    }
+
+    void SymbolIndex::remove_below(const std::string& directory) {
+        std::string prefix = directory + "/";
+        std::unique_lock lock(mutex_);
+        std::vector<std::string> gone;
+        for (const auto& [path, symbols] : files_) {
+            if (path.starts_with(prefix)) gone.push_back(path);
+        }
+        for (const auto& path : gone) replace_locked(path, std::nullopt);
+    }
+
+    errors::Status SymbolIndex::watch() {
+        if (!watcher_) {
+            watcher_ = std::make_unique<fs::TreeWatcher>(
+                [this](const fs::TreeEvent& event) { on_event(event); });
+        }
+        return watcher_->watch(root_);
+    }
+
+    void SymbolIndex::on_event(const fs::TreeEvent& event) {
+        // Events were lost, or ignore rules changed what is covered: walk again
+        std::string prefix = root_ + "/";
+        if (event.kind == fs::TreeEvent::Kind::Overflow) {
+            build();
+            return;
+        }
+        if (!event.path.starts_with(prefix)) return;
+        std::string path = event.path.substr(prefix.size());
+
+        if (event.kind == fs::TreeEvent::Kind::File) {
+            if (path == ".gitignore" || path.ends_with("/.gitignore")) {
+                build();
+            } else {
+                update(path);
+            }
+            return;
+        }
+
+        remove_below(path);
+        struct stat info {};
+        if (::stat(event.path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode) ||
+            fs::walk_skips(root_, path, true, options_.walk)) {
+            return;
+        }
+        // A directory created or moved in: index what is already inside
+        std::vector<std::string> found;
+        std::mutex mutex;
+        fs::WalkOptions walk = options_.walk;
+        walk.threads = 1;
+        auto walked = fs::walk(event.path, walk, [&](const fs::WalkEntry& entry) {
+            if (!entry.is_dir && wanted(entry.path)) {
+                std::lock_guard<std::mutex> lock(mutex);
+                found.push_back(path + "/" + std::string(entry.path));
+            }
+            return true;
+        });
+        if (errors::is_error(walked)) return;
+        for (const auto& file : found) update(file);
+    }
+
+    // --- Queries ---
+
+    std::vector<SymbolMatch> SymbolIndex::find(const SymbolQuery& query) const {
+        queries_.fetch_add(1, std::memory_order_relaxed);
+
+        // "a::b::name": look name up, then keep the scopes ending in a::b
+        std::string_view name = query.name;
+        bool anchored = name.starts_with("::");
+        if (anchored) name.remove_prefix(2);
+        std::string_view qualifier;
+        if (std::size_t cut = name.rfind("::"); cut != std::string_view::npos) {
+            qualifier = name.substr(0, cut);
+            name = name.substr(cut + 2);
+        }
+        if (name.empty()) return {};
+        auto in_scope = [&](std::string_view scope) {
+            if (anchored || scope.size() <= qualifier.size()) return scope == qualifier;
+            return qualifier.empty() ||
+                   (scope.ends_with(qualifier) &&
+                    scope.substr(0, scope.size() - qualifier.size()).ends_with("::"));
+        };
+
+        std::vector<SymbolMatch> matches;
+        auto collect = [&](const std::string& symbol_name,
+                           const std::vector<const std::string*>& paths) {
+            for (const std::string* path : paths) {
+                for (const Symbol& symbol : files_.find(*path)->second) {
+                    if (symbol.name != symbol_name) continue;
+                    if (query.kind && symbol.kind != *query.kind) continue;
+                    if (!in_scope(symbol.scope)) continue;
+                    matches.push_back(SymbolMatch{*path, symbol});
+                }
+            }
+        };
+        {
+            std::shared_lock lock(mutex_);
+            if (!query.prefix) {
+                if (auto it = names_.find(name); it != names_.end()) collect(it->first, it->second);
+            } else {
+                for (auto it = names_.lower_bound(name);
+                     it != names_.end() && it->first.starts_with(name) &&
+                     matches.size() < kMaxCollected;
+                     ++it) {
+                    collect(it->first, it->second);
+                }
+            }
+        }
+
+        std::sort(matches.begin(), matches.end(), [](const auto& a, const auto& b) {
+            if (a.symbol.definition != b.symbol.definition) return a.symbol.definition;
+            if (a.path != b.path) return a.path < b.path;
+            return a.symbol.line < b.symbol.line;
+        });
+        if (matches.size() > query.max_results) matches.resize(query.max_results);
+        return matches;
+    }
+
+    SymbolIndexStats SymbolIndex::stats() const {
+        std::shared_lock lock(mutex_);
+        SymbolIndexStats stats = stats_;
+        stats.files = files_.size();
+        stats.symbols = symbol_count_;
+        stats.names = names_.size();
+        stats.queries = queries_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+} // namespace agent::core::search
@@ -0,0 +1,107 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/fs/tree_watcher.hpp"
+#include "core/fs/workspace_walker.hpp"
+#include "core/search/cpp_symbols.hpp"
+
+namespace agent::core::search {
+
+    struct SymbolIndexOptions {
+        std::size_t threads = 0;                // Build threads; 0: one per core
+        std::size_t max_file_bytes = 8u << 20;  // Larger (generated) sources are left out
+        std::vector<std::string> extensions = {".c",   ".cc",  ".cpp", ".cxx", ".c++", ".h",
+                                               ".hh",  ".hpp", ".hxx", ".h++", ".inl", ".ipp",
+                                               ".tcc", ".cu",  ".cuh"};
+        fs::WalkOptions walk;                   // Which files the index covers
+    };
+
+    struct SymbolIndexStats {
+        std::size_t files = 0;    // Source files indexed
+        std::size_t symbols = 0;
+        std::size_t names = 0;    // Distinct unqualified names
+        std::size_t builds = 0;   // Full walks: the first one, and after an inotify overflow
+        std::size_t updates = 0;  // Files reindexed one at a time
+        std::size_t queries = 0;
+    };
+
+    struct SymbolQuery {
+        // Unqualified ("parse") or qualified by any trailing part of its
+        // scope ("Parser::parse", "core::Parser::parse"); a leading "::"
+        // requires the whole scope to match
+        std::string name;
+        std::optional<SymbolKind> kind;   // Any kind when unset
+        bool prefix = false;              // The last part of name is a prefix of the symbol's
+        std::size_t max_results = 50;
+    };
+
+    struct SymbolMatch {
+        std::string path;  // Relative to the root
+        Symbol symbol;
+    };
+
+    // Where the namespaces, classes, functions and macros of the C and C++
+    // sources in a workspace are declared, as extract_cpp_symbols() reads
+    // them. Built with one pass over the tree on several threads, then kept
+    // current file by file; lookups go through a sorted map of names, so
+    // exact and prefix queries cost a few map probes plus the files that
+    // declare the name.
+    //
+    // Safe to query from any thread while updates are applied.
+    class SymbolIndex {
+    public:
+        static errors::Result<std::unique_ptr<SymbolIndex>> open(const std::string& root,
+                                                                 SymbolIndexOptions options = {});
+        ~SymbolIndex();
+
+        SymbolIndex(const SymbolIndex&) = delete;
+        SymbolIndex& operator=(const SymbolIndex&) = delete;
+
+        // Keeps the index current from inotify events
+        errors::Status watch();
+
+        // Reindexes one file (relative to the root) now, e.g. after a tool wrote it
+        void update(std::string_view path);
+
+        // Definitions before declarations, then by path and line
+        std::vector<SymbolMatch> find(const SymbolQuery& query) const;
+
+        const std::string& root() const { return root_; }
+        SymbolIndexStats stats() const;
+
+    private:
+        SymbolIndex(std::string root, SymbolIndexOptions options);
+
+        std::string root_;
+        SymbolIndexOptions options_;
+
+        mutable std::shared_mutex mutex_;
+        std::unordered_map<std::string, std::vector<Symbol>> files_;  // By path
+        // Name -> the files declaring it, each once; the keys of files_ are stable
+        std::map<std::string, std::vector<const std::string*>, std::less<>> names_;
+        std::size_t symbol_count_ = 0;
+        SymbolIndexStats stats_;
+        mutable std::atomic<std::size_t> queries_{0};
+
+        std::unique_ptr<fs::TreeWatcher> watcher_;
+
+        errors::Status build();
+        bool wanted(std::string_view path) const;
+        std::optional<std::vector<Symbol>> scan(std::string_view path) const;
+        void add_names_locked(const std::string& path, const std::vector<Symbol>& symbols);
+        void drop_names_locked(const std::string& path, const std::vector<Symbol>& symbols);
+        void replace_locked(const std::string& path, std::optional<std::vector<Symbol>> symbols);
+        void remove_below(const std::string& directory);
+        void on_event(const fs::TreeEvent& event);
+    };
+
+} // namespace agent::core::search
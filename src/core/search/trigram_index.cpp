@@ -0,0 +1,769 @@
+#include "core/search/trigram_index.hpp"
+#include <sys/stat.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include "core/fs/text_scan.hpp"
+#include "core/logging/logger.hpp"
+
+namespace agent::core::search {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    namespace {
+
+        // --- Snapshot layout ---
+        //
+        //   Header, root path, padding to 8
+        //   FileRecord[file_count]
+        //   DirectoryEntry[trigram_count], sorted by trigram
+        //   Posting lists: varint file ids, each one a delta from the previous
+        //   Path bytes
+
+        constexpr char kMagic[8] = {'A', 'G', 'T', 'R', 'I', 'G', 'R', 'M'};
+        constexpr std::uint32_t kVersion = 1;
+
+        // Pending changes are folded into a new snapshot past this many files,
+        // or past an eighth of the index, whichever is larger
+        constexpr std::size_t kMinPendingToCompact = 1024;
+
+        struct Header {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t file_count;
+            std::uint32_t trigram_count;
+            std::uint32_t root_length;
+            std::uint64_t files_offset;
+            std::uint64_t directory_offset;
+            std::uint64_t postings_offset;
+            std::uint64_t paths_offset;
+            std::uint64_t total_bytes;
+        };
+
+        struct FileRecord {
+            std::uint64_t path_offset;  // Into the path bytes
+            std::uint32_t path_length;
+            std::uint32_t reserved;
+            std::int64_t mtime_ns;
+            std::uint64_t size;
+        };
+
+        struct DirectoryEntry {
+            std::uint32_t trigram;
+            std::uint32_t count;   // Files in the list
+            std::uint64_t offset;  // Into the posting bytes
+        };
+
+        static_assert(sizeof(Header) == 64 && sizeof(FileRecord) == 32 &&
+                      sizeof(DirectoryEntry) == 16);
+
+        std::size_t align8(std::size_t n) { return (n + 7) & ~std::size_t{7}; }
+
+        // The image is 8-aligned (mmap'ed, or a heap buffer) and so are its tables
+        const Header& header_of(std::string_view image) {
+            return *reinterpret_cast<const Header*>(image.data());
+        }
+        const FileRecord* files_of(std::string_view image) {
+            return reinterpret_cast<const FileRecord*>(image.data() +
+                                                       header_of(image).files_offset);
+        }
+        const DirectoryEntry* directory_of(std::string_view image) {
+            return reinterpret_cast<const DirectoryEntry*>(image.data() +
+                                                           header_of(image).directory_offset);
+        }
+        std::string_view path_of(std::string_view image, std::uint32_t id) {
+            const FileRecord& record = files_of(image)[id];
+            return image.substr(header_of(image).paths_offset + record.path_offset,
+                                record.path_length);
+        }
+
+        void put_varint(std::string& out, std::uint32_t value) {
+            while (value >= 0x80) {
+                out.push_back(static_cast<char>(value | 0x80));
+                value >>= 7;
+            }
+            out.push_back(static_cast<char>(value));
+        }
+
+        // Walks one posting list. Stops early rather than read past the
+        // posting bytes; valid() rejects snapshots where that would happen.
+        class PostingCursor {
+        public:
+            PostingCursor(std::string_view image, const DirectoryEntry& entry)
+                : data_(reinterpret_cast<const unsigned char*>(image.data()) +
+                        header_of(image).postings_offset + entry.offset),
+                  end_(reinterpret_cast<const unsigned char*>(image.data()) +
+                       header_of(image).paths_offset),
+                  left_(entry.count) {}
+
+            bool next(std::uint32_t& id) {
+                if (left_ == 0) return false;
+                std::uint32_t delta = 0;
+                for (int shift = 0;; shift += 7) {
+                    if (data_ == end_ || shift > 28) return stop();
+                    unsigned char byte = *data_++;
+                    delta |= static_cast<std::uint32_t>(byte & 0x7f) << shift;
+                    if (byte < 0x80) break;
+                }
+                id = started_ ? id_ + delta : delta;
+                id_ = id;
+                started_ = true;
+                --left_;
+                return true;
+            }
+
+            bool truncated() const { return truncated_; }
+
+        private:
+            const unsigned char* data_;
+            const unsigned char* end_;
+            std::uint32_t left_;
+            std::uint32_t id_ = 0;
+            bool started_ = false;
+            bool truncated_ = false;
+
+            bool stop() {
+                truncated_ = true;
+                left_ = 0;
+                return false;
+            }
+        };
+
+        // Everything the readers index with is in bounds: the sections, each
+        // file's path, each posting list, and every file id in them, which
+        // must also ascend as the list intersection assumes
+        bool valid(std::string_view image, const std::string& root) {
+            if (image.size() < sizeof(Header)) return false;
+            const Header& header = header_of(image);
+            if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+                header.version != kVersion || header.total_bytes != image.size()) {
+                return false;
+            }
+            if (image.substr(sizeof(Header), header.root_length) != root) return false;
+            if (header.files_offset % 8 != 0 || header.directory_offset % 8 != 0 ||
+                header.files_offset > header.directory_offset ||
+                header.directory_offset > header.postings_offset ||
+                header.postings_offset > header.paths_offset ||
+                header.paths_offset > image.size()) {
+                return false;
+            }
+            if (std::uint64_t{header.file_count} * sizeof(FileRecord) >
+                    header.directory_offset - header.files_offset ||
+                std::uint64_t{header.trigram_count} * sizeof(DirectoryEntry) >
+                    header.postings_offset - header.directory_offset) {
+                return false;
+            }
+
+            std::uint64_t path_bytes = image.size() - header.paths_offset;
+            const FileRecord* files = files_of(image);
+            for (std::uint32_t id = 0; id < header.file_count; ++id) {
+                if (files[id].path_offset > path_bytes ||
+                    files[id].path_length > path_bytes - files[id].path_offset) {
+                    return false;
+                }
+            }
+
+            std::uint64_t posting_bytes = header.paths_offset - header.postings_offset;
+            const DirectoryEntry* directory = directory_of(image);
+            for (std::uint32_t i = 0; i < header.trigram_count; ++i) {
+                const DirectoryEntry& entry = directory[i];
+                if ((i > 0 && entry.trigram <= directory[i - 1].trigram) ||
+                    entry.count > header.file_count || entry.offset > posting_bytes) {
+                    return false;
+                }
+                PostingCursor cursor(image, entry);
+                std::uint64_t previous = 0;
+                std::uint32_t seen = 0;
+                for (std::uint32_t id; cursor.next(id); ++seen) {
+                    if (id >= header.file_count || (seen > 0 && id <= previous)) return false;
+                    previous = id;
+                }
+                if (cursor.truncated()) return false;
+            }
+            return true;
+        }
+
+        constexpr std::array<unsigned char, 256> kFold = [] {
+            std::array<unsigned char, 256> fold{};
+            for (int c = 0; c < 256; ++c) {
+                fold[static_cast<std::size_t>(c)] =
+                    static_cast<unsigned char>(c >= 'A' && c <= 'Z' ? c + 32 : c);
+            }
+            return fold;
+        }();
+
+        // Distinct trigrams of a text, found with a bitmap over all 2^24 of
+        // them rather than by sorting one entry per input byte
+        class TrigramSet {
+        public:
+            TrigramSet() : seen_(std::size_t{1} << 18) {}
+
+            const std::vector<std::uint32_t>& of(std::string_view text) {
+                for (std::uint32_t t : list_) seen_[t >> 6] &= ~(std::uint64_t{1} << (t & 63));
+                list_.clear();
+
+                // Branch-free: the store always happens and the append only
+                // counts when the bit was new, so unseen trigrams cost no
+                // mispredicts.
+                const auto* data = reinterpret_cast<const unsigned char*>(text.data());
+                list_.resize(text.size());
+                std::size_t unique = 0;
+                std::uint32_t trigram = 0;
+                for (std::size_t i = 0; i < text.size(); ++i) {
+                    trigram = ((trigram << 8) | kFold[data[i]]) & 0xffffff;
+                    if (i < 2) continue;
+                    std::uint64_t word = seen_[trigram >> 6];
+                    std::uint64_t bit = std::uint64_t{1} << (trigram & 63);
+                    seen_[trigram >> 6] = word | bit;
+                    list_[unique] = trigram;
+                    unique += (word & bit) == 0;
+                }
+                list_.resize(unique);
+                std::sort(list_.begin(), list_.end());
+                return list_;
+            }
+
+        private:
+            std::vector<std::uint64_t> seen_;
+            std::vector<std::uint32_t> list_;
+        };
+
+        struct Indexed {
+            std::int64_t mtime_ns = 0;
+            std::uint64_t size = 0;
+            const std::vector<std::uint32_t>* trigrams = nullptr;  // Owned by the TrigramSet
+        };
+
+        // Binary and oversized files get no trigrams, as grep skips them, but
+        // are still tracked so that reconciling does not read them again.
+        // stat() comes first so that a change racing with the read is caught
+        // by the next check.
+        std::optional<Indexed> index_file(const std::string& root, std::string_view path,
+                                          TrigramSet& set, std::size_t max_bytes) {
+            static const std::vector<std::uint32_t> kNone;
+            std::string full = root + "/" + std::string(path);
+            struct stat info {};
+            if (::stat(full.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return std::nullopt;
+
+            Indexed indexed;
+            indexed.mtime_ns = info.st_mtim.tv_sec * 1'000'000'000LL + info.st_mtim.tv_nsec;
+            indexed.size = static_cast<std::uint64_t>(info.st_size);
+            indexed.trigrams = &kNone;
+            if (indexed.size > max_bytes) return indexed;
+
+            auto file = fs::MappedFile::open(full);
+            if (errors::is_error(file)) return std::nullopt;
+            std::string_view bytes = errors::get_value(file).bytes();
+            if (fs::sniff_encoding(bytes) != fs::Encoding::Binary) {
+                indexed.trigrams = &set.of(bytes);
+            }
+            return indexed;
+        }
+
+        // Accumulates files and postings, then lays them out as a snapshot
+        class ImageBuilder {
+        public:
+            std::uint32_t add_file(std::string_view path, std::int64_t mtime_ns,
+                                   std::uint64_t size) {
+                files_.push_back(FileRecord{paths_.size(), static_cast<std::uint32_t>(path.size()),
+                                            0, mtime_ns, size});
+                paths_.append(path);
+                return static_cast<std::uint32_t>(files_.size() - 1);
+            }
+
+            // Each trigram must see its files in increasing id order
+            void add(std::uint32_t trigram, std::uint32_t file) {
+                Postings& postings = postings_[trigram];
+                put_varint(postings.bytes, postings.count == 0 ? file : file - postings.last);
+                postings.last = file;
+                ++postings.count;
+            }
+
+            std::string finish(const std::string& root) {
+                std::vector<std::uint32_t> trigrams;
+                trigrams.reserve(postings_.size());
+                std::size_t posting_bytes = 0;
+                for (const auto& [trigram, postings] : postings_) {
+                    trigrams.push_back(trigram);
+                    posting_bytes += postings.bytes.size();
+                }
+                std::sort(trigrams.begin(), trigrams.end());
+
+                Header header{};
+                std::memcpy(header.magic, kMagic, sizeof(kMagic));
+                header.version = kVersion;
+                header.file_count = static_cast<std::uint32_t>(files_.size());
+                header.trigram_count = static_cast<std::uint32_t>(trigrams.size());
+                header.root_length = static_cast<std::uint32_t>(root.size());
+                header.files_offset = align8(sizeof(Header) + root.size());
+                header.directory_offset = header.files_offset + files_.size() * sizeof(FileRecord);
+                header.postings_offset =
+                    header.directory_offset + trigrams.size() * sizeof(DirectoryEntry);
+                header.paths_offset = header.postings_offset + posting_bytes;
+                header.total_bytes = header.paths_offset + paths_.size();
+
+                std::string image(header.total_bytes, '\0');
+                std::memcpy(image.data(), &header, sizeof(header));
+                std::memcpy(image.data() + sizeof(Header), root.data(), root.size());
+                if (!files_.empty()) {
+                    std::memcpy(image.data() + header.files_offset, files_.data(),
+                                files_.size() * sizeof(FileRecord));
+                }
+                auto* directory =
+                    reinterpret_cast<DirectoryEntry*>(image.data() + header.directory_offset);
+                std::size_t offset = 0;
+                for (std::size_t i = 0; i < trigrams.size(); ++i) {
+                    const Postings& postings = postings_[trigrams[i]];
+                    directory[i] = DirectoryEntry{trigrams[i], postings.count, offset};
+                    std::memcpy(image.data() + header.postings_offset + offset,
+                                postings.bytes.data(), postings.bytes.size());
+                    offset += postings.bytes.size();
+                }
+                std::memcpy(image.data() + header.paths_offset, paths_.data(), paths_.size());
+                return image;
+            }
+
+        private:
+            struct Postings {
+                std::uint32_t last = 0;
+                std::uint32_t count = 0;
+                std::string bytes;
+            };
+            std::vector<FileRecord> files_;
+            std::string paths_;
+            std::unordered_map<std::uint32_t, Postings> postings_;
+        };
+
+        std::string normalize(const std::string& root) {
+            std::error_code error;
+            auto absolute = std::filesystem::absolute(root, error);
+            std::string path =
+                (error ? std::filesystem::path(root) : absolute).lexically_normal().string();
+            if (path.size() > 1 && path.back() == '/') path.pop_back();
+            return path;
+        }
+
+    } // namespace
+
+    TrigramIndex::TrigramIndex(std::string root, TrigramIndexOptions options)
+        : root_(std::move(root)), options_(std::move(options)) {}
+
+    TrigramIndex::~TrigramIndex() {
+        watcher_.reset();  // No events may arrive once members start going away
+    }
+
+    errors::Result<std::unique_ptr<TrigramIndex>> TrigramIndex::open(
+        const std::string& root, TrigramIndexOptions options) {
+        std::unique_ptr<TrigramIndex> index(new TrigramIndex(normalize(root), std::move(options)));
+        if (index->load()) {
+            index->reconcile();
+            if (!index->pending_.empty() || index->shadowed_count_ > 0) {
+                auto saved = index->save();
+                if (errors::is_error(saved)) return errors::get_error(saved);
+            }
+            return index;
+        }
+        auto built = index->build();
+        if (errors::is_error(built)) return errors::get_error(built);
+        return index;
+    }
+
+    // --- Building and loading snapshots ---
+
+    errors::Status TrigramIndex::build() {
+        ImageBuilder builder;
+        std::mutex builder_mutex;
+
+        // One 2 MiB scratch bitmap per walker thread
+        std::mutex sets_mutex;
+        std::unordered_map<std::thread::id, std::unique_ptr<TrigramSet>> sets;
+        auto set_for_this_thread = [&]() -> TrigramSet& {
+            std::lock_guard<std::mutex> lock(sets_mutex);
+            auto& set = sets[std::this_thread::get_id()];
+            if (!set) set = std::make_unique<TrigramSet>();
+            return *set;
+        };
+
+        fs::WalkOptions walk = options_.walk;
+        walk.threads = options_.threads;
+        auto walked = fs::walk(root_, walk, [&](const fs::WalkEntry& entry) {
+            if (entry.is_dir) return true;
+            auto indexed = index_file(root_, entry.path, set_for_this_thread(),
+                                      options_.max_file_bytes);
+            if (!indexed) return true;
+            std::lock_guard<std::mutex> lock(builder_mutex);
+            std::uint32_t id = builder.add_file(entry.path, indexed->mtime_ns, indexed->size);
+            for (std::uint32_t trigram : *indexed->trigrams) builder.add(trigram, id);
+            return true;
+        });
+        if (errors::is_error(walked)) return errors::get_error(walked);
+
+        std::unique_lock lock(mutex_);
+        pending_.clear();
+        adopt_locked(builder.finish(root_));
+        ++stats_.builds;
+        return write_locked();
+    }
+
+    bool TrigramIndex::load() {
+        if (options_.path.empty()) return false;
+        auto file = fs::MappedFile::open(options_.path, fs::MappedFile::Access::Random);
+        if (errors::is_error(file)) return false;
+        if (!valid(errors::get_value(file).bytes(), root_)) {
+            LOG_WARN("Ignoring trigram index " + options_.path +
+                     ": stale format, other root or corrupt");
+            return false;
+        }
+
+        std::unique_lock lock(mutex_);
+        mapped_.emplace(std::move(std::get<fs::MappedFile>(file)));
+        built_.clear();
+        image_ = mapped_->bytes();
+        index_paths_locked();
+        return true;
+    }
+
+    void TrigramIndex::adopt_locked(std::string image) {
+        built_ = std::move(image);
+        mapped_.reset();
+        image_ = built_;
+        index_paths_locked();
+    }
+
+    void TrigramIndex::index_paths_locked() {
+        std::uint32_t count = header_of(image_).file_count;
+        ids_.clear();
+        ids_.reserve(count);
+        for (std::uint32_t id = 0; id < count; ++id) ids_.emplace(path_of(image_, id), id);
+        shadowed_.assign(count, false);
+        shadowed_count_ = 0;
+    }
+
+    void TrigramIndex::compact_locked() {
+        const Header& header = header_of(image_);
+        const FileRecord* files = files_of(image_);
+        ImageBuilder builder;
+
+        // Surviving snapshot files keep their relative order, pending ones follow
+        constexpr std::uint32_t kGone = ~std::uint32_t{0};
+        std::vector<std::uint32_t> remap(header.file_count, kGone);
+        for (std::uint32_t id = 0; id < header.file_count; ++id) {
+            if (shadowed_[id]) continue;
+            remap[id] = builder.add_file(path_of(image_, id), files[id].mtime_ns, files[id].size);
+        }
+        auto first_pending = static_cast<std::uint32_t>(header.file_count - shadowed_count_);
+        for (const auto& [path, entry] : pending_) {
+            builder.add_file(path, entry.mtime_ns, entry.size);
+        }
+
+        const DirectoryEntry* directory = directory_of(image_);
+        for (std::uint32_t i = 0; i < header.trigram_count; ++i) {
+            PostingCursor cursor(image_, directory[i]);
+            for (std::uint32_t id; cursor.next(id);) {
+                if (remap[id] != kGone) builder.add(directory[i].trigram, remap[id]);
+            }
+        }
+        std::uint32_t id = first_pending;
+        for (const auto& [path, entry] : pending_) {
+            for (std::uint32_t trigram : entry.trigrams) builder.add(trigram, id);
+            ++id;
+        }
+
+        pending_.clear();
+        adopt_locked(builder.finish(root_));
+        ++stats_.builds;
+    }
+
+    errors::Status TrigramIndex::write_locked() {
+        if (options_.path.empty() || mapped_) return std::monostate{};  // Nothing new to write
+
+        std::string temp = options_.path + ".tmp";
+        {
+            std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+            out.write(image_.data(), static_cast<std::streamsize>(image_.size()));
+            out.flush();
+            if (!out) {
+                std::error_code ec;
+                std::filesystem::remove(temp, ec);
+                return AgentError{ErrorCategory::Execution,
+                                  "Cannot write trigram index " + options_.path};
+            }
+        }
+        std::error_code ec;
+        std::filesystem::rename(temp, options_.path, ec);
+        if (ec) {
+            std::filesystem::remove(temp, ec);
+            return AgentError{ErrorCategory::Execution,
+                              "Cannot write trigram index " + options_.path};
+        }
+
+        // Serve from the page cache rather than keeping a private copy
+        auto file = fs::MappedFile::open(options_.path, fs::MappedFile::Access::Random);
+        if (!errors::is_error(file) && errors::get_value(file).size() == image_.size()) {
+            mapped_.emplace(std::move(std::get<fs::MappedFile>(file)));
+            image_ = mapped_->bytes();
+            built_.clear();
+            built_.shrink_to_fit();
+            index_paths_locked();
+        }
+        return std::monostate{};
+    }
+
+    errors::Status TrigramIndex::save() {
+        std::unique_lock lock(mutex_);
+        if (!pending_.empty() || shadowed_count_ > 0) compact_locked();
+        return write_locked();
+    }
+
+    // --- Incremental updates ---
+
+    void TrigramIndex::apply(const std::string& path, std::optional<Pending> entry) {
+        std::unique_lock lock(mutex_);
+        auto it = ids_.find(path);
+        if (it != ids_.end() && !shadowed_[it->second]) {
+            shadowed_[it->second] = true;
+            ++shadowed_count_;
+        }
+        if (entry) {
+            pending_[path] = std::move(*entry);
+        } else {
+            pending_.erase(path);
+        }
+        ++stats_.updates;
+
+        std::size_t limit = std::max<std::size_t>(kMinPendingToCompact, ids_.size() / 8);
+        if (pending_.size() + shadowed_count_ > limit) {
+            compact_locked();
+            auto written = write_locked();
+            if (errors::is_error(written)) LOG_WARN(errors::get_error(written).message);
+        }
+    }
+
+    void TrigramIndex::update(std::string_view path) {
+        TrigramSet set;
+        std::optional<Pending> entry;
+        if (!fs::walk_skips(root_, path, false, options_.walk)) {
+            if (auto indexed = index_file(root_, path, set, options_.max_file_bytes)) {
+                entry = Pending{*indexed->trigrams, indexed->mtime_ns, indexed->size};
+            }
+        }
+        apply(std::string(path), std::move(entry));
+    }
+
+    void TrigramIndex::remove_below(const std::string& directory) {
+        std::string prefix = directory + "/";
+        std::unique_lock lock(mutex_);
+        for (const auto& [path, id] : ids_) {
+            if (!shadowed_[id] && path.starts_with(prefix)) {
+                shadowed_[id] = true;
+                ++shadowed_count_;
+            }
+        }
+        auto it = pending_.lower_bound(prefix);
+        while (it != pending_.end() && it->first.starts_with(prefix)) it = pending_.erase(it);
+    }
+
+    void TrigramIndex::reconcile() {
+        // stat() everything the walk finds; only files that changed are read
+        std::mutex mutex;
+        std::vector<bool> seen;
+        std::unordered_set<std::string> seen_pending;
+        std::vector<std::string> changed;
+        {
+            std::shared_lock lock(mutex_);
+            seen.assign(ids_.size(), false);
+        }
+
+        fs::WalkOptions walk = options_.walk;
+        walk.threads = options_.threads;
+        auto walked = fs::walk(root_, walk, [&](const fs::WalkEntry& entry) {
+            if (entry.is_dir) return true;
+            struct stat info {};
+            std::string full = root_ + "/" + std::string(entry.path);
+            if (::stat(full.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return true;
+            std::int64_t mtime_ns = info.st_mtim.tv_sec * 1'000'000'000LL + info.st_mtim.tv_nsec;
+            auto size = static_cast<std::uint64_t>(info.st_size);
+
+            std::shared_lock lock(mutex_);
+            std::lock_guard<std::mutex> guard(mutex);
+            auto pending = pending_.find(std::string(entry.path));
+            if (pending != pending_.end()) {
+                seen_pending.insert(pending->first);
+                if (pending->second.mtime_ns == mtime_ns && pending->second.size == size) {
+                    return true;
+                }
+            } else if (auto id = ids_.find(entry.path); id != ids_.end()) {
+                if (!shadowed_[id->second]) {
+                    seen[id->second] = true;
+                    const FileRecord& record = files_of(image_)[id->second];
+                    if (record.mtime_ns == mtime_ns && record.size == size) return true;
+                }
+            }
+            changed.emplace_back(entry.path);
+            return true;
+        });
+        if (errors::is_error(walked)) {
+            LOG_WARN("Trigram index: " + errors::get_error(walked).message);
+            return;
+        }
+
+        std::vector<std::string> gone;
+        {
+            std::shared_lock lock(mutex_);
+            for (const auto& [path, id] : ids_) {
+                if (!shadowed_[id] && !seen[id]) gone.emplace_back(path);
+            }
+            for (const auto& [path, entry] : pending_) {
+                if (!seen_pending.count(path)) gone.push_back(path);
+            }
+        }
+        for (const auto& path : gone) apply(path, std::nullopt);
+
+        TrigramSet set;
+        for (const auto& path : changed) {
+            std::optional<Pending> entry;
+            if (auto indexed = index_file(root_, path, set, options_.max_file_bytes)) {
+                entry = Pending{*indexed->trigrams, indexed->mtime_ns, indexed->size};
+            }
+            apply(path, std::move(entry));
+        }
+    }
+
+    errors::Status TrigramIndex::watch() {
+        if (!watcher_) {
+            watcher_ = std::make_unique<fs::TreeWatcher>(
+                [this](const fs::TreeEvent& event) { on_event(event); });
+        }
+        return watcher_->watch(root_);
+    }
+
+    void TrigramIndex::on_event(const fs::TreeEvent& event) {
+        std::string prefix = root_ + "/";
+        if (event.kind == fs::TreeEvent::Kind::Overflow) {
+            reconcile();
+            return;
+        }
+        if (!event.path.starts_with(prefix)) return;
+        std::string path = event.path.substr(prefix.size());
+
+        if (event.kind == fs::TreeEvent::Kind::File) {
+            // New ignore rules can change which files are indexed anywhere below
+            if (path == ".gitignore" || path.ends_with("/.gitignore")) {
+                reconcile();
+            } else {
+                update(path);
+            }
+            return;
+        }
+
+        remove_below(path);
+        struct stat info {};
+        if (::stat(event.path.c_str(), &info) != 0 || !S_ISDIR(info.st_mode) ||
+            fs::walk_skips(root_, path, true, options_.walk)) {
+            return;
+        }
+        // A directory created or moved in: index what is already inside
+        std::vector<std::string> found;
+        std::mutex mutex;
+        fs::WalkOptions walk = options_.walk;
+        walk.threads = 1;
+        auto walked = fs::walk(event.path, walk, [&](const fs::WalkEntry& entry) {
+            if (!entry.is_dir) {
+                std::lock_guard<std::mutex> lock(mutex);
+                found.push_back(path + "/" + std::string(entry.path));
+            }
+            return true;
+        });
+        if (errors::is_error(walked)) return;
+        for (const auto& file : found) update(file);
+    }
+
+    // --- Queries ---
+
+    std::optional<std::vector<std::string>> TrigramIndex::candidates(
+        std::string_view literal) const {
+        if (literal.size() < 3) return std::nullopt;
+        queries_.fetch_add(1, std::memory_order_relaxed);
+
+        std::vector<std::uint32_t> wanted;
+        for (std::size_t i = 2; i < literal.size(); ++i) {
+            wanted.push_back(std::uint32_t{kFold[static_cast<unsigned char>(literal[i - 2])]}
+                                 << 16 |
+                             std::uint32_t{kFold[static_cast<unsigned char>(literal[i - 1])]}
+                                 << 8 |
+                             kFold[static_cast<unsigned char>(literal[i])]);
+        }
+        std::sort(wanted.begin(), wanted.end());
+        wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+        std::shared_lock lock(mutex_);
+        std::vector<std::string> files;
+
+        // 1. Snapshot: intersect the posting lists, rarest first
+        const Header& header = header_of(image_);
+        const DirectoryEntry* directory = directory_of(image_);
+        const DirectoryEntry* end = directory + header.trigram_count;
+        std::vector<const DirectoryEntry*> lists;
+        for (std::uint32_t trigram : wanted) {
+            const DirectoryEntry* entry = std::lower_bound(
+                directory, end, trigram,
+                [](const DirectoryEntry& e, std::uint32_t t) { return e.trigram < t; });
+            if (entry == end || entry->trigram != trigram) {
+                lists.clear();
+                break;
+            }
+            lists.push_back(entry);
+        }
+        if (!lists.empty()) {
+            std::sort(lists.begin(), lists.end(),
+                      [](const auto* a, const auto* b) { return a->count < b->count; });
+            std::vector<std::uint32_t> ids;
+            PostingCursor first(image_, *lists[0]);
+            for (std::uint32_t id; first.next(id);) ids.push_back(id);
+
+            for (std::size_t i = 1; i < lists.size() && !ids.empty(); ++i) {
+                PostingCursor cursor(image_, *lists[i]);
+                std::size_t kept = 0;
+                std::uint32_t id = 0;
+                bool more = cursor.next(id);
+                for (std::uint32_t want : ids) {
+                    while (more && id < want) more = cursor.next(id);
+                    if (!more) break;
+                    if (id == want) ids[kept++] = want;
+                }
+                ids.resize(kept);
+            }
+            for (std::uint32_t id : ids) {
+                if (!shadowed_[id]) files.emplace_back(path_of(image_, id));
+            }
+        }
+
+        // 2. Pending files
+        for (const auto& [path, entry] : pending_) {
+            if (std::includes(entry.trigrams.begin(), entry.trigrams.end(), wanted.begin(),
+                              wanted.end())) {
+                files.push_back(path);
+            }
+        }
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    TrigramIndexStats TrigramIndex::stats() const {
+        std::shared_lock lock(mutex_);
+        TrigramIndexStats stats = stats_;
+        stats.files = ids_.size() - shadowed_count_ + pending_.size();
+        stats.trigrams = header_of(image_).trigram_count;
+        stats.snapshot_bytes = image_.size();
+        stats.pending = pending_.size();
+        stats.queries = queries_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+} // namespace agent::core::search
@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/fs/mapped_file.hpp"
+#include "core/fs/tree_watcher.hpp"
+#include "core/fs/workspace_walker.hpp"
+
+namespace agent::core::search {
+
+    struct TrigramIndexOptions {
+        std::string path;                        // Snapshot file; empty keeps the index in memory
+        std::size_t max_file_bytes = 64u << 20;  // Larger files are left out, as grep skips them
+        std::size_t threads = 0;                 // Build threads; 0: one per core
+        fs::WalkOptions walk;                    // Which files the index covers
+    };
+
+    struct TrigramIndexStats {
+        std::size_t files = 0;           // Including pending ones, and binary ones (no trigrams)
+        std::size_t trigrams = 0;        // Distinct trigrams in the snapshot
+        std::size_t snapshot_bytes = 0;
+        std::size_t pending = 0;         // Files changed since the snapshot, indexed in memory
+        std::size_t builds = 0;          // Snapshots built or rewritten
+        std::size_t updates = 0;         // Files reindexed one at a time
+        std::size_t queries = 0;
+    };
+
+    // Inverted index from every three-byte sequence (ASCII letters folded to
+    // lowercase) to the files containing it. A literal that every match of a
+    // query must contain narrows the search to the files holding all of its
+    // trigrams, so repeated searches read a handful of files rather than the
+    // whole workspace.
+    //
+    // The index is a snapshot plus pending changes. The snapshot is one flat
+    // image (a file table, a sorted trigram directory and delta-encoded
+    // posting lists) that is mmap'ed from disk as is. Files that change
+    // afterwards are reindexed into memory, shadowing their snapshot entry,
+    // and folded into a new snapshot by save() or once they pile up.
+    //
+    // Safe to query from any thread while updates are applied.
+    class TrigramIndex {
+    public:
+        // Loads the snapshot at options.path and reindexes what changed since
+        // it was written; builds from scratch (and saves) when there is none
+        static errors::Result<std::unique_ptr<TrigramIndex>> open(const std::string& root,
+                                                                  TrigramIndexOptions options = {});
+        ~TrigramIndex();
+
+        TrigramIndex(const TrigramIndex&) = delete;
+        TrigramIndex& operator=(const TrigramIndex&) = delete;
+
+        // Keeps the index current from inotify events
+        errors::Status watch();
+
+        // Reindexes one file (relative to the root) now, e.g. after a tool wrote it
+        void update(std::string_view path);
+
+        // Files (relative, sorted) that may contain literal, compared case-insensitively.
+        // nullopt when the literal is too short to narrow anything down.
+        std::optional<std::vector<std::string>> candidates(std::string_view literal) const;
+
+        // Folds pending changes into a new snapshot and writes it to options.path
+        errors::Status save();
+
+        const std::string& root() const { return root_; }
+        TrigramIndexStats stats() const;
+
+    private:
+        struct Pending {
+            std::vector<std::uint32_t> trigrams;  // Sorted
+            std::int64_t mtime_ns = 0;
+            std::uint64_t size = 0;
+        };
+
+        TrigramIndex(std::string root, TrigramIndexOptions options);
+
+        std::string root_;
+        TrigramIndexOptions options_;
+
+        mutable std::shared_mutex mutex_;
+        std::optional<fs::MappedFile> mapped_;  // The snapshot, when it came from disk
+        std::string built_;                     // ... or when it was built in memory
+        std::string_view image_;
+        std::unordered_map<std::string_view, std::uint32_t> ids_;  // Snapshot path -> file id
+        std::vector<bool> shadowed_;            // Snapshot files deleted or pending
+        std::size_t shadowed_count_ = 0;
+        std::map<std::string, Pending> pending_;
+        TrigramIndexStats stats_;
+        mutable std::atomic<std::size_t> queries_{0};
+
+        std::unique_ptr<fs::TreeWatcher> watcher_;
+
+        errors::Status build();
+        bool load();
+        void reconcile();
+        void adopt_locked(std::string image);
+        void index_paths_locked();
+        void compact_locked();
+        errors::Status write_locked();
+        void apply(const std::string& path, std::optional<Pending> entry);
+        void remove_below(const std::string& directory);
+        void on_event(const fs::TreeEvent& event);
+    };
+
+} // namespace agent::core::search
@@ -0,0 +1,101 @@
+#include "core/storage/blob_store.hpp"
+#include <unistd.h>
+#include <atomic>
+#include <filesystem>
+#include <sstream>
+#include "core/hash/stable_hash.hpp"
+
+namespace agent::core::storage {
+
+    using errors::AgentError;
+    using errors::ErrorCategory;
+
+    BlobStore::BlobStore(std::string directory) : directory_(std::move(directory)) {
+        std::error_code ec;
+        std::filesystem::create_directories(directory_, ec);
+    }
+
+    std::string BlobStore::path_for(const std::string& id) const {
+        return directory_ + "/" + id + ".blob";
+    }
+
+    errors::Result<BlobStore::Writer> BlobStore::open() const {
+        static std::atomic<unsigned> counter{0};
+        std::string temp = directory_ + "/.incoming." + std::to_string(::getpid()) + "." +
+                           std::to_string(counter++);
+        Writer writer(*this, temp);
+        if (!writer.out_) return AgentError{ErrorCategory::Internal, "Cannot write " + temp};
+        return writer;
+    }
+
+    errors::Result<std::string> BlobStore::put(std::string_view bytes) const {
+        auto writer = open();
+        if (errors::is_error(writer)) return errors::get_error(writer);
+        auto& open_writer = std::get<Writer>(writer);
+        open_writer.write(bytes);
+        return open_writer.commit();
+    }
+
+    errors::Result<std::string> BlobStore::read(const std::string& id) const {
+        std::ifstream in(path_for(id), std::ios::binary);
+        if (!in) return AgentError{ErrorCategory::Input, "Unknown blob: " + id};
+        std::stringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    // --- Writer ---
+
+    BlobStore::Writer::Writer(const BlobStore& store, std::string temp_path)
+        : store_(&store), temp_path_(std::move(temp_path)),
+          out_(temp_path_, std::ios::binary | std::ios::trunc), hash_(hash::kFnvOffset) {}
+
+    BlobStore::Writer::Writer(Writer&& other) noexcept
+        : store_(other.store_), temp_path_(std::move(other.temp_path_)),
+          out_(std::move(other.out_)), hash_(other.hash_), size_(other.size_),
+          failed_(other.failed_), done_(other.done_) {
+        other.done_ = true;
+    }
+
+    BlobStore::Writer::~Writer() {
+        if (done_) return;
+        out_.close();
+        std::error_code ec;
+        std::filesystem::remove(temp_path_, ec);
+    }
+
+    bool BlobStore::Writer::write(std::string_view bytes) {
+        if (failed_ || done_) return false;
+        out_.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        if (!out_) {
+            failed_ = true;
+            return false;
+        }
+        hash_ = hash::stable_hash(bytes, hash_);
+        size_ += bytes.size();
+        return true;
+    }
+
+    errors::Result<std::string> BlobStore::Writer::commit() {
+        if (done_) return AgentError{ErrorCategory::Internal, "Blob already committed"};
+        out_.flush();
+        bool ok = !failed_ && out_.good();
+        out_.close();
+        done_ = true;
+
+        std::error_code ec;
+        if (!ok) {
+            std::filesystem::remove(temp_path_, ec);
+            return AgentError{ErrorCategory::Internal, "Short write " + temp_path_};
+        }
+
+        std::string id = hash::to_hex(hash_);
+        std::filesystem::rename(temp_path_, store_->path_for(id), ec);
+        if (ec) {
+            std::filesystem::remove(temp_path_, ec);
+            return AgentError{ErrorCategory::Internal, "Cannot store blob " + id};
+        }
+        return id;
+    }
+
+} // namespace agent::core::storage
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include "core/errors/agent_errors.hpp"
+
+namespace agent::core::storage {
+
+    // Content-addressed files on disk for payloads too large to keep in memory
+    // or in the conversation (full command logs, big file snapshots). A blob's
+    // id is the stable hash of its bytes, so storing the same output twice
+    // costs one file.
+    class BlobStore {
+    public:
+        explicit BlobStore(std::string directory);
+
+        // Streams one blob to a temporary file; commit() hashes it into place.
+        // A writer that is destroyed without commit() leaves nothing behind.
+        class Writer {
+        public:
+            Writer(Writer&& other) noexcept;
+            Writer& operator=(Writer&&) = delete;
+            ~Writer();
+
+            // Returns false once a write has failed (disk full, ...); later writes are dropped
+            bool write(std::string_view bytes);
+            std::uint64_t size() const { return size_; }
+
+            // Returns the blob id
+            errors::Result<std::string> commit();
+
+        private:
+            friend class BlobStore;
+            Writer(const BlobStore& store, std::string temp_path);
+
+            const BlobStore* store_;
+            std::string temp_path_;
+            std::ofstream out_;
+            std::uint64_t hash_;
+            std::uint64_t size_ = 0;
+            bool failed_ = false;
+            bool done_ = false;
+        };
+
+        errors::Result<Writer> open() const;
+        errors::Result<std::string> put(std::string_view bytes) const;
+        errors::Result<std::string> read(const std::string& id) const;
+
+        std::string path_for(const std::string& id) const;
+        const std::string& directory() const { return directory_; }
+
+    private:
+        std::string directory_;
+    };
+
+} // namespace agent::core::storage
@@ -0,0 +1,125 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "protocol/event_contract.hpp"
+#include "protocol/tool_contract.hpp"
+
+namespace agent::core::streaming {
+
+    // Tracks the structure of a JSON value that arrives in pieces.
+    // It does not build a DOM; it only answers "is the value finished yet?"
+    // so that we can react to a tool call before the model stops talking.
+    class IncrementalArgumentParser {
+    public:
+        enum class State {
+            Incomplete,  // Still waiting for more bytes
+            Complete,    // The top-level object/array has been closed
+            Invalid      // The stream can never become valid JSON
+        };
+
+        // Feeds the next fragment and returns the updated state
+        State feed(std::string_view fragment) {
+            for (char c : fragment) {
+                if (state_ != State::Incomplete) {
+                    // Only whitespace may follow a complete value
+                    if (state_ == State::Complete && !is_space(c)) state_ = State::Invalid;
+                    continue;
+                }
+                step(c);
+            }
+            return state_;
+        }
+
+        State state() const { return state_; }
+        bool is_complete() const { return state_ == State::Complete; }
+
+        void reset() { *this = IncrementalArgumentParser{}; }
+
+    private:
+        State state_ = State::Incomplete;
+        std::vector<char> stack_;  // Open brackets: '{' or '['
+        bool in_string_ = false;
+        bool escaped_ = false;
+
+        static bool is_space(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+        void step(char c) {
+            if (in_string_) {
+                if (escaped_) {
+                    escaped_ = false;
+                } else if (c == '\\') {
+                    escaped_ = true;
+                } else if (c == '"') {
+                    in_string_ = false;
+                }
+                return;
+            }
+
+            if (stack_.empty()) {
+                // Tool arguments are always an object (or, rarely, an array)
+                if (is_space(c)) return;
+                if (c == '{' || c == '[') {
+                    stack_.push_back(c);
+                } else {
+                    state_ = State::Invalid;
+                }
+                return;
+            }
+
+            switch (c) {
+                case '"': in_string_ = true; break;
+                case '{':
+                case '[': stack_.push_back(c); break;
+                case '}':
+                case ']': {
+                    char open = (c == '}') ? '{' : '[';
+                    if (stack_.back() != open) {
+                        state_ = State::Invalid;
+                        return;
+                    }
+                    stack_.pop_back();
+                    if (stack_.empty()) state_ = State::Complete;
+                    break;
+                }
+                default: break;
+            }
+        }
+    };
+
+    // Reassembles streamed ToolCallDeltaEvents into whole ToolCalls.
+    // feed() hands back a ToolCall the moment its arguments close, which is
+    // usually well before the provider reports StopReason::ToolCall.
+    class ToolCallAssembler {
+    public:
+        std::optional<protocol::ToolCall> feed(const protocol::ToolCallDeltaEvent& delta) {
+            if (delta.index >= partials_.size()) partials_.resize(delta.index + 1);
+            Partial& partial = partials_[delta.index];
+
+            if (!delta.id.empty()) partial.call.id = delta.id;
+            if (!delta.name.empty()) partial.call.name += delta.name;
+            partial.call.arguments += delta.arguments_delta;
+
+            bool was_complete = partial.parser.is_complete();
+            partial.parser.feed(delta.arguments_delta);
+
+            // Report each call exactly once, on the fragment that closed it
+            if (!was_complete && partial.parser.is_complete() && !partial.call.name.empty()) {
+                return partial.call;
+            }
+            return std::nullopt;
+        }
+
+        void reset() { partials_.clear(); }
+
+    private:
+        struct Partial {
+            protocol::ToolCall call;
+            IncrementalArgumentParser parser;
+        };
+        std::vector<Partial> partials_;
+    };
+
+} // namespace agent::core::streaming
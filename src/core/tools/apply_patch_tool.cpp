@@ -0,0 +1,208 @@
+#include "core/tools/apply_patch_tool.hpp"
+#include <deque>
+#include <filesystem>
+#include <optional>
+#include <vector>
+#include "core/diff/line_diff.hpp"
+#include "core/diff/patch.hpp"
+#include "core/fs/file_transaction.hpp"
+#include "core/fs/mapped_file.hpp"
+#include "core/fs/text_scan.hpp"
+
+namespace agent::core::tools {
+
+    namespace {
+
+        // Relative, and not climbing out of the root
+        bool inside_root(const std::string& path) {
+            if (path.empty() || path[0] == '/') return false;
+            for (const auto& part : std::filesystem::path(path)) {
+                if (part == "..") return false;
+            }
+            return true;
+        }
+
+        // One file the patch touches, before and after
+        struct Target {
+            std::string path;  // As the patch names it
+            std::string full;
+            std::optional<fs::ResolvedPath> resolved;  // What the policy checked, held open
+            fs::FileStamp stamp;
+            std::optional<std::string> original;  // nullopt: did not exist
+            std::optional<std::string> content;   // nullopt: does not exist afterwards
+            bool binary = false;
+        };
+
+        std::string label(const char* prefix, const std::optional<std::string>& text,
+                          const std::string& path) {
+            if (!text) return "/dev/null";
+            return std::string(prefix).append(path);
+        }
+
+    } // namespace
+
+    ApplyPatchTool::ApplyPatchTool(ApplyPatchOptions options)
+        : TypedTool("apply_patch",
+                    "Apply a unified diff (as git diff prints it) to one or more files in one "
+                    "step. Use --- /dev/null to create a file and +++ /dev/null to delete one. "
+                    "Line numbers in @@ headers are only hints, but context and removed lines "
+                    "must match the file. If any hunk does not apply, nothing is written and "
+                    "every problem is listed."),
+          options_(std::move(options)) {}
+
+    protocol::ToolResult ApplyPatchTool::run(const protocol::ToolCall& call,
+                                             const ApplyPatchArgs& args) {
+        auto parsed = diff::parse_patch(args.patch);
+        if (errors::is_error(parsed)) {
+            return failure(call, "apply_patch: " + errors::get_error(parsed).message);
+        }
+
+        // 1. Work out every new content in memory; a deque keeps Target* valid
+        std::deque<Target> targets;
+        std::vector<std::string> problems;
+        auto load = [&](const std::string& path) -> Target* {
+            for (auto& target : targets) {
+                if (target.path == path) return &target;
+            }
+            Target target;
+            target.path = path;
+            if (options_.policy) {
+                auto resolved =
+                    options_.policy->resolve(path, fs::PathAccess::Write, options_.root);
+                if (errors::is_error(resolved)) {
+                    problems.push_back(errors::get_error(resolved).message);
+                    return nullptr;
+                }
+                target.resolved.emplace(std::move(std::get<fs::ResolvedPath>(resolved)));
+                target.full = target.resolved->path();
+            } else if (inside_root(path)) {
+                target.full = options_.root.empty() ? path : options_.root + "/" + path;
+            } else {
+                problems.push_back(path + ": outside the workspace");
+                return nullptr;
+            }
+            // Everything after the check goes through the parent it left open
+            target.stamp = target.resolved ? fs::stamp(*target.resolved) : fs::stamp(target.full);
+            if (target.stamp.exists) {
+                if (options_.cache) {
+                    auto snapshot = target.resolved ? options_.cache->snapshot(*target.resolved)
+                                                    : options_.cache->snapshot(target.full);
+                    if (errors::is_error(snapshot)) {
+                        problems.push_back(errors::get_error(snapshot).message);
+                        return nullptr;
+                    }
+                    target.stamp = errors::get_value(snapshot).stamp;
+                    target.original = *errors::get_value(snapshot).content;
+                } else {
+                    auto file = target.resolved ? fs::MappedFile::open(*target.resolved)
+                                                : fs::MappedFile::open(target.full);
+                    if (errors::is_error(file)) {
+                        problems.push_back(errors::get_error(file).message);
+                        return nullptr;
+                    }
+                    target.original = std::string(errors::get_value(file).bytes());
+                }
+                target.binary = fs::sniff_encoding(*target.original) == fs::Encoding::Binary;
+                target.content = target.original;
+            }
+            targets.push_back(std::move(target));
+            return &targets.back();
+        };
+
+        for (const auto& file : errors::get_value(parsed)) {
+            const std::string& source = file.creates() ? file.new_path : file.old_path;
+            Target* from = load(source);
+            if (!from) continue;
+            if (from->binary) {
+                problems.push_back(source + ": binary file");
+                continue;
+            }
+            if (file.creates() && from->content) {
+                problems.push_back(source + ": already exists");
+                continue;
+            }
+            if (!file.creates() && !from->content) {
+                problems.push_back(source + ": no such file");
+                continue;
+            }
+            auto applied = diff::apply_hunks(from->content.value_or(""), file.hunks);
+            if (errors::is_error(applied)) {
+                std::string_view message = errors::get_error(applied).message;
+                while (!message.empty()) {
+                    std::size_t end = std::min(message.find('\n'), message.size());
+                    problems.push_back(source + ": " + std::string(message.substr(0, end)));
+                    message.remove_prefix(std::min(end + 1, message.size()));
+                }
+                continue;
+            }
+            if (file.deletes()) {
+                if (!std::get<std::string>(applied).empty()) {
+                    problems.push_back(source + ": deletion does not match the whole file");
+                    continue;
+                }
+                from->content.reset();
+                continue;
+            }
+            Target* to = from;
+            if (!file.creates() && file.new_path != file.old_path) {
+                to = load(file.new_path);
+                if (!to) continue;
+                if (to->content) {
+                    problems.push_back(file.new_path + ": already exists");
+                    continue;
+                }
+                from->content.reset();
+            }
+            to->content = std::get<std::string>(std::move(applied));
+        }
+        if (!problems.empty()) {
+            std::string message = "apply_patch: nothing was written; the patch does not apply:";
+            for (const auto& problem : problems) message.append("\n").append(problem);
+            return failure(call, std::move(message));
+        }
+
+        // 2. Commit them together
+        fs::FileTransaction transaction({options_.sync});
+        for (auto& target : targets) {
+            if (target.content == target.original) continue;
+            if (target.content && target.resolved) {
+                transaction.write(std::move(*target.resolved), *target.content, target.stamp);
+            } else if (target.content) {
+                transaction.write(target.full, *target.content, target.stamp);
+            } else if (target.resolved) {
+                transaction.remove(std::move(*target.resolved), target.stamp);
+            } else {
+                transaction.remove(target.full, target.stamp);
+            }
+        }
+        if (transaction.size() > 0) {
+            auto committed = transaction.commit();
+            if (options_.cache) {
+                for (const auto& target : targets) options_.cache->invalidate(target.full);
+            }
+            if (errors::is_error(committed)) {
+                return failure(call, "apply_patch: nothing was written; " +
+                                         errors::get_error(committed).message);
+            }
+        }
+
+        // 3. One line per file, and the diffs if wanted
+        std::string output;
+        std::string diffs;
+        for (const auto& target : targets) {
+            if (target.content == target.original) continue;
+            auto diff = diff::unified_diff(target.original.value_or(""),
+                                           target.content.value_or(""),
+                                           label("a/", target.original, target.path),
+                                           label("b/", target.content, target.path));
+            output += !target.original ? "Created " : !target.content ? "Deleted " : "Updated ";
+            output += target.path;
+            output += " (+" + std::to_string(diff.insertions) + " -" +
+                      std::to_string(diff.deletions) + ")\n";
+            if (options_.show_diff) diffs += diff.text;
+        }
+        if (output.empty()) output = "The patch changes nothing\n";
+        return protocol::ToolResult{call.id, true, output + diffs, "", 0.0};
+    }
+
+} // namespace agent::core::tools
@@ -0,0 +1,45 @@
+#pragma once
+#include <string>
+#include <tuple>
+#include "core/fs/file_cache.hpp"
+#include "core/fs/path_policy.hpp"
+#include "core/tools/typed_tool.hpp"
+
+namespace agent::core::tools {
+
+    struct ApplyPatchOptions {
+        std::string root;                // Patch paths are relative to this
+        fs::FileCache* cache = nullptr;  // Current contents come from here; invalidated after
+        bool sync = true;                // Durable before the tool returns (FileTransaction)
+        bool show_diff = false;          // Echo a unified diff of what was actually written
+        // Decides which paths may be written; without one, any relative path
+        // that stays below root may
+        const fs::PathPolicy* policy = nullptr;
+    };
+
+    struct ApplyPatchArgs {
+        std::string patch;
+
+        static constexpr auto fields() { return std::tuple{arg("patch", &ApplyPatchArgs::patch)}; }
+    };
+
+    // apply_patch: applies a unified diff that may span many files, all of
+    // it or none of it.
+    // Every hunk is placed against the current contents before anything is
+    // written (see diff::apply_hunks for how loosely); any hunk that fits
+    // nowhere fails the whole call, listing each problem. The new contents
+    // are then committed through one fs::FileTransaction. Creating
+    // (--- /dev/null), deleting (+++ /dev/null) and renaming files works too.
+    class ApplyPatchTool : public TypedTool<ApplyPatchArgs> {
+    public:
+        explicit ApplyPatchTool(ApplyPatchOptions options = {});
+
+    protected:
+        protocol::ToolResult run(const protocol::ToolCall& call,
+                                 const ApplyPatchArgs& args) override;
+
+    private:
+        ApplyPatchOptions options_;
+    };
+
+} // namespace agent::core::tools
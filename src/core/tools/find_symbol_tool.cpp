@@ -0,0 +1,56 @@
+#include "core/tools/find_symbol_tool.hpp"
+#include <algorithm>
+
+namespace agent::core::tools {
+
+    FindSymbolTool::FindSymbolTool(FindSymbolOptions options)
+        : TypedTool("find_symbol",
+                    "Find where a C or C++ symbol is declared: namespaces, classes, structs, "
+                    "unions, enums, functions, macros and type aliases. The name may be "
+                    "qualified (Parser::parse) to narrow it down. Returns one path:line per "
+                    "declaration, definitions first."),
+          options_(options) {}
+
+    protocol::ToolResult FindSymbolTool::run(const protocol::ToolCall& call,
+                                             const FindSymbolArgs& args) {
+        if (!options_.index) return failure(call, "find_symbol: no symbol index is loaded");
+
+        search::SymbolQuery query;
+        query.name = args.name;
+        if (args.kind) query.kind = search::symbol_kind_from(*args.kind);
+        query.prefix = args.prefix;
+        std::size_t limit = options_.max_results;
+        if (args.max_results) {
+            limit = std::min(static_cast<std::size_t>(*args.max_results), options_.max_results);
+        }
+        limit = std::max(limit, std::size_t{1});
+        query.max_results = limit + 1;  // One more, to tell whether there are others
+
+        auto matches = options_.index->find(query);
+        if (matches.empty()) {
+            return protocol::ToolResult{call.id, true, "No symbol matches " + query.name, "",
+                                        0.0};
+        }
+
+        std::string output;
+        for (std::size_t i = 0; i < matches.size() && i < limit; ++i) {
+            const auto& [path, symbol] = matches[i];
+            output += path;
+            output += ':';
+            output += std::to_string(symbol.line);
+            output += ' ';
+            output += search::to_string(symbol.kind);
+            output += ' ';
+            if (!symbol.scope.empty()) output.append(symbol.scope).append("::");
+            output += symbol.name;
+            if (!symbol.definition) output += " (declaration)";
+            output += '\n';
+        }
+        if (matches.size() > limit) {
+            output += "[More than " + std::to_string(limit) +
+                      " matches; qualify the name or give a kind]\n";
+        }
+        return protocol::ToolResult{call.id, true, std::move(output), "", 0.0};
+    }
+
+} // namespace agent::core::tools
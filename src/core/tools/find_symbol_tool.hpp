@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include "core/search/symbol_index.hpp"
+#include "core/tools/typed_tool.hpp"
+
+namespace agent::core::tools {
+
+    struct FindSymbolOptions {
+        const search::SymbolIndex* index = nullptr;  // Required
+        std::size_t max_results = 100;               // Cap on what the model may ask for
+    };
+
+    struct FindSymbolArgs {
+        static constexpr std::string_view kKinds[] = {"namespace", "class",    "struct", "union",
+                                                      "enum",      "function", "macro",  "alias"};
+
+        std::string name;
+        std::optional<std::string> kind;
+        bool prefix = false;
+        std::optional<long long> max_results;
+
+        static constexpr auto fields() {
+            return std::tuple{
+                arg("name", &FindSymbolArgs::name).non_empty(),
+                arg("kind", &FindSymbolArgs::kind).one_of(kKinds),
+                arg("prefix", &FindSymbolArgs::prefix)
+                    .optional()
+                    .describe("Match names starting with name"),
+                arg("max_results", &FindSymbolArgs::max_results).at_least(1)};
+        }
+    };
+
+    // find_symbol: where a C or C++ namespace, class, function, macro or type
+    // alias is declared, from the workspace's SymbolIndex.
+    // Output is one line per symbol, definitions first:
+    //   path:line kind qualified::name[ (declaration)]
+    // and a last line in brackets when there were more than max_results.
+    class FindSymbolTool : public TypedTool<FindSymbolArgs> {
+    public:
+        explicit FindSymbolTool(FindSymbolOptions options = {});
+
+        bool is_side_effect_free() const override { return true; }
+
+    protected:
+        protocol::ToolResult run(const protocol::ToolCall& call,
+                                 const FindSymbolArgs& args) override;
+
+    private:
+        FindSymbolOptions options_;
+    };
+
+} // namespace agent::core::tools
@@ -0,0 +1,121 @@
+#include "core/tools/output_collector.hpp"
+#include <algorithm>
+#include <cstring>
+#include "core/logging/logger.hpp"
+
+namespace agent::core::tools {
+
+    namespace {
+
+        bool is_continuation(char c) { return (static_cast<unsigned char>(c) & 0xC0) == 0x80; }
+
+        // Length of text without a trailing, incomplete UTF-8 sequence
+        std::size_t complete_utf8_prefix(std::string_view text) {
+            std::size_t lead = text.size();
+            while (lead > 0 && is_continuation(text[lead - 1])) --lead;
+            if (lead == 0) return text.size();
+            --lead;
+            auto c = static_cast<unsigned char>(text[lead]);
+            std::size_t need = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : c >= 0xC0 ? 2 : 1;
+            return lead + need > text.size() ? lead : text.size();
+        }
+
+    } // namespace
+
+    OutputCollector::OutputCollector(CaptureLimits limits)
+        : limits_(limits), ring_(limits.tail_bytes) {
+        head_.reserve(limits_.head_bytes);
+    }
+
+    void OutputCollector::spill_to(const storage::BlobStore& store) {
+        auto writer = store.open();
+        if (errors::is_error(writer)) {
+            LOG_WARN(errors::get_error(writer).message);
+            return;
+        }
+        spill_.emplace(std::move(std::get<storage::BlobStore::Writer>(writer)));
+    }
+
+    void OutputCollector::write(std::string_view chunk) {
+        if (chunk.empty()) return;
+        total_bytes_ += chunk.size();
+        newlines_ += static_cast<std::uint64_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+        last_byte_ = chunk.back();
+        if (spill_) spill_->write(chunk);
+
+        std::size_t to_head = std::min(chunk.size(), limits_.head_bytes - head_.size());
+        head_.append(chunk.data(), to_head);
+        chunk.remove_prefix(to_head);
+        if (!chunk.empty()) push_tail(chunk);
+    }
+
+    void OutputCollector::push_tail(std::string_view bytes) {
+        std::size_t capacity = ring_.size();
+        if (capacity == 0) return;
+
+        // Only the last `capacity` bytes of a huge chunk can survive anyway
+        if (bytes.size() >= capacity) {
+            std::memcpy(ring_.data(), bytes.data() + bytes.size() - capacity, capacity);
+            ring_pos_ = 0;
+            ring_full_ = true;
+            return;
+        }
+
+        std::size_t first = std::min(bytes.size(), capacity - ring_pos_);
+        std::memcpy(ring_.data() + ring_pos_, bytes.data(), first);
+        std::memcpy(ring_.data(), bytes.data() + first, bytes.size() - first);
+        if (ring_pos_ + bytes.size() >= capacity) ring_full_ = true;
+        ring_pos_ = (ring_pos_ + bytes.size()) % capacity;
+    }
+
+    std::string OutputCollector::tail() const {
+        if (!ring_full_) return std::string(ring_.data(), ring_pos_);
+        std::string out(ring_.data() + ring_pos_, ring_.size() - ring_pos_);
+        out.append(ring_.data(), ring_pos_);
+        return out;
+    }
+
+    std::uint64_t OutputCollector::total_lines() const {
+        // A final line without a newline still counts
+        return newlines_ + (total_bytes_ > 0 && last_byte_ != '\n' ? 1 : 0);
+    }
+
+    std::string OutputCollector::finish() {
+        if (spill_) {
+            auto id = spill_->commit();
+            if (errors::is_error(id)) {
+                LOG_WARN("Could not keep full tool output: " + errors::get_error(id).message);
+            } else {
+                blob_id_ = errors::get_value(id);
+            }
+            spill_.reset();
+        }
+
+        std::string tail_bytes = tail();
+        if (!truncated()) return head_ + tail_bytes;
+
+        // Never split a UTF-8 sequence at either cut
+        std::size_t head_end = complete_utf8_prefix(head_);
+        std::size_t tail_begin = 0;
+        while (tail_begin < tail_bytes.size() && is_continuation(tail_bytes[tail_begin])) {
+            ++tail_begin;
+        }
+
+        auto lines_in = [](std::string_view text) {
+            return static_cast<std::uint64_t>(std::count(text.begin(), text.end(), '\n'));
+        };
+        std::string_view kept_head(head_.data(), head_end);
+        std::string_view kept_tail(tail_bytes.data() + tail_begin, tail_bytes.size() - tail_begin);
+        std::uint64_t omitted_bytes = total_bytes_ - kept_head.size() - kept_tail.size();
+        std::uint64_t omitted_lines = newlines_ - lines_in(kept_head) - lines_in(kept_tail);
+
+        std::string out(kept_head);
+        out += "\n[... " + std::to_string(omitted_bytes) + " bytes, " +
+               std::to_string(omitted_lines) + " lines omitted";
+        if (blob_id_) out += "; full output saved as blob " + *blob_id_;
+        out += " ...]\n";
+        out += kept_tail;
+        return out;
+    }
+
+} // namespace agent::core::tools
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/storage/blob_store.hpp"
+
+namespace agent::core::tools {
+
+    struct CaptureLimits {
+        std::size_t head_bytes = 16 * 1024;  // The command line echo, the first errors
+        std::size_t tail_bytes = 48 * 1024;  // The summary and the final failure
+    };
+
+    // Bounded capture of a tool's output stream. Keeps the first head_bytes
+    // and the last tail_bytes (in a ring buffer), counts everything, and
+    // optionally streams the full output into the blob store. Memory use is
+    // fixed at construction, however much the tool prints.
+    class OutputCollector {
+    public:
+        explicit OutputCollector(CaptureLimits limits = {});
+
+        // Also keep the whole stream on disk; call before the first write()
+        void spill_to(const storage::BlobStore& store);
+
+        void write(std::string_view chunk);
+
+        std::uint64_t total_bytes() const { return total_bytes_; }
+        std::uint64_t total_lines() const;
+        bool truncated() const { return total_bytes_ > limits_.head_bytes + limits_.tail_bytes; }
+
+        // Commits the spill and renders head + omission marker + tail,
+        // ready for ToolResult::output. Call once, after the last write().
+        std::string finish();
+
+        // Set by finish() when the full output was spilled successfully
+        const std::optional<std::string>& blob_id() const { return blob_id_; }
+
+    private:
+        CaptureLimits limits_;
+        std::string head_;
+        std::vector<char> ring_;
+        std::size_t ring_pos_ = 0;
+        bool ring_full_ = false;
+
+        std::uint64_t total_bytes_ = 0;
+        std::uint64_t newlines_ = 0;
+        char last_byte_ = '\n';
+
+        std::optional<storage::BlobStore::Writer> spill_;
+        std::optional<std::string> blob_id_;
+
+        void push_tail(std::string_view bytes);
+        std::string tail() const;
+    };
+
+} // namespace agent::core::tools
@@ -0,0 +1,185 @@
+#include "core/tools/read_file_tool.hpp"
+#include <algorithm>
+#include <optional>
+#include "core/fs/mapped_file.hpp"
+#include "core/fs/text_scan.hpp"
+#include "core/tools/tool_memo.hpp"
+
+namespace agent::core::tools {
+
+    namespace {
+
+        // Lines in text, counting a final line without '\n'
+        std::size_t line_count(std::string_view text) {
+            std::size_t lines = fs::count_newlines(text);
+            return !text.empty() && text.back() != '\n' ? lines + 1 : lines;
+        }
+
+    } // namespace
+
+    ReadFileTool::ReadFileTool(ReadFileOptions options)
+        : TypedTool("read_file",
+                    "Read a text file. Returns at most " + std::to_string(options.max_lines) +
+                        " lines per call; use start_line/end_line (1-based, inclusive) or "
+                        "byte_offset/byte_length to read other parts of a large file."),
+          options_(std::move(options)) {}
+
+    std::string ReadFileTool::memo_scope() const {
+        std::string scope = options_.root;
+        scope.append(1, '\0').append(std::to_string(options_.max_lines));
+        scope.append(1, '\0').append(std::to_string(options_.max_bytes));
+        if (options_.policy) scope.append(1, '\0').append(options_.policy->rules_key());
+        return scope;
+    }
+
+    protocol::ToolResult ReadFileTool::run(const protocol::ToolCall& call,
+                                           const ReadFileArgs& args) {
+        long long start_line = args.start_line.value_or(1);
+        long long end_line = args.end_line.value_or(0);
+        long long byte_offset = args.byte_offset.value_or(0);
+        long long byte_length = args.byte_length.value_or(0);
+        bool by_bytes = args.byte_offset || args.byte_length;
+        bool by_lines = args.start_line || args.end_line;
+        if (by_bytes && by_lines) {
+            return failure(call, "read_file takes a line range or a byte range, not both");
+        }
+
+        // 1. Map the file, or take it from the cache
+        std::string path = args.path;
+        std::optional<fs::ResolvedPath> resolved;
+        if (options_.policy) {
+            auto checked = options_.policy->resolve(path, fs::PathAccess::Read, options_.root);
+            if (errors::is_error(checked)) return failure(call, errors::get_error(checked).message);
+            resolved.emplace(std::move(std::get<fs::ResolvedPath>(checked)));
+            path = resolved->path();
+        } else if (!options_.root.empty() && !path.empty() && path[0] != '/') {
+            path = options_.root + "/" + path;
+        }
+        note_file_read(path);
+
+        // Whichever of the two holds the bytes must outlive `text`. Files
+        // the cache would not keep are mapped rather than copied into it.
+        std::optional<fs::MappedFile> mapped;
+        fs::FileCache::Content cached;
+        // Whatever the policy checked is reached through its open parent, so a
+        // symlink swapped in since is refused rather than followed
+        auto size = resolved ? fs::stamp(*resolved).size : fs::stamp(path).size;
+        bool use_cache = options_.cache && options_.cache->keeps(static_cast<std::size_t>(size));
+        if (use_cache) {
+            auto read = resolved ? options_.cache->read(*resolved) : options_.cache->read(path);
+            if (errors::is_error(read)) return failure(call, errors::get_error(read).message);
+            cached = errors::get_value(read);
+        } else {
+            auto access =
+                by_bytes ? fs::MappedFile::Access::Random : fs::MappedFile::Access::Sequential;
+            auto opened = resolved ? fs::MappedFile::open(*resolved, access)
+                                   : fs::MappedFile::open(path, access);
+            if (errors::is_error(opened)) return failure(call, errors::get_error(opened).message);
+            mapped.emplace(std::move(std::get<fs::MappedFile>(opened)));
+        }
+        std::string_view text = cached ? std::string_view(*cached) : mapped->bytes();
+
+        // 2. Is it text?
+        auto encoding = fs::sniff_encoding(text);
+        if (encoding == fs::Encoding::Binary) {
+            return failure(call, "Binary file (" + std::to_string(text.size()) +
+                                     " bytes); not shown");
+        }
+        if (encoding == fs::Encoding::Utf16) {
+            return failure(call, "UTF-16 file; only UTF-8 and Latin-1 text can be read");
+        }
+        if (text.substr(0, 3) == "\xEF\xBB\xBF") text.remove_prefix(3);
+
+        // 3. Pick the slice
+        std::size_t begin = 0;
+        std::size_t end = 0;
+        std::string note;
+        if (by_bytes) {
+            auto offset = std::min(static_cast<std::size_t>(byte_offset), text.size());
+            std::size_t length = byte_length > 0 ? static_cast<std::size_t>(byte_length)
+                                                 : options_.max_bytes;
+            length = std::min({length, options_.max_bytes, text.size() - offset});
+            begin = offset;
+            end = offset + length;
+            if (encoding == fs::Encoding::Utf8) {
+                begin = fs::utf8_ceil(text, begin);
+                end = std::max(begin, fs::utf8_floor(text, end));
+            }
+            if (begin > 0 || end < text.size()) {
+                note = "Showing bytes " + std::to_string(begin) + "-" + std::to_string(end) +
+                       " of " + std::to_string(text.size());
+            }
+        } else {
+            auto first = static_cast<std::size_t>(start_line);
+            std::size_t wanted = options_.max_lines;
+            if (end_line > 0) {
+                if (end_line < start_line) return failure(call, "end_line is before start_line");
+                wanted = std::min(wanted, static_cast<std::size_t>(end_line - start_line + 1));
+            }
+
+            begin = fs::find_line_start(text, first - 1);
+            if (begin == text.size() && first > 1) {
+                return failure(call, "start_line " + std::to_string(first) +
+                                         " is past the end of the file (" +
+                                         std::to_string(line_count(text)) + " lines)");
+            }
+            std::string_view rest = text.substr(begin);
+            end = begin + fs::find_line_start(rest, wanted);
+
+            // Over the byte budget: stop at the last whole line that fits, or
+            // inside the first line when not even that one does
+            bool cut = false;
+            if (end - begin > options_.max_bytes) {
+                std::string_view budget = text.substr(begin, options_.max_bytes);
+                std::size_t last = budget.rfind('\n');
+                cut = last == std::string_view::npos;
+                if (!cut) {
+                    end = begin + last + 1;
+                } else if (encoding == fs::Encoding::Utf8) {
+                    end = begin + fs::utf8_floor(rest, options_.max_bytes);
+                } else {
+                    end = begin + options_.max_bytes;
+                }
+            }
+
+            if (cut) {
+                note = "Showing bytes " + std::to_string(begin) + "-" + std::to_string(end) +
+                       " of " + std::to_string(text.size()) + ", part of line " +
+                       std::to_string(first) + "; continue with byte_offset=" +
+                       std::to_string(end);
+            } else if (begin > 0 || end < text.size()) {
+                std::size_t shown = line_count(text.substr(begin, end - begin));
+                std::size_t last = first + (shown > 0 ? shown - 1 : 0);
+                std::size_t total = first - 1 + line_count(rest);
+                note = "Showing lines " + std::to_string(first) + "-" + std::to_string(last) +
+                       " of " + std::to_string(total);
+                if (end < text.size()) {
+                    note += "; continue with start_line=" + std::to_string(last + 1);
+                }
+            }
+        }
+
+        // 4. Straight from the mapping into the result; Latin-1 is re-encoded on the way
+        std::string_view slice = text.substr(begin, end - begin);
+        if (encoding == fs::Encoding::Utf8 && !fs::is_valid_utf8(slice)) {
+            encoding = fs::Encoding::Latin1;
+        }
+        if (encoding == fs::Encoding::Latin1) {
+            note += std::string(note.empty() ? "" : "; ") + "decoded as Latin-1";
+        }
+
+        protocol::ToolResult result{call.id, true, "", "", 0.0};
+        result.output.reserve(slice.size() + note.size() + 4);
+        if (encoding == fs::Encoding::Latin1) {
+            fs::append_latin1_as_utf8(result.output, slice);
+        } else {
+            result.output.append(slice);
+        }
+        if (!note.empty()) {
+            if (!result.output.empty() && result.output.back() != '\n') result.output += '\n';
+            result.output += "[" + note + "]";
+        }
+        return result;
+    }
+
+} // namespace agent::core::tools
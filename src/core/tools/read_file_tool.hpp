@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <tuple>
+#include "core/fs/file_cache.hpp"
+#include "core/fs/path_policy.hpp"
+#include "core/tools/typed_tool.hpp"
+
+namespace agent::core::tools {
+
+    struct ReadFileOptions {
+        std::string root;                   // Relative paths are resolved against this
+        std::size_t max_lines = 2000;       // Per call, whatever the model asks for
+        std::size_t max_bytes = 256 * 1024; // Per call; cuts at a line end where possible
+        fs::FileCache* cache = nullptr;     // Serve repeated reads from memory
+        const fs::PathPolicy* policy = nullptr;  // Refuse paths it does not allow reading
+    };
+
+    struct ReadFileArgs {
+        std::string path;
+        std::optional<long long> start_line;  // 1-based
+        std::optional<long long> end_line;    // Inclusive
+        std::optional<long long> byte_offset;
+        std::optional<long long> byte_length;
+
+        static constexpr auto fields() {
+            return std::tuple{arg("path", &ReadFileArgs::path),
+                              arg("start_line", &ReadFileArgs::start_line).at_least(1),
+                              arg("end_line", &ReadFileArgs::end_line).at_least(1),
+                              arg("byte_offset", &ReadFileArgs::byte_offset).at_least(0),
+                              arg("byte_length", &ReadFileArgs::byte_length).at_least(1)};
+        }
+    };
+
+    // read_file: returns a file's text, or a range of it.
+    // Line and byte ranges are exclusive of each other. When less than the whole
+    // file is returned, a last line in brackets says which part it was.
+    class ReadFileTool : public TypedTool<ReadFileArgs> {
+    public:
+        explicit ReadFileTool(ReadFileOptions options = {});
+
+        bool is_side_effect_free() const override { return true; }
+        std::string memo_scope() const override;
+
+    protected:
+        protocol::ToolResult run(const protocol::ToolCall& call,
+                                 const ReadFileArgs& args) override;
+
+    private:
+        ReadFileOptions options_;
+    };
+
+} // namespace agent::core::tools
@@ -0,0 +1,67 @@
+#include "core/tools/run_command_tool.hpp"
+#include <algorithm>
+#include "core/exec/process_util.hpp"
+
+namespace agent::core::tools {
+
+    RunCommandTool::RunCommandTool(RunCommandOptions options)
+        : TypedTool("run_command",
+                    "Run a shell command and return its exit code, stdout and stderr. Long "
+                    "output is cut to its beginning and end."),
+          options_(std::move(options)) {}
+
+    protocol::ToolResult RunCommandTool::run(const protocol::ToolCall& call,
+                                             const RunCommandArgs& args) {
+        std::string command = args.command;
+        auto spec = exec::CommandSpec::shell(command);
+        spec.cwd = args.cwd.value_or(options_.working_directory);
+        if (options_.policy) {
+            auto resolved = options_.policy->resolve(spec.cwd.empty() ? "." : spec.cwd,
+                                                     fs::PathAccess::Write,
+                                                     options_.working_directory);
+            if (errors::is_error(resolved)) {
+                return failure(call, errors::get_error(resolved).message);
+            }
+            spec.cwd = errors::get_value(resolved).path();
+        }
+        int timeout = args.timeout_ms.value_or(options_.default_timeout_ms);
+        spec.timeout_ms = std::clamp(timeout, 1, options_.max_timeout_ms);
+        spec.limits = options_.limits;
+        spec.stdout_limits = options_.stdout_limits;
+        spec.spill = options_.spill;
+
+        // A warm shell keeps the cwd of its previous command unless told
+        // otherwise; under a policy it is always told, as that cwd is the
+        // one that was checked. The cd stands on its own line so that no
+        // part of a ';' or newline separated command runs if it fails.
+        errors::Result<exec::CommandResult> outcome = exec::CommandResult{};
+        if (options_.shells) {
+            if (args.cwd || options_.policy) {
+                command = "cd -- " + exec::detail::shell_quote(spec.cwd) + " || exit 1\n" +
+                          command;
+            }
+            outcome =
+                options_.shells->run(command, spec.timeout_ms, spec.stdout_limits, spec.spill);
+        } else {
+            outcome = exec::run_command(spec);
+        }
+        if (errors::is_error(outcome)) return failure(call, errors::get_error(outcome).message);
+        auto& result = std::get<exec::CommandResult>(outcome);
+
+        std::string status = result.timed_out
+                                 ? "Timed out after " + std::to_string(spec.timeout_ms) + " ms"
+                                 : "Exit code " + std::to_string(result.exit_code);
+        bool success = !result.timed_out && result.exit_code == 0;
+
+        // The loop shows the model error_message for failed calls, and a failed
+        // build usually explains itself on stdout, so both streams go in there
+        std::string details = status;
+        if (!success && !result.stdout_text.empty()) details += "\n" + result.stdout_text;
+        if (!result.stderr_text.empty()) details += "\n[stderr]\n" + result.stderr_text;
+
+        protocol::ToolResult tool_result{call.id, success, std::move(result.stdout_text),
+                                         std::move(details), result.duration_ms};
+        return tool_result;
+    }
+
+} // namespace agent::core::tools
@@ -0,0 +1,55 @@
+#pragma once
+#include <optional>
+#include <string>
+#include <tuple>
+#include "core/exec/command_runner.hpp"
+#include "core/exec/shell_pool.hpp"
+#include "core/fs/path_policy.hpp"
+#include "core/tools/typed_tool.hpp"
+
+namespace agent::core::tools {
+
+    struct RunCommandOptions {
+        std::string working_directory;  // Default cwd for commands that do not pass one
+        int default_timeout_ms = 120000;
+        int max_timeout_ms = 600000;    // Cap on what the model may ask for
+        exec::ResourceLimits limits;
+        CaptureLimits stdout_limits;
+        const storage::BlobStore* spill = nullptr;
+        // Run in warm shells instead of a fresh /bin/sh per call. State such as
+        // cwd and exported variables then carries over between calls, and
+        // `limits` is ignored in favour of the pool's own.
+        exec::ShellPool* shells = nullptr;
+        // Refuse working directories it does not allow writing; relative
+        // ones start from working_directory, or else its first root. With
+        // shells, every command then starts with a cd to the checked one.
+        const fs::PathPolicy* policy = nullptr;
+    };
+
+    struct RunCommandArgs {
+        std::string command;
+        std::optional<std::string> cwd;
+        std::optional<int> timeout_ms;
+
+        static constexpr auto fields() {
+            return std::tuple{arg("command", &RunCommandArgs::command)
+                                  .describe("Passed to /bin/sh -c"),
+                              arg("cwd", &RunCommandArgs::cwd),
+                              arg("timeout_ms", &RunCommandArgs::timeout_ms)};
+        }
+    };
+
+    // run_command: runs a shell command and reports exit code, stdout and stderr.
+    class RunCommandTool : public TypedTool<RunCommandArgs> {
+    public:
+        explicit RunCommandTool(RunCommandOptions options = {});
+
+    protected:
+        protocol::ToolResult run(const protocol::ToolCall& call,
+                                 const RunCommandArgs& args) override;
+
+    private:
+        RunCommandOptions options_;
+    };
+
+} // namespace agent::core::tools
@@ -0,0 +1,139 @@
+#include "core/tools/search_tool.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include "core/search/grep.hpp"
+#include "core/tools/tool_memo.hpp"
+
+namespace agent::core::tools {
+
+    namespace {
+
+        // Where root sits below the index root ("" or "dir/"), if it does
+        std::optional<std::string> inside(const std::string& root, const std::string& index_root) {
+            std::error_code error;
+            auto absolute = std::filesystem::absolute(root, error);
+            if (error) return std::nullopt;
+            std::string path = absolute.lexically_normal().string();
+            if (path.size() > 1 && path.back() == '/') path.pop_back();
+            if (path == index_root) return "";
+            if (!path.starts_with(index_root + "/")) return std::nullopt;
+            return path.substr(index_root.size() + 1) + "/";
+        }
+
+    } // namespace
+
+    SearchTool::SearchTool(SearchOptions options)
+        : TypedTool("search",
+                    "Search file contents in the workspace with a regular expression (grep/"
+                    "ripgrep syntax) or a fixed string. Files ignored by .gitignore and binary "
+                    "files are skipped. Returns JSON matches with path, line, column and text."),
+          options_(std::move(options)) {}
+
+    std::string SearchTool::memo_scope() const {
+        std::string scope = options_.root;
+        scope.append(1, '\0').append(std::to_string(options_.max_results));
+        scope.append(1, '\0').append(std::to_string(options_.max_context));
+        if (options_.policy) scope.append(1, '\0').append(options_.policy->rules_key());
+        return scope;
+    }
+
+    protocol::ToolResult SearchTool::run(const protocol::ToolCall& call, const SearchArgs& args) {
+        search::RegexOptions regex_options;
+        regex_options.literal = args.literal;
+        regex_options.case_insensitive = args.case_insensitive;
+        auto regex = search::Regex::compile(args.pattern, regex_options);
+        if (errors::is_error(regex)) return failure(call, errors::get_error(regex).message);
+
+        search::GrepOptions grep_options;
+        grep_options.file_glob = args.glob.value_or("");
+        grep_options.context = std::min(static_cast<std::size_t>(args.context.value_or(0)),
+                                        options_.max_context);
+        grep_options.max_matches = options_.max_results;
+        if (args.max_results) {
+            grep_options.max_matches =
+                std::min(static_cast<std::size_t>(*args.max_results), options_.max_results);
+        }
+        grep_options.max_matches = std::max(grep_options.max_matches, std::size_t{1});
+
+        std::string root = options_.root.empty() ? "." : options_.root;
+        std::string path = args.path.value_or("");
+        if (options_.policy) {
+            auto resolved = options_.policy->resolve(path.empty() ? "." : path,
+                                                     fs::PathAccess::Read, options_.root);
+            if (errors::is_error(resolved)) {
+                return failure(call, errors::get_error(resolved).message);
+            }
+            root = errors::get_value(resolved).path();
+        } else if (!path.empty()) {
+            root = path[0] == '/' ? path : root + "/" + path;
+        }
+
+        std::vector<search::GrepMatch> matches;
+        auto collect = [&](search::GrepMatch&& match) { matches.push_back(std::move(match)); };
+
+        // The index, when it can rule files out; otherwise walk the whole tree
+        std::optional<std::vector<std::string>> files;
+        std::optional<std::string> prefix;
+        if (options_.index) prefix = inside(root, options_.index->root());
+        if (prefix) files = options_.index->candidates(errors::get_value(regex).folded_literal());
+
+        errors::Result<search::GrepStats> stats = search::GrepStats{};
+        if (files) {
+            std::erase_if(*files, [&](const std::string& f) { return !f.starts_with(*prefix); });
+            for (auto& file : *files) file.erase(0, prefix->size());
+            stats = search::grep_files(root, *files, errors::get_value(regex), grep_options,
+                                       options_.threads, collect);
+        } else {
+            // Index answers are not memoized: the index catches up on changes
+            // on its own thread, after the memo has dropped the old result
+            note_tree_read(root);
+            fs::WalkOptions walk;
+            walk.threads = options_.threads;
+            stats = search::grep(root, errors::get_value(regex), grep_options, walk, collect);
+        }
+        if (errors::is_error(stats)) return failure(call, errors::get_error(stats).message);
+
+        // Walker threads finish in any order; give the model a stable listing
+        std::sort(matches.begin(), matches.end(), [](const auto& a, const auto& b) {
+            return a.path != b.path ? a.path < b.path : a.line < b.line;
+        });
+
+        // Only the files that matched are resolved: there are few of them, and
+        // a symlink in the tree can lead anywhere, so their names are not enough
+        if (options_.policy) {
+            std::vector<search::GrepMatch> allowed;
+            std::string last;
+            bool readable = false;
+            for (auto& match : matches) {
+                if (match.path != last) {
+                    readable = !errors::is_error(options_.policy->resolve(
+                        root + "/" + match.path, fs::PathAccess::Read));
+                    last = match.path;
+                }
+                if (readable) allowed.push_back(std::move(match));
+            }
+            matches = std::move(allowed);
+        }
+
+        nlohmann::json listing = nlohmann::json::array();
+        for (auto& match : matches) {
+            nlohmann::json item = {{"path", std::move(match.path)},
+                                   {"line", match.line},
+                                   {"column", match.column},
+                                   {"text", std::move(match.text)}};
+            if (!match.before.empty()) item["before"] = std::move(match.before);
+            if (!match.after.empty()) item["after"] = std::move(match.after);
+            listing.push_back(std::move(item));
+        }
+        const auto& totals = errors::get_value(stats);
+        nlohmann::json output = {{"matches", std::move(listing)},
+                                 {"files_searched", totals.files_searched},
+                                 {"truncated", totals.truncated}};
+
+        // Invalid UTF-8 in a source line must not make the whole result unserializable
+        std::string text = output.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+        return protocol::ToolResult{call.id, true, std::move(text), "", 0.0};
+    }
+
+} // namespace agent::core::tools
@@ -0,0 +1,64 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <tuple>
+#include "core/fs/path_policy.hpp"
+#include "core/search/trigram_index.hpp"
+#include "core/tools/typed_tool.hpp"
+
+namespace agent::core::tools {
+
+    struct SearchOptions {
+        std::string root;                // Workspace to search; "path" arguments are inside it
+        std::size_t max_results = 200;   // Cap on what the model may ask for
+        std::size_t max_context = 5;     // Context lines per side
+        std::size_t threads = 0;         // Walker threads; 0: one per core
+        // Narrows each search to the files that can match, when its root
+        // covers the searched directory and the pattern has a literal of three
+        // or more bytes; everything else is still found by walking the tree
+        const search::TrigramIndex* index = nullptr;
+        // Refuse search paths it does not allow reading, and leave out
+        // matches in the files below them that it denies
+        const fs::PathPolicy* policy = nullptr;
+    };
+
+    struct SearchArgs {
+        std::string pattern;
+        std::optional<std::string> path;
+        bool literal = false;
+        bool case_insensitive = false;
+        std::optional<std::string> glob;
+        std::optional<long long> context;
+        std::optional<long long> max_results;
+
+        static constexpr auto fields() {
+            return std::tuple{
+                arg("pattern", &SearchArgs::pattern).non_empty(),
+                arg("path", &SearchArgs::path).describe("Directory to search, default all"),
+                arg("literal", &SearchArgs::literal).optional(),
+                arg("case_insensitive", &SearchArgs::case_insensitive).optional(),
+                arg("glob", &SearchArgs::glob).describe("File name filter, e.g. *.cpp"),
+                arg("context", &SearchArgs::context).at_least(0),
+                arg("max_results", &SearchArgs::max_results).at_least(1)};
+        }
+    };
+
+    // search: regex or fixed-string search over the workspace, honouring .gitignore.
+    // Output is JSON: {"matches": [{"path", "line", "column", "text", "before"?, "after"?}],
+    //                  "files_searched": n, "truncated": bool}, matches sorted by path and line.
+    class SearchTool : public TypedTool<SearchArgs> {
+    public:
+        explicit SearchTool(SearchOptions options = {});
+
+        bool is_side_effect_free() const override { return true; }
+        std::string memo_scope() const override;
+
+    protected:
+        protocol::ToolResult run(const protocol::ToolCall& call, const SearchArgs& args) override;
+
+    private:
+        SearchOptions options_;
+    };
+
+} // namespace agent::core::tools
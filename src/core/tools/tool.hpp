@@ -0,0 +1,30 @@
+#pragma once
+#include <string>
+#include "protocol/tool_contract.hpp"
+
+namespace agent::core::tools {
+
+    // The interface every tool in the Execution Layer implements.
+    // A failing tool is not an AgentError: it returns a ToolResult with
+    // success = false so that the LLM can read the reason and try again.
+    class Tool {
+    public:
+        virtual ~Tool() = default;
+
+        // What we advertise to the LLM (name, description, argument schema)
+        virtual const protocol::ToolSchema& schema() const = 0;
+
+        // True for tools that only observe the world (read_file, list, search).
+        // These may be run speculatively and their results thrown away.
+        virtual bool is_side_effect_free() const { return false; }
+
+        // Everything besides a call's arguments that decides its result: a
+        // workspace root, output limits, a path policy. ToolMemo reuses a
+        // result only for a tool of the same name and scope.
+        virtual std::string memo_scope() const { return {}; }
+
+        // Must be safe to call from several threads at once
+        virtual protocol::ToolResult execute(const protocol::ToolCall& call) = 0;
+    };
+
+} // namespace agent::core::tools
@@ -0,0 +1,275 @@
+#include "core/tools/tool_args.hpp"
+#include <cstdio>
+
+namespace agent::core::tools::detail {
+
+    namespace {
+
+        bool is_space(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+        int hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        void append_utf8(std::uint32_t cp, std::string& out) {
+            if (cp < 0x80) {
+                out += static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                out += static_cast<char>(0xC0 | (cp >> 6));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                out += static_cast<char>(0xE0 | (cp >> 12));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (cp >> 18));
+                out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+        bool is_number_char(char c) {
+            return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' ||
+                   c == 'E';
+        }
+
+    } // namespace
+
+    // --- JsonCursor ---
+
+    void JsonCursor::skip_space() {
+        while (pos_ < text_.size() && is_space(text_[pos_])) ++pos_;
+    }
+
+    bool JsonCursor::expect(char c) {
+        skip_space();
+        if (failed_ || pos_ >= text_.size() || text_[pos_] != c) return fail();
+        ++pos_;
+        return true;
+    }
+
+    JsonCursor::Kind JsonCursor::peek() {
+        skip_space();
+        if (failed_ || pos_ >= text_.size()) return Kind::Invalid;
+        char c = text_[pos_];
+        switch (c) {
+            case '"': return Kind::String;
+            case '{': return Kind::Object;
+            case '[': return Kind::Array;
+            case 't':
+            case 'f': return Kind::Bool;
+            case 'n': return Kind::Null;
+            default: return c == '-' || (c >= '0' && c <= '9') ? Kind::Number : Kind::Invalid;
+        }
+    }
+
+    bool JsonCursor::enter_object() {
+        first_ = true;
+        return expect('{');
+    }
+
+    bool JsonCursor::enter_array() {
+        first_ = true;
+        return expect('[');
+    }
+
+    bool JsonCursor::next_element() {
+        skip_space();
+        if (failed_ || pos_ >= text_.size()) return fail();
+        if (text_[pos_] == ']') {
+            ++pos_;
+            first_ = false;
+            return false;
+        }
+        if (!first_ && !expect(',')) return false;
+        first_ = false;
+        return true;
+    }
+
+    bool JsonCursor::next_key(std::string_view& key, std::string& scratch) {
+        skip_space();
+        if (failed_ || pos_ >= text_.size()) return fail();
+        if (text_[pos_] == '}') {
+            ++pos_;
+            first_ = false;
+            return false;
+        }
+        if (!first_ && !expect(',')) return false;
+        first_ = false;
+        if (peek() != Kind::String) return fail();
+
+        // Keys are almost never escaped: point into the text
+        std::size_t start = pos_ + 1;
+        std::size_t end = text_.find_first_of("\"\\", start);
+        if (end != std::string_view::npos && text_[end] == '"') {
+            key = text_.substr(start, end - start);
+            pos_ = end + 1;
+        } else {
+            scratch.clear();
+            if (!read_string(scratch)) return false;
+            key = scratch;
+        }
+        return expect(':');
+    }
+
+    bool JsonCursor::read_string(std::string& out) {
+        if (!expect('"')) return false;
+        out.clear();
+        while (true) {
+            // Copy plain runs whole
+            std::size_t stop = text_.find_first_of("\"\\", pos_);
+            if (stop == std::string_view::npos) return fail();
+            out.append(text_.substr(pos_, stop - pos_));
+            pos_ = stop + 1;
+            if (text_[stop] == '"') return true;
+
+            if (pos_ >= text_.size()) return fail();
+            char c = text_[pos_++];
+            switch (c) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    auto hex4 = [&](std::uint32_t& value) {
+                        if (pos_ + 4 > text_.size()) return false;
+                        value = 0;
+                        for (int i = 0; i < 4; ++i) {
+                            int digit = hex_value(text_[pos_++]);
+                            if (digit < 0) return false;
+                            value = (value << 4) | static_cast<std::uint32_t>(digit);
+                        }
+                        return true;
+                    };
+                    std::uint32_t cp = 0;
+                    if (!hex4(cp)) return fail();
+                    // A surrogate pair spells one code point above U+FFFF
+                    if (cp >= 0xD800 && cp <= 0xDBFF && text_.substr(pos_, 2) == "\\u") {
+                        pos_ += 2;
+                        std::uint32_t low = 0;
+                        if (!hex4(low)) return fail();
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            append_utf8(0xFFFD, out);
+                            cp = low;
+                        }
+                    } else if (cp >= 0xD800 && cp <= 0xDFFF) {
+                        cp = 0xFFFD;
+                    }
+                    append_utf8(cp, out);
+                    break;
+                }
+                default: return fail();
+            }
+        }
+    }
+
+    bool JsonCursor::read_bool(bool& out) {
+        skip_space();
+        if (text_.substr(pos_, 4) == "true") {
+            out = true;
+            pos_ += 4;
+            return true;
+        }
+        if (text_.substr(pos_, 5) == "false") {
+            out = false;
+            pos_ += 5;
+            return true;
+        }
+        return fail();
+    }
+
+    bool JsonCursor::read_number(std::string_view& token) {
+        skip_space();
+        std::size_t start = pos_;
+        while (pos_ < text_.size() && is_number_char(text_[pos_])) ++pos_;
+        if (pos_ == start) return fail();
+        token = text_.substr(start, pos_ - start);
+        // from_chars takes no '+'; JSON allows none either, except in exponents
+        if (token[0] == '+') return fail();
+        return true;
+    }
+
+    void JsonCursor::skip_value() {
+        switch (peek()) {
+            case Kind::String: {
+                std::string ignored;
+                read_string(ignored);
+                return;
+            }
+            case Kind::Number: {
+                std::string_view ignored;
+                read_number(ignored);
+                return;
+            }
+            case Kind::Bool: {
+                bool ignored;
+                read_bool(ignored);
+                return;
+            }
+            case Kind::Null:
+                if (text_.substr(pos_, 4) == "null") {
+                    pos_ += 4;
+                } else {
+                    fail();
+                }
+                return;
+            case Kind::Object: {
+                enter_object();
+                std::string scratch;
+                std::string_view key;
+                while (next_key(key, scratch)) skip_value();
+                return;
+            }
+            case Kind::Array:
+                enter_array();
+                while (next_element()) skip_value();
+                return;
+            case Kind::Invalid: fail(); return;
+        }
+    }
+
+    bool JsonCursor::finish() {
+        skip_space();
+        return !failed_ && pos_ == text_.size();
+    }
+
+    // --- Schema and errors ---
+
+    void append_json_string(std::string& out, std::string_view text) {
+        out += '"';
+        for (char c : text) {
+            switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\t': out += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        char escaped[8];
+                        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                        out += escaped;
+                    } else {
+                        out += c;
+                    }
+            }
+        }
+        out += '"';
+    }
+
+    errors::AgentError argument_error(std::string_view name, std::string_view problem) {
+        std::string message = "\"";
+        message.append(name).append("\" ").append(problem);
+        return errors::AgentError{errors::ErrorCategory::Input, std::move(message)};
+    }
+
+} // namespace agent::core::tools::detail
@@ -0,0 +1,345 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+
+// Typed tool arguments. A tool declares its argument struct once, with a
+// static fields() listing its members:
+//
+//   struct FindArgs {
+//       std::string name;
+//       std::optional<long long> limit;
+//       static constexpr auto fields() {
+//           return std::tuple{arg("name", &FindArgs::name).non_empty(),
+//                             arg("limit", &FindArgs::limit).at_least(1)};
+//       }
+//   };
+//
+// json_schema<FindArgs>() is the schema we advertise, and
+// bind_arguments<FindArgs>(call.arguments) reads the model's JSON straight
+// into the struct: no DOM, and no allocation beyond the strings it keeps.
+// Members are required unless they are std::optional or marked optional().
+namespace agent::core::tools {
+
+    namespace detail {
+
+        template <typename T>
+        struct is_optional : std::false_type {};
+        template <typename T>
+        struct is_optional<std::optional<T>> : std::true_type {};
+
+        template <typename T>
+        struct is_vector : std::false_type {};
+        template <typename T>
+        struct is_vector<std::vector<T>> : std::true_type {};
+
+    } // namespace detail
+
+    // One member of an argument struct, as the model sees it
+    template <typename Owner, typename T>
+    struct ArgField {
+        std::string_view name;
+        T Owner::*member;
+        std::string_view description{};
+        bool required = !detail::is_optional<T>::value;
+        std::optional<long long> minimum{};           // Integers
+        std::size_t min_length = 0;                   // Strings
+        std::span<const std::string_view> choices{};  // Strings: the only values allowed
+
+        constexpr ArgField describe(std::string_view text) const {
+            ArgField copy = *this;
+            copy.description = text;
+            return copy;
+        }
+        // Absent: the member keeps its default
+        constexpr ArgField optional() const {
+            ArgField copy = *this;
+            copy.required = false;
+            return copy;
+        }
+        constexpr ArgField at_least(long long value) const {
+            ArgField copy = *this;
+            copy.minimum = value;
+            return copy;
+        }
+        constexpr ArgField non_empty() const {
+            ArgField copy = *this;
+            copy.min_length = 1;
+            return copy;
+        }
+        constexpr ArgField one_of(std::span<const std::string_view> values) const {
+            ArgField copy = *this;
+            copy.choices = values;
+            return copy;
+        }
+    };
+
+    template <typename Owner, typename T>
+    constexpr ArgField<Owner, T> arg(std::string_view name, T Owner::*member) {
+        return ArgField<Owner, T>{name, member};
+    }
+
+    namespace detail {
+
+        // Reads one JSON text in place. Each call consumes one token or
+        // value; after any failure failed() stays true and reads do nothing.
+        class JsonCursor {
+        public:
+            enum class Kind { String, Number, Bool, Null, Array, Object, Invalid };
+
+            explicit JsonCursor(std::string_view text) : text_(text) {}
+
+            Kind peek();
+            bool enter_object();
+            // The next key of the current object; false at its '}'. Keys
+            // without escapes point into the text, others into `scratch`.
+            bool next_key(std::string_view& key, std::string& scratch);
+            bool enter_array();
+            bool next_element();  // False at the array's ']'
+
+            bool read_string(std::string& out);
+            bool read_bool(bool& out);
+            bool read_number(std::string_view& token);  // The literal, for from_chars
+            void skip_value();
+
+            bool finish();  // Nothing but whitespace left
+            bool failed() const { return failed_; }
+
+        private:
+            void skip_space();
+            bool expect(char c);
+            bool fail() {
+                failed_ = true;
+                return false;
+            }
+
+            std::string_view text_;
+            std::size_t pos_ = 0;
+            bool failed_ = false;
+            bool first_ = true;  // No ',' is due before the next key or element
+        };
+
+        void append_json_string(std::string& out, std::string_view text);
+
+        errors::AgentError argument_error(std::string_view name, std::string_view problem);
+
+        template <typename T>
+        void append_type(std::string& out) {
+            if constexpr (is_optional<T>::value) {
+                append_type<typename T::value_type>(out);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                out += R"("type":"string")";
+            } else if constexpr (std::is_same_v<T, bool>) {
+                out += R"("type":"boolean")";
+            } else if constexpr (std::is_integral_v<T>) {
+                out += R"("type":"integer")";
+            } else if constexpr (std::is_floating_point_v<T>) {
+                out += R"("type":"number")";
+            } else if constexpr (is_vector<T>::value) {
+                out += R"("type":"array","items":{)";
+                append_type<typename T::value_type>(out);
+                out += '}';
+            } else {
+                static_assert(sizeof(T) == 0, "Unsupported tool argument type");
+            }
+        }
+
+        template <typename T>
+        const char* type_phrase() {
+            if constexpr (is_optional<T>::value) {
+                return type_phrase<typename T::value_type>();
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return "must be a string";
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return "must be true or false";
+            } else if constexpr (std::is_integral_v<T>) {
+                return "must be an integer";
+            } else if constexpr (std::is_floating_point_v<T>) {
+                return "must be a number";
+            } else {
+                return "must be an array";
+            }
+        }
+
+        // Reads one value into `out`; false when the value has the wrong type
+        template <typename T>
+        bool read_value(JsonCursor& cursor, T& out) {
+            auto kind = cursor.peek();
+            if constexpr (is_optional<T>::value) {
+                if (kind == JsonCursor::Kind::Null) {
+                    cursor.skip_value();
+                    out.reset();
+                    return true;
+                }
+                return read_value(cursor, out.emplace());
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return kind == JsonCursor::Kind::String && cursor.read_string(out);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                return kind == JsonCursor::Kind::Bool && cursor.read_bool(out);
+            } else if constexpr (std::is_arithmetic_v<T>) {
+                std::string_view token;
+                if (kind != JsonCursor::Kind::Number || !cursor.read_number(token)) return false;
+                auto [end, error] = std::from_chars(token.data(), token.data() + token.size(), out);
+                return error == std::errc() && end == token.data() + token.size();
+            } else {
+                if (kind != JsonCursor::Kind::Array || !cursor.enter_array()) return false;
+                out.clear();
+                while (cursor.next_element()) {
+                    if (!read_value(cursor, out.emplace_back())) return false;
+                }
+                return !cursor.failed();
+            }
+        }
+
+        // The value an argument holds, or nullptr for an empty optional
+        template <typename T>
+        const T* present(const T& value) {
+            return &value;
+        }
+        template <typename T>
+        const T* present(const std::optional<T>& value) {
+            return value ? &*value : nullptr;
+        }
+
+        template <typename Owner, typename T>
+        std::optional<errors::AgentError> bind_field(JsonCursor& cursor, Owner& args,
+                                                     const ArgField<Owner, T>& field) {
+            T& out = args.*field.member;
+            if (!read_value(cursor, out)) {
+                if (cursor.failed()) return std::nullopt;  // Reported as malformed JSON
+                return argument_error(field.name, type_phrase<T>());
+            }
+            const auto* value = present(out);
+            if (!value) return std::nullopt;
+            using Value = std::remove_cvref_t<decltype(*value)>;
+            if constexpr (std::is_integral_v<Value> && !std::is_same_v<Value, bool>) {
+                if (field.minimum && static_cast<long long>(*value) < *field.minimum) {
+                    return argument_error(field.name,
+                                          "must be at least " + std::to_string(*field.minimum));
+                }
+            }
+            if constexpr (std::is_same_v<Value, std::string>) {
+                if (value->size() < field.min_length) {
+                    return argument_error(field.name, "must not be empty");
+                }
+                if (!field.choices.empty()) {
+                    bool known = false;
+                    std::string list;
+                    for (auto choice : field.choices) {
+                        known = known || *value == choice;
+                        if (!list.empty()) list += ", ";
+                        list += choice;
+                    }
+                    if (!known) return argument_error(field.name, "must be one of " + list);
+                }
+            }
+            return std::nullopt;
+        }
+
+    } // namespace detail
+
+    template <typename Args>
+    std::string json_schema() {
+        constexpr auto fields = Args::fields();
+        std::string out = R"({"type":"object","properties":{)";
+        std::string required;
+        bool first = true;
+        std::apply(
+            [&](const auto&... field) {
+                auto add = [&](const auto& each) {
+                    if (!first) out += ',';
+                    first = false;
+                    detail::append_json_string(out, each.name);
+                    out += ":{";
+                    using T = std::remove_cvref_t<decltype(std::declval<Args&>().*each.member)>;
+                    detail::append_type<T>(out);
+                    if (!each.choices.empty()) {
+                        out += R"(,"enum":[)";
+                        for (std::size_t i = 0; i < each.choices.size(); ++i) {
+                            if (i > 0) out += ',';
+                            detail::append_json_string(out, each.choices[i]);
+                        }
+                        out += ']';
+                    }
+                    if (each.minimum) {
+                        out.append(R"(,"minimum":)").append(std::to_string(*each.minimum));
+                    }
+                    if (each.min_length > 0) {
+                        out.append(R"(,"minLength":)").append(std::to_string(each.min_length));
+                    }
+                    if (!each.description.empty()) {
+                        out += R"(,"description":)";
+                        detail::append_json_string(out, each.description);
+                    }
+                    out += '}';
+                    if (each.required) {
+                        if (!required.empty()) required += ',';
+                        detail::append_json_string(required, each.name);
+                    }
+                };
+                (add(field), ...);
+            },
+            fields);
+        out += '}';
+        if (!required.empty()) out.append(R"(,"required":[)").append(required).append("]");
+        out += '}';
+        return out;
+    }
+
+    // Input errors name the argument at fault, e.g. "\"limit\" must be at least 1"
+    template <typename Args>
+    errors::Result<Args> bind_arguments(std::string_view json) {
+        constexpr auto fields = Args::fields();
+        constexpr std::size_t count = std::tuple_size_v<decltype(fields)>;
+        static_assert(count <= 64, "Too many tool arguments");
+
+        Args args{};
+        std::uint64_t seen = 0;
+        detail::JsonCursor cursor(json);
+        std::string scratch;
+        std::string_view key;
+        std::optional<errors::AgentError> problem;
+        auto malformed = [] {
+            return errors::AgentError{errors::ErrorCategory::Input,
+                                      "the arguments are not a valid JSON object"};
+        };
+        if (!cursor.enter_object()) return malformed();
+        while (cursor.next_key(key, scratch)) {
+            bool known = false;
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                auto visit = [&](auto index) {
+                    const auto& field = std::get<decltype(index)::value>(fields);
+                    if (known || field.name != key) return;
+                    known = true;
+                    seen |= std::uint64_t{1} << decltype(index)::value;
+                    problem = detail::bind_field(cursor, args, field);
+                };
+                (visit(std::integral_constant<std::size_t, I>{}), ...);
+            }(std::make_index_sequence<count>{});
+            if (problem) return *problem;
+            if (!known) cursor.skip_value();
+        }
+        if (cursor.failed() || !cursor.finish()) return malformed();
+
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            auto check = [&](const auto& field, std::size_t index) {
+                if (!problem && field.required && !((seen >> index) & 1u)) {
+                    problem = detail::argument_error(field.name, "is required");
+                }
+            };
+            (check(std::get<I>(fields), I), ...);
+        }(std::make_index_sequence<count>{});
+        if (problem) return *problem;
+        return args;
+    }
+
+} // namespace agent::core::tools
@@ -0,0 +1,59 @@
+#include "core/tools/tool_dispatcher.hpp"
+#include <chrono>
+
+namespace agent::core::tools {
+
+    errors::Status ToolDispatcher::register_tool(std::unique_ptr<Tool> tool) {
+        const std::string& name = tool->schema().name;
+        if (by_name_.find(name) != nullptr) {
+            return errors::AgentError{errors::ErrorCategory::Input,
+                                      "Tool already registered: " + name};
+        }
+        tools_.push_back(std::move(tool));
+
+        std::vector<std::pair<std::string, Tool*>> entries;
+        entries.reserve(tools_.size());
+        for (const auto& each : tools_) entries.emplace_back(each->schema().name, each.get());
+        by_name_ = hash::PerfectHashMap<Tool*>(std::move(entries));
+        return std::monostate{};
+    }
+
+    const Tool* ToolDispatcher::find(std::string_view name) const {
+        Tool* const* tool = by_name_.find(name);
+        return tool ? *tool : nullptr;
+    }
+
+    std::vector<protocol::ToolSchema> ToolDispatcher::schemas() const {
+        std::vector<protocol::ToolSchema> out;
+        out.reserve(tools_.size());
+        for (const auto& tool : tools_) out.push_back(tool->schema());
+        return out;
+    }
+
+    protocol::ToolResult ToolDispatcher::dispatch(const protocol::ToolCall& call) const {
+        auto start = std::chrono::steady_clock::now();
+
+        protocol::ToolResult result;
+        Tool* const* tool = by_name_.find(call.name);
+        if (!tool) {
+            result = protocol::ToolResult{call.id, false, "", "Unknown tool: " + call.name, 0.0};
+        } else if (!memo_) {
+            result = (*tool)->execute(call);
+        } else if ((*tool)->is_side_effect_free()) {
+            result = memo_->run(**tool, call);
+        } else {
+            result = (*tool)->execute(call);
+            memo_->invalidate_trees();
+        }
+
+        result.tool_call_id = call.id;
+        // Tools that time themselves (e.g. run_command) keep their own number
+        if (result.duration_ms <= 0.0) {
+            std::chrono::duration<double, std::milli> elapsed =
+                std::chrono::steady_clock::now() - start;
+            result.duration_ms = elapsed.count();
+        }
+        return result;
+    }
+
+} // namespace agent::core::tools
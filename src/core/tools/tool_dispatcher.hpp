@@ -0,0 +1,41 @@
+#pragma once
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/hash/perfect_hash.hpp"
+#include "core/tools/tool.hpp"
+#include "core/tools/tool_memo.hpp"
+#include "protocol/tool_contract.hpp"
+
+namespace agent::core::tools {
+
+    // Owns the registered tools and routes each ToolCall to the right one.
+    // Registration happens at startup; after that dispatch() is read-only
+    // and can be called from several threads.
+    class ToolDispatcher {
+    public:
+        errors::Status register_tool(std::unique_ptr<Tool> tool);
+
+        const Tool* find(std::string_view name) const;
+
+        // Side-effect-free calls go through the memo; every other call drops
+        // its results over whole trees. Optional, owned by the caller.
+        void set_memo(ToolMemo* memo) { memo_ = memo; }
+
+        // The schemas of every registered tool, in registration order
+        std::vector<protocol::ToolSchema> schemas() const;
+
+        // Runs the call and stamps tool_call_id and duration_ms on the result.
+        // Unknown tools produce a failed ToolResult, not an AgentError.
+        protocol::ToolResult dispatch(const protocol::ToolCall& call) const;
+
+    private:
+        std::vector<std::unique_ptr<Tool>> tools_;
+        // Rebuilt on each registration, so dispatch never probes or allocates
+        hash::PerfectHashMap<Tool*> by_name_;
+        ToolMemo* memo_ = nullptr;
+    };
+
+} // namespace agent::core::tools
@@ -0,0 +1,238 @@
+#include "core/tools/tool_memo.hpp"
+#include <algorithm>
+#include <filesystem>
+#include "providers/canonical_request.hpp"
+
+namespace agent::core::tools {
+
+    namespace {
+
+        struct Reads {
+            std::vector<std::pair<std::string, fs::FileStamp>> files;
+            std::vector<std::string> trees;
+        };
+
+        // The reads of the memoized call running on this thread, if any
+        thread_local Reads* active_reads = nullptr;
+
+        class Recording {
+        public:
+            explicit Recording(Reads& reads) : outer_(std::exchange(active_reads, &reads)) {}
+            ~Recording() { active_reads = outer_; }
+
+            Recording(const Recording&) = delete;
+            Recording& operator=(const Recording&) = delete;
+
+        private:
+            Reads* outer_;
+        };
+
+        // Absolute and lexically normal, as inotify reports paths; no trailing '/'
+        std::string normalize(const std::string& path) {
+            std::error_code error;
+            auto absolute = std::filesystem::absolute(path, error);
+            std::string out =
+                (error ? std::filesystem::path(path) : absolute).lexically_normal().string();
+            if (out.size() > 1 && out.back() == '/') out.pop_back();
+            return out;
+        }
+
+        // path is dir or lies below it
+        bool covers(const std::string& dir, const std::string& path) {
+            return path.starts_with(dir) &&
+                   (path.size() == dir.size() || dir.back() == '/' || path[dir.size()] == '/');
+        }
+
+    } // namespace
+
+    double ToolMemoStats::hit_ratio() const {
+        std::size_t lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / static_cast<double>(lookups);
+    }
+
+    void note_file_read(const std::string& path) {
+        if (!active_reads) return;
+        std::string key = normalize(path);
+        fs::FileStamp stamp = fs::stamp(key);
+        active_reads->files.emplace_back(std::move(key), stamp);
+    }
+
+    void note_tree_read(const std::string& root) {
+        if (active_reads) active_reads->trees.push_back(normalize(root));
+    }
+
+    ToolMemo::ToolMemo(ToolMemoOptions options) : options_(options) {}
+
+    ToolMemo::~ToolMemo() {
+        watcher_.reset();  // Stops event delivery before the entries go away
+    }
+
+    protocol::ToolResult ToolMemo::run(Tool& tool, const protocol::ToolCall& call) {
+        // Tools of one name set up differently (another root or policy) do not share
+        std::string key = call.name;
+        key += '\0';
+        key += tool.memo_scope();
+        key += '\0';
+        key += providers::canonical_arguments(call.arguments);
+
+        // 1. The remembered result, if nothing it read has changed
+        std::shared_ptr<const Memoized> found;
+        std::uint64_t generation = 0;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            generation = generation_;
+            ++stats_.misses;  // Taken back below on a hit
+            auto it = entries_.find(key);
+            if (it != entries_.end()) {
+                found = it->second.memoized;
+                lru_.splice(lru_.begin(), lru_, it->second.lru);
+            }
+        }
+        if (found) {
+            // stat() outside the lock: other lookups need not wait on the disk
+            bool fresh = std::all_of(found->files.begin(), found->files.end(),
+                                     [](const auto& file) {
+                                         return fs::stamp(file.first) == file.second;
+                                     });
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (fresh) {
+                --stats_.misses;
+                ++stats_.hits;
+                protocol::ToolResult result = found->result;
+                result.tool_call_id = call.id;
+                result.duration_ms = 0.0;
+                return result;
+            }
+            ++stats_.stale;
+            auto it = entries_.find(key);
+            if (it != entries_.end() && it->second.memoized == found) drop_locked(it);
+        }
+
+        // 2. Run it, noting what it reads
+        Reads reads;
+        protocol::ToolResult result;
+        {
+            Recording recording(reads);
+            result = tool.execute(call);
+        }
+        store(std::move(key), Memoized{result, std::move(reads.files), std::move(reads.trees)},
+              generation);
+        return result;
+    }
+
+    void ToolMemo::store(std::string key, Memoized memoized, std::uint64_t generation) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        bool usable = !memoized.files.empty() || !memoized.trees.empty();
+        for (const auto& tree : memoized.trees) usable = usable && watched_locked(tree);
+        // A tree changed while the tool was reading it: the result may mix both states
+        if (!memoized.trees.empty() && generation != generation_) usable = false;
+
+        std::size_t bytes = key.size() + memoized.result.output.size() +
+                            memoized.result.error_message.size();
+        for (const auto& [path, stamp] : memoized.files) bytes += path.size();
+        for (const auto& tree : memoized.trees) bytes += tree.size();
+        if (!usable || bytes > options_.max_bytes || options_.max_entries == 0) {
+            ++stats_.uncacheable;
+            return;
+        }
+
+        auto existing = entries_.find(key);
+        if (existing != entries_.end()) drop_locked(existing);  // Another caller got here first
+
+        lru_.push_front(key);
+        Entry entry{std::make_shared<const Memoized>(std::move(memoized)), bytes, lru_.begin()};
+        entries_.emplace(std::move(key), std::move(entry));
+        stats_.bytes += bytes;
+        while (entries_.size() > options_.max_entries || stats_.bytes > options_.max_bytes) {
+            ++stats_.evictions;
+            drop_locked(entries_.find(lru_.back()));
+        }
+    }
+
+    bool ToolMemo::watched_locked(const std::string& tree) const {
+        return std::any_of(watched_.begin(), watched_.end(),
+                           [&](const std::string& root) { return covers(root, tree); });
+    }
+
+    void ToolMemo::drop_locked(std::unordered_map<std::string, Entry>::iterator it) {
+        stats_.bytes -= it->second.bytes;
+        lru_.erase(it->second.lru);
+        entries_.erase(it);
+    }
+
+    void ToolMemo::invalidate_trees() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            auto next = std::next(it);
+            if (!it->second.memoized->trees.empty()) {
+                ++stats_.invalidations;
+                drop_locked(it);
+            }
+            it = next;
+        }
+    }
+
+    void ToolMemo::clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+        entries_.clear();
+        lru_.clear();
+        stats_.bytes = 0;
+    }
+
+    ToolMemoStats ToolMemo::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ToolMemoStats copy = stats_;
+        copy.entries = entries_.size();
+        return copy;
+    }
+
+    // --- inotify ---
+
+    errors::Status ToolMemo::watch(const std::string& root) {
+        std::lock_guard<std::mutex> watch_lock(watch_mutex_);
+        if (!watcher_) {
+            auto listener = [this](const fs::TreeEvent& e) { on_changed(e); };
+            watcher_ = std::make_unique<fs::TreeWatcher>(listener);
+        }
+        std::string path = normalize(root);
+        auto status = watcher_->watch(path);
+        if (errors::is_error(status)) return status;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        watched_.push_back(std::move(path));
+        return status;
+    }
+
+    void ToolMemo::on_changed(const fs::TreeEvent& event) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++generation_;
+        bool everything = event.kind == fs::TreeEvent::Kind::Overflow;
+        bool directory = event.kind == fs::TreeEvent::Kind::Directory;
+        for (auto it = entries_.begin(); it != entries_.end();) {
+            auto next = std::next(it);
+            const Memoized& memoized = *it->second.memoized;
+            // A file event touches a file we read, or one inside a tree we
+            // read; a directory event takes along everything beneath it
+            bool affected =
+                everything ||
+                std::any_of(memoized.files.begin(), memoized.files.end(),
+                            [&](const auto& file) {
+                                return directory ? covers(event.path, file.first)
+                                                 : file.first == event.path;
+                            }) ||
+                std::any_of(memoized.trees.begin(), memoized.trees.end(),
+                            [&](const std::string& tree) {
+                                return covers(tree, event.path) ||
+                                       (directory && covers(event.path, tree));
+                            });
+            if (affected) {
+                ++stats_.invalidations;
+                drop_locked(it);
+            }
+            it = next;
+        }
+    }
+
+} // namespace agent::core::tools
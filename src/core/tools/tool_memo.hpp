@@ -0,0 +1,108 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "core/fs/file_cache.hpp"
+#include "core/fs/tree_watcher.hpp"
+#include "core/tools/tool.hpp"
+#include "protocol/tool_contract.hpp"
+
+namespace agent::core::tools {
+
+    struct ToolMemoOptions {
+        std::size_t max_entries = 4096;
+        std::size_t max_bytes = 64u << 20;  // Keys and result text; least recently used go first
+    };
+
+    struct ToolMemoStats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t stale = 0;          // Found, but a file it read has changed since
+        std::size_t uncacheable = 0;    // Ran, but cannot be reused (see ToolMemo)
+        std::size_t invalidations = 0;  // Entries dropped on a change in the workspace
+        std::size_t evictions = 0;      // Entries dropped for the entry or byte budget
+        std::size_t bytes = 0;          // Currently held
+        std::size_t entries = 0;
+
+        // Share of lookups answered from the memo, 0 before the first one
+        double hit_ratio() const;
+    };
+
+    // Called by tools as they run, before reading, to say what their result
+    // depends on. Outside a call run through ToolMemo they do nothing.
+    void note_file_read(const std::string& path);
+    void note_tree_read(const std::string& root);  // Anything at or below root
+
+    // Reuses the results of side-effect-free tool calls, within a session and
+    // across sessions sharing one memo. The key is the tool name, its
+    // memo_scope() and the canonical arguments; an entry also keeps what the
+    // call said it read, and is only reused while all of it is unchanged:
+    //
+    // - Files: stamped (mtime, size, inode) before the tool reads them, and
+    //   stat()ed again on every hit.
+    // - Trees (a search over a directory): only kept for trees under a
+    //   watch()ed root. Any inotify event below the tree drops the entry,
+    //   as does any tool call with side effects (invalidate_trees()),
+    //   since its writes may not have reached inotify yet.
+    //
+    // Calls that note no reads at all (bad arguments, denied paths, answers
+    // from an index) are never stored. Safe to use from any thread.
+    class ToolMemo {
+    public:
+        explicit ToolMemo(ToolMemoOptions options = {});
+        ~ToolMemo();
+
+        ToolMemo(const ToolMemo&) = delete;
+        ToolMemo& operator=(const ToolMemo&) = delete;
+
+        // Watches every directory under root, so that results over it can be kept
+        errors::Status watch(const std::string& root);
+
+        // tool.execute(call), or the remembered result of the same call. A
+        // remembered result has duration_ms 0, for the dispatcher to fill in.
+        protocol::ToolResult run(Tool& tool, const protocol::ToolCall& call);
+
+        // Drops every entry that depends on a tree
+        void invalidate_trees();
+
+        void clear();
+
+        ToolMemoStats stats() const;
+
+    private:
+        struct Memoized {
+            protocol::ToolResult result;
+            std::vector<std::pair<std::string, fs::FileStamp>> files;
+            std::vector<std::string> trees;
+        };
+        struct Entry {
+            std::shared_ptr<const Memoized> memoized;
+            std::size_t bytes;
+            std::list<std::string>::iterator lru;
+        };
+
+        ToolMemoOptions options_;
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, Entry> entries_;
+        std::list<std::string> lru_;  // Front is most recent
+        ToolMemoStats stats_;
+        std::uint64_t generation_ = 0;      // Bumped by every invalidation
+        std::vector<std::string> watched_;  // Roots given to watch()
+
+        std::mutex watch_mutex_;
+        std::unique_ptr<fs::TreeWatcher> watcher_;
+
+        void store(std::string key, Memoized memoized, std::uint64_t generation);
+        bool watched_locked(const std::string& tree) const;
+        void drop_locked(std::unordered_map<std::string, Entry>::iterator it);
+        void on_changed(const fs::TreeEvent& event);
+    };
+
+} // namespace agent::core::tools
@@ -0,0 +1,43 @@
+#pragma once
+#include <string>
+#include "core/tools/tool.hpp"
+#include "core/tools/tool_args.hpp"
+
+namespace agent::core::tools {
+
+    // A Tool whose arguments are the struct Args (see tool_args.hpp). The
+    // schema comes from Args::fields(), and run() gets the arguments already
+    // bound and checked; arguments that do not fit fail the call with a
+    // message naming the one at fault, e.g. "read_file: \"path\" is required".
+    template <typename Args>
+    class TypedTool : public Tool {
+    public:
+        const protocol::ToolSchema& schema() const override { return schema_; }
+
+        protocol::ToolResult execute(const protocol::ToolCall& call) final {
+            auto args = bind_arguments<Args>(call.arguments);
+            if (errors::is_error(args)) {
+                std::string message = schema_.name;
+                message.append(": ").append(errors::get_error(args).message);
+                return failure(call, std::move(message));
+            }
+            return run(call, errors::get_value(args));
+        }
+
+    protected:
+        TypedTool(std::string name, std::string description)
+            : schema_{std::move(name), std::move(description), json_schema<Args>()} {}
+
+        // Must be safe to call from several threads at once, as execute() is
+        virtual protocol::ToolResult run(const protocol::ToolCall& call, const Args& args) = 0;
+
+        // The failed result for call, with message as its error
+        static protocol::ToolResult failure(const protocol::ToolCall& call, std::string message) {
+            return protocol::ToolResult{call.id, false, "", std::move(message), 0.0};
+        }
+
+    private:
+        protocol::ToolSchema schema_;
+    };
+
+} // namespace agent::core::tools
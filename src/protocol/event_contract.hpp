@@ -1,4 +1,5 @@
 #pragma once
+#include <cstddef>
 #include <string>
 #include <variant>
 
@@ -16,6 +17,26 @@ namespace agent::protocol {
     struct AgentStartEvent { std::string run_id; };
     struct TurnStartEvent {};
     struct MessageDeltaEvent { std::string delta_text; };
+
+    // A streamed fragment of a tool call. Providers send the id and name once,
+    // then the JSON arguments arrive in pieces across many fragments.
+    struct ToolCallDeltaEvent {
+        std::size_t index;            // Which parallel tool call this fragment belongs to
+        std::string id;               // Only set on the first fragment
+        std::string name;             // Only set on the first fragment
+        std::string arguments_delta;  // Next piece of the raw JSON arguments
+    };
+    // The history sent this turn no longer starts with the bytes sent last
+    // turn, so the provider's prompt cache cannot be reused past this point.
+    struct PrefixCacheBreakEvent {
+        bool header_changed;        // Tools or model parameters changed
+        std::size_t message_index;  // First message whose serialization changed
+    };
+    // Old history was shrunk to stay inside the context window
+    struct ContextCompactedEvent {
+        std::size_t tokens_before;
+        std::size_t tokens_after;
+    };
     struct ToolExecutionStartEvent { std::string tool_name; };
     struct ToolExecutionEndEvent { bool success; };
     struct AgentEndEvent { StopReason reason; };
@@ -26,6 +47,9 @@ namespace agent::protocol {
         AgentStartEvent,
         TurnStartEvent,
         MessageDeltaEvent,
+        ToolCallDeltaEvent,
+        PrefixCacheBreakEvent,
+        ContextCompactedEvent,
         ToolExecutionStartEvent,
         ToolExecutionEndEvent,
         AgentEndEvent
@@ -10,6 +10,13 @@ namespace agent::protocol {
         std::string arguments;  // Raw JSON string of the arguments
     };
 
+    // How a tool describes itself to the LLM
+    struct ToolSchema {
+        std::string name;
+        std::string description;
+        std::string parameters;  // Raw JSON Schema of the arguments object
+    };
+
     // How your Execution Layer replies back
     struct ToolResult {
         std::string tool_call_id;
@@ -0,0 +1,202 @@
+#include "providers/canonical_request.hpp"
+#include <algorithm>
+#include <optional>
+#include "core/hash/stable_hash.hpp"
+
+namespace agent::providers {
+
+    using core::errors::AgentError;
+    using core::errors::ErrorCategory;
+
+    const char* to_string(protocol::Role role) {
+        switch (role) {
+            case protocol::Role::User: return "user";
+            case protocol::Role::Assistant: return "assistant";
+            case protocol::Role::System: return "system";
+            case protocol::Role::Tool: return "tool";
+        }
+        return "unknown";
+    }
+
+    const char* to_string(protocol::StopReason reason) {
+        switch (reason) {
+            case protocol::StopReason::Finished: return "finished";
+            case protocol::StopReason::ToolCall: return "tool_call";
+            case protocol::StopReason::MaxTokens: return "max_tokens";
+            case protocol::StopReason::Error: return "error";
+        }
+        return "unknown";
+    }
+
+    core::errors::Result<protocol::Role> role_from_string(const std::string& name) {
+        if (name == "user") return protocol::Role::User;
+        if (name == "assistant") return protocol::Role::Assistant;
+        if (name == "system") return protocol::Role::System;
+        if (name == "tool") return protocol::Role::Tool;
+        return AgentError{ErrorCategory::Input, "Unknown role: " + name};
+    }
+
+    core::errors::Result<protocol::StopReason> stop_reason_from_string(const std::string& name) {
+        if (name == "finished") return protocol::StopReason::Finished;
+        if (name == "tool_call") return protocol::StopReason::ToolCall;
+        if (name == "max_tokens") return protocol::StopReason::MaxTokens;
+        if (name == "error") return protocol::StopReason::Error;
+        return AgentError{ErrorCategory::Input, "Unknown stop_reason: " + name};
+    }
+
+    std::string canonical_arguments(const std::string& raw) {
+        // nlohmann::json objects are std::map-backed, so dump() sorts keys
+        auto parsed = nlohmann::json::parse(raw, nullptr, false);
+        if (parsed.is_discarded()) return raw;
+        return parsed.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace);
+    }
+
+    nlohmann::ordered_json message_to_json(const protocol::Message& message,
+                                           bool canonicalize_arguments) {
+        nlohmann::ordered_json json;
+        json["role"] = to_string(message.role);
+        json["content"] = message.content;
+
+        auto calls = nlohmann::ordered_json::array();
+        for (const auto& call : message.tool_calls) {
+            nlohmann::ordered_json entry;
+            entry["id"] = call.id;
+            entry["name"] = call.name;
+            entry["arguments"] =
+                canonicalize_arguments ? canonical_arguments(call.arguments) : call.arguments;
+            calls.push_back(std::move(entry));
+        }
+        json["tool_calls"] = std::move(calls);
+        json["tool_call_id"] = message.tool_call_id ? nlohmann::ordered_json(*message.tool_call_id)
+                                                    : nlohmann::ordered_json(nullptr);
+        return json;
+    }
+
+    core::errors::Result<protocol::Message> message_from_json(const nlohmann::json& json) {
+        if (!json.is_object()) return AgentError{ErrorCategory::Input, "Message must be an object"};
+
+        // Absent fields take the fallback; present ones must be strings
+        auto text = [](const nlohmann::json& object, const char* key,
+                       const char* fallback) -> std::optional<std::string> {
+            auto it = object.find(key);
+            if (it == object.end()) return std::string(fallback);
+            if (!it->is_string()) return std::nullopt;
+            return it->get<std::string>();
+        };
+
+        auto role_name = text(json, "role", "");
+        auto content = text(json, "content", "");
+        if (!role_name || !content) {
+            return AgentError{ErrorCategory::Input, "Message role and content must be strings"};
+        }
+        auto role = role_from_string(*role_name);
+        if (core::errors::is_error(role)) return core::errors::get_error(role);
+
+        protocol::Message message{core::errors::get_value(role), std::move(*content), {},
+                                  std::nullopt};
+        auto calls = json.find("tool_calls");
+        if (calls != json.end()) {
+            if (!calls->is_array()) {
+                return AgentError{ErrorCategory::Input, "Message tool_calls must be an array"};
+            }
+            for (const auto& call : *calls) {
+                if (!call.is_object()) {
+                    return AgentError{ErrorCategory::Input, "Tool call must be an object"};
+                }
+                auto id = text(call, "id", "");
+                auto name = text(call, "name", "");
+                auto arguments = text(call, "arguments", "{}");
+                if (!id || !name || !arguments) {
+                    return AgentError{ErrorCategory::Input, "Tool call fields must be strings"};
+                }
+                message.tool_calls.push_back(
+                    protocol::ToolCall{std::move(*id), std::move(*name), std::move(*arguments)});
+            }
+        }
+        if (json.contains("tool_call_id") && json["tool_call_id"].is_string()) {
+            message.tool_call_id = json["tool_call_id"].get<std::string>();
+        }
+        return message;
+    }
+
+    namespace {
+
+        std::string dump(const nlohmann::ordered_json& json) {
+            // Invalid UTF-8 in tool output must not throw; replace it instead
+            return json.dump(-1, ' ', false, nlohmann::ordered_json::error_handler_t::replace);
+        }
+
+    } // namespace
+
+    CanonicalRequest canonicalize(const CompletionRequest& request) {
+        CanonicalRequest out;
+
+        // 1. Header: everything that precedes the history on the wire
+        nlohmann::ordered_json params;
+        params["model"] = request.params.model;
+        params["temperature"] = request.params.temperature;
+        params["max_output_tokens"] = request.params.max_output_tokens;
+
+        auto tools = nlohmann::ordered_json::array();
+        for (const auto& tool : request.tools) {
+            nlohmann::ordered_json entry;
+            entry["name"] = tool.name;
+            entry["description"] = tool.description;
+            entry["parameters"] = canonical_arguments(tool.parameters);
+            tools.push_back(std::move(entry));
+        }
+
+        out.body = "{\"params\":" + dump(params) + ",\"tools\":" + dump(tools) + ",\"messages\":[";
+        out.header_hash = core::hash::stable_hash(out.body);
+
+        // 2. History: each message is serialized on its own, so its bytes never
+        //    depend on what comes after it, and the hash chain extends per message.
+        std::uint64_t rolling = out.header_hash;
+        out.prefix_hashes.reserve(request.messages.size());
+        for (std::size_t i = 0; i < request.messages.size(); ++i) {
+            std::string bytes = dump(message_to_json(request.messages[i]));
+            if (i > 0) out.body += ',';
+            out.body += bytes;
+            rolling = core::hash::stable_hash(bytes, rolling);
+            out.prefix_hashes.push_back(rolling);
+        }
+        out.body += "]}";
+        return out;
+    }
+
+    std::string serialize_canonical(const CompletionRequest& request) {
+        return canonicalize(request).body;
+    }
+
+    std::uint64_t request_key(const CompletionRequest& request) {
+        return core::hash::stable_hash(serialize_canonical(request));
+    }
+
+    std::optional<PrefixBreak> PrefixCacheTracker::observe(const CanonicalRequest& request) {
+        ++requests_;
+        std::optional<PrefixBreak> result;
+
+        if (has_previous_) {
+            if (request.header_hash != previous_header_) {
+                result = PrefixBreak{true, 0};
+            } else {
+                // Appending keeps every old prefix; a shorter history (e.g. after
+                // compaction) still shares its prefix. Only a changed byte breaks.
+                std::size_t common = std::min(previous_.size(), request.prefix_hashes.size());
+                for (std::size_t i = 0; i < common; ++i) {
+                    if (previous_[i] != request.prefix_hashes[i]) {
+                        result = PrefixBreak{false, i};
+                        break;
+                    }
+                }
+            }
+        }
+        if (result) ++breaks_;
+
+        has_previous_ = true;
+        previous_header_ = request.header_hash;
+        previous_ = request.prefix_hashes;
+        return result;
+    }
+
+} // namespace agent::providers
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "core/errors/agent_errors.hpp"
+#include "protocol/event_contract.hpp"
+#include "protocol/message_contract.hpp"
+#include "providers/provider.hpp"
+
+namespace agent::providers {
+
+    // Stable names used in every file and request we write
+    const char* to_string(protocol::Role role);
+    const char* to_string(protocol::StopReason reason);
+    core::errors::Result<protocol::Role> role_from_string(const std::string& name);
+    core::errors::Result<protocol::StopReason> stop_reason_from_string(const std::string& name);
+
+    // Re-serializes tool-call arguments with sorted keys and no whitespace so
+    // that two spellings of the same arguments produce the same bytes.
+    // Strings that are not valid JSON are passed through untouched.
+    std::string canonical_arguments(const std::string& raw);
+
+    // Fixed key order, no optional keys left to chance. Recordings keep the
+    // arguments exactly as the model wrote them; request keys canonicalize them.
+    nlohmann::ordered_json message_to_json(const protocol::Message& message,
+                                           bool canonicalize_arguments = true);
+    core::errors::Result<protocol::Message> message_from_json(const nlohmann::json& json);
+
+    // The canonical byte form of a request, laid out so that the bytes of
+    // messages[0..i] are always a prefix of the bytes with more messages.
+    // Provider prompt caches match on byte prefixes, so any drift here
+    // (key order, whitespace, argument spelling) silently costs a cache miss.
+    struct CanonicalRequest {
+        std::string body;
+        std::uint64_t header_hash = 0;             // Model parameters + tool schemas
+        std::vector<std::uint64_t> prefix_hashes;  // [i] covers header + messages[0..i]
+    };
+
+    CanonicalRequest canonicalize(const CompletionRequest& request);
+
+    // Shorthand for canonicalize(request).body
+    std::string serialize_canonical(const CompletionRequest& request);
+
+    // Stable 64-bit key of serialize_canonical(request)
+    std::uint64_t request_key(const CompletionRequest& request);
+
+    // Where consecutive requests stopped sharing a prefix
+    struct PrefixBreak {
+        bool header_changed;        // Tools or model parameters differ: nothing is reusable
+        std::size_t message_index;  // Otherwise, the first message whose bytes changed
+    };
+
+    // Compares each request's prefix hashes with the previous request's.
+    // One tracker per session; the loop calls observe() before every turn.
+    class PrefixCacheTracker {
+    public:
+        std::optional<PrefixBreak> observe(const CanonicalRequest& request);
+
+        std::size_t requests() const { return requests_; }
+        std::size_t breaks() const { return breaks_; }
+
+    private:
+        bool has_previous_ = false;
+        std::uint64_t previous_header_ = 0;
+        std::vector<std::uint64_t> previous_;
+        std::size_t requests_ = 0;
+        std::size_t breaks_ = 0;
+    };
+
+} // namespace agent::providers
@@ -0,0 +1,187 @@
+#include "providers/http/http_client.hpp"
+
+namespace agent::providers::http {
+
+    using core::errors::AgentError;
+    using core::errors::ErrorCategory;
+
+    namespace {
+
+        // Consecutive pipeline rounds on new connections that answered nothing
+        constexpr int kMaxStalledRounds = 3;
+
+    } // namespace
+
+    // --- HttpConnectionPool ---
+
+    core::errors::Result<std::unique_ptr<HttpConnection>> HttpConnectionPool::acquire(
+        const Endpoint& endpoint, bool& reused) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = idle_.find(endpoint.key());
+            if (it != idle_.end()) {
+                auto& idle = it->second;
+                auto now = std::chrono::steady_clock::now();
+                // Most recently used first: it is the least likely to have timed out
+                while (!idle.empty()) {
+                    std::unique_ptr<HttpConnection> connection = std::move(idle.back());
+                    idle.pop_back();
+
+                    auto idle_for = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        now - connection->idle_since);
+                    if (idle_for.count() > options_.idle_timeout_ms || connection->is_stale()) {
+                        ++stats_.discarded;
+                        continue;
+                    }
+                    ++stats_.reuses;
+                    reused = true;
+                    return connection;
+                }
+            }
+        }
+
+        // Connect outside the lock so a slow handshake does not block other sessions
+        reused = false;
+        auto connection = HttpConnection::connect(endpoint, options_.connection);
+        if (!core::errors::is_error(connection)) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            ++stats_.connects;
+        }
+        return connection;
+    }
+
+    void HttpConnectionPool::release(std::unique_ptr<HttpConnection> connection) {
+        if (!connection || !connection->reusable()) return;
+
+        connection->idle_since = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& idle = idle_[connection->endpoint().key()];
+        if (idle.size() >= options_.max_idle_per_endpoint) {
+            idle.pop_front();  // Drop the oldest
+            ++stats_.discarded;
+        }
+        idle.push_back(std::move(connection));
+    }
+
+    PoolStats HttpConnectionPool::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    std::size_t HttpConnectionPool::idle_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::size_t total = 0;
+        for (const auto& [key, idle] : idle_) total += idle.size();
+        return total;
+    }
+
+    // --- HttpClient ---
+
+    core::errors::Result<HttpResponseHead> HttpClient::stream(const Endpoint& endpoint,
+                                                              const HttpRequest& request,
+                                                              const BodySink& on_body) {
+        bool head_request = request.method == "HEAD";
+
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            bool reused = false;
+            auto acquired = pool_.acquire(endpoint, reused);
+            if (core::errors::is_error(acquired)) return core::errors::get_error(acquired);
+            auto connection = std::move(std::get<std::unique_ptr<HttpConnection>>(acquired));
+
+            std::size_t received_before = connection->bytes_received();
+            auto sent = connection->send_request(request);
+            auto head = core::errors::is_error(sent)
+                            ? core::errors::Result<HttpResponseHead>(core::errors::get_error(sent))
+                            : connection->read_head();
+
+            if (core::errors::is_error(head)) {
+                // The server closed an idle keep-alive under us before answering:
+                // nothing was processed, so sending again is safe.
+                bool nothing_received = connection->bytes_received() == received_before;
+                if (reused && nothing_received && attempt == 0) continue;
+                return core::errors::get_error(head);
+            }
+
+            auto body = connection->read_body(core::errors::get_value(head), head_request, on_body);
+            pool_.release(std::move(connection));
+            if (core::errors::is_error(body)) return core::errors::get_error(body);
+            return head;
+        }
+        return AgentError{ErrorCategory::Provider, "unreachable: retry loop exhausted"};
+    }
+
+    core::errors::Result<HttpResponse> HttpClient::fetch(const Endpoint& endpoint,
+                                                         const HttpRequest& request) {
+        HttpResponse response;
+        auto head = stream(endpoint, request, [&](std::string_view chunk) {
+            response.body.append(chunk);
+            return true;
+        });
+        if (core::errors::is_error(head)) return core::errors::get_error(head);
+        response.head = std::move(std::get<HttpResponseHead>(head));
+        return response;
+    }
+
+    core::errors::Result<std::vector<HttpResponseHead>> HttpClient::pipeline(
+        const Endpoint& endpoint, const std::vector<HttpRequest>& requests,
+        const PipelineSink& on_body) {
+        for (const auto& request : requests) {
+            if (request.method != "GET" && request.method != "HEAD" &&
+                request.method != "OPTIONS") {
+                return AgentError{ErrorCategory::Input,
+                                  "Cannot pipeline non-idempotent " + request.method + " request"};
+            }
+        }
+
+        std::vector<HttpResponseHead> heads;
+        heads.reserve(requests.size());
+        int stalled_rounds = 0;
+
+        // Each round writes every outstanding request, then reads as many answers
+        // as the connection gives us. A server may close mid-batch (Connection:
+        // close, keep-alive limits); the unanswered tail goes out again.
+        while (heads.size() < requests.size()) {
+            bool reused = false;
+            auto acquired = pool_.acquire(endpoint, reused);
+            if (core::errors::is_error(acquired)) return core::errors::get_error(acquired);
+            auto connection = std::move(std::get<std::unique_ptr<HttpConnection>>(acquired));
+
+            std::size_t first = heads.size();
+            std::size_t sent = first;
+            std::optional<AgentError> failure;
+            for (; sent < requests.size(); ++sent) {
+                auto status = connection->send_request(requests[sent]);
+                if (core::errors::is_error(status)) {
+                    // The server may already have answered what it did receive
+                    failure = core::errors::get_error(status);
+                    break;
+                }
+            }
+
+            for (std::size_t i = first; i < sent; ++i) {
+                auto head = connection->read_head();
+                if (core::errors::is_error(head)) {
+                    failure = core::errors::get_error(head);
+                    break;
+                }
+                auto body = connection->read_body(
+                    core::errors::get_value(head), requests[i].method == "HEAD",
+                    [&](std::string_view chunk) { return on_body(i, chunk); });
+                if (core::errors::is_error(body)) return core::errors::get_error(body);
+
+                heads.push_back(std::move(std::get<HttpResponseHead>(head)));
+                if (!connection->reusable()) break;
+            }
+            pool_.release(std::move(connection));
+
+            // Give up only when fresh connections repeatedly make no progress
+            if (heads.size() > first) {
+                stalled_rounds = 0;
+            } else if (failure && !reused && ++stalled_rounds >= kMaxStalledRounds) {
+                return *failure;
+            }
+        }
+        return heads;
+    }
+
+} // namespace agent::providers::http
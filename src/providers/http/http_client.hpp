@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "providers/http/http_connection.hpp"
+
+namespace agent::providers::http {
+
+    struct PoolOptions {
+        ConnectionOptions connection;
+        std::size_t max_idle_per_endpoint = 8;
+        int idle_timeout_ms = 60000;  // Servers usually drop idle keep-alives after ~60-90s
+    };
+
+    struct PoolStats {
+        std::size_t connects = 0;   // New TCP connections opened
+        std::size_t reuses = 0;     // Requests served on a pooled connection
+        std::size_t discarded = 0;  // Idle connections found dead or expired
+    };
+
+    // Keeps idle keep-alive connections per endpoint so that consecutive
+    // turns skip the TCP (and, later, TLS) handshake. Thread-safe.
+    class HttpConnectionPool {
+    public:
+        explicit HttpConnectionPool(PoolOptions options = {}) : options_(std::move(options)) {}
+
+        // Returns a pooled connection if a live one is idle, otherwise connects.
+        // reused is set so callers know whether a stale-connection retry makes sense.
+        core::errors::Result<std::unique_ptr<HttpConnection>> acquire(const Endpoint& endpoint,
+                                                                      bool& reused);
+
+        // Hands a connection back; it is kept only if it is still reusable
+        void release(std::unique_ptr<HttpConnection> connection);
+
+        PoolStats stats() const;
+        std::size_t idle_count() const;
+
+    private:
+        PoolOptions options_;
+        mutable std::mutex mutex_;
+        std::unordered_map<std::string, std::deque<std::unique_ptr<HttpConnection>>> idle_;
+        PoolStats stats_;
+    };
+
+    struct HttpResponse {
+        HttpResponseHead head;
+        std::string body;
+    };
+
+    // Receives the body of response number `index` in a pipelined batch
+    using PipelineSink = std::function<bool(std::size_t index, std::string_view chunk)>;
+
+    // The request/response layer that provider adapters build on
+    class HttpClient {
+    public:
+        explicit HttpClient(HttpConnectionPool& pool) : pool_(pool) {}
+
+        // Sends one request and streams the response body into on_body.
+        // A request on a pooled connection that the server already closed is
+        // retried once on a fresh connection.
+        core::errors::Result<HttpResponseHead> stream(const Endpoint& endpoint,
+                                                      const HttpRequest& request,
+                                                      const BodySink& on_body);
+
+        // Convenience wrapper that buffers the whole body
+        core::errors::Result<HttpResponse> fetch(const Endpoint& endpoint,
+                                                 const HttpRequest& request);
+
+        // Writes all requests on one connection before reading any response.
+        // HTTP/1.1 only allows this for idempotent methods, so anything other
+        // than GET/HEAD/OPTIONS is rejected with ErrorCategory::Input.
+        core::errors::Result<std::vector<HttpResponseHead>> pipeline(
+            const Endpoint& endpoint, const std::vector<HttpRequest>& requests,
+            const PipelineSink& on_body);
+
+    private:
+        HttpConnectionPool& pool_;
+    };
+
+} // namespace agent::providers::http
@@ -0,0 +1,384 @@
+#include "providers/http/http_connection.hpp"
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+
+namespace agent::providers::http {
+
+    using core::errors::AgentError;
+    using core::errors::ErrorCategory;
+
+    namespace {
+
+        std::string lower(std::string_view text) {
+            std::string out(text);
+            std::transform(out.begin(), out.end(), out.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return out;
+        }
+
+        std::string_view trim(std::string_view text) {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+                text.remove_prefix(1);
+            }
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+                text.remove_suffix(1);
+            }
+            return text;
+        }
+
+        // The whole token must be the number: garbage read as 0 would look
+        // like the end of the body and silently truncate it
+        std::optional<std::size_t> parse_size(std::string_view text, int base) {
+            std::size_t value = 0;
+            const char* end = text.data() + text.size();
+            auto [stop, ec] = std::from_chars(text.data(), end, value, base);
+            if (text.empty() || ec != std::errc() || stop != end) return std::nullopt;
+            return value;
+        }
+
+        // Waits until fd is ready for `events`; false on timeout or error
+        bool wait_for(int fd, short events, int timeout_ms) {
+            pollfd pfd{fd, events, 0};
+            while (true) {
+                int rc = ::poll(&pfd, 1, timeout_ms);
+                if (rc < 0 && errno == EINTR) continue;
+                return rc > 0;
+            }
+        }
+
+        AgentError provider_error(const std::string& message) {
+            return AgentError{ErrorCategory::Provider, message};
+        }
+
+    } // namespace
+
+    std::optional<std::string_view> HttpResponseHead::header(std::string_view name) const {
+        for (const auto& [key, value] : headers) {
+            if (key == name) return std::string_view(value);
+        }
+        return std::nullopt;
+    }
+
+    HttpConnection::HttpConnection(int fd, Endpoint endpoint, const ConnectionOptions& options)
+        : fd_(fd),
+          endpoint_(std::move(endpoint)),
+          options_(options),
+          buffer_(std::max<std::size_t>(options.read_buffer_bytes, 1024)) {}
+
+    HttpConnection::~HttpConnection() {
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    core::errors::Result<std::unique_ptr<HttpConnection>> HttpConnection::connect(
+        const Endpoint& endpoint, const ConnectionOptions& options) {
+        addrinfo hints{};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+
+        addrinfo* addresses = nullptr;
+        std::string port = std::to_string(endpoint.port);
+        int rc = ::getaddrinfo(endpoint.host.c_str(), port.c_str(), &hints, &addresses);
+        if (rc != 0) {
+            return provider_error("DNS lookup failed for " + endpoint.host + ": " +
+                                  ::gai_strerror(rc));
+        }
+
+        std::string last_error = "no addresses";
+        for (addrinfo* ai = addresses; ai != nullptr; ai = ai->ai_next) {
+            int fd = ::socket(ai->ai_family, ai->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                              ai->ai_protocol);
+            if (fd < 0) {
+                last_error = std::strerror(errno);
+                continue;
+            }
+
+            // Non-blocking connect so that we can enforce connect_timeout_ms
+            int err = 0;
+            if (::connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+                err = errno;
+                if (err == EINPROGRESS) {
+                    if (wait_for(fd, POLLOUT, options.connect_timeout_ms)) {
+                        socklen_t len = sizeof(err);
+                        ::getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len);
+                    } else {
+                        err = ETIMEDOUT;
+                    }
+                }
+            }
+            if (err != 0) {
+                last_error = std::strerror(err);
+                ::close(fd);
+                continue;
+            }
+
+            // Small request heads should not wait for Nagle
+            int one = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            ::freeaddrinfo(addresses);
+            return std::unique_ptr<HttpConnection>(new HttpConnection(fd, endpoint, options));
+        }
+
+        ::freeaddrinfo(addresses);
+        return provider_error("Cannot connect to " + endpoint.key() + ": " + last_error);
+    }
+
+    core::errors::Status HttpConnection::fail(const std::string& message) {
+        reusable_ = false;
+        return provider_error(endpoint_.key() + ": " + message);
+    }
+
+    core::errors::Status HttpConnection::send_request(const HttpRequest& request) {
+        // 1. Serialize the head into the reused buffer
+        request_head_.clear();
+        request_head_ += request.method;
+        request_head_ += ' ';
+        request_head_ += request.target;
+        request_head_ += " HTTP/1.1\r\n";
+
+        bool has_host = false;
+        for (const auto& [name, value] : request.headers) {
+            if (lower(name) == "host") has_host = true;
+            request_head_ += name;
+            request_head_ += ": ";
+            request_head_ += value;
+            request_head_ += "\r\n";
+        }
+        if (!has_host) request_head_ += "Host: " + endpoint_.host + "\r\n";
+        if (!request.body.empty() || request.method == "POST" || request.method == "PUT") {
+            request_head_ += "Content-Length: " + std::to_string(request.body.size()) + "\r\n";
+        }
+        request_head_ += "\r\n";
+
+        // 2. Write head and body together without copying the body
+        iovec parts[2] = {
+            {request_head_.data(), request_head_.size()},
+            {const_cast<char*>(request.body.data()), request.body.size()},
+        };
+        int count = request.body.empty() ? 1 : 2;
+        iovec* next = parts;
+
+        while (count > 0) {
+            msghdr msg{};
+            msg.msg_iov = next;
+            msg.msg_iovlen = static_cast<std::size_t>(count);
+            ssize_t sent = ::sendmsg(fd_, &msg, MSG_NOSIGNAL);
+            if (sent < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                    if (!wait_for(fd_, POLLOUT, options_.io_timeout_ms)) {
+                        return fail("write timed out");
+                    }
+                    continue;
+                }
+                return fail(std::string("write failed: ") + std::strerror(errno));
+            }
+
+            auto remaining = static_cast<std::size_t>(sent);
+            while (count > 0 && remaining >= next->iov_len) {
+                remaining -= next->iov_len;
+                ++next;
+                --count;
+            }
+            if (count > 0) {
+                next->iov_base = static_cast<char*>(next->iov_base) + remaining;
+                next->iov_len -= remaining;
+            }
+        }
+
+        ++requests_sent_;
+        return std::monostate{};
+    }
+
+    core::errors::Result<std::size_t> HttpConnection::fill() {
+        if (begin_ == end_) begin_ = end_ = 0;
+        if (end_ == buffer_.size()) {
+            if (begin_ > 0) {
+                std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+                end_ -= begin_;
+                begin_ = 0;
+            } else {
+                // Only a single oversized header line can get us here
+                buffer_.resize(buffer_.size() * 2);
+            }
+        }
+
+        while (true) {
+            ssize_t n = ::recv(fd_, buffer_.data() + end_, buffer_.size() - end_, 0);
+            if (n > 0) {
+                end_ += static_cast<std::size_t>(n);
+                bytes_received_ += static_cast<std::size_t>(n);
+                return static_cast<std::size_t>(n);
+            }
+            if (n == 0) {
+                reusable_ = false;
+                return std::size_t{0};
+            }
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                if (!wait_for(fd_, POLLIN, options_.io_timeout_ms)) {
+                    return core::errors::get_error(fail("read timed out"));
+                }
+                continue;
+            }
+            auto failed = fail(std::string("read failed: ") + std::strerror(errno));
+            return core::errors::get_error(failed);
+        }
+    }
+
+    core::errors::Result<std::string_view> HttpConnection::read_line() {
+        std::size_t scanned = begin_;
+        while (true) {
+            std::string_view window(buffer_.data() + begin_, end_ - begin_);
+            std::size_t pos = window.find("\r\n", scanned > begin_ ? scanned - begin_ - 1 : 0);
+            if (pos != std::string_view::npos) {
+                begin_ += pos + 2;
+                return window.substr(0, pos);
+            }
+
+            std::size_t offset = end_ - begin_;
+            auto got = fill();
+            if (core::errors::is_error(got)) return core::errors::get_error(got);
+            if (core::errors::get_value(got) == 0) {
+                return core::errors::get_error(fail("connection closed mid-line"));
+            }
+            scanned = begin_ + offset;
+        }
+    }
+
+    core::errors::Result<HttpResponseHead> HttpConnection::read_head() {
+        // 1. Status line: "HTTP/1.1 200 OK"
+        auto status_line = read_line();
+        if (core::errors::is_error(status_line)) return core::errors::get_error(status_line);
+        std::string_view line = core::errors::get_value(status_line);
+
+        if (line.size() < 12 || line.substr(0, 5) != "HTTP/") {
+            return core::errors::get_error(fail("malformed status line"));
+        }
+        bool http10 = line.substr(0, 8) == "HTTP/1.0";
+
+        HttpResponseHead head;
+        head.status = std::atoi(std::string(line.substr(9, 3)).c_str());
+        if (line.size() > 13) head.reason = std::string(line.substr(13));
+        head.keep_alive = !http10;
+
+        // 2. Headers until the blank line
+        while (true) {
+            auto header_line = read_line();
+            if (core::errors::is_error(header_line)) return core::errors::get_error(header_line);
+            std::string_view header = core::errors::get_value(header_line);
+            if (header.empty()) break;
+
+            std::size_t colon = header.find(':');
+            if (colon == std::string_view::npos) continue;
+            std::string name = lower(trim(header.substr(0, colon)));
+            std::string value(trim(header.substr(colon + 1)));
+
+            if (name == "content-length") {
+                auto length = parse_size(value, 10);
+                if (!length) return core::errors::get_error(fail("malformed Content-Length"));
+                head.content_length = *length;
+            } else if (name == "transfer-encoding") {
+                head.chunked = lower(value).find("chunked") != std::string::npos;
+            } else if (name == "connection") {
+                std::string token = lower(value);
+                if (token.find("close") != std::string::npos) head.keep_alive = false;
+                if (token.find("keep-alive") != std::string::npos) head.keep_alive = true;
+            }
+            head.headers.emplace_back(std::move(name), std::move(value));
+        }
+
+        if (!head.keep_alive) reusable_ = false;
+        return head;
+    }
+
+    core::errors::Status HttpConnection::deliver(std::size_t length, const BodySink& on_body) {
+        while (length > 0) {
+            if (begin_ == end_) {
+                auto got = fill();
+                if (core::errors::is_error(got)) return core::errors::get_error(got);
+                if (core::errors::get_value(got) == 0) return fail("connection closed mid-body");
+            }
+            std::size_t n = std::min(length, end_ - begin_);
+            std::string_view chunk(buffer_.data() + begin_, n);
+            begin_ += n;
+            length -= n;
+            if (!on_body(chunk)) {
+                // Abandoning a body leaves unread bytes on the wire
+                reusable_ = false;
+                return AgentError{ErrorCategory::Provider, "response body aborted by caller"};
+            }
+        }
+        return std::monostate{};
+    }
+
+    core::errors::Status HttpConnection::read_body(const HttpResponseHead& head,
+                                                   bool head_request, const BodySink& on_body) {
+        // 1. Responses that never carry a body
+        if (head_request || head.status / 100 == 1 || head.status == 204 || head.status == 304) {
+            return std::monostate{};
+        }
+
+        // 2. Chunked transfer encoding: "<hex size>\r\n<bytes>\r\n" ... "0\r\n\r\n"
+        if (head.chunked) {
+            while (true) {
+                auto size_line = read_line();
+                if (core::errors::is_error(size_line)) return core::errors::get_error(size_line);
+                std::string_view line = core::errors::get_value(size_line);
+                auto size = parse_size(trim(line.substr(0, line.find(';'))), 16);  // ";ext"
+                if (!size) return fail("malformed chunk size");
+
+                if (*size == 0) {
+                    // Skip optional trailers up to the final blank line
+                    while (true) {
+                        auto trailer = read_line();
+                        if (core::errors::is_error(trailer)) {
+                            return core::errors::get_error(trailer);
+                        }
+                        if (core::errors::get_value(trailer).empty()) return std::monostate{};
+                    }
+                }
+
+                auto delivered = deliver(*size, on_body);
+                if (core::errors::is_error(delivered)) return delivered;
+                auto crlf = read_line();
+                if (core::errors::is_error(crlf)) return core::errors::get_error(crlf);
+            }
+        }
+
+        // 3. Fixed length
+        if (head.content_length) return deliver(*head.content_length, on_body);
+
+        // 4. Neither: the body runs until the server closes the connection
+        reusable_ = false;
+        while (true) {
+            if (begin_ == end_) {
+                auto got = fill();
+                if (core::errors::is_error(got)) return core::errors::get_error(got);
+                if (core::errors::get_value(got) == 0) return std::monostate{};
+            }
+            auto delivered = deliver(end_ - begin_, on_body);
+            if (core::errors::is_error(delivered)) return delivered;
+        }
+    }
+
+    bool HttpConnection::is_stale() const {
+        if (!reusable_ || begin_ != end_) return true;
+        // Readable while idle means EOF or unsolicited bytes; either way, unusable
+        pollfd pfd{fd_, POLLIN, 0};
+        return ::poll(&pfd, 1, 0) != 0;
+    }
+
+} // namespace agent::providers::http
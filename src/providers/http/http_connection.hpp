@@ -0,0 +1,109 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+
+namespace agent::providers::http {
+
+    struct Endpoint {
+        std::string host;
+        std::uint16_t port = 80;
+
+        std::string key() const { return host + ":" + std::to_string(port); }
+    };
+
+    struct HttpRequest {
+        std::string method = "GET";
+        std::string target = "/";  // Path plus query string
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+    };
+
+    struct HttpResponseHead {
+        int status = 0;
+        std::string reason;
+        std::vector<std::pair<std::string, std::string>> headers;  // Names are lower-cased
+        std::optional<std::size_t> content_length;
+        bool chunked = false;
+        bool keep_alive = true;
+
+        // Returns the first header with this (lower-case) name
+        std::optional<std::string_view> header(std::string_view name) const;
+    };
+
+    // Receives the body piece by piece. The view points into the connection's
+    // read buffer and is only valid during the call. Return false to abort.
+    using BodySink = std::function<bool(std::string_view chunk)>;
+
+    struct ConnectionOptions {
+        int connect_timeout_ms = 5000;
+        int io_timeout_ms = 60000;
+        std::size_t read_buffer_bytes = 64 * 1024;
+    };
+
+    // One keep-alive HTTP/1.1 connection over plain TCP.
+    //
+    // The read buffer is allocated once per connection and reused for every
+    // response; body bytes are handed to the BodySink straight out of it, so a
+    // streamed response costs no allocation per chunk.
+    class HttpConnection {
+    public:
+        static core::errors::Result<std::unique_ptr<HttpConnection>> connect(
+            const Endpoint& endpoint, const ConnectionOptions& options);
+
+        ~HttpConnection();
+        HttpConnection(const HttpConnection&) = delete;
+        HttpConnection& operator=(const HttpConnection&) = delete;
+
+        // Writes one request. Several may be written before reading (pipelining).
+        core::errors::Status send_request(const HttpRequest& request);
+
+        core::errors::Result<HttpResponseHead> read_head();
+
+        // Streams the body of the response whose head was just read
+        core::errors::Status read_body(const HttpResponseHead& head, bool head_request,
+                                       const BodySink& on_body);
+
+        // False once the peer asked to close, a read failed, or a body was abandoned
+        bool reusable() const { return reusable_; }
+
+        // True if the idle connection has been closed (or written to) by the peer
+        bool is_stale() const;
+
+        const Endpoint& endpoint() const { return endpoint_; }
+        std::size_t requests_sent() const { return requests_sent_; }
+        std::size_t bytes_received() const { return bytes_received_; }
+
+        std::chrono::steady_clock::time_point idle_since;
+
+    private:
+        HttpConnection(int fd, Endpoint endpoint, const ConnectionOptions& options);
+
+        int fd_;
+        Endpoint endpoint_;
+        ConnectionOptions options_;
+        bool reusable_ = true;
+
+        std::vector<char> buffer_;
+        std::size_t begin_ = 0;  // First unread byte
+        std::size_t end_ = 0;    // One past the last received byte
+        std::string request_head_;  // Reused between requests
+        std::size_t requests_sent_ = 0;
+        std::size_t bytes_received_ = 0;
+
+        // Reads more bytes into the buffer; returns 0 on orderly EOF
+        core::errors::Result<std::size_t> fill();
+        core::errors::Result<std::string_view> read_line();
+        core::errors::Status deliver(std::size_t length, const BodySink& on_body);
+        core::errors::Status fail(const std::string& message);
+    };
+
+} // namespace agent::providers::http
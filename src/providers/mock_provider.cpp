@@ -0,0 +1,212 @@
+#include "providers/mock_provider.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <optional>
+#include <thread>
+#include <nlohmann/json.hpp>
+#include "providers/canonical_request.hpp"
+
+namespace agent::providers {
+
+    using core::errors::AgentError;
+    using core::errors::ErrorCategory;
+
+    namespace {
+
+        // Tool-call arguments are streamed in chunks of this many bytes
+        constexpr std::size_t kArgumentChunkBytes = 8;
+
+        // Paces emitted tokens against a fixed schedule so that sleep overshoot
+        // on one token does not accumulate over the whole message.
+        class TokenPacer {
+        public:
+            explicit TokenPacer(double tokens_per_second)
+                : start_(std::chrono::steady_clock::now()),
+                  interval_(tokens_per_second > 0.0 ? 1.0 / tokens_per_second : 0.0) {}
+
+            void wait_for_next() {
+                if (interval_ <= 0.0) return;
+                ++emitted_;
+                auto due = start_ + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                        std::chrono::duration<double>(interval_ * emitted_));
+                std::this_thread::sleep_until(due);
+            }
+
+        private:
+            std::chrono::steady_clock::time_point start_;
+            double interval_;
+            std::size_t emitted_ = 0;
+        };
+
+    } // namespace
+
+    MockProvider::MockProvider(std::vector<ScriptedTurn> script, MockTiming timing, bool loop)
+        : script_(std::move(script)), timing_(timing), loop_(loop), rng_(timing.seed) {}
+
+    core::errors::Result<std::vector<ScriptedTurn>> MockProvider::load_script(
+        const std::string& path) {
+        std::ifstream in(path);
+        if (!in) return AgentError{ErrorCategory::Input, "Cannot open mock script: " + path};
+
+        std::vector<ScriptedTurn> script;
+        std::string line;
+        std::size_t line_no = 0;
+        while (std::getline(in, line)) {
+            ++line_no;
+            if (line.empty()) continue;
+
+            auto json = nlohmann::json::parse(line, nullptr, false);
+            if (json.is_discarded() || !json.is_object()) {
+                return AgentError{ErrorCategory::Input,
+                                  path + ":" + std::to_string(line_no) + ": invalid JSON"};
+            }
+
+            // Scripts are hand-edited: a wrong-typed field is an input error
+            // naming its line, never a json exception
+            std::string where = path + ":" + std::to_string(line_no) + ": ";
+            std::optional<AgentError> invalid;
+            auto field = [&](const nlohmann::json& object, const char* key) {
+                std::optional<std::string> value;
+                auto it = object.find(key);
+                if (it == object.end() || it->is_null()) return value;
+                if (it->is_string()) {
+                    value = it->get<std::string>();
+                } else if (!invalid) {
+                    invalid = AgentError{ErrorCategory::Input,
+                                         where + "\"" + key + "\" must be a string"};
+                }
+                return value;
+            };
+
+            ScriptedTurn turn;
+            turn.text = field(json, "text").value_or("");
+            turn.error = field(json, "error");
+            auto stop_reason = field(json, "stop_reason");
+            auto calls = json.find("tool_calls");
+            if (calls != json.end() && !calls->is_null()) {
+                if (!calls->is_array()) {
+                    return AgentError{ErrorCategory::Input,
+                                      where + "\"tool_calls\" must be an array"};
+                }
+                for (const auto& call : *calls) {
+                    if (!call.is_object()) {
+                        return AgentError{ErrorCategory::Input,
+                                          where + "each tool call must be an object"};
+                    }
+                    // Recorded arguments may be the JSON object itself
+                    auto arguments = call.find("arguments");
+                    std::string raw = arguments != call.end() && arguments->is_object()
+                                          ? arguments->dump()
+                                          : field(call, "arguments").value_or("{}");
+                    turn.tool_calls.push_back(protocol::ToolCall{
+                        field(call, "id").value_or(""), field(call, "name").value_or(""), raw});
+                }
+            }
+            if (invalid) return *invalid;
+
+            std::string default_reason = turn.tool_calls.empty() ? "finished" : "tool_call";
+            auto reason = stop_reason_from_string(stop_reason.value_or(default_reason));
+            if (core::errors::is_error(reason)) {
+                return AgentError{ErrorCategory::Input,
+                                  where + core::errors::get_error(reason).message};
+            }
+            turn.stop_reason = core::errors::get_value(reason);
+
+            script.push_back(std::move(turn));
+        }
+        return script;
+    }
+
+    std::vector<std::string> MockProvider::tokenize(const std::string& text) {
+        std::vector<std::string> tokens;
+        std::size_t i = 0;
+        while (i < text.size()) {
+            std::size_t start = i;
+            while (i < text.size() && std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+            while (i < text.size() && !std::isspace(static_cast<unsigned char>(text[i]))) ++i;
+            tokens.push_back(text.substr(start, i - start));
+        }
+        return tokens;
+    }
+
+    std::size_t MockProvider::turns_served() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return next_turn_;
+    }
+
+    double MockProvider::sample_latency_ms(const LatencyDistribution& dist) {
+        switch (dist.kind) {
+            case LatencyDistribution::Kind::Fixed: return dist.mean_ms;
+            case LatencyDistribution::Kind::Normal: {
+                std::normal_distribution<double> normal(dist.mean_ms, dist.stddev_ms);
+                return std::max(0.0, normal(rng_));
+            }
+            case LatencyDistribution::Kind::LogNormal: {
+                if (dist.mean_ms <= 0.0) return 0.0;
+                // Convert the desired mean/stddev into the underlying normal's parameters
+                double variance = dist.stddev_ms * dist.stddev_ms;
+                double mean_sq = dist.mean_ms * dist.mean_ms;
+                double sigma = std::sqrt(std::log(1.0 + variance / mean_sq));
+                double mu = std::log(dist.mean_ms) - 0.5 * sigma * sigma;
+                std::lognormal_distribution<double> lognormal(mu, sigma);
+                return lognormal(rng_);
+            }
+        }
+        return 0.0;
+    }
+
+    core::errors::Result<CompletionResponse> MockProvider::complete(const CompletionRequest&,
+                                                                    const EventSink& on_event) {
+        // 1. Pick the turn and roll the dice while holding the lock, then stream
+        //    without it so that concurrent sessions do not serialize on us.
+        const ScriptedTurn* turn = nullptr;
+        double first_token_ms = 0.0;
+        bool inject_error = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (script_.empty() || (!loop_ && next_turn_ >= script_.size())) {
+                return AgentError{ErrorCategory::Provider, "Mock script exhausted"};
+            }
+            turn = &script_[next_turn_ % script_.size()];
+            ++next_turn_;
+
+            first_token_ms = sample_latency_ms(timing_.first_token);
+            if (timing_.error_rate > 0.0) {
+                std::bernoulli_distribution coin(timing_.error_rate);
+                inject_error = coin(rng_);
+            }
+        }
+
+        if (first_token_ms > 0.0) {
+            std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(first_token_ms));
+        }
+        if (turn->error) return AgentError{ErrorCategory::Provider, *turn->error};
+        if (inject_error) return AgentError{ErrorCategory::Provider, "Mock injected failure"};
+
+        // 2. Stream the text, then each tool call in argument fragments
+        TokenPacer pacer(timing_.tokens_per_second);
+        for (auto& token : tokenize(turn->text)) {
+            pacer.wait_for_next();
+            on_event(protocol::MessageDeltaEvent{std::move(token)});
+        }
+
+        for (std::size_t index = 0; index < turn->tool_calls.size(); ++index) {
+            const auto& call = turn->tool_calls[index];
+            pacer.wait_for_next();
+            on_event(protocol::ToolCallDeltaEvent{index, call.id, call.name, ""});
+            for (std::size_t pos = 0; pos < call.arguments.size(); pos += kArgumentChunkBytes) {
+                pacer.wait_for_next();
+                on_event(protocol::ToolCallDeltaEvent{
+                    index, "", "", call.arguments.substr(pos, kArgumentChunkBytes)});
+            }
+        }
+
+        protocol::Message message{protocol::Role::Assistant, turn->text, turn->tool_calls,
+                                  std::nullopt};
+        return CompletionResponse{std::move(message), turn->stop_reason};
+    }
+
+} // namespace agent::providers
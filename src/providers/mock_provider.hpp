@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "providers/provider.hpp"
+
+namespace agent::providers {
+
+    // One scripted assistant reply
+    struct ScriptedTurn {
+        std::string text;
+        std::vector<protocol::ToolCall> tool_calls;
+        protocol::StopReason stop_reason = protocol::StopReason::Finished;
+        std::optional<std::string> error;  // If set, the turn fails with ErrorCategory::Provider
+    };
+
+    // A latency in milliseconds drawn from a simple distribution
+    struct LatencyDistribution {
+        enum class Kind { Fixed, Normal, LogNormal };
+        Kind kind = Kind::Fixed;
+        double mean_ms = 0.0;
+        double stddev_ms = 0.0;
+    };
+
+    struct MockTiming {
+        double tokens_per_second = 0.0;    // 0 streams as fast as possible
+        LatencyDistribution first_token;   // Time to first token
+        double error_rate = 0.0;           // Extra random Provider errors, 0..1
+        std::uint64_t seed = 42;           // Same seed => same latencies and errors
+    };
+
+    // A network-free Provider that replays a script.
+    // Text is streamed as word-sized MessageDeltaEvents and tool calls as
+    // ToolCallDeltaEvent fragments, so the whole loop (including speculation)
+    // sees the same event shapes a real adapter would produce.
+    class MockProvider : public Provider {
+    public:
+        MockProvider(std::vector<ScriptedTurn> script, MockTiming timing = {}, bool loop = false);
+
+        // Loads a recorded conversation: one JSON object per line, e.g.
+        // {"text": "...", "tool_calls": [{"id": "...", "name": "...", "arguments": "{}"}],
+        //  "stop_reason": "tool_call", "error": "rate limited"}
+        static core::errors::Result<std::vector<ScriptedTurn>> load_script(const std::string& path);
+
+        core::errors::Result<CompletionResponse> complete(const CompletionRequest& request,
+                                                          const EventSink& on_event) override;
+
+        // Splits text into the chunks we stream (leading whitespace + one word)
+        static std::vector<std::string> tokenize(const std::string& text);
+
+        std::size_t turns_served() const;
+
+    private:
+        std::vector<ScriptedTurn> script_;
+        MockTiming timing_;
+        bool loop_;
+
+        mutable std::mutex mutex_;
+        std::size_t next_turn_ = 0;
+        std::mt19937_64 rng_;
+
+        double sample_latency_ms(const LatencyDistribution& dist);
+    };
+
+} // namespace agent::providers
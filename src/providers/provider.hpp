@@ -0,0 +1,47 @@
+#pragma once
+#include <functional>
+#include <string>
+#include <vector>
+#include "core/errors/agent_errors.hpp"
+#include "protocol/event_contract.hpp"
+#include "protocol/message_contract.hpp"
+#include "protocol/tool_contract.hpp"
+
+namespace agent::providers {
+
+    // Sampling knobs that are forwarded to the vendor API
+    struct ModelParams {
+        std::string model;
+        double temperature = 0.0;
+        int max_output_tokens = 4096;
+    };
+
+    // Everything a provider needs to produce the next assistant message
+    struct CompletionRequest {
+        std::vector<protocol::Message> messages;
+        std::vector<protocol::ToolSchema> tools;
+        ModelParams params;
+    };
+
+    // The fully assembled assistant message plus why generation stopped
+    struct CompletionResponse {
+        protocol::Message message;
+        protocol::StopReason stop_reason;
+    };
+
+    // Receives MessageDeltaEvent / ToolCallDeltaEvent while the model is still generating
+    using EventSink = std::function<void(const protocol::AgentEvent&)>;
+
+    // The adapter edge from the ADR: every vendor (OpenAI, Anthropic, a mock...)
+    // implements this and translates its wire format into our protocol structs.
+    class Provider {
+    public:
+        virtual ~Provider() = default;
+
+        // Streams deltas into on_event and returns the final message.
+        // Transport and API failures come back as ErrorCategory::Provider.
+        virtual core::errors::Result<CompletionResponse> complete(
+            const CompletionRequest& request, const EventSink& on_event) = 0;
+    };
+
+} // namespace agent::providers
@@ -0,0 +1,213 @@
+#include "providers/request_scheduler.hpp"
+#include <algorithm>
+#include <cctype>
+#include <string_view>
+
+namespace agent::providers {
+
+    namespace {
+
+        constexpr std::size_t kMaxSessionTags = 1024;
+
+        std::size_t class_of(Priority priority) {
+            return priority == Priority::Interactive ? 0 : 1;
+        }
+
+        // True if the message carries `code` as an HTTP status: the whole
+        // number, right after "HTTP" or "status" ("HTTP 429", "HTTP/1.1 429",
+        // "status: 429", "status_code=429"), so ids and sizes that merely
+        // contain the digits do not match
+        bool has_status(std::string_view message, std::string_view code) {
+            auto digit = [](char c) { return std::isdigit(static_cast<unsigned char>(c)) != 0; };
+            for (auto at = message.find(code); at != std::string_view::npos;
+                 at = message.find(code, at + 1)) {
+                std::size_t end = at + code.size();
+                if ((at > 0 && digit(message[at - 1])) ||
+                    (end < message.size() && digit(message[end]))) {
+                    continue;
+                }
+                std::string_view before = message.substr(0, at);
+                before = before.substr(0, before.find_last_not_of(" :=") + 1);
+                // "HTTP/1.1": step over the protocol version
+                auto version = before.find_last_not_of("0123456789.");
+                if (version != std::string_view::npos && version + 1 < before.size() &&
+                    before[version] == '/') {
+                    before = before.substr(0, version);
+                }
+                for (std::string_view label : {"http", "status", "status code", "status_code"}) {
+                    if (before.size() >= label.size() &&
+                        before.substr(before.size() - label.size()) == label) {
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        // Vendors say 429 in different words
+        bool rate_limited(const core::errors::AgentError& error) {
+            if (error.category != core::errors::ErrorCategory::Provider) return false;
+            std::string message = error.message;
+            std::transform(message.begin(), message.end(), message.begin(),
+                           [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            if (has_status(message, "429")) return true;
+            for (const char* marker : {"rate limit", "rate_limit", "too many requests"}) {
+                if (message.find(marker) != std::string::npos) return true;
+            }
+            return false;
+        }
+
+    } // namespace
+
+    // --- RequestScheduler ---
+
+    RequestScheduler::RequestScheduler(RateLimits limits) : refilled_(Clock::now()) {
+        auto setup = [&](Bucket& bucket, double per_minute) {
+            if (per_minute <= 0.0) return;
+            bucket.per_second = per_minute / 60.0;
+            bucket.capacity = std::max(bucket.per_second * limits.burst_seconds, 1.0);
+            bucket.level = bucket.capacity;
+        };
+        setup(requests_, limits.requests_per_minute);
+        setup(tokens_, limits.tokens_per_minute);
+    }
+
+    void RequestScheduler::acquire(const std::string& session, Priority priority,
+                                   std::size_t tokens) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        auto arrived = Clock::now();
+        std::size_t cls = class_of(priority);
+
+        // 1. Start-time fair queueing: a session's next request starts where
+        // its last one finished, or now (in virtual time) if it has been idle
+        double& finish = finish_[cls][session];
+        double start = std::max(virtual_time_[cls], finish);
+        finish = start + static_cast<double>(tokens) + 1.0;  // Tiny requests still cost
+        auto key = std::make_pair(start, arrivals_++);
+        queues_[cls].emplace(key, tokens);
+        ++stats_.queued;
+
+        // 2. Wait to reach the head, then for the buckets to hold enough
+        bool waited = false;
+        while (true) {
+            if (head_locked()->first.second == key.second) {
+                refill_locked();
+                auto wait = wait_locked(tokens);
+                if (wait <= Clock::duration::zero()) break;
+                changed_.wait_for(lock, wait);
+            } else {
+                changed_.wait(lock);
+            }
+            waited = true;
+        }
+
+        // 3. Take the quota; a request larger than the bucket leaves it in debt
+        queues_[cls].erase(key);
+        virtual_time_[cls] = start;
+        if (requests_.capacity > 0.0) requests_.level -= 1.0;
+        if (tokens_.capacity > 0.0) tokens_.level -= static_cast<double>(tokens);
+        if (finish_[cls].size() > kMaxSessionTags) {
+            // Sessions whose tags virtual time has passed start from it anyway
+            std::erase_if(finish_[cls], [&](const auto& tag) { return tag.second <= start; });
+        }
+
+        --stats_.queued;
+        ++stats_.admitted;
+        if (waited) ++stats_.delayed;
+        stats_.wait_ms += std::chrono::duration<double, std::milli>(Clock::now() - arrived).count();
+        stats_.tokens += tokens;
+        lock.unlock();
+        changed_.notify_all();  // The next request is now at the head
+    }
+
+    void RequestScheduler::settle(std::size_t charged, std::size_t used) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            refill_locked();
+            if (tokens_.capacity > 0.0) {
+                double refund = static_cast<double>(charged) - static_cast<double>(used);
+                tokens_.level = std::min(tokens_.capacity, tokens_.level + refund);
+            }
+            stats_.tokens += used;
+            stats_.tokens -= std::min(charged, stats_.tokens);
+        }
+        changed_.notify_all();
+    }
+
+    void RequestScheduler::throttled() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        refill_locked();
+        requests_.level = std::min(requests_.level, 0.0);
+        tokens_.level = std::min(tokens_.level, 0.0);
+        ++stats_.throttled;
+    }
+
+    SchedulerStats RequestScheduler::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    void RequestScheduler::refill_locked() {
+        auto now = Clock::now();
+        double seconds = std::chrono::duration<double>(now - refilled_).count();
+        refilled_ = now;
+        for (Bucket* bucket : {&requests_, &tokens_}) {
+            if (bucket->capacity <= 0.0) continue;
+            double level = bucket->level + seconds * bucket->per_second;
+            bucket->level = std::min(bucket->capacity, level);
+        }
+    }
+
+    const RequestScheduler::Queue::value_type* RequestScheduler::head_locked() const {
+        for (const auto& queue : queues_) {
+            if (!queue.empty()) return &*queue.begin();
+        }
+        return nullptr;
+    }
+
+    RequestScheduler::Clock::duration RequestScheduler::wait_locked(std::size_t tokens) const {
+        double seconds = 0.0;
+        auto need = [&](const Bucket& bucket, double amount) {
+            if (bucket.capacity <= 0.0) return;
+            double target = std::min(amount, bucket.capacity);
+            if (bucket.level < target) {
+                seconds = std::max(seconds, (target - bucket.level) / bucket.per_second);
+            }
+        };
+        need(requests_, 1.0);
+        need(tokens_, static_cast<double>(tokens));
+        return std::chrono::ceil<Clock::duration>(std::chrono::duration<double>(seconds));
+    }
+
+    // --- ScheduledProvider ---
+
+    ScheduledProvider::ScheduledProvider(Provider& upstream, RequestScheduler& scheduler,
+                                         core::context::TokenEstimator& estimator,
+                                         std::string session, Priority priority)
+        : upstream_(upstream), scheduler_(scheduler), estimator_(estimator),
+          session_(std::move(session)), priority_(priority) {}
+
+    core::errors::Result<CompletionResponse> ScheduledProvider::complete(
+        const CompletionRequest& request, const EventSink& on_event) {
+        auto charge =
+            estimator_.charge(request.messages, request.tools, request.params.max_output_tokens);
+        scheduler_.acquire(session_, priority_, charge.reserved);
+
+        auto response = upstream_.complete(request, on_event);
+        // Rejected requests do not count against the quota
+        std::size_t used = 0;
+        if (!core::errors::is_error(response)) {
+            used = estimator_.used(charge, core::errors::get_value(response).message);
+        }
+        scheduler_.settle(charge.reserved, used);
+        if (core::errors::is_error(response) && rate_limited(core::errors::get_error(response))) {
+            scheduler_.throttled();
+        }
+        return response;
+    }
+
+    std::size_t ScheduledProvider::estimate(const CompletionRequest& request) {
+        return estimator_.prompt(request.messages, request.tools);
+    }
+
+} // namespace agent::providers
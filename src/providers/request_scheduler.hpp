@@ -0,0 +1,119 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "core/context/token_estimator.hpp"
+#include "core/errors/agent_errors.hpp"
+#include "providers/provider.hpp"
+
+namespace agent::providers {
+
+    // Interactive requests (a user is watching) always go before background ones
+    enum class Priority { Interactive, Background };
+
+    struct RateLimits {
+        double requests_per_minute = 0.0;  // 0: no limit
+        double tokens_per_minute = 0.0;    // Prompt plus output; 0: no limit
+        double burst_seconds = 60.0;       // Bucket size, as that many seconds of quota
+    };
+
+    struct SchedulerStats {
+        std::size_t admitted = 0;
+        std::size_t delayed = 0;     // Requests that had to wait for quota or their turn
+        std::size_t throttled = 0;   // Rate-limit errors seen upstream despite all this
+        double wait_ms = 0.0;        // Total time requests spent waiting
+        std::size_t tokens = 0;      // Charged, after settling
+        std::size_t queued = 0;      // Waiting right now
+    };
+
+    // The one gate every outgoing provider request passes through, shared
+    // by all sessions and sub-agents of a process.
+    //
+    // Two token buckets, one for requests and one for tokens, refill at the
+    // per-minute quotas, so we send as fast as the quota allows and no
+    // faster; the provider never has to throttle us. Each request is
+    // charged its estimated tokens up front (a provider counts the output
+    // allowance against the quota too) and settle() returns what it did
+    // not use.
+    //
+    // Waiting requests are served interactive class first, and within a
+    // class by start-time fair queueing over tokens: a session sending
+    // large prompts cannot starve one sending small ones. A request larger
+    // than the bucket is sent once the bucket is full, leaving it in debt.
+    class RequestScheduler {
+    public:
+        explicit RequestScheduler(RateLimits limits);
+
+        RequestScheduler(const RequestScheduler&) = delete;
+        RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+        // Blocks until this request may be sent
+        void acquire(const std::string& session, Priority priority, std::size_t tokens);
+
+        // Once the reply is in: corrects the up-front charge to what was used
+        void settle(std::size_t charged, std::size_t used);
+
+        // The provider throttled us anyway (another client shares the key):
+        // empties both buckets so that sending resumes at the refill rate
+        void throttled();
+
+        SchedulerStats stats() const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Bucket {
+            double capacity = 0.0;  // 0: unlimited
+            double per_second = 0.0;
+            double level = 0.0;
+        };
+        // (start tag, arrival) -> tokens, so the head is the next one due
+        using Queue = std::map<std::pair<double, std::uint64_t>, std::size_t>;
+
+        mutable std::mutex mutex_;
+        std::condition_variable changed_;
+        Bucket requests_;
+        Bucket tokens_;
+        Clock::time_point refilled_;
+        Queue queues_[2];                      // By Priority
+        double virtual_time_[2] = {0.0, 0.0};  // Start tag of the last request admitted
+        std::unordered_map<std::string, double> finish_[2];  // Session -> its last finish tag
+        std::uint64_t arrivals_ = 0;
+        SchedulerStats stats_;
+
+        void refill_locked();
+        const Queue::value_type* head_locked() const;
+        Clock::duration wait_locked(std::size_t tokens) const;  // Zero once the request fits
+    };
+
+    // A Provider decorator that sends every request through a shared
+    // RequestScheduler. Prompt tokens are estimated through the shared
+    // TokenEstimator, whose cache means each turn only tokenizes what is
+    // new; safe to share between threads, like the scheduler.
+    class ScheduledProvider : public Provider {
+    public:
+        ScheduledProvider(Provider& upstream, RequestScheduler& scheduler,
+                          core::context::TokenEstimator& estimator, std::string session,
+                          Priority priority = Priority::Interactive);
+
+        core::errors::Result<CompletionResponse> complete(const CompletionRequest& request,
+                                                          const EventSink& on_event) override;
+
+        // Prompt tokens of the request: messages and tool schemas
+        std::size_t estimate(const CompletionRequest& request);
+
+    private:
+        Provider& upstream_;
+        RequestScheduler& scheduler_;
+        core::context::TokenEstimator& estimator_;
+        std::string session_;
+        Priority priority_;
+    };
+
+} // namespace agent::providers
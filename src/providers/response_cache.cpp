@@ -0,0 +1,313 @@
+#include "providers/response_cache.hpp"
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "core/hash/stable_hash.hpp"
+#include "core/logging/logger.hpp"
+#include "providers/canonical_request.hpp"
+
+namespace agent::providers {
+
+    using core::errors::AgentError;
+    using core::errors::ErrorCategory;
+
+    namespace {
+
+        constexpr int kFormatVersion = 2;  // 2: every event carries its "type"
+
+        struct RecordedEvent {
+            double offset_ms;
+            protocol::AgentEvent event;
+        };
+
+        // Every event type is stored, tagged with its kind, so that whatever
+        // the upstream streamed can be replayed
+        nlohmann::json event_to_json(const RecordedEvent& recorded) {
+            nlohmann::json json;
+            json["t"] = recorded.offset_ms;
+            const auto& event = recorded.event;
+            if (const auto* text = std::get_if<protocol::MessageDeltaEvent>(&event)) {
+                json["type"] = "text";
+                json["text"] = text->delta_text;
+            } else if (const auto* call = std::get_if<protocol::ToolCallDeltaEvent>(&event)) {
+                json["type"] = "tool_call";
+                json["index"] = call->index;
+                json["id"] = call->id;
+                json["name"] = call->name;
+                json["arguments"] = call->arguments_delta;
+            } else if (const auto* start = std::get_if<protocol::AgentStartEvent>(&event)) {
+                json["type"] = "agent_start";
+                json["run_id"] = start->run_id;
+            } else if (std::holds_alternative<protocol::TurnStartEvent>(event)) {
+                json["type"] = "turn_start";
+            } else if (const auto* broken = std::get_if<protocol::PrefixCacheBreakEvent>(&event)) {
+                json["type"] = "prefix_cache_break";
+                json["header_changed"] = broken->header_changed;
+                json["message_index"] = broken->message_index;
+            } else if (const auto* compacted =
+                           std::get_if<protocol::ContextCompactedEvent>(&event)) {
+                json["type"] = "context_compacted";
+                json["tokens_before"] = compacted->tokens_before;
+                json["tokens_after"] = compacted->tokens_after;
+            } else if (const auto* tool = std::get_if<protocol::ToolExecutionStartEvent>(&event)) {
+                json["type"] = "tool_start";
+                json["name"] = tool->tool_name;
+            } else if (const auto* ended = std::get_if<protocol::ToolExecutionEndEvent>(&event)) {
+                json["type"] = "tool_end";
+                json["success"] = ended->success;
+            } else if (const auto* end = std::get_if<protocol::AgentEndEvent>(&event)) {
+                json["type"] = "agent_end";
+                json["reason"] = to_string(end->reason);
+            }
+            return json;
+        }
+
+        // Absent or wrong-typed fields, or an unknown type, make the whole
+        // recording unreadable
+        std::optional<RecordedEvent> event_from_json(const nlohmann::json& json) {
+            if (!json.is_object()) return std::nullopt;
+            auto offset = json.find("t");
+            if (offset == json.end() || !offset->is_number()) return std::nullopt;
+            auto string = [&](const char* key) -> std::optional<std::string> {
+                auto it = json.find(key);
+                if (it == json.end() || !it->is_string()) return std::nullopt;
+                return it->get<std::string>();
+            };
+            auto count = [&](const char* key) -> std::optional<std::size_t> {
+                auto it = json.find(key);
+                if (it == json.end() || !it->is_number_unsigned()) return std::nullopt;
+                return it->get<std::size_t>();
+            };
+            auto flag = [&](const char* key) -> std::optional<bool> {
+                auto it = json.find(key);
+                if (it == json.end() || !it->is_boolean()) return std::nullopt;
+                return it->get<bool>();
+            };
+            auto type = string("type");
+            if (!type) return std::nullopt;
+
+            double offset_ms = offset->get<double>();
+            auto recorded = [&](protocol::AgentEvent event) {
+                return std::optional<RecordedEvent>{RecordedEvent{offset_ms, std::move(event)}};
+            };
+            if (*type == "text") {
+                auto text = string("text");
+                if (!text) return std::nullopt;
+                return recorded(protocol::MessageDeltaEvent{std::move(*text)});
+            }
+            if (*type == "tool_call") {
+                auto index = count("index");
+                auto id = string("id");
+                auto name = string("name");
+                auto arguments = string("arguments");
+                if (!index || !id || !name || !arguments) return std::nullopt;
+                return recorded(protocol::ToolCallDeltaEvent{*index, std::move(*id),
+                                                             std::move(*name),
+                                                             std::move(*arguments)});
+            }
+            if (*type == "agent_start") {
+                auto run_id = string("run_id");
+                if (!run_id) return std::nullopt;
+                return recorded(protocol::AgentStartEvent{std::move(*run_id)});
+            }
+            if (*type == "turn_start") return recorded(protocol::TurnStartEvent{});
+            if (*type == "prefix_cache_break") {
+                auto header_changed = flag("header_changed");
+                auto message_index = count("message_index");
+                if (!header_changed || !message_index) return std::nullopt;
+                return recorded(protocol::PrefixCacheBreakEvent{*header_changed, *message_index});
+            }
+            if (*type == "context_compacted") {
+                auto before = count("tokens_before");
+                auto after = count("tokens_after");
+                if (!before || !after) return std::nullopt;
+                return recorded(protocol::ContextCompactedEvent{*before, *after});
+            }
+            if (*type == "tool_start") {
+                auto name = string("name");
+                if (!name) return std::nullopt;
+                return recorded(protocol::ToolExecutionStartEvent{std::move(*name)});
+            }
+            if (*type == "tool_end") {
+                auto success = flag("success");
+                if (!success) return std::nullopt;
+                return recorded(protocol::ToolExecutionEndEvent{*success});
+            }
+            if (*type == "agent_end") {
+                auto name = string("reason");
+                if (!name) return std::nullopt;
+                auto reason = stop_reason_from_string(*name);
+                if (core::errors::is_error(reason)) return std::nullopt;
+                return recorded(protocol::AgentEndEvent{core::errors::get_value(reason)});
+            }
+            return std::nullopt;
+        }
+
+        struct Recording {
+            protocol::Message message;
+            protocol::StopReason stop_reason;
+            std::vector<RecordedEvent> events;
+        };
+
+        // A recording for exactly this canonical request, or nullopt for a
+        // different request (a hash collision), another format version, or
+        // a corrupt file; all of those are misses
+        std::optional<Recording> read_recording(const std::string& contents,
+                                                const std::string& canonical) {
+            auto json = nlohmann::json::parse(contents, nullptr, false);
+            if (json.is_discarded() || !json.is_object()) return std::nullopt;
+            auto version = json.find("version");
+            auto request = json.find("request");
+            auto reason_name = json.find("stop_reason");
+            auto message = json.find("message");
+            auto events = json.find("events");
+            if (version == json.end() || !version->is_number_integer() ||
+                version->get<std::int64_t>() != kFormatVersion || request == json.end() ||
+                !request->is_string() || request->get_ref<const std::string&>() != canonical ||
+                reason_name == json.end() || !reason_name->is_string() || message == json.end() ||
+                events == json.end() || !events->is_array()) {
+                return std::nullopt;
+            }
+
+            auto parsed = message_from_json(*message);
+            auto reason = stop_reason_from_string(reason_name->get<std::string>());
+            if (core::errors::is_error(parsed) || core::errors::is_error(reason)) {
+                return std::nullopt;
+            }
+            Recording recording{std::move(std::get<protocol::Message>(parsed)),
+                                core::errors::get_value(reason), {}};
+            recording.events.reserve(events->size());
+            for (const auto& item : *events) {
+                auto event = event_from_json(item);
+                if (!event) return std::nullopt;
+                recording.events.push_back(std::move(*event));
+            }
+            return recording;
+        }
+
+        // Writes to a temporary sibling and renames it into place, so a reader
+        // never sees a half-written recording.
+        core::errors::Status write_atomically(const std::string& path, const std::string& bytes) {
+            static std::atomic<unsigned> counter{0};
+            std::string temp = path + ".tmp." + std::to_string(::getpid()) + "." +
+                               std::to_string(counter++);
+            {
+                std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+                if (!out) return AgentError{ErrorCategory::Internal, "Cannot write " + temp};
+                out << bytes;
+                if (!out.flush()) return AgentError{ErrorCategory::Internal, "Short write " + temp};
+            }
+            std::error_code ec;
+            std::filesystem::rename(temp, path, ec);
+            if (ec) {
+                std::filesystem::remove(temp, ec);
+                return AgentError{ErrorCategory::Internal, "Cannot rename into " + path};
+            }
+            return std::monostate{};
+        }
+
+    } // namespace
+
+    CachingProvider::CachingProvider(Provider& upstream, ResponseCacheOptions options)
+        : upstream_(upstream), options_(std::move(options)) {
+        std::error_code ec;
+        std::filesystem::create_directories(options_.directory, ec);
+    }
+
+    void CachingProvider::count(std::size_t ResponseCacheStats::*field) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++(stats_.*field);
+    }
+
+    ResponseCacheStats CachingProvider::stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    std::string CachingProvider::path_for(const CompletionRequest& request) const {
+        return options_.directory + "/" + core::hash::to_hex(request_key(request)) + ".json";
+    }
+
+    core::errors::Result<CompletionResponse> CachingProvider::complete(
+        const CompletionRequest& request, const EventSink& on_event) {
+        std::string canonical = serialize_canonical(request);
+        std::string path =
+            options_.directory + "/" + core::hash::to_hex(core::hash::stable_hash(canonical)) +
+            ".json";
+
+        // 1. Hit: replay the recording. The stored canonical request must match
+        //    exactly, so a 64-bit hash collision degrades to a miss.
+        std::ifstream in(path, std::ios::binary);
+        if (in) {
+            std::stringstream contents;
+            contents << in.rdbuf();
+            auto recording = read_recording(contents.str(), canonical);
+            if (recording) {
+                count(&ResponseCacheStats::hits);
+
+                double divisor = 0.0;
+                if (options_.timing == ReplayTiming::Original) divisor = 1.0;
+                if (options_.timing == ReplayTiming::Accelerated) divisor = options_.speedup;
+
+                auto start = std::chrono::steady_clock::now();
+                for (const auto& recorded : recording->events) {
+                    if (divisor > 0.0) {
+                        std::chrono::duration<double, std::milli> due(recorded.offset_ms /
+                                                                      divisor);
+                        std::this_thread::sleep_until(
+                            start +
+                            std::chrono::duration_cast<std::chrono::steady_clock::duration>(due));
+                    }
+                    on_event(recorded.event);
+                }
+                return CompletionResponse{std::move(recording->message), recording->stop_reason};
+            }
+            LOG_WARN("Ignoring unreadable response cache entry: " + path);
+        }
+
+        // 2. Miss: call upstream while recording every event with its timestamp
+        count(&ResponseCacheStats::misses);
+        if (options_.offline) {
+            return AgentError{ErrorCategory::Provider,
+                              "Response cache miss in offline mode: " + path};
+        }
+
+        std::vector<RecordedEvent> recorded;
+        auto start = std::chrono::steady_clock::now();
+        auto response = upstream_.complete(request, [&](const protocol::AgentEvent& event) {
+            std::chrono::duration<double, std::milli> offset =
+                std::chrono::steady_clock::now() - start;
+            recorded.push_back(RecordedEvent{offset.count(), event});
+            on_event(event);
+        });
+        // Failures are not cached: a retry should really retry
+        if (core::errors::is_error(response)) return response;
+
+        const auto& completion = core::errors::get_value(response);
+        nlohmann::json json;
+        json["version"] = kFormatVersion;
+        json["request"] = canonical;
+        json["stop_reason"] = to_string(completion.stop_reason);
+        json["message"] = message_to_json(completion.message, false);
+        json["events"] = nlohmann::json::array();
+        for (const auto& event : recorded) json["events"].push_back(event_to_json(event));
+
+        auto written = write_atomically(
+            path, json.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace));
+        if (core::errors::is_error(written)) {
+            LOG_WARN(core::errors::get_error(written).message);
+        } else {
+            count(&ResponseCacheStats::writes);
+        }
+        return response;
+    }
+
+} // namespace agent::providers
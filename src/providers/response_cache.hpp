@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include "core/errors/agent_errors.hpp"
+#include "providers/provider.hpp"
+
+namespace agent::providers {
+
+    enum class ReplayTiming {
+        Instant,      // Emit every recorded delta immediately
+        Original,     // Reproduce the recorded gaps between deltas
+        Accelerated   // Recorded gaps divided by `speedup`
+    };
+
+    struct ResponseCacheOptions {
+        std::string directory;             // One <key>.json file per cached request
+        ReplayTiming timing = ReplayTiming::Instant;
+        double speedup = 10.0;             // Only used by ReplayTiming::Accelerated
+        bool offline = false;              // Misses fail instead of calling upstream
+    };
+
+    struct ResponseCacheStats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t writes = 0;
+    };
+
+    // A Provider decorator that records and replays whole completions.
+    //
+    // The key is the stable hash of the canonical request (history, tool
+    // schemas, model parameters). A hit replays the recorded delta stream,
+    // in order and byte-for-byte, so a replayed session is deterministic.
+    class CachingProvider : public Provider {
+    public:
+        CachingProvider(Provider& upstream, ResponseCacheOptions options);
+
+        core::errors::Result<CompletionResponse> complete(const CompletionRequest& request,
+                                                          const EventSink& on_event) override;
+
+        ResponseCacheStats stats() const;
+
+        // Where the recording for this request lives (whether or not it exists)
+        std::string path_for(const CompletionRequest& request) const;
+
+    private:
+        Provider& upstream_;
+        ResponseCacheOptions options_;
+        mutable std::mutex mutex_;
+        ResponseCacheStats stats_;
+
+        void count(std::size_t ResponseCacheStats::*field);
+    };
+
+} // namespace agent::providers
@@ -0,0 +1,163 @@
+#include "providers/sse/delta_extractor.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace agent::providers::sse {
+
+    namespace {
+
+        bool is_space(char c) { return c == ' ' || c == '\n' || c == '\r' || c == '\t'; }
+
+        // Given the index of an opening quote, returns the index of the closing one
+        std::size_t string_end(std::string_view json, std::size_t open) {
+            std::size_t pos = open + 1;
+            while (pos < json.size()) {
+                const void* hit = std::memchr(json.data() + pos, '"', json.size() - pos);
+                if (hit == nullptr) return std::string_view::npos;
+                std::size_t quote = static_cast<const char*>(hit) - json.data();
+
+                // An odd run of backslashes means this quote is escaped
+                std::size_t slashes = 0;
+                while (quote - slashes > open + 1 && json[quote - slashes - 1] == '\\') ++slashes;
+                if (slashes % 2 == 0) return quote;
+                pos = quote + 1;
+            }
+            return std::string_view::npos;
+        }
+
+        int hex_value(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        }
+
+        bool read_hex4(std::string_view raw, std::size_t pos, std::uint32_t& out) {
+            if (pos + 4 > raw.size()) return false;
+            out = 0;
+            for (std::size_t i = 0; i < 4; ++i) {
+                int v = hex_value(raw[pos + i]);
+                if (v < 0) return false;
+                out = (out << 4) | static_cast<std::uint32_t>(v);
+            }
+            return true;
+        }
+
+        void append_utf8(std::uint32_t cp, std::string& out) {
+            if (cp < 0x80) {
+                out += static_cast<char>(cp);
+            } else if (cp < 0x800) {
+                out += static_cast<char>(0xC0 | (cp >> 6));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else if (cp < 0x10000) {
+                out += static_cast<char>(0xE0 | (cp >> 12));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            } else {
+                out += static_cast<char>(0xF0 | (cp >> 18));
+                out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+                out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                out += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+        }
+
+    } // namespace
+
+    std::optional<std::string_view> find_string_field(std::string_view json, std::string_view key) {
+        std::size_t pos = 0;
+        while (pos < json.size()) {
+            const void* hit = std::memchr(json.data() + pos, '"', json.size() - pos);
+            if (hit == nullptr) return std::nullopt;
+            std::size_t open = static_cast<const char*>(hit) - json.data();
+            std::size_t close = string_end(json, open);
+            if (close == std::string_view::npos) return std::nullopt;
+
+            // A string followed by ':' is a key; anything else was a value
+            std::size_t after = close + 1;
+            while (after < json.size() && is_space(json[after])) ++after;
+            if (after >= json.size() || json[after] != ':') {
+                pos = close + 1;
+                continue;
+            }
+
+            std::string_view name = json.substr(open + 1, close - open - 1);
+            std::size_t value = after + 1;
+            while (value < json.size() && is_space(json[value])) ++value;
+
+            if (name == key && value < json.size() && json[value] == '"') {
+                std::size_t value_end = string_end(json, value);
+                if (value_end == std::string_view::npos) return std::nullopt;
+                return json.substr(value + 1, value_end - value - 1);
+            }
+            pos = value;
+        }
+        return std::nullopt;
+    }
+
+    bool unescape_json_string(std::string_view raw, std::string& out) {
+        // Fast path: most deltas contain no escapes at all
+        std::size_t slash = raw.find('\\');
+        if (slash == std::string_view::npos) {
+            out.append(raw.data(), raw.size());
+            return true;
+        }
+
+        out.reserve(out.size() + raw.size());
+        out.append(raw.data(), slash);
+        for (std::size_t i = slash; i < raw.size(); ++i) {
+            char c = raw[i];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (++i >= raw.size()) return false;
+            switch (raw[i]) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    std::uint32_t cp = 0;
+                    if (!read_hex4(raw, i + 1, cp)) return false;
+                    i += 4;
+                    // Surrogate pair: "\ud83d\ude00" is one code point
+                    if (cp >= 0xD800 && cp <= 0xDBFF && i + 6 < raw.size() &&
+                        raw[i + 1] == '\\' && raw[i + 2] == 'u') {
+                        std::uint32_t low = 0;
+                        if (read_hex4(raw, i + 3, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            i += 6;
+                        }
+                    }
+                    append_utf8(cp, out);
+                    break;
+                }
+                default: return false;
+            }
+        }
+        return true;
+    }
+
+    bool DeltaExtractor::on_event(const SseEvent& event, const EventSink& on_delta) {
+        if (event.data == "[DONE]") {
+            done_ = true;
+            return false;
+        }
+
+        auto raw = find_string_field(event.data, field_);
+        if (!raw || raw->empty()) return false;
+
+        protocol::MessageDeltaEvent delta;
+        if (!unescape_json_string(*raw, delta.delta_text)) {
+            ++malformed_;
+            return false;
+        }
+        on_delta(delta);
+        return true;
+    }
+
+} // namespace agent::providers::sse
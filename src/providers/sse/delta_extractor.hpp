@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+#include "providers/provider.hpp"
+#include "providers/sse/sse_parser.hpp"
+
+namespace agent::providers::sse {
+
+    // Finds the first string-valued member named `key` anywhere in a JSON
+    // document and returns its raw (still escaped) contents. It is a single
+    // forward scan that only understands strings and key positions, which is
+    // all we need to pull delta text out of a streaming chunk without a DOM.
+    std::optional<std::string_view> find_string_field(std::string_view json, std::string_view key);
+
+    // Appends the decoded form of a raw JSON string body to out.
+    // Returns false on a malformed escape.
+    bool unescape_json_string(std::string_view raw, std::string& out);
+
+    // Turns SSE events from a streaming completion into MessageDeltaEvents.
+    // The field is "content" for OpenAI-style chunks and "text" for
+    // Anthropic-style content_block_delta events.
+    class DeltaExtractor {
+    public:
+        explicit DeltaExtractor(std::string field) : field_(std::move(field)) {}
+
+        // Returns true if the event carried delta text
+        bool on_event(const SseEvent& event, const EventSink& on_delta);
+
+        // True once the "[DONE]" sentinel has been seen
+        bool done() const { return done_; }
+        std::size_t malformed_events() const { return malformed_; }
+
+    private:
+        std::string field_;
+        bool done_ = false;
+        std::size_t malformed_ = 0;
+    };
+
+} // namespace agent::providers::sse
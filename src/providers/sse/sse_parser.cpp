@@ -0,0 +1,145 @@
+#include "providers/sse/sse_parser.hpp"
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace agent::providers::sse {
+
+    std::size_t find_line_end(const char* data, std::size_t size) {
+        std::size_t i = 0;
+#if defined(__SSE2__)
+        // 16 bytes per step: compare against '\n' and '\r' and take the first hit
+        const __m128i lf = _mm_set1_epi8('\n');
+        const __m128i cr = _mm_set1_epi8('\r');
+        for (; i + 16 <= size; i += 16) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(block, lf), _mm_cmpeq_epi8(block, cr));
+            int mask = _mm_movemask_epi8(hits);
+            if (mask != 0) return i + static_cast<std::size_t>(__builtin_ctz(mask));
+        }
+#endif
+        for (; i < size; ++i) {
+            if (data[i] == '\n' || data[i] == '\r') return i;
+        }
+        return size;
+    }
+
+    void SseParser::own(std::string_view& view, std::string& storage) {
+        if (view.data() == storage.data()) return;
+        storage.assign(view.data(), view.size());
+        view = storage;
+    }
+
+    void SseParser::feed(std::string_view chunk, const SseHandler& on_event) {
+        std::size_t pos = 0;
+        if (skip_lf_ && !chunk.empty() && chunk[0] == '\n') pos = 1;
+        skip_lf_ = false;
+
+        while (pos < chunk.size()) {
+            std::size_t rest = chunk.size() - pos;
+            std::size_t offset = find_line_end(chunk.data() + pos, rest);
+            if (offset == rest) {
+                // No terminator yet: keep the partial line for the next read
+                line_carry_.append(chunk.data() + pos, rest);
+                bytes_carried_ += rest;
+                break;
+            }
+
+            std::size_t end = pos + offset;
+            std::size_t next = end + 1;
+            if (chunk[end] == '\r') {
+                // "\r\n" counts as one terminator, even when split across reads
+                if (next < chunk.size()) {
+                    if (chunk[next] == '\n') ++next;
+                } else {
+                    skip_lf_ = true;
+                }
+            }
+
+            if (line_carry_.empty()) {
+                process_line(chunk.substr(pos, offset), false, on_event);
+            } else {
+                line_carry_.append(chunk.data() + pos, offset);
+                bytes_carried_ += offset;
+                process_line(line_carry_, true, on_event);
+                line_carry_.clear();
+            }
+            pos = next;
+        }
+
+        // The chunk is about to be overwritten by the next read
+        carry_pending_fields();
+    }
+
+    void SseParser::finish(const SseHandler& on_event) {
+        if (!line_carry_.empty()) {
+            process_line(line_carry_, true, on_event);
+            line_carry_.clear();
+        }
+        dispatch(on_event);
+    }
+
+    void SseParser::process_line(std::string_view line, bool line_is_owned,
+                                 const SseHandler& on_event) {
+        if (line.empty()) {
+            dispatch(on_event);
+            return;
+        }
+        if (line[0] == ':') return;  // Comment / keep-alive ping
+
+        std::string_view field = line;
+        std::string_view value;
+        std::size_t colon = line.find(':');
+        if (colon != std::string_view::npos) {
+            field = line.substr(0, colon);
+            value = line.substr(colon + 1);
+            if (!value.empty() && value[0] == ' ') value.remove_prefix(1);
+        }
+
+        if (field == "data") {
+            append_data(value, line_is_owned);
+        } else if (field == "event") {
+            event_ = value;
+            if (line_is_owned) own(event_, owned_event_);
+        } else if (field == "id") {
+            // The last event id outlives the event, so always keep our own copy
+            id_ = value;
+            own(id_, owned_id_);
+        }
+        // "retry" and unknown fields are ignored
+    }
+
+    void SseParser::append_data(std::string_view value, bool value_is_owned) {
+        if (!has_data_) {
+            has_data_ = true;
+            data_ = value;
+            if (value_is_owned) own(data_, owned_data_);
+            return;
+        }
+        // Multi-line data is rare; only then do we build a joined copy
+        own(data_, owned_data_);
+        owned_data_ += '\n';
+        owned_data_.append(value.data(), value.size());
+        data_ = owned_data_;
+    }
+
+    void SseParser::dispatch(const SseHandler& on_event) {
+        if (has_data_) {
+            on_event(SseEvent{event_.empty() ? std::string_view("message") : event_, data_, id_});
+            ++events_dispatched_;
+        }
+        has_data_ = false;
+        data_ = {};
+        event_ = {};
+    }
+
+    void SseParser::carry_pending_fields() {
+        if (has_data_ && data_.data() != owned_data_.data()) {
+            bytes_carried_ += data_.size();
+            own(data_, owned_data_);
+        }
+        if (!event_.empty()) own(event_, owned_event_);
+    }
+
+} // namespace agent::providers::sse
@@ -0,0 +1,65 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+
+namespace agent::providers::sse {
+
+    // One dispatched Server-Sent Event. The views are only valid during the
+    // callback: they point into the caller's read buffer whenever possible.
+    struct SseEvent {
+        std::string_view event;  // "message" when the stream did not name it
+        std::string_view data;
+        std::string_view id;
+    };
+
+    using SseHandler = std::function<void(const SseEvent& event)>;
+
+    // Returns the offset of the first '\r' or '\n' in [data, data + size),
+    // or size if there is none. Uses SSE2 when the target has it.
+    std::size_t find_line_end(const char* data, std::size_t size);
+
+    // Incremental parser for a text/event-stream body.
+    //
+    // feed() is called with each socket read exactly as it arrived. Complete
+    // lines are parsed in place and events are handed out as views into that
+    // chunk. Only an unfinished tail (a partial line, or an event whose blank
+    // line has not arrived yet) is copied, so an event is copied at most once,
+    // and only when it straddles two reads.
+    class SseParser {
+    public:
+        void feed(std::string_view chunk, const SseHandler& on_event);
+
+        // Dispatches a final event that was not followed by a blank line
+        void finish(const SseHandler& on_event);
+
+        std::size_t events_dispatched() const { return events_dispatched_; }
+        std::size_t bytes_carried() const { return bytes_carried_; }
+
+    private:
+        // Partial line left over from the previous chunk
+        std::string line_carry_;
+        bool skip_lf_ = false;  // Previous chunk ended in '\r'; drop a leading '\n'
+
+        // Fields of the event being built. They view either the current chunk
+        // or the owned strings below once they have been carried over.
+        std::string_view data_;
+        std::string_view event_;
+        std::string_view id_;
+        bool has_data_ = false;
+        std::string owned_data_;
+        std::string owned_event_;
+        std::string owned_id_;
+
+        std::size_t events_dispatched_ = 0;
+        std::size_t bytes_carried_ = 0;
+
+        void process_line(std::string_view line, bool line_is_owned, const SseHandler& on_event);
+        void append_data(std::string_view value, bool value_is_owned);
+        void dispatch(const SseHandler& on_event);
+        void carry_pending_fields();
+        static void own(std::string_view& view, std::string& storage);
+    };
+
+} // namespace agent::providers::sse
@@ -0,0 +1,24 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "core/context/bpe_tokenizer.hpp"
+
+namespace agent::testing {
+
+    // One token per byte, so token budgets in tests are plain byte counts
+    inline const core::context::BpeTokenizer& byte_tokenizer() {
+        static const auto tokenizer = [] {
+            std::vector<std::pair<std::string, std::uint32_t>> ranks;
+            for (int byte = 0; byte < 256; ++byte) {
+                ranks.emplace_back(std::string(1, static_cast<char>(byte)), byte);
+            }
+            return std::move(std::get<core::context::BpeTokenizer>(
+                core::context::BpeTokenizer::from_ranks(ranks, "bytes")));
+        }();
+        return tokenizer;
+    }
+
+} // namespace agent::testing
@@ -0,0 +1,169 @@
+#pragma once
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace agent::testing {
+
+    // A tiny stand-in HTTP/1.1 server on 127.0.0.1 for transport tests.
+    // Each accepted connection is served on its own thread; the handler turns
+    // (method, target, body) into a complete raw response.
+    class LocalHttpServer {
+    public:
+        using Handler = std::function<std::string(const std::string& method,
+                                                  const std::string& target,
+                                                  const std::string& body)>;
+
+        // max_requests_per_connection > 0 makes the server silently hang up
+        // after that many requests, like an idle keep-alive timeout would.
+        explicit LocalHttpServer(Handler handler, int max_requests_per_connection = 0)
+            : handler_(std::move(handler)), max_requests_(max_requests_per_connection) {
+            listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            int one = 1;
+            ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            addr.sin_port = 0;
+            ::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+            ::listen(listen_fd_, 64);
+
+            socklen_t len = sizeof(addr);
+            ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+            port_ = ntohs(addr.sin_port);
+
+            acceptor_ = std::thread([this] { accept_loop(); });
+        }
+
+        ~LocalHttpServer() {
+            stop_ = true;
+            acceptor_.join();
+            ::close(listen_fd_);
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& worker : workers_) worker.join();
+        }
+
+        std::uint16_t port() const { return port_; }
+        int connections_accepted() const { return accepted_.load(); }
+        int requests_served() const { return served_.load(); }
+
+        // Helpers for building raw responses
+        static std::string ok(const std::string& body, const std::string& extra_headers = "") {
+            return "HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(body.size()) +
+                   "\r\n" + extra_headers + "\r\n" + body;
+        }
+
+        static std::string chunked(const std::vector<std::string>& chunks) {
+            std::string out = "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+            char size[32];
+            for (const auto& chunk : chunks) {
+                std::snprintf(size, sizeof(size), "%zx\r\n", chunk.size());
+                out += size + chunk + "\r\n";
+            }
+            return out + "0\r\n\r\n";
+        }
+
+    private:
+        Handler handler_;
+        int max_requests_;
+        int listen_fd_ = -1;
+        std::uint16_t port_ = 0;
+        std::atomic<bool> stop_{false};
+        std::atomic<int> accepted_{0};
+        std::atomic<int> served_{0};
+        std::thread acceptor_;
+        std::mutex mutex_;
+        std::vector<std::thread> workers_;
+
+        void accept_loop() {
+            while (!stop_) {
+                pollfd pfd{listen_fd_, POLLIN, 0};
+                if (::poll(&pfd, 1, 20) <= 0) continue;
+                int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+                if (fd < 0) continue;
+                ++accepted_;
+                std::lock_guard<std::mutex> lock(mutex_);
+                workers_.emplace_back([this, fd] { serve(fd); });
+            }
+        }
+
+        // Reads more bytes into `in`, giving up when the server is stopping
+        bool read_more(int fd, std::string& in) {
+            char buf[4096];
+            while (!stop_) {
+                pollfd pfd{fd, POLLIN, 0};
+                if (::poll(&pfd, 1, 20) <= 0) continue;
+                ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+                if (n <= 0) return false;
+                in.append(buf, static_cast<std::size_t>(n));
+                return true;
+            }
+            return false;
+        }
+
+        void serve(int fd) {
+            std::string in;
+            int handled = 0;
+            while (!stop_) {
+                // 1. Head
+                std::size_t head_end;
+                while ((head_end = in.find("\r\n\r\n")) == std::string::npos) {
+                    if (!read_more(fd, in)) {
+                        ::close(fd);
+                        return;
+                    }
+                }
+                std::string head = in.substr(0, head_end);
+                in.erase(0, head_end + 4);
+
+                std::size_t sp1 = head.find(' ');
+                std::size_t sp2 = head.find(' ', sp1 + 1);
+                std::string method = head.substr(0, sp1);
+                std::string target = head.substr(sp1 + 1, sp2 - sp1 - 1);
+
+                // 2. Body (Content-Length only; our client never sends chunked)
+                std::size_t length = 0;
+                std::size_t cl = head.find("Content-Length: ");
+                if (cl != std::string::npos) {
+                    length = std::strtoul(head.c_str() + cl + 16, nullptr, 10);
+                }
+                while (in.size() < length) {
+                    if (!read_more(fd, in)) {
+                        ::close(fd);
+                        return;
+                    }
+                }
+                std::string body = in.substr(0, length);
+                in.erase(0, length);
+
+                // 3. Respond
+                std::string response = handler_(method, target, body);
+                ::send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+                ++served_;
+                ++handled;
+
+                bool close_requested = response.find("Connection: close") != std::string::npos;
+                if (close_requested || (max_requests_ > 0 && handled >= max_requests_)) break;
+            }
+            // Lingering close, as real servers do: closing with pipelined
+            // requests still unread would reset the connection, and a reset
+            // can discard answers the client has not read yet
+            ::shutdown(fd, SHUT_WR);
+            while (read_more(fd, in)) in.clear();
+            ::close(fd);
+        }
+    };
+
+} // namespace agent::testing
@@ -0,0 +1,63 @@
+#pragma once
+#include <unistd.h>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace agent::testing {
+
+    // A scratch directory under the system temp dir, named after the test
+    // and the process so parallel test runs do not share it. Created empty
+    // on construction and removed with everything in it on destruction.
+    class TempWorkspace {
+    public:
+        explicit TempWorkspace(const std::string& name)
+            : path_(std::filesystem::canonical(std::filesystem::temp_directory_path()) /
+                    (name + "_" + std::to_string(::getpid()))) {
+            std::filesystem::remove_all(path_);
+            std::filesystem::create_directories(path_);
+        }
+        ~TempWorkspace() {
+            std::error_code ignored;
+            std::filesystem::remove_all(path_, ignored);
+        }
+
+        TempWorkspace(const TempWorkspace&) = delete;
+        TempWorkspace& operator=(const TempWorkspace&) = delete;
+
+        const std::filesystem::path& path() const { return path_; }
+        std::string string() const { return path_.string(); }
+        std::filesystem::path operator/(const std::filesystem::path& relative) const {
+            return path_ / relative;
+        }
+
+        // Writes bytes to a file relative to the workspace, creating its
+        // directories; returns the file's full path
+        std::string write(const std::string& name, std::string_view bytes = {}) const {
+            auto file = path_ / name;
+            std::filesystem::create_directories(file.parent_path());
+            std::ofstream(file, std::ios::binary).write(bytes.data(),
+                                                        static_cast<std::streamsize>(bytes.size()));
+            return file.string();
+        }
+
+    private:
+        std::filesystem::path path_;
+    };
+
+    // Polls until predicate holds, for changes a watcher thread picks up;
+    // false if it still does not after five seconds
+    template <typename Predicate>
+    bool eventually(Predicate predicate) {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!predicate()) {
+            if (std::chrono::steady_clock::now() > deadline) return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return true;
+    }
+
+} // namespace agent::testing
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "core/diff/line_diff.hpp"
+#include "core/diff/patch.hpp"
+#include "core/fs/file_cache.hpp"
+#include "core/fs/file_transaction.hpp"
+#include "core/tools/apply_patch_tool.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::TempWorkspace;
+
+namespace {
+
+    std::string patched(const std::string& text, const std::string& patch) {
+        auto files = core::diff::parse_patch(patch);
+        EXPECT_FALSE(core::errors::is_error(files));
+        if (core::errors::is_error(files)) return "";
+        auto applied =
+            core::diff::apply_hunks(text, core::errors::get_value(files).front().hunks);
+        if (core::errors::is_error(applied)) {
+            return "error: " + core::errors::get_error(applied).message;
+        }
+        return core::errors::get_value(applied);
+    }
+
+} // namespace
+
+TEST(PatchTest, PlacesHunksByContentNotLineNumbers) {
+    std::string text = "a\nb\nc\nd\ne\nf\ng\n";
+    // The header is off by three lines, and the blank context line lost its space
+    EXPECT_EQ(patched(text, "diff --git a/x b/x\nindex 1..2 100644\n--- a/x\n+++ b/x\n"
+                          "@@ -1,3 +1,3 @@\n d\n-e\n+E\n f\n\n"),
+              "a\nb\nc\nd\nE\nf\ng\n");
+    // Trailing whitespace in the patch is forgiven when nothing matches exactly
+    EXPECT_EQ(patched(text, "--- x\n+++ x\n@@\n a  \n+inserted\n b\n"),
+              "a\ninserted\nb\nc\nd\ne\nf\ng\n");
+    // Adding to a file whose last line has no newline
+    EXPECT_EQ(patched("x\ny", "--- x\n+++ x\n@@ -2 +2,2 @@\n y\n"
+                               "\\ No newline at end of file\n+z\n"),
+              "x\ny\nz\n");
+    EXPECT_EQ(patched(text, "--- x\n+++ x\n@@ -4,2 +4,2 @@\n d\n-q\n+Q\n"),
+              "error: hunk 1 (line 4): line 5 reads \"e\" where the patch has \"q\"");
+
+    auto files = core::diff::parse_patch("--- /dev/null\n+++ b/new.txt\n@@ -0,0 +1 @@\n+hi\n"
+                                         "--- a/old.txt\n+++ /dev/null\n@@ -1 +0,0 @@\n-bye\n");
+    ASSERT_FALSE(core::errors::is_error(files));
+    const auto& parsed = core::errors::get_value(files);
+    ASSERT_EQ(parsed.size(), 2u);
+    EXPECT_TRUE(parsed[0].creates());
+    EXPECT_EQ(parsed[0].new_path, "new.txt");
+    EXPECT_TRUE(parsed[1].deletes());
+    EXPECT_EQ(parsed[1].old_path, "old.txt");
+    EXPECT_TRUE(core::errors::is_error(core::diff::parse_patch("no headers here\n")));
+}
+
+TEST(PatchTest, HeaderCountsKeepDashedLinesInTheHunk) {
+    // Removing "-- x" and adding "++ y" prints lines that look like a file header
+    std::string before = "keep\n-- x\nend\n";
+    std::string after = "keep\n++ y\nend\n";
+    auto diff = core::diff::unified_diff(before, after, "a/f", "b/f");
+    ASSERT_NE(diff.text.find("\n--- x\n+++ y\n"), std::string::npos) << diff.text;
+    EXPECT_EQ(patched(before, diff.text), after);
+
+    // Counts that promise more lines than the hunk has stop at the next file
+    auto files = core::diff::parse_patch("--- a/f\n+++ b/f\n@@ -1,4 +1,4 @@\n x\n-y\n+Y\n"
+                                         "--- a/g\n+++ b/g\n@@ -1,3 +1,3 @@\n p\n-q\n+Q\n");
+    ASSERT_FALSE(core::errors::is_error(files));
+    ASSERT_EQ(core::errors::get_value(files).size(), 2u);
+    EXPECT_EQ(core::errors::get_value(files)[0].hunks.size(), 1u);
+    EXPECT_EQ(core::errors::get_value(files)[0].hunks[0].lines.size(), 3u);
+    EXPECT_EQ(core::errors::get_value(files)[1].new_path, "g");
+    EXPECT_EQ(patched("x\ny\n", "--- a/f\n+++ b/f\n@@ -1,4 +1,4 @@\n x\n-y\n+Y\n"
+                                "--- a/g\n+++ b/g\n@@ -1 +1 @@\n-q\n+Q\n"),
+              "x\nY\n");
+
+    // Without counts the lenient scan still ends the hunk at the next header
+    files = core::diff::parse_patch("--- a/f\n+++ b/f\n@@\n-x\n+y\n"
+                                    "--- a/g\n+++ b/g\n@@\n-p\n+q\n");
+    ASSERT_FALSE(core::errors::is_error(files));
+    EXPECT_EQ(core::errors::get_value(files).size(), 2u);
+}
+
+namespace {
+
+    class ApplyPatchTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            root_.write("src/a.txt", "one\ntwo\nthree\n");
+            root_.write("src/b.txt", "alpha\nbeta\n");
+            root_.write("old.txt", "obsolete\n");
+        }
+
+        std::string read(const std::string& name) {
+            std::ifstream in(root_ / name);
+            std::stringstream text;
+            text << in.rdbuf();
+            return text.str();
+        }
+        bool exists(const std::string& name) { return std::filesystem::exists(root_ / name); }
+
+        // Nothing but the files the test made: no temp files or backups left over
+        std::size_t file_count() {
+            std::size_t count = 0;
+            for (const auto& entry : std::filesystem::recursive_directory_iterator(root_.path())) {
+                count += entry.is_regular_file();
+            }
+            return count;
+        }
+
+        protocol::ToolResult run(const std::string& patch) {
+            core::tools::ApplyPatchTool tool({root_.string(), &cache_, false, false});
+            nlohmann::json args = {{"patch", patch}};
+            return tool.execute({"c1", "apply_patch", args.dump()});
+        }
+
+        TempWorkspace root_{"apply_patch_test"};
+        core::fs::FileCache cache_;
+    };
+
+} // namespace
+
+TEST_F(ApplyPatchTest, AppliesEveryFileTogether) {
+    ASSERT_EQ(core::errors::get_value(cache_.read((root_ / "src/a.txt").string()))->size(), 14u);
+    auto result = run("--- a/src/a.txt\n+++ b/src/a.txt\n"
+                      "@@ -1,3 +1,3 @@\n one\n-two\n+TWO\n three\n"
+                      "--- a/src/b.txt\n+++ b/src/b.txt\n@@ -2 +2,2 @@\n beta\n+gamma\n"
+                      "--- /dev/null\n+++ b/docs/new.md\n@@ -0,0 +1 @@\n+# New\n"
+                      "--- a/old.txt\n+++ /dev/null\n@@ -1 +0,0 @@\n-obsolete\n");
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.output, "Updated src/a.txt (+1 -1)\nUpdated src/b.txt (+1 -0)\n"
+                             "Created docs/new.md (+1 -0)\nDeleted old.txt (+0 -1)\n");
+    EXPECT_EQ(read("src/a.txt"), "one\nTWO\nthree\n");
+    EXPECT_EQ(read("src/b.txt"), "alpha\nbeta\ngamma\n");
+    EXPECT_EQ(read("docs/new.md"), "# New\n");
+    EXPECT_FALSE(exists("old.txt"));
+    EXPECT_EQ(file_count(), 3u);
+    // The cache serves the new content, not the one it held
+    EXPECT_EQ(*core::errors::get_value(cache_.read((root_ / "src/a.txt").string())),
+              "one\nTWO\nthree\n");
+}
+
+TEST_F(ApplyPatchTest, OneBadHunkWritesNothing) {
+    auto result = run("--- a/src/a.txt\n+++ b/src/a.txt\n@@ -1,2 +1,2 @@\n one\n-two\n+TWO\n"
+                      "--- a/src/b.txt\n+++ b/src/b.txt\n@@ -1,2 +1,2 @@\n alpha\n-delta\n+DELTA\n"
+                      "--- a/missing.txt\n+++ b/missing.txt\n@@ -1 +1 @@\n-x\n+y\n"
+                      "--- a/../escape.txt\n+++ b/../escape.txt\n@@ -1 +1 @@\n-x\n+y\n");
+    ASSERT_FALSE(result.success);
+    EXPECT_EQ(result.error_message,
+              "apply_patch: nothing was written; the patch does not apply:\n"
+              "src/b.txt: hunk 1 (line 1): line 2 reads \"beta\" where the patch has \"delta\"\n"
+              "missing.txt: no such file\n"
+              "../escape.txt: outside the workspace");
+    EXPECT_EQ(read("src/a.txt"), "one\ntwo\nthree\n");
+    EXPECT_EQ(file_count(), 3u);
+}
+
+TEST_F(ApplyPatchTest, DeletionMustCoverTheWholeFile) {
+    auto result = run("--- a/src/a.txt\n+++ /dev/null\n@@ -1,2 +0,0 @@\n-one\n-two\n");
+    ASSERT_FALSE(result.success);
+    EXPECT_EQ(result.error_message,
+              "apply_patch: nothing was written; the patch does not apply:\n"
+              "src/a.txt: deletion does not match the whole file");
+    EXPECT_EQ(read("src/a.txt"), "one\ntwo\nthree\n");
+}
+
+TEST_F(ApplyPatchTest, TransactionRefusesFilesChangedSinceRead) {
+    std::string a = (root_ / "src/a.txt").string();
+    std::string b = (root_ / "src/b.txt").string();
+    auto a_stamp = core::fs::stamp(a);
+    auto b_stamp = core::fs::stamp(b);
+    root_.write("src/b.txt", "someone else's edit, longer than before\n");
+
+    core::fs::FileTransaction transaction({false});
+    transaction.write(a, "new a\n", a_stamp);
+    transaction.write(b, "new b\n", b_stamp);
+    transaction.write((root_ / "made/deep/c.txt").string(), "c\n", core::fs::FileStamp{});
+    auto committed = transaction.commit();
+    ASSERT_TRUE(core::errors::is_error(committed));
+    EXPECT_EQ(read("src/a.txt"), "one\ntwo\nthree\n");
+    EXPECT_FALSE(exists("made"));
+    EXPECT_EQ(file_count(), 3u);
+
+    core::fs::FileTransaction retry({true});
+    retry.write(b, "new b\n", core::fs::stamp(b));
+    retry.remove(a, core::fs::stamp(a));
+    ASSERT_FALSE(core::errors::is_error(retry.commit()));
+    EXPECT_EQ(read("src/b.txt"), "new b\n");
+    EXPECT_FALSE(exists("src/a.txt"));
+}
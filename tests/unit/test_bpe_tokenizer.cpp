@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "core/context/bpe_tokenizer.hpp"
+
+using namespace agent;
+using core::context::BpeTokenizer;
+using core::context::PreTokenizer;
+
+namespace {
+
+    // Every byte, then a handful of merges in priority order
+    std::vector<std::pair<std::string, std::uint32_t>> tiny_ranks() {
+        std::vector<std::pair<std::string, std::uint32_t>> ranks;
+        for (int byte = 0; byte < 256; ++byte) {
+            ranks.emplace_back(std::string(1, static_cast<char>(byte)), byte);
+        }
+        std::uint32_t next = 256;
+        for (const char* merged : {"he", "ll", "hell", " w", "or", " wor", " world"}) {
+            ranks.emplace_back(merged, next++);
+        }
+        return ranks;
+    }
+
+    BpeTokenizer tiny() {
+        auto tokenizer = BpeTokenizer::from_ranks(tiny_ranks(), "tiny");
+        EXPECT_FALSE(core::errors::is_error(tokenizer));
+        return std::move(std::get<BpeTokenizer>(tokenizer));
+    }
+
+    std::vector<std::string> split(std::string_view text) {
+        std::vector<std::string> pieces;
+        PreTokenizer pre(text);
+        std::string_view piece;
+        while (pre.next(piece)) pieces.emplace_back(piece);
+        return pieces;
+    }
+
+} // namespace
+
+TEST(BpeTokenizerTest, PreTokenizesLikeCl100k) {
+    EXPECT_EQ(split("Hello world's  123456 !!\n\n  x"),
+              (std::vector<std::string>{"Hello", " world", "'s", " ", " ", "123", "456", " !!\n\n",
+                                        " ", " x"}));
+    EXPECT_EQ(split("(foo)\tbar"), (std::vector<std::string>{"(foo", ")", "\tbar"}));
+    // Long letter runs cross the SIMD block boundary
+    std::string word(40, 'q');
+    EXPECT_EQ(split(word + " end"), (std::vector<std::string>{word, " end"}));
+}
+
+TEST(BpeTokenizerTest, MergesByRankAndRoundTrips) {
+    auto tokenizer = tiny();
+    // "hello": he + l + l + o -> he + ll + o -> hell + o
+    EXPECT_EQ(tokenizer.encode("hello"), (std::vector<std::uint32_t>{258, 'o'}));
+    EXPECT_EQ(tokenizer.encode(" world"), (std::vector<std::uint32_t>{262}));
+    EXPECT_EQ(tokenizer.count("hello world"), 3u);
+
+    std::string text = "Hello, world! \xE2\x9C\x93 done\n\tindented 42";
+    EXPECT_EQ(tokenizer.decode(tokenizer.encode(text)), text);
+    EXPECT_EQ(tokenizer.count(text), tokenizer.encode(text).size());
+}
+
+TEST(BpeTokenizerTest, CountsMessagesWithFramingOverhead) {
+    auto tokenizer = tiny();
+    protocol::Message message{protocol::Role::Assistant, "hello", {{"c1", "ls", "{}"}},
+                              std::nullopt};
+    EXPECT_EQ(tokenizer.count(message), BpeTokenizer::kMessageOverhead + 2 + 2 + 2);
+}
+
+TEST(BpeTokenizerTest, LoadsTiktokenFileAndRejectsMissingBytes) {
+    static const char* kAlphabet =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    auto base64 = [](const std::string& in) {
+        std::string out;
+        std::uint32_t buffer = 0;
+        int bits = 0;
+        for (unsigned char c : in) {
+            buffer = (buffer << 8) | c;
+            bits += 8;
+            while (bits >= 6) {
+                bits -= 6;
+                out += kAlphabet[(buffer >> bits) & 0x3F];
+            }
+        }
+        if (bits > 0) out += kAlphabet[(buffer << (6 - bits)) & 0x3F];
+        while (out.size() % 4 != 0) out += '=';
+        return out;
+    };
+
+    std::string path = ::testing::TempDir() + "tiny.tiktoken";
+    {
+        std::ofstream out(path);
+        for (const auto& [bytes, rank] : tiny_ranks()) out << base64(bytes) << ' ' << rank << '\n';
+    }
+    auto loaded = BpeTokenizer::load(path);
+    std::remove(path.c_str());
+
+    ASSERT_FALSE(core::errors::is_error(loaded));
+    const auto& tokenizer = core::errors::get_value(loaded);
+    EXPECT_EQ(tokenizer.vocab_size(), 263u);
+    EXPECT_EQ(tokenizer.id().rfind("tiny.tiktoken@", 0), 0u);
+    EXPECT_EQ(tokenizer.encode("hello"), (std::vector<std::uint32_t>{258, 'o'}));
+
+    auto partial = BpeTokenizer::from_ranks({{"a", 0}}, "partial");
+    ASSERT_TRUE(core::errors::is_error(partial));
+    EXPECT_EQ(core::errors::get_error(partial).category, core::errors::ErrorCategory::Input);
+
+    // Unparsable ranks are rejected rather than read as 0, and a rank far
+    // beyond the vocabulary cannot size the rank table
+    for (const char* rank : {"", "x1", "12abc", "-3", "99999999999", "4000000000"}) {
+        {
+            std::ofstream out(path);
+            for (const auto& [bytes, good] : tiny_ranks()) {
+                out << base64(bytes) << ' ' << good << '\n';
+            }
+            out << base64("xyz") << ' ' << rank << '\n';
+        }
+        auto bad = BpeTokenizer::load(path);
+        std::remove(path.c_str());
+        ASSERT_TRUE(core::errors::is_error(bad)) << rank;
+        EXPECT_EQ(core::errors::get_error(bad).category, core::errors::ErrorCategory::Input);
+    }
+}
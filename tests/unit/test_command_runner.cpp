@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <string>
+#include "core/exec/command_runner.hpp"
+#include "core/tools/run_command_tool.hpp"
+
+using namespace agent;
+using core::exec::CommandResult;
+using core::exec::CommandSpec;
+
+namespace {
+
+    CommandResult run(const CommandSpec& spec) {
+        auto result = core::exec::run_command(spec);
+        EXPECT_FALSE(core::errors::is_error(result));
+        return std::get<CommandResult>(result);
+    }
+
+    // Runs in a death-test child: room for the two pipes and nothing more
+    [[noreturn]] void run_out_of_descriptors() {
+        for (int fd = 3; fd < 1024; ++fd) ::close(fd);
+        rlimit limit{7, 7};
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        auto result = core::exec::run_command(CommandSpec::shell("true"));
+        bool ok = core::errors::is_error(result) &&
+                  core::errors::get_error(result).category ==
+                      core::errors::ErrorCategory::Execution &&
+                  core::errors::get_error(result).message.rfind("epoll_create1", 0) == 0;
+        std::_Exit(ok ? 0 : 1);
+    }
+
+} // namespace
+
+TEST(CommandRunnerTest, CapturesBothStreamsAndExitCode) {
+    auto result = run(CommandSpec::shell("echo out; echo err >&2; exit 3"));
+    EXPECT_EQ(result.exit_code, 3);
+    EXPECT_EQ(result.stdout_text, "out\n");
+    EXPECT_EQ(result.stderr_text, "err\n");
+    EXPECT_FALSE(result.timed_out);
+    EXPECT_GT(result.duration_ms, 0.0);
+}
+
+TEST(CommandRunnerTest, ReadsLargeInterleavedOutputWithoutDeadlock) {
+    // Both pipes fill far beyond their kernel buffers at the same time
+    auto spec = CommandSpec::shell(
+        "i=0; while [ $i -lt 20000 ]; do echo \"line $i\"; echo \"warn $i\" >&2; "
+        "i=$((i+1)); done");
+    spec.stdout_limits = core::tools::CaptureLimits{128, 128};
+    auto result = run(spec);
+
+    EXPECT_EQ(result.exit_code, 0);
+    EXPECT_GT(result.stdout_bytes, 200000u);
+    EXPECT_GT(result.stderr_bytes, 200000u);
+    EXPECT_LT(result.stdout_text.size(), 400u);
+    EXPECT_NE(result.stdout_text.find("line 19999"), std::string::npos);
+}
+
+TEST(CommandRunnerTest, TimeoutKillsTheWholeProcessGroup) {
+    // The backgrounded sleep would hold stdout open if only the shell died
+    auto spec = CommandSpec::shell("sleep 30 & sleep 30");
+    spec.timeout_ms = 100;
+    spec.kill_grace_ms = 200;
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = run(spec);
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(result.timed_out);
+    EXPECT_EQ(result.term_signal, SIGTERM);
+    EXPECT_LT(elapsed, std::chrono::seconds(5));
+}
+
+TEST(CommandRunnerTest, AppliesCwdEnvAndLimits) {
+    auto spec = CommandSpec::shell("pwd; echo $AGENT_TEST_VAR; ulimit -n");
+    spec.cwd = "/tmp";
+    spec.env = {"AGENT_TEST_VAR=hello"};
+    spec.limits.open_files = 64;
+    auto result = run(spec);
+
+    EXPECT_EQ(result.exit_code, 0);
+    EXPECT_EQ(result.stdout_text, "/tmp\nhello\n64\n");
+}
+
+TEST(CommandRunnerTest, MissingProgramIsAnExecutionError) {
+    CommandSpec spec;
+    spec.argv = {"definitely-not-a-real-program-xyz"};
+    auto result = core::exec::run_command(spec);
+    ASSERT_TRUE(core::errors::is_error(result));
+    EXPECT_EQ(core::errors::get_error(result).category, core::errors::ErrorCategory::Execution);
+}
+
+TEST(CommandRunnerTest, DescriptorExhaustionIsAnExecutionError) {
+    EXPECT_EXIT(run_out_of_descriptors(), ::testing::ExitedWithCode(0), "");
+}
+
+TEST(CommandRunnerTest, RunCommandToolReportsFailuresWithBothStreams) {
+    core::tools::RunCommandTool tool;
+    auto ok = tool.execute(protocol::ToolCall{"c1", "run_command", R"({"command":"echo hi"})"});
+    EXPECT_TRUE(ok.success);
+    EXPECT_EQ(ok.output, "hi\n");
+
+    auto failed = tool.execute(protocol::ToolCall{
+        "c2", "run_command", R"({"command":"echo built; echo boom >&2; false"})"});
+    EXPECT_FALSE(failed.success);
+    EXPECT_NE(failed.error_message.find("Exit code 1"), std::string::npos);
+    EXPECT_NE(failed.error_message.find("built"), std::string::npos);
+    EXPECT_NE(failed.error_message.find("boom"), std::string::npos);
+    EXPECT_GT(failed.duration_ms, 0.0);
+
+    auto bad = tool.execute(protocol::ToolCall{"c3", "run_command", "{}"});
+    EXPECT_FALSE(bad.success);
+
+    // Wrong-typed arguments from the model are a failed call, not an exception
+    for (const char* arguments : {R"({"command":"true","cwd":7})",
+                                  R"({"command":"true","timeout_ms":"5s"})",
+                                  R"({"command":"true","timeout_ms":1e99})"}) {
+        auto wrong = tool.execute(protocol::ToolCall{"c4", "run_command", arguments});
+        EXPECT_FALSE(wrong.success) << arguments;
+    }
+}
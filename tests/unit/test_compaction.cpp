@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "core/context/compaction_policies.hpp"
+#include "core/context/compactor.hpp"
+#include "providers/mock_provider.hpp"
+#include "byte_tokenizer.hpp"
+
+using namespace agent;
+using agent::testing::byte_tokenizer;
+using core::context::CompactionOptions;
+using core::context::Compactor;
+
+namespace {
+
+    // Appends an assistant tool call plus its result
+    void add_call(std::vector<protocol::Message>& history, const std::string& id,
+                  const std::string& tool, const std::string& path, const std::string& output) {
+        history.push_back(protocol::Message{protocol::Role::Assistant, "",
+                                            {{id, tool, "{\"path\":\"" + path + "\"}"}},
+                                            std::nullopt});
+        history.push_back(protocol::Message{protocol::Role::Tool, output, {}, id});
+    }
+
+    std::vector<protocol::Message> task() {
+        return {protocol::Message{protocol::Role::User, "fix the build", {}, std::nullopt}};
+    }
+
+    CompactionOptions options(std::size_t limit) {
+        CompactionOptions result;
+        result.context_limit = limit;
+        result.keep_recent = 2;
+        return result;
+    }
+
+    std::size_t fresh_total(const std::vector<protocol::Message>& history) {
+        core::context::TokenLedger ledger(byte_tokenizer());
+        ledger.sync(history);
+        return ledger.total();
+    }
+
+    // No two user-side (user or tool result) or two assistant messages in a row
+    bool alternates(const std::vector<protocol::Message>& history) {
+        for (std::size_t i = 1; i < history.size(); ++i) {
+            bool assistant = history[i].role == protocol::Role::Assistant;
+            if (assistant == (history[i - 1].role == protocol::Role::Assistant)) return false;
+        }
+        return true;
+    }
+
+} // namespace
+
+TEST(CompactionTest, DoesNothingBelowTrigger) {
+    Compactor compactor(byte_tokenizer(), options(100000));
+    compactor.add_policy(std::make_unique<core::context::TruncateToolOutputs>());
+    auto history = task();
+    add_call(history, "c1", "run_command", "", std::string(5000, 'x'));
+
+    auto report = compactor.maybe_compact(history);
+    EXPECT_FALSE(report.ran);
+    EXPECT_EQ(history[2].content.size(), 5000u);
+}
+
+TEST(CompactionTest, TruncatesOldOutputsButNotRecentOnes) {
+    Compactor compactor(byte_tokenizer(), options(20000));
+    compactor.add_policy(std::make_unique<core::context::TruncateToolOutputs>(100, 100));
+    auto history = task();
+    for (int i = 0; i < 4; ++i) {
+        add_call(history, "c" + std::to_string(i), "run_command", "", std::string(5000, 'x'));
+    }
+
+    auto report = compactor.maybe_compact(history);
+    ASSERT_TRUE(report.ran);
+    EXPECT_LE(report.tokens_after, 12000u);
+    EXPECT_LT(history[2].content.size(), 400u);
+    EXPECT_NE(history[2].content.find("bytes elided"), std::string::npos);
+    EXPECT_EQ(history.back().content.size(), 5000u);  // Protected tail
+    EXPECT_EQ(compactor.ledger().total(), fresh_total(history));
+}
+
+TEST(CompactionTest, ElidesSupersededReadsBeforeTruncating) {
+    Compactor compactor(byte_tokenizer(), options(16000));
+    compactor.add_policy(std::make_unique<core::context::ElideStaleReads>());
+    compactor.add_policy(std::make_unique<core::context::TruncateToolOutputs>(100, 100));
+    auto history = task();
+    add_call(history, "c1", "read_file", "a.cpp", std::string(6000, 'a'));
+    add_call(history, "c2", "read_file", "b.cpp", std::string(3000, 'b'));
+    add_call(history, "c3", "read_file", "a.cpp", std::string(6000, 'a'));
+    add_call(history, "c4", "run_command", "", "ok");
+
+    auto report = compactor.maybe_compact(history);
+    ASSERT_TRUE(report.ran);
+    EXPECT_NE(history[2].content.find("Earlier contents of a.cpp"), std::string::npos);
+    EXPECT_EQ(history[4].content.size(), 3000u);  // Target reached without touching b.cpp
+    EXPECT_EQ(history[6].content.size(), 6000u);  // The latest read of a.cpp stays
+    EXPECT_EQ(compactor.ledger().total(), fresh_total(history));
+}
+
+TEST(CompactionTest, SummaryFollowsTheTaskBeforeAProtectedCall) {
+    providers::MockProvider summarizer({providers::ScriptedTurn{
+        "Read a.cpp and b.cpp.", {}, protocol::StopReason::Finished, std::nullopt}});
+    Compactor compactor(byte_tokenizer(), options(7000));
+    compactor.add_policy(
+        std::make_unique<core::context::SummarizeOldTurns>(summarizer, providers::ModelParams{}));
+    auto history = task();
+    add_call(history, "c1", "read_file", "a.cpp", std::string(3000, 'a'));
+    add_call(history, "c2", "read_file", "b.cpp", std::string(3000, 'b'));
+    add_call(history, "c3", "run_command", "", "ok");
+
+    auto report = compactor.maybe_compact(history);
+    ASSERT_TRUE(report.ran);
+    ASSERT_EQ(history.size(), 3u);
+    // The c3 call is protected, so between it and the task the summary is
+    // appended to the task, whose own text stays as it was
+    EXPECT_EQ(history[0].role, protocol::Role::User);
+    EXPECT_EQ(history[0].content.rfind("fix the build\n\n", 0), 0u);
+    EXPECT_NE(history[0].content.find("Read a.cpp and b.cpp."), std::string::npos);
+    EXPECT_EQ(history[1].role, protocol::Role::Assistant);
+    EXPECT_EQ(history[1].content, "");
+    ASSERT_EQ(history[1].tool_calls.size(), 1u);
+    EXPECT_EQ(history[1].tool_calls[0].id, "c3");
+    EXPECT_EQ(history[2].tool_call_id, "c3");
+    EXPECT_TRUE(alternates(history));
+    EXPECT_EQ(compactor.ledger().total(), fresh_total(history));
+}
+
+TEST(CompactionTest, SummaryBeforeAUserTurnStandsAlone) {
+    providers::MockProvider summarizer({providers::ScriptedTurn{
+        "Read a.cpp and b.cpp.", {}, protocol::StopReason::Finished, std::nullopt}});
+    auto opts = options(7000);
+    opts.keep_recent = 3;
+    Compactor compactor(byte_tokenizer(), opts);
+    compactor.add_policy(
+        std::make_unique<core::context::SummarizeOldTurns>(summarizer, providers::ModelParams{}));
+    auto history = task();
+    add_call(history, "c1", "read_file", "a.cpp", std::string(3000, 'a'));
+    add_call(history, "c2", "read_file", "b.cpp", std::string(3000, 'b'));
+    history.push_back(protocol::Message{protocol::Role::User, "now the tests", {}, std::nullopt});
+    add_call(history, "c3", "run_command", "", "ok");
+
+    ASSERT_TRUE(compactor.maybe_compact(history).ran);
+    ASSERT_EQ(history.size(), 5u);
+    EXPECT_EQ(history[1].role, protocol::Role::Assistant);
+    EXPECT_NE(history[1].content.find("Read a.cpp and b.cpp."), std::string::npos);
+    EXPECT_EQ(history[2].content, "now the tests");
+    EXPECT_TRUE(alternates(history));
+    EXPECT_EQ(compactor.ledger().total(), fresh_total(history));
+}
+
+TEST(CompactionTest, SummaryIsNeverWrittenIntoAToolResult) {
+    providers::MockProvider summarizer(
+        {providers::ScriptedTurn{"Read a.cpp.", {}, protocol::StopReason::Finished, std::nullopt},
+         providers::ScriptedTurn{"Read a.cpp and b.cpp.", {}, protocol::StopReason::Finished,
+                                 std::nullopt}});
+    auto opts = options(7000);
+    opts.keep_recent = 1;
+    Compactor compactor(byte_tokenizer(), opts);
+    compactor.add_policy(
+        std::make_unique<core::context::SummarizeOldTurns>(summarizer, providers::ModelParams{}));
+
+    // Only the c3 result is protected: the summary takes over the c3 call,
+    // and the next summary starts right after that call's result
+    auto history = task();
+    add_call(history, "c1", "read_file", "a.cpp", std::string(3000, 'a'));
+    add_call(history, "c2", "read_file", "a.cpp", std::string(3000, 'a'));
+    add_call(history, "c3", "run_command", "", "ok");
+    ASSERT_TRUE(compactor.maybe_compact(history).ran);
+    ASSERT_EQ(history.size(), 3u);
+    ASSERT_EQ(history[1].tool_calls.size(), 1u);
+    EXPECT_EQ(history[1].tool_calls[0].id, "c3");
+    EXPECT_EQ(history[2].content, "ok");
+
+    // The protected final answer clashes with a summary after the c3 result,
+    // so the span grows back over that result and its call
+    add_call(history, "c4", "read_file", "b.cpp", std::string(6000, 'b'));
+    history.push_back(protocol::Message{protocol::Role::Assistant, "done", {}, std::nullopt});
+    ASSERT_TRUE(compactor.maybe_compact(history).ran);
+    ASSERT_EQ(history.size(), 2u);
+    EXPECT_EQ(history[0].content.rfind("fix the build\n\n", 0), 0u);
+    EXPECT_NE(history[0].content.find("Read a.cpp and b.cpp."), std::string::npos);
+    EXPECT_EQ(history[1].content, "done");
+    for (const auto& message : history) EXPECT_NE(message.role, protocol::Role::Tool);
+    EXPECT_TRUE(alternates(history));
+    EXPECT_EQ(compactor.ledger().total(), fresh_total(history));
+}
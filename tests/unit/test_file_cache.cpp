@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "core/fs/file_cache.hpp"
+#include "core/tools/read_file_tool.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::eventually;
+using agent::testing::TempWorkspace;
+using core::fs::FileCache;
+using core::fs::FileCacheOptions;
+
+namespace {
+
+    class FileCacheTest : public ::testing::Test {
+    protected:
+        static std::string read(FileCache& cache, const std::string& path) {
+            auto content = cache.read(path);
+            EXPECT_FALSE(core::errors::is_error(content));
+            return *core::errors::get_value(content);
+        }
+
+        TempWorkspace dir_{"file_cache_test"};
+    };
+
+} // namespace
+
+TEST_F(FileCacheTest, HitsUntilTheFileChanges) {
+    FileCache cache;
+    auto path = dir_.write("a.txt", "first");
+
+    EXPECT_EQ(read(cache, path), "first");
+    EXPECT_EQ(read(cache, (dir_ / "." / "a.txt").string()), "first");  // Same key
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().misses, 1u);
+
+    dir_.write("a.txt", "second, longer");
+    EXPECT_EQ(read(cache, path), "second, longer");
+    EXPECT_EQ(cache.stats().stale, 1u);
+
+    std::filesystem::remove(path);
+    EXPECT_TRUE(core::errors::is_error(cache.read(path)));
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
+
+TEST_F(FileCacheTest, InotifyCatchesRewritesThatKeepSizeAndMtime) {
+    FileCache cache;
+    auto path = dir_.write("sub/b.txt", "aaaa");
+    ASSERT_FALSE(core::errors::is_error(cache.watch(dir_.string())));
+
+    struct stat before {};
+    ::stat(path.c_str(), &before);
+    EXPECT_EQ(read(cache, path), "aaaa");
+
+    dir_.write("sub/b.txt", "bbbb");
+    struct timespec times[2] = {before.st_atim, before.st_mtim};
+    ::utimensat(AT_FDCWD, path.c_str(), times, 0);  // Hide the change from the stat check
+
+    EXPECT_TRUE(eventually([&] { return cache.stats().invalidations >= 1; }));
+    EXPECT_EQ(read(cache, path), "bbbb");
+}
+
+TEST_F(FileCacheTest, WatchesDirectoriesCreatedLater) {
+    FileCache cache;
+    ASSERT_FALSE(core::errors::is_error(cache.watch(dir_.string())));
+    std::filesystem::create_directories(dir_ / "late");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));  // Let the watch land
+
+    auto path = dir_.write("late/c.txt", "old");
+    EXPECT_EQ(read(cache, path), "old");
+    dir_.write("late/c.txt", "new");
+    EXPECT_TRUE(eventually([&] { return cache.stats().invalidations >= 1; }));
+}
+
+TEST_F(FileCacheTest, EvictsLeastRecentlyUsedPastTheBudget) {
+    FileCacheOptions options;
+    options.max_bytes = 250;
+    FileCache cache(options);
+    auto a = dir_.write("a", std::string(100, 'a'));
+    auto b = dir_.write("b", std::string(100, 'b'));
+    auto c = dir_.write("c", std::string(100, 'c'));
+
+    read(cache, a);
+    read(cache, b);
+    read(cache, a);  // b is now the coldest
+    read(cache, c);
+
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.bytes, 200u);
+    read(cache, a);
+    EXPECT_EQ(cache.stats().hits, 2u);
+    read(cache, b);
+    EXPECT_EQ(cache.stats().misses, 4u);
+}
+
+TEST_F(FileCacheTest, SharedAcrossThreadsAndUsedByReadFile) {
+    FileCache cache;
+    auto path = dir_.write("shared.txt", "one\ntwo\nthree\n");
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 200; ++i) EXPECT_EQ(read(cache, path), "one\ntwo\nthree\n");
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    EXPECT_EQ(cache.stats().hits + cache.stats().misses, 800u);
+    EXPECT_EQ(cache.stats().entries, 1u);
+
+    core::tools::ReadFileOptions options;
+    options.cache = &cache;
+    core::tools::ReadFileTool tool(options);
+    nlohmann::json args = {{"path", path}, {"start_line", 2}, {"end_line", 2}};
+    auto result = tool.execute({"c1", "read_file", args.dump()});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "two\n[Showing lines 2-2 of 3; continue with start_line=3]");
+    EXPECT_EQ(cache.stats().hits + cache.stats().misses, 801u);
+}
+
+TEST_F(FileCacheTest, ReadFileMapsFilesTooLargeToCache) {
+    FileCacheOptions cache_options;
+    cache_options.max_file_bytes = 1024;
+    FileCache cache(cache_options);
+    auto path = dir_.write("large.txt", std::string(2000, 'x') + "\nend\n");
+
+    core::tools::ReadFileOptions options;
+    options.cache = &cache;
+    core::tools::ReadFileTool tool(options);
+    nlohmann::json args = {{"path", path}, {"start_line", 2}};
+    auto result = tool.execute({"c1", "read_file", args.dump()});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "end\n[Showing lines 2-2 of 2]");
+    EXPECT_EQ(cache.stats().misses, 0u);  // Never read through the cache
+    EXPECT_EQ(cache.stats().entries, 0u);
+}
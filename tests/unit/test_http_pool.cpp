@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+#include "local_http_server.hpp"
+#include "providers/http/http_client.hpp"
+
+using namespace agent::providers::http;
+using agent::testing::LocalHttpServer;
+namespace errors = agent::core::errors;
+
+namespace {
+
+    std::string route(const std::string& method, const std::string& target,
+                      const std::string& body) {
+        if (target == "/chunked") return LocalHttpServer::chunked({"data: one\n", "data: two\n"});
+        if (target == "/close") return LocalHttpServer::ok("bye", "Connection: close\r\n");
+        if (target == "/bad-chunk") {
+            return std::string("HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n"
+                               "4;ext=1\r\nonce\r\nzz\r\nlost\r\n0\r\n\r\n");
+        }
+        if (target == "/bad-length") {
+            return std::string("HTTP/1.1 200 OK\r\nContent-Length: 4x\r\n\r\nbody");
+        }
+        if (method == "POST") return LocalHttpServer::ok("echo:" + body);
+        return LocalHttpServer::ok("hello " + target);
+    }
+
+    HttpRequest get(const std::string& target) { return HttpRequest{"GET", target, {}, ""}; }
+
+} // namespace
+
+TEST(HttpPoolTest, ReusesKeepAliveConnectionAcrossRequests) {
+    LocalHttpServer server(route);
+    HttpConnectionPool pool;
+    HttpClient client(pool);
+    Endpoint endpoint{"127.0.0.1", server.port()};
+
+    for (int i = 0; i < 5; ++i) {
+        auto response = client.fetch(endpoint, get("/turn"));
+        ASSERT_FALSE(errors::is_error(response)) << errors::get_error(response).message;
+        EXPECT_EQ(errors::get_value(response).head.status, 200);
+        EXPECT_EQ(errors::get_value(response).body, "hello /turn");
+    }
+
+    EXPECT_EQ(server.connections_accepted(), 1);
+    EXPECT_EQ(pool.stats().connects, 1u);
+    EXPECT_EQ(pool.stats().reuses, 4u);
+}
+
+TEST(HttpPoolTest, StreamsChunkedBodyAndPostsBodies) {
+    LocalHttpServer server(route);
+    HttpConnectionPool pool;
+    HttpClient client(pool);
+    Endpoint endpoint{"127.0.0.1", server.port()};
+
+    std::vector<std::string> chunks;
+    auto head = client.stream(endpoint, get("/chunked"), [&](std::string_view chunk) {
+        chunks.emplace_back(chunk);
+        return true;
+    });
+    ASSERT_FALSE(errors::is_error(head));
+    EXPECT_TRUE(errors::get_value(head).chunked);
+    ASSERT_EQ(chunks.size(), 2u);
+    EXPECT_EQ(chunks[0], "data: one\n");
+
+    auto echoed = client.fetch(endpoint, HttpRequest{"POST", "/v1/messages", {}, "{\"x\":1}"});
+    ASSERT_FALSE(errors::is_error(echoed));
+    EXPECT_EQ(errors::get_value(echoed).body, "echo:{\"x\":1}");
+    EXPECT_EQ(server.connections_accepted(), 1);
+}
+
+TEST(HttpPoolTest, MalformedSizesAreErrorsNotShortBodies) {
+    LocalHttpServer server(route);
+    HttpConnectionPool pool;
+    HttpClient client(pool);
+    Endpoint endpoint{"127.0.0.1", server.port()};
+
+    std::string body;
+    auto chunked = client.stream(endpoint, get("/bad-chunk"), [&](std::string_view chunk) {
+        body.append(chunk);
+        return true;
+    });
+    ASSERT_TRUE(errors::is_error(chunked));
+    EXPECT_EQ(errors::get_error(chunked).category, errors::ErrorCategory::Provider);
+    EXPECT_NE(errors::get_error(chunked).message.find("malformed chunk size"), std::string::npos);
+    EXPECT_EQ(body, "once");  // The chunk extension was skipped, not misread
+
+    auto sized = client.fetch(endpoint, get("/bad-length"));
+    ASSERT_TRUE(errors::is_error(sized));
+    EXPECT_NE(errors::get_error(sized).message.find("malformed Content-Length"),
+              std::string::npos);
+}
+
+TEST(HttpPoolTest, DropsConnectionsTheServerClosed) {
+    LocalHttpServer server(route);
+    HttpConnectionPool pool;
+    HttpClient client(pool);
+    Endpoint endpoint{"127.0.0.1", server.port()};
+
+    auto first = client.fetch(endpoint, get("/close"));
+    ASSERT_FALSE(errors::is_error(first));
+    EXPECT_EQ(pool.idle_count(), 0u);
+
+    auto second = client.fetch(endpoint, get("/again"));
+    ASSERT_FALSE(errors::is_error(second));
+    EXPECT_EQ(server.connections_accepted(), 2);
+}
+
+TEST(HttpPoolTest, RecoversWhenIdleConnectionIsClosedSilently) {
+    // The server hangs up after every request without saying so
+    LocalHttpServer server(route, 1);
+    HttpConnectionPool pool;
+    HttpClient client(pool);
+    Endpoint endpoint{"127.0.0.1", server.port()};
+
+    for (int i = 0; i < 3; ++i) {
+        auto response = client.fetch(endpoint, get("/x"));
+        ASSERT_FALSE(errors::is_error(response)) << errors::get_error(response).message;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(server.connections_accepted(), 3);
+}
+
+TEST(HttpPoolTest, PipelinesIdempotentRequestsOnOneConnection) {
+    LocalHttpServer server(route);
+    HttpConnectionPool pool;
+    HttpClient client(pool);
+    Endpoint endpoint{"127.0.0.1", server.port()};
+
+    std::vector<std::string> bodies(3);
+    auto heads = client.pipeline(endpoint, {get("/a"), get("/b"), get("/c")},
+                                 [&](std::size_t index, std::string_view chunk) {
+                                     bodies[index].append(chunk);
+                                     return true;
+                                 });
+
+    ASSERT_FALSE(errors::is_error(heads));
+    EXPECT_EQ(errors::get_value(heads).size(), 3u);
+    EXPECT_EQ(bodies[0], "hello /a");
+    EXPECT_EQ(bodies[2], "hello /c");
+    EXPECT_EQ(server.connections_accepted(), 1);
+
+    auto rejected = client.pipeline(endpoint, {HttpRequest{"POST", "/", {}, "x"}},
+                                    [](std::size_t, std::string_view) { return true; });
+    ASSERT_TRUE(errors::is_error(rejected));
+    EXPECT_EQ(errors::get_error(rejected).category, errors::ErrorCategory::Input);
+}
+
+TEST(HttpPoolTest, PipelineResendsTailWhenServerClosesMidBatch) {
+    LocalHttpServer server(route, 2);
+    HttpConnectionPool pool;
+    HttpClient client(pool);
+    Endpoint endpoint{"127.0.0.1", server.port()};
+
+    std::vector<std::string> bodies(5);
+    auto heads = client.pipeline(endpoint, {get("/1"), get("/2"), get("/3"), get("/4"), get("/5")},
+                                 [&](std::size_t index, std::string_view chunk) {
+                                     bodies[index].append(chunk);
+                                     return true;
+                                 });
+
+    ASSERT_FALSE(errors::is_error(heads)) << errors::get_error(heads).message;
+    EXPECT_EQ(bodies[4], "hello /5");
+    EXPECT_EQ(server.connections_accepted(), 3);
+}
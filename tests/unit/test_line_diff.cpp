@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "core/diff/line_diff.hpp"
+
+using namespace agent;
+using core::diff::Algorithm;
+using core::diff::Change;
+using core::diff::DiffOptions;
+
+namespace {
+
+    std::vector<std::string> lines_of(const std::string& text) {
+        std::vector<std::string> lines;
+        std::size_t start = 0;
+        while (start < text.size()) {
+            std::size_t end = text.find('\n', start);
+            end = end == std::string::npos ? text.size() : end + 1;
+            lines.push_back(text.substr(start, end - start));
+            start = end;
+        }
+        return lines;
+    }
+
+    // Replays the changes on the old text; must give the new one back
+    std::string apply(const std::string& old_text, const std::string& new_text,
+                      const std::vector<Change>& changes) {
+        auto old_lines = lines_of(old_text);
+        auto new_lines = lines_of(new_text);
+        std::string out;
+        std::size_t at = 0;
+        for (const Change& change : changes) {
+            for (; at < change.old_start; ++at) out += old_lines[at];
+            for (std::size_t i = 0; i < change.new_count; ++i) {
+                out += new_lines[change.new_start + i];
+            }
+            at += change.old_count;
+        }
+        for (; at < old_lines.size(); ++at) out += old_lines[at];
+        return out;
+    }
+
+    std::size_t lcs_length(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+        std::vector<std::vector<std::size_t>> table(a.size() + 1,
+                                                    std::vector<std::size_t>(b.size() + 1));
+        for (std::size_t i = 1; i <= a.size(); ++i) {
+            for (std::size_t j = 1; j <= b.size(); ++j) {
+                table[i][j] = a[i - 1] == b[j - 1] ? table[i - 1][j - 1] + 1
+                                                   : std::max(table[i - 1][j], table[i][j - 1]);
+            }
+        }
+        return table[a.size()][b.size()];
+    }
+
+    std::string unified(const std::string& old_text, const std::string& new_text,
+                        Algorithm algorithm = Algorithm::Myers) {
+        DiffOptions options;
+        options.algorithm = algorithm;
+        return core::diff::unified_diff(old_text, new_text, "a/f", "b/f", options).text;
+    }
+
+} // namespace
+
+TEST(LineDiffTest, PrintsUnifiedHunksLikeDiffU) {
+    std::string old_text = "1\n2\n3\n4\n5\n6\n7\n8\n9\n10\n11\n12\n13\n14\n15\n16\n";
+    std::string new_text = "1\n2\nthree\n4\n5\n6\n7\n8\n9\n10\n11\n12\n13\n14\n15\n16\n17\n";
+    auto diff = core::diff::unified_diff(old_text, new_text, "a/f", "b/f");
+    EXPECT_EQ(diff.text, "--- a/f\n+++ b/f\n"
+                         "@@ -1,6 +1,6 @@\n 1\n 2\n-3\n+three\n 4\n 5\n 6\n"
+                         "@@ -14,3 +14,4 @@\n 14\n 15\n 16\n+17\n");
+    EXPECT_EQ(diff.insertions, 2u);
+    EXPECT_EQ(diff.deletions, 1u);
+
+    EXPECT_EQ(unified("a\nb", "a\nb\n"),
+              "--- a/f\n+++ b/f\n@@ -1,2 +1,2 @@\n a\n-b\n\\ No newline at end of file\n+b\n");
+    EXPECT_EQ(unified("", "x\n"), "--- a/f\n+++ b/f\n@@ -0,0 +1 @@\n+x\n");
+    EXPECT_EQ(unified("x\ny\n", ""), "--- a/f\n+++ b/f\n@@ -1,2 +0,0 @@\n-x\n-y\n");
+    EXPECT_EQ(unified("same\n", "same\n"), "");
+}
+
+TEST(LineDiffTest, AddedBlocksEndOnBlankLines) {
+    std::string old_text = "int f() {\n}\n\nint h() {\n}\n";
+    std::string new_text = "int f() {\n}\n\nint g() {\n}\n\nint h() {\n}\n";
+    for (auto algorithm : {Algorithm::Myers, Algorithm::Histogram}) {
+        EXPECT_EQ(unified(old_text, new_text, algorithm),
+                  "--- a/f\n+++ b/f\n@@ -1,5 +1,8 @@\n int f() {\n }\n \n"
+                  "+int g() {\n+}\n+\n int h() {\n }\n");
+    }
+}
+
+TEST(LineDiffTest, HistogramAnchorsOnUniqueLines) {
+    // Myers matches the braces and blank lines of a moved function; the
+    // histogram diff keeps the unique signatures together
+    std::string old_text = "void a() {\n  x();\n}\n\nvoid b() {\n  y();\n}\n";
+    std::string new_text = "void b() {\n  y();\n}\n\nvoid a() {\n  x();\n}\n";
+    auto changes = core::diff::diff_lines(old_text, new_text, {Algorithm::Histogram, 3, false});
+    EXPECT_EQ(apply(old_text, new_text, changes), new_text);
+    ASSERT_EQ(changes.size(), 2u);
+    EXPECT_EQ(changes[0].old_count + changes[0].new_count, 4u);  // One function moved whole
+    EXPECT_EQ(changes[1].old_count + changes[1].new_count, 4u);
+}
+
+TEST(LineDiffTest, RandomEditsReplayAndMyersIsMinimal) {
+    std::mt19937 random(7);
+    auto random_text = [&](std::size_t lines) {
+        std::string text;
+        for (std::size_t i = 0; i < lines; ++i) {
+            text += static_cast<char>('a' + random() % 5);
+            text += '\n';
+        }
+        if (random() % 4 == 0 && !text.empty()) text.pop_back();
+        return text;
+    };
+    for (int round = 0; round < 300; ++round) {
+        std::string old_text = random_text(random() % 40);
+        std::string new_text = random_text(random() % 40);
+        auto a = lines_of(old_text);
+        auto b = lines_of(new_text);
+        for (auto algorithm : {Algorithm::Myers, Algorithm::Histogram}) {
+            auto changes = core::diff::diff_lines(old_text, new_text, {algorithm, 3, true});
+            ASSERT_EQ(apply(old_text, new_text, changes), new_text);
+            if (algorithm != Algorithm::Myers) continue;
+            std::size_t edits = 0;
+            for (const auto& change : changes) edits += change.old_count + change.new_count;
+            EXPECT_EQ(edits, a.size() + b.size() - 2 * lcs_length(a, b));
+        }
+    }
+
+    // Large and unrelated: the cost cap must still give a correct script
+    std::string old_text = random_text(20000);
+    std::string new_text = random_text(20000);
+    auto changes = core::diff::diff_lines(old_text, new_text);
+    EXPECT_EQ(apply(old_text, new_text, changes), new_text);
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include "providers/mock_provider.hpp"
+
+using namespace agent;
+using providers::MockProvider;
+using providers::ScriptedTurn;
+
+namespace {
+
+    // Collects every streamed event for inspection
+    struct Recorder {
+        std::string text;
+        std::string arguments;
+        std::string tool_name;
+
+        providers::EventSink sink() {
+            return [this](const protocol::AgentEvent& event) {
+                if (auto* delta = std::get_if<protocol::MessageDeltaEvent>(&event)) {
+                    text += delta->delta_text;
+                } else if (auto* call = std::get_if<protocol::ToolCallDeltaEvent>(&event)) {
+                    tool_name += call->name;
+                    arguments += call->arguments_delta;
+                }
+            };
+        }
+    };
+
+} // namespace
+
+TEST(MockProviderTest, StreamsTextAndToolCallsThatReassembleExactly) {
+    ScriptedTurn turn{"Reading the  config file now.",
+                      {protocol::ToolCall{"c1", "read_file", "{\"path\": \"config/app.yaml\"}"}},
+                      protocol::StopReason::ToolCall,
+                      std::nullopt};
+    MockProvider provider({turn});
+
+    Recorder recorder;
+    auto result = provider.complete(providers::CompletionRequest{}, recorder.sink());
+
+    ASSERT_FALSE(core::errors::is_error(result));
+    const auto& response = core::errors::get_value(result);
+    EXPECT_EQ(response.stop_reason, protocol::StopReason::ToolCall);
+    EXPECT_EQ(recorder.text, turn.text);
+    EXPECT_EQ(recorder.tool_name, "read_file");
+    EXPECT_EQ(recorder.arguments, turn.tool_calls[0].arguments);
+}
+
+TEST(MockProviderTest, ScriptedErrorsSurfaceAsProviderErrors) {
+    ScriptedTurn turn;
+    turn.error = "429 Too Many Requests";
+    MockProvider provider({turn});
+
+    Recorder recorder;
+    auto result = provider.complete(providers::CompletionRequest{}, recorder.sink());
+
+    ASSERT_TRUE(core::errors::is_error(result));
+    EXPECT_EQ(core::errors::get_error(result).category, core::errors::ErrorCategory::Provider);
+
+    // A non-looping script is exhausted after one turn
+    result = provider.complete(providers::CompletionRequest{}, recorder.sink());
+    EXPECT_TRUE(core::errors::is_error(result));
+}
+
+TEST(MockProviderTest, SameSeedGivesSameInjectedErrors) {
+    providers::MockTiming timing;
+    timing.error_rate = 0.5;
+    timing.seed = 7;
+
+    auto run = [&]() {
+        MockProvider provider({ScriptedTurn{"ok", {}, protocol::StopReason::Finished,
+                                            std::nullopt}},
+                              timing, true);
+        std::string pattern;
+        Recorder recorder;
+        for (int i = 0; i < 32; ++i) {
+            auto result = provider.complete(providers::CompletionRequest{}, recorder.sink());
+            pattern += core::errors::is_error(result) ? 'E' : '.';
+        }
+        return pattern;
+    };
+
+    std::string first = run();
+    EXPECT_EQ(first, run());
+    EXPECT_NE(first.find('E'), std::string::npos);
+    EXPECT_NE(first.find('.'), std::string::npos);
+}
+
+TEST(MockProviderTest, HonoursTokenRate) {
+    providers::MockTiming timing;
+    timing.tokens_per_second = 200.0;  // 10 tokens => ~50ms
+    MockProvider provider({ScriptedTurn{"a b c d e f g h i j", {}, protocol::StopReason::Finished,
+                                        std::nullopt}},
+                          timing);
+
+    Recorder recorder;
+    auto start = std::chrono::steady_clock::now();
+    provider.complete(providers::CompletionRequest{}, recorder.sink());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_GE(elapsed, std::chrono::milliseconds(45));
+}
+
+TEST(MockProviderTest, LoadsRecordedConversationFromJsonl) {
+    std::string path = ::testing::TempDir() + "mock_script.jsonl";
+    {
+        std::ofstream out(path);
+        out << R"({"text": "looking", "tool_calls": [{"id": "c1", "name": "ls", )"
+            << R"("arguments": "{}"}]})" << "\n"
+            << R"({"text": "done"})" << "\n";
+    }
+
+    auto script = MockProvider::load_script(path);
+    std::remove(path.c_str());
+
+    ASSERT_FALSE(core::errors::is_error(script));
+    const auto& turns = core::errors::get_value(script);
+    ASSERT_EQ(turns.size(), 2u);
+    EXPECT_EQ(turns[0].stop_reason, protocol::StopReason::ToolCall);
+    EXPECT_EQ(turns[0].tool_calls[0].name, "ls");
+    EXPECT_EQ(turns[1].stop_reason, protocol::StopReason::Finished);
+}
+
+TEST(MockProviderTest, MalformedScriptFieldsAreInputErrors) {
+    std::string path = ::testing::TempDir() + "mock_script_bad.jsonl";
+    for (const char* line : {R"({"text": 42})", R"({"error": ["rate limited"]})",
+                             R"({"tool_calls": {"id": "c1"}})",
+                             R"({"tool_calls": [{"id": "c1", "name": 3}]})",
+                             R"({"stop_reason": "sleeping"})"}) {
+        {
+            std::ofstream out(path);
+            out << R"({"text": "fine"})" << "\n" << line << "\n";
+        }
+        auto script = MockProvider::load_script(path);
+        ASSERT_TRUE(core::errors::is_error(script)) << line;
+        const auto& error = core::errors::get_error(script);
+        EXPECT_EQ(error.category, core::errors::ErrorCategory::Input);
+        EXPECT_NE(error.message.find(path + ":2: "), std::string::npos) << error.message;
+    }
+
+    // Null means absent, and recorded arguments may be an object
+    {
+        std::ofstream out(path);
+        out << R"({"text": null, "error": null, "tool_calls": [{"id": "c1", "name": "ls", )"
+            << R"("arguments": {"path": "."}}]})" << "\n";
+    }
+    auto script = MockProvider::load_script(path);
+    std::remove(path.c_str());
+    ASSERT_FALSE(core::errors::is_error(script)) << core::errors::get_error(script).message;
+    const auto& turn = core::errors::get_value(script)[0];
+    EXPECT_EQ(turn.text, "");
+    EXPECT_FALSE(turn.error.has_value());
+    EXPECT_EQ(turn.tool_calls[0].arguments, R"({"path":"."})");
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include "core/storage/blob_store.hpp"
+#include "core/tools/output_collector.hpp"
+
+using namespace agent;
+using core::tools::CaptureLimits;
+using core::tools::OutputCollector;
+
+namespace {
+
+    class OutputCollectorTest : public ::testing::Test {
+    protected:
+        std::string dir = ::testing::TempDir() + "blob_store_test";
+        void SetUp() override { std::filesystem::remove_all(dir); }
+        void TearDown() override { std::filesystem::remove_all(dir); }
+    };
+
+    std::string numbered_lines(int count) {
+        std::string out;
+        for (int i = 0; i < count; ++i) out += "line " + std::to_string(i) + "\n";
+        return out;
+    }
+
+} // namespace
+
+TEST_F(OutputCollectorTest, ShortOutputPassesThroughUnchanged) {
+    OutputCollector collector(CaptureLimits{8, 8});
+    collector.write("hello ");
+    collector.write("world\nbye");
+
+    EXPECT_FALSE(collector.truncated());
+    EXPECT_EQ(collector.total_lines(), 2u);
+    EXPECT_EQ(collector.finish(), "hello world\nbye");
+}
+
+TEST_F(OutputCollectorTest, KeepsHeadAndTailOfLongStreams) {
+    std::string full = numbered_lines(10000);
+    OutputCollector collector(CaptureLimits{64, 64});
+    // Uneven chunks exercise ring wrap-around and oversized writes
+    for (std::size_t pos = 0, step = 1; pos < full.size(); pos += step, step = step * 3 % 997) {
+        collector.write(std::string_view(full).substr(pos, step));
+    }
+
+    EXPECT_EQ(collector.total_bytes(), full.size());
+    EXPECT_EQ(collector.total_lines(), 10000u);
+    std::string rendered = collector.finish();
+    EXPECT_EQ(rendered.rfind(full.substr(0, 64), 0), 0u);
+    EXPECT_EQ(rendered.substr(rendered.size() - 64), full.substr(full.size() - 64));
+    EXPECT_NE(rendered.find(" lines omitted ...]"), std::string::npos);
+    EXPECT_LT(rendered.size(), 256u);
+}
+
+TEST_F(OutputCollectorTest, DoesNotSplitUtf8AtTheCuts) {
+    // Two-byte characters with odd limits: both cuts land mid-character
+    std::string text;
+    for (int i = 0; i < 200; ++i) text += "\xC3\xA9";
+    OutputCollector collector(CaptureLimits{7, 7});
+    collector.write(text);
+    std::string rendered = collector.finish();
+
+    EXPECT_EQ(rendered.substr(0, 6), text.substr(0, 6));
+    EXPECT_EQ(rendered.substr(rendered.size() - 6), text.substr(0, 6));
+}
+
+TEST_F(OutputCollectorTest, SpillsFullStreamToBlobStore) {
+    core::storage::BlobStore store(dir);
+    std::string full = numbered_lines(5000);
+
+    OutputCollector collector(CaptureLimits{32, 32});
+    collector.spill_to(store);
+    for (std::size_t pos = 0; pos < full.size(); pos += 4096) {
+        collector.write(std::string_view(full).substr(pos, 4096));
+    }
+    std::string rendered = collector.finish();
+
+    ASSERT_TRUE(collector.blob_id().has_value());
+    EXPECT_NE(rendered.find(*collector.blob_id()), std::string::npos);
+    auto stored = store.read(*collector.blob_id());
+    ASSERT_FALSE(core::errors::is_error(stored));
+    EXPECT_EQ(core::errors::get_value(stored), full);
+
+    // Same bytes, same id
+    auto again = store.put(full);
+    ASSERT_FALSE(core::errors::is_error(again));
+    EXPECT_EQ(core::errors::get_value(again), *collector.blob_id());
+}
+
+TEST_F(OutputCollectorTest, AbandonedWriterLeavesNothingBehind) {
+    core::storage::BlobStore store(dir);
+    {
+        auto writer = store.open();
+        ASSERT_FALSE(core::errors::is_error(writer));
+        std::get<core::storage::BlobStore::Writer>(writer).write("partial");
+    }
+    EXPECT_TRUE(std::filesystem::is_empty(dir));
+}
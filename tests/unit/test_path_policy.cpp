@@ -0,0 +1,231 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "core/exec/shell_pool.hpp"
+#include "core/fs/file_cache.hpp"
+#include "core/fs/file_transaction.hpp"
+#include "core/fs/mapped_file.hpp"
+#include "core/fs/path_policy.hpp"
+#include "core/tools/apply_patch_tool.hpp"
+#include "core/tools/read_file_tool.hpp"
+#include "core/tools/run_command_tool.hpp"
+#include "core/tools/search_tool.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::TempWorkspace;
+using core::fs::PathAccess;
+
+namespace {
+
+    class PathPolicyTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            root_ = base_ / "ws";
+            base_.write("ws/src/main.cpp", "int main() {}\n");
+            base_.write("ws/.env", "TOKEN=1\n");
+            base_.write("outside/secret.txt", "secret\n");
+            std::filesystem::create_directories(root_ / "vendor");
+            std::filesystem::create_directory_symlink(base_ / "outside", root_ / "escape");
+            std::filesystem::create_symlink("../src/main.cpp", root_ / "vendor/main.cpp");
+
+            auto compiled = core::fs::PathPolicy::compile(
+                {{root_.string()}, {"vendor", "/usr/include"}, {".env*", ".git/**"}});
+            ASSERT_FALSE(core::errors::is_error(compiled));
+            policy_.emplace(std::move(std::get<core::fs::PathPolicy>(compiled)));
+        }
+
+        std::string at(const std::string& relative) { return (root_ / relative).string(); }
+
+        TempWorkspace base_{"path_policy_test"};
+        std::filesystem::path root_;
+        std::optional<core::fs::PathPolicy> policy_;
+    };
+
+} // namespace
+
+TEST_F(PathPolicyTest, DenyBeatsReadOnlyBeatsRoots) {
+    EXPECT_TRUE(policy_->allows(at("src/main.cpp"), PathAccess::Write));
+    EXPECT_TRUE(policy_->allows(at("src/new/file.cpp"), PathAccess::Write));
+    EXPECT_TRUE(policy_->allows(at("vendor/lib.h"), PathAccess::Read));
+    EXPECT_FALSE(policy_->allows(at("vendor/lib.h"), PathAccess::Write));
+    EXPECT_TRUE(policy_->allows("/usr/include/stdio.h", PathAccess::Read));
+    EXPECT_FALSE(policy_->allows("/usr/include/stdio.h", PathAccess::Write));
+    EXPECT_FALSE(policy_->allows("/etc/passwd", PathAccess::Read));
+    EXPECT_FALSE(policy_->allows(at(".env"), PathAccess::Read));
+    EXPECT_FALSE(policy_->allows(at("src/.env.local"), PathAccess::Read));
+    EXPECT_FALSE(policy_->allows(at(".git/config"), PathAccess::Read));
+    EXPECT_TRUE(policy_->allows(at("src/.gitignore"), PathAccess::Write));
+
+    auto refused = policy_->check(at("vendor/lib.h"), PathAccess::Write);
+    ASSERT_TRUE(core::errors::is_error(refused));
+    EXPECT_EQ(core::errors::get_error(refused).category, core::errors::ErrorCategory::Policy);
+    EXPECT_EQ(core::errors::get_error(refused).message,
+              at("vendor/lib.h") + ": read-only by the rule \"vendor\"");
+}
+
+TEST_F(PathPolicyTest, ResolvesSymlinksAndDotsBeforeChecking) {
+    auto resolved = policy_->resolve("src/../src/./main.cpp", PathAccess::Write);
+    ASSERT_FALSE(core::errors::is_error(resolved)) << core::errors::get_error(resolved).message;
+    EXPECT_EQ(core::errors::get_value(resolved).path(), at("src/main.cpp"));
+    EXPECT_GE(core::errors::get_value(resolved).parent(), 0);
+    EXPECT_EQ(core::errors::get_value(resolved).name(), "main.cpp");
+
+    // A symlink out of the workspace is judged by where it leads
+    auto escaped = policy_->resolve("escape/secret.txt", PathAccess::Read);
+    ASSERT_TRUE(core::errors::is_error(escaped));
+    EXPECT_EQ(core::errors::get_error(escaped).message,
+              "escape/secret.txt: outside the workspace");
+    // And a read-only file linking into the writable part may be written there
+    auto linked = policy_->resolve("vendor/main.cpp", PathAccess::Write);
+    ASSERT_FALSE(core::errors::is_error(linked));
+    EXPECT_EQ(core::errors::get_value(linked).path(), at("src/main.cpp"));
+
+    // Files to be created: the missing part is taken as written
+    auto created = policy_->resolve(at("src/a/b/../c.cpp"), PathAccess::Write);
+    ASSERT_FALSE(core::errors::is_error(created));
+    EXPECT_EQ(core::errors::get_value(created).path(), at("src/a/c.cpp"));
+    EXPECT_EQ(core::errors::get_value(created).parent(), -1);
+    EXPECT_TRUE(core::errors::is_error(policy_->resolve("src/../../outside/x", PathAccess::Read)));
+    EXPECT_TRUE(core::errors::is_error(policy_->resolve("src/main.cpp/x", PathAccess::Read)));
+}
+
+TEST_F(PathPolicyTest, ApplyPatchAsksThePolicy) {
+    core::tools::ApplyPatchOptions options;
+    options.root = root_.string();
+    options.sync = false;
+    options.policy = &*policy_;
+    core::tools::ApplyPatchTool tool(options);
+    nlohmann::json args = {{"patch", "--- a/vendor/lib.h\n+++ b/vendor/lib.h\n"
+                                     "@@ -0,0 +1 @@\n+x\n"
+                                     "--- a/escape/secret.txt\n+++ b/escape/secret.txt\n"
+                                     "@@ -1 +1 @@\n-secret\n+leaked\n"}};
+    auto result = tool.execute({"c1", "apply_patch", args.dump()});
+    ASSERT_FALSE(result.success);
+    EXPECT_EQ(result.error_message,
+              "apply_patch: nothing was written; the patch does not apply:\n"
+              "vendor/lib.h: read-only by the rule \"vendor\"\n"
+              "escape/secret.txt: outside the workspace");
+}
+
+TEST_F(PathPolicyTest, ReadFileOpensTheFileThePolicyChecked) {
+    core::tools::ReadFileOptions options;
+    options.root = root_.string();
+    options.policy = &*policy_;
+    core::tools::ReadFileTool tool(options);
+    auto read = [&](const std::string& path) {
+        return tool.execute({"c1", "read_file", nlohmann::json{{"path", path}}.dump()});
+    };
+    EXPECT_EQ(read("vendor/main.cpp").output, "int main() {}\n");
+    EXPECT_FALSE(read(".env").success);
+    EXPECT_FALSE(read("escape/secret.txt").success);
+
+    // A symlink swapped in after the check is not followed
+    auto resolved = policy_->resolve("src/main.cpp", PathAccess::Read);
+    ASSERT_FALSE(core::errors::is_error(resolved));
+    std::filesystem::remove(root_ / "src/main.cpp");
+    std::filesystem::create_symlink(base_ / "outside/secret.txt", root_ / "src/main.cpp");
+    EXPECT_TRUE(core::errors::is_error(
+        core::fs::MappedFile::open(core::errors::get_value(resolved))));
+    EXPECT_FALSE(core::errors::is_error(core::fs::MappedFile::open(at("src/main.cpp"))));
+}
+
+TEST_F(PathPolicyTest, CachedReadsAndWritesStayWhereThePolicyLooked) {
+    auto resolve = [&](const std::string& path, PathAccess access) {
+        auto resolved = policy_->resolve(path, access);
+        EXPECT_FALSE(core::errors::is_error(resolved)) << path;
+        return std::move(std::get<core::fs::ResolvedPath>(resolved));
+    };
+
+    // The cache, like MappedFile, will not read through a symlink swapped in
+    core::fs::FileCache cache;
+    auto checked = resolve("src/main.cpp", PathAccess::Read);
+    std::filesystem::rename(root_ / "src/main.cpp", root_ / "src/kept.cpp");
+    std::filesystem::create_symlink(base_ / "outside/secret.txt", root_ / "src/main.cpp");
+    EXPECT_TRUE(core::errors::is_error(cache.read(checked)));
+    EXPECT_EQ(*core::errors::get_value(cache.read(at("src/main.cpp"))), "secret\n");
+
+    // A write lands in the directory that was checked, even once it is moved
+    // and a symlink out of the workspace takes its name
+    auto target = resolve("src/new.txt", PathAccess::Write);
+    std::filesystem::rename(root_ / "src", root_ / "moved");
+    std::filesystem::create_directory_symlink(base_ / "outside", root_ / "src");
+    core::fs::FileTransaction transaction({false});
+    transaction.write(std::move(target), "new\n", {});
+    ASSERT_FALSE(core::errors::is_error(transaction.commit()));
+    EXPECT_TRUE(std::filesystem::exists(root_ / "moved/new.txt"));
+    EXPECT_FALSE(std::filesystem::exists(base_ / "outside/new.txt"));
+
+    // Missing parents are made along the checked path, never through a symlink
+    auto nested = resolve("gen/deep/x.txt", PathAccess::Write);
+    auto diverted = resolve("out/deep/x.txt", PathAccess::Write);
+    std::filesystem::create_directory_symlink(base_ / "outside", root_ / "out");
+    core::fs::FileTransaction made({false});
+    made.write(std::move(nested), "x\n", {});
+    ASSERT_FALSE(core::errors::is_error(made.commit()));
+    EXPECT_TRUE(std::filesystem::exists(root_ / "gen/deep/x.txt"));
+    core::fs::FileTransaction refused({false});
+    refused.write(std::move(diverted), "x\n", {});
+    EXPECT_TRUE(core::errors::is_error(refused.commit()));
+    EXPECT_FALSE(std::filesystem::exists(base_ / "outside/deep"));
+}
+
+TEST_F(PathPolicyTest, SearchAndRunCommandAskThePolicy) {
+    core::tools::SearchOptions search_options;
+    search_options.root = root_.string();
+    search_options.threads = 1;
+    search_options.policy = &*policy_;
+    core::tools::SearchTool search(search_options);
+    auto grep = [&](const nlohmann::json& args) {
+        return search.execute({"c1", "search", args.dump()});
+    };
+    auto found = grep({{"pattern", "main|TOKEN"}});
+    ASSERT_TRUE(found.success) << found.error_message;
+    auto matches = nlohmann::json::parse(found.output)["matches"];
+    ASSERT_EQ(matches.size(), 2u) << matches.dump();  // Not .env, which is denied
+    EXPECT_EQ(matches[0]["path"], "src/main.cpp");
+    EXPECT_EQ(matches[1]["path"], "vendor/main.cpp");  // Read-only is still readable
+    std::filesystem::create_symlink(base_ / "outside/secret.txt", root_ / "leak.txt");
+    found = grep({{"pattern", "secret"}});
+    EXPECT_EQ(nlohmann::json::parse(found.output)["matches"].size(), 0u);  // Not through leak.txt
+    auto outside = grep({{"pattern", "secret"}, {"path", "escape"}});
+    EXPECT_FALSE(outside.success);
+    EXPECT_NE(outside.error_message.find("outside the workspace"), std::string::npos);
+
+    core::tools::RunCommandOptions run_options;
+    run_options.working_directory = root_.string();
+    run_options.policy = &*policy_;
+    core::tools::RunCommandTool run(run_options);
+    auto pwd = [&](const std::string& cwd) {
+        return run.execute(
+            {"c2", "run_command", nlohmann::json{{"command", "pwd"}, {"cwd", cwd}}.dump()});
+    };
+    EXPECT_EQ(pwd("src").output, at("src") + "\n");
+    EXPECT_NE(pwd("vendor").error_message.find("read-only"), std::string::npos);
+    EXPECT_NE(pwd("escape").error_message.find("outside the workspace"), std::string::npos);
+
+    // A warm shell left somewhere else still runs the next command where the policy looked
+    core::exec::ShellPool shells({{}, 1});
+    run_options.shells = &shells;
+    core::tools::RunCommandTool warm(run_options);
+    auto shell = [&](const std::string& command) {
+        return warm.execute({"c3", "run_command", nlohmann::json{{"command", command}}.dump()});
+    };
+    ASSERT_TRUE(shell("cd /").success);
+    EXPECT_EQ(shell("pwd").output, root_.string() + "\n");
+
+    // If that cd fails, no later part of the command runs in the shell's old cwd
+    auto missing = [&](const std::string& command) {
+        return warm.execute({"c4", "run_command",
+                             nlohmann::json{{"command", command}, {"cwd", "not/made"}}.dump()});
+    };
+    ASSERT_TRUE(shell("cd /").success);
+    for (const char* command : {"true; pwd", "true\npwd", "true && pwd"}) {
+        auto result = missing(command);
+        EXPECT_FALSE(result.success) << command;
+        EXPECT_EQ(result.output.find("\n/\n"), std::string::npos) << result.output;
+        EXPECT_EQ(result.output.rfind("/\n", 0), std::string::npos) << result.output;
+    }
+}
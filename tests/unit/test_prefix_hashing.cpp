@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "core/loop/agent_loop.hpp"
+#include "core/tools/tool_dispatcher.hpp"
+#include "providers/canonical_request.hpp"
+#include "providers/mock_provider.hpp"
+
+using namespace agent;
+
+namespace {
+
+    protocol::Message user(const std::string& text) {
+        return protocol::Message{protocol::Role::User, text, {}, std::nullopt};
+    }
+
+    providers::CompletionRequest make_request(std::vector<protocol::Message> messages) {
+        providers::CompletionRequest request;
+        request.params.model = "test-model";
+        request.tools.push_back(
+            protocol::ToolSchema{"read_file", "Read a file", "{\"type\":\"object\"}"});
+        request.messages = std::move(messages);
+        return request;
+    }
+
+} // namespace
+
+TEST(PrefixHashingTest, BodyOfShorterHistoryIsBytePrefixOfLonger) {
+    auto shorter = providers::canonicalize(make_request({user("a"), user("b")}));
+    auto longer = providers::canonicalize(make_request({user("a"), user("b"), user("c")}));
+
+    // Everything except the closing "]}" is shared
+    std::string open = shorter.body.substr(0, shorter.body.size() - 2);
+    EXPECT_EQ(longer.body.compare(0, open.size(), open), 0);
+
+    ASSERT_EQ(longer.prefix_hashes.size(), 3u);
+    EXPECT_EQ(longer.prefix_hashes[0], shorter.prefix_hashes[0]);
+    EXPECT_EQ(longer.prefix_hashes[1], shorter.prefix_hashes[1]);
+}
+
+TEST(PrefixHashingTest, ArgumentFormattingDoesNotChangeHashes) {
+    auto with_call = [](const std::string& arguments) {
+        return make_request({user("go"), protocol::Message{protocol::Role::Assistant, "",
+                                                           {{"c1", "read_file", arguments}},
+                                                           std::nullopt}});
+    };
+    auto a = providers::canonicalize(with_call("{\"b\": 1, \"a\": 2}"));
+    auto b = providers::canonicalize(with_call("{\"a\":2,\"b\":1}"));
+    EXPECT_EQ(a.body, b.body);
+    EXPECT_EQ(a.prefix_hashes, b.prefix_hashes);
+}
+
+TEST(PrefixHashingTest, TrackerReportsFirstRewrittenMessage) {
+    providers::PrefixCacheTracker tracker;
+
+    EXPECT_FALSE(tracker.observe(providers::canonicalize(make_request({user("a")}))));
+    EXPECT_FALSE(
+        tracker.observe(providers::canonicalize(make_request({user("a"), user("b"), user("c")}))));
+
+    auto broken = tracker.observe(
+        providers::canonicalize(make_request({user("a"), user("B"), user("c"), user("d")})));
+    ASSERT_TRUE(broken);
+    EXPECT_FALSE(broken->header_changed);
+    EXPECT_EQ(broken->message_index, 1u);
+
+    // Dropping the tail keeps the surviving prefix cached
+    EXPECT_FALSE(tracker.observe(providers::canonicalize(make_request({user("a")}))));
+
+    auto changed_tools = make_request({user("a")});
+    changed_tools.tools.clear();
+    broken = tracker.observe(providers::canonicalize(changed_tools));
+    ASSERT_TRUE(broken);
+    EXPECT_TRUE(broken->header_changed);
+
+    EXPECT_EQ(tracker.requests(), 5u);
+    EXPECT_EQ(tracker.breaks(), 2u);
+}
+
+TEST(PrefixHashingTest, AgentLoopKeepsPrefixAcrossToolTurns) {
+    providers::MockProvider provider(
+        {providers::ScriptedTurn{"", {protocol::ToolCall{"c1", "missing_tool", "{}"}},
+                                 protocol::StopReason::ToolCall, std::nullopt},
+         providers::ScriptedTurn{"done", {}, protocol::StopReason::Finished, std::nullopt}});
+    core::tools::ToolDispatcher dispatcher;
+    core::loop::AgentLoop loop(provider, dispatcher, core::loop::LoopOptions{});
+
+    int breaks = 0;
+    std::vector<protocol::Message> history{user("hello")};
+    auto result = loop.run(history, [&](const protocol::AgentEvent& event) {
+        if (std::holds_alternative<protocol::PrefixCacheBreakEvent>(event)) ++breaks;
+    });
+
+    ASSERT_FALSE(core::errors::is_error(result));
+    EXPECT_EQ(breaks, 0);
+    EXPECT_EQ(loop.prefix_tracker().requests(), 2u);
+    EXPECT_EQ(loop.prefix_tracker().breaks(), 0u);
+}
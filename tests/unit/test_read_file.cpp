@@ -0,0 +1,175 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "core/fs/mapped_file.hpp"
+#include "core/fs/text_scan.hpp"
+#include "core/tools/read_file_tool.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::TempWorkspace;
+namespace fs = core::fs;
+
+namespace {
+
+    class ReadFileTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            core::tools::ReadFileOptions options;
+            options.root = dir_.string();
+            options.max_lines = 100;
+            options.max_bytes = 4096;
+            tool_ = std::make_unique<core::tools::ReadFileTool>(options);
+        }
+
+        protocol::ToolResult read(const nlohmann::json& args) {
+            return tool_->execute({"call-1", "read_file", args.dump()});
+        }
+
+        TempWorkspace dir_{"read_file_test"};
+        std::unique_ptr<core::tools::ReadFileTool> tool_;
+    };
+
+    std::string numbered_lines(int count) {
+        std::string text;
+        for (int i = 1; i <= count; ++i) text += "line " + std::to_string(i) + "\n";
+        return text;
+    }
+
+} // namespace
+
+TEST(TextScanTest, FindLineStartMatchesAScalarScan) {
+    std::mt19937 rng(7);
+    std::string text;
+    for (int i = 0; i < 5000; ++i) {
+        text += rng() % 9 == 0 ? '\n' : static_cast<char>('a' + rng() % 26);
+    }
+
+    std::size_t line = 0;
+    for (std::size_t pos = 0; pos <= text.size(); ++pos) {
+        if (pos == 0 || text[pos - 1] == '\n') {
+            ASSERT_EQ(fs::find_line_start(text, line), pos) << "line " << line;
+            ++line;
+        }
+    }
+    EXPECT_EQ(fs::count_newlines(text), line - 1);
+    EXPECT_EQ(fs::find_line_start(text, line + 10), text.size());
+}
+
+TEST(TextScanTest, ValidatesUtf8AndSniffsEncoding) {
+    EXPECT_TRUE(fs::is_valid_utf8(std::string(40, 'a') + "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80"));
+    EXPECT_FALSE(fs::is_valid_utf8(std::string(40, 'a') + "\xC3"));       // Truncated
+    EXPECT_FALSE(fs::is_valid_utf8("\xC0\xAF"));                          // Overlong
+    EXPECT_FALSE(fs::is_valid_utf8("\xED\xA0\x80"));                      // Surrogate
+
+    EXPECT_EQ(fs::sniff_encoding("plain text\n"), fs::Encoding::Utf8);
+    EXPECT_EQ(fs::sniff_encoding("caf\xE9\n"), fs::Encoding::Latin1);
+    EXPECT_EQ(fs::sniff_encoding(std::string("ELF\0\1", 5)), fs::Encoding::Binary);
+    EXPECT_EQ(fs::sniff_encoding("\xFF\xFEh\0i\0"), fs::Encoding::Utf16);
+}
+
+TEST(TextScanTest, CharacterAcrossTheSniffWindowIsStillUtf8) {
+    // Each of 2, 3 and 4 byte characters, cut after every byte but its last
+    for (std::string character : {"\xC3\xA9", "\xE6\x97\xA5", "\xF0\x9F\x98\x80"}) {
+        for (std::size_t cut = 1; cut < character.size(); ++cut) {
+            std::string text(fs::kSniffBytes - cut, 'a');
+            text += character + "tail\n";
+            EXPECT_EQ(fs::sniff_encoding(text), fs::Encoding::Utf8)
+                << character.size() << "-byte character cut after " << cut;
+        }
+    }
+    // A stray continuation byte at the edge is still not UTF-8
+    EXPECT_EQ(fs::sniff_encoding(std::string(fs::kSniffBytes - 1, 'a') + "\xA9"),
+              fs::Encoding::Latin1);
+}
+
+TEST_F(ReadFileTest, ReadsSmallFilesWhole) {
+    dir_.write("small.txt", "hello\nworld\n");
+    auto result = read({{"path", "small.txt"}});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "hello\nworld\n");
+}
+
+TEST_F(ReadFileTest, LineRangesInAMappedFile) {
+    dir_.write("big.txt", numbered_lines(20000));  // Well past the mmap threshold
+    auto file = fs::MappedFile::open((dir_ / "big.txt").string());
+    ASSERT_FALSE(core::errors::is_error(file));
+    EXPECT_TRUE(core::errors::get_value(file).mapped());
+
+    auto result = read({{"path", "big.txt"}, {"start_line", 15000}, {"end_line", 15002}});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output,
+              "line 15000\nline 15001\nline 15002\n"
+              "[Showing lines 15000-15002 of 20000; continue with start_line=15003]");
+
+    // Without a range the line cap applies
+    result = read({{"path", "big.txt"}});
+    EXPECT_EQ(result.output.substr(0, 14), "line 1\nline 2\n");
+    EXPECT_NE(result.output.find("[Showing lines 1-100 of 20000;"), std::string::npos);
+
+    result = read({{"path", "big.txt"}, {"start_line", 20001}});
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error_message.find("20000 lines"), std::string::npos);
+}
+
+TEST_F(ReadFileTest, ByteBudgetCutsAtALineEnd) {
+    std::string line(1000, 'x');
+    dir_.write("wide.txt", line + "\n" + line + "\n" + line + "\n" + line + "\n" + line + "\n");
+    auto result = read({{"path", "wide.txt"}});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output.find("[Showing lines 1-4 of 5; continue with start_line=5]"),
+              4 * 1001u);
+}
+
+TEST_F(ReadFileTest, LineLongerThanTheBudgetContinuesByOffset) {
+    // 4095 bytes of 'x' and then a 2-byte character straddling the budget
+    dir_.write("long.txt", "short\n" + std::string(4095, 'x') + "\xC3\xA9 tail\nnext\n");
+    auto result = read({{"path", "long.txt"}, {"start_line", 2}});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output.find_first_not_of('x'), 4095u);
+    EXPECT_EQ(result.output.substr(4095), "\n[Showing bytes 6-4101 of 4114, part of line 2; "
+                                          "continue with byte_offset=4101]");
+
+    result = read({{"path", "long.txt"}, {"byte_offset", 4101}});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output.substr(0, 8), "\xC3\xA9 tail\n");
+}
+
+TEST_F(ReadFileTest, ByteRangesStayOnCharacterBoundaries) {
+    dir_.write("utf8.txt", "ab\xC3\xA9\xC3\xA9z");  // "abeez" with two 2-byte e-acute
+    auto result = read({{"path", "utf8.txt"}, {"byte_offset", 3}, {"byte_length", 3}});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "\xC3\xA9\n[Showing bytes 4-6 of 7]");
+}
+
+TEST_F(ReadFileTest, Utf8PastTheSniffWindowIsNotDecodedAsLatin1) {
+    std::string text;
+    // Ten-byte lines: the character at bytes 8190-8192 crosses the sniff window
+    while (text.size() < 9000) text += "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\n";
+    dir_.write("japanese.txt", text);
+    auto result = read({{"path", "japanese.txt"}, {"end_line", 2}});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output.find("Latin-1"), std::string::npos);
+    EXPECT_EQ(result.output.substr(0, 20), text.substr(0, 20));
+}
+
+TEST_F(ReadFileTest, DecodesLatin1AndRefusesBinary) {
+    dir_.write("latin1.txt", "caf\xE9\n");
+    auto result = read({{"path", "latin1.txt"}});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "caf\xC3\xA9\n[decoded as Latin-1]");
+
+    dir_.write("blob.bin", std::string("\x7F" "ELF\0\0\0", 7));
+    result = read({{"path", "blob.bin"}});
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error_message.find("Binary file"), std::string::npos);
+
+    result = read({{"path", "missing.txt"}});
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error_message.find("No such file"), std::string::npos);
+
+    result = read({{"path", "latin1.txt"}, {"start_line", 1}, {"byte_offset", 0}});
+    EXPECT_FALSE(result.success);
+}
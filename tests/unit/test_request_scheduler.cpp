@@ -0,0 +1,172 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "providers/request_scheduler.hpp"
+#include "byte_tokenizer.hpp"
+
+using namespace agent;
+using agent::testing::byte_tokenizer;
+using providers::Priority;
+using providers::RateLimits;
+using providers::RequestScheduler;
+
+namespace {
+
+    double elapsed_ms(std::chrono::steady_clock::time_point since) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since)
+            .count();
+    }
+
+    // Records the order in which acquire() let requests through
+    class AdmissionLog {
+    public:
+        void add(const std::string& who) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            order_.push_back(who);
+        }
+        std::vector<std::string> order() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return order_;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::vector<std::string> order_;
+    };
+
+    class FixedProvider : public providers::Provider {
+    public:
+        std::optional<std::string> error;
+
+        core::errors::Result<providers::CompletionResponse> complete(
+            const providers::CompletionRequest&, const providers::EventSink&) override {
+            if (error) {
+                return core::errors::AgentError{core::errors::ErrorCategory::Provider, *error};
+            }
+            return providers::CompletionResponse{
+                protocol::Message{protocol::Role::Assistant, "ok", {}, std::nullopt},
+                protocol::StopReason::Finished};
+        }
+    };
+
+} // namespace
+
+TEST(RequestSchedulerTest, PacesRequestsToTheQuota) {
+    RateLimits limits;
+    limits.requests_per_minute = 6000;  // 100 per second
+    limits.burst_seconds = 0.05;        // 5 at once
+    RequestScheduler scheduler(limits);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 25; ++i) scheduler.acquire("s", Priority::Interactive, 0);
+    double ms = elapsed_ms(start);
+    EXPECT_GE(ms, 150.0);  // 20 past the burst at 10ms each
+    EXPECT_LT(ms, 1000.0);
+    EXPECT_GE(scheduler.stats().delayed, 15u);
+    EXPECT_EQ(scheduler.stats().admitted, 25u);
+}
+
+TEST(RequestSchedulerTest, SettlingRefundsUnusedTokens) {
+    RateLimits limits;
+    limits.tokens_per_minute = 60000;  // 1000 per second
+    limits.burst_seconds = 0.1;        // 100 at once
+    RequestScheduler scheduler(limits);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 5; ++i) {
+        scheduler.acquire("s", Priority::Interactive, 100);
+        scheduler.settle(100, 10);
+    }
+    EXPECT_LT(elapsed_ms(start), 100.0);  // Each request paid 10 of its 100
+    EXPECT_EQ(scheduler.stats().tokens, 50u);
+
+    // Without the refunds the bucket has to refill between requests
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 3; ++i) scheduler.acquire("s", Priority::Interactive, 100);
+    EXPECT_GE(elapsed_ms(start), 150.0);
+}
+
+TEST(RequestSchedulerTest, InteractiveGoesFirstAndSessionsTakeTurns) {
+    RateLimits limits;
+    limits.requests_per_minute = 1200;  // One every 50ms, no burst
+    limits.burst_seconds = 0.0;
+    RequestScheduler scheduler(limits);
+    scheduler.acquire("warmup", Priority::Interactive, 0);  // Empties the bucket
+
+    AdmissionLog log;
+    std::vector<std::thread> threads;
+    auto submit = [&](const std::string& session, Priority priority, const std::string& tag) {
+        threads.emplace_back([&, session, priority, tag] {
+            scheduler.acquire(session, priority, 10);
+            log.add(tag);
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));  // Fix the arrival order
+    };
+    submit("batch", Priority::Background, "background");
+    for (int i = 0; i < 3; ++i) submit("a", Priority::Interactive, "a");
+    submit("b", Priority::Interactive, "b");
+    for (auto& thread : threads) thread.join();
+
+    // "b" arrived last but does not wait behind all of "a"
+    auto order = log.order();
+    ASSERT_EQ(order.size(), 5u);
+    EXPECT_EQ(order.back(), "background");
+    EXPECT_NE(order[2], "b");
+    EXPECT_NE(order[3], "b");
+}
+
+TEST(RequestSchedulerTest, ProviderIsChargedWhatItUsed) {
+    RateLimits limits;
+    limits.tokens_per_minute = 600000;
+    RequestScheduler scheduler(limits);
+    FixedProvider upstream;
+    core::context::TokenEstimator estimator(byte_tokenizer());
+    providers::ScheduledProvider provider(upstream, scheduler, estimator, "session");
+
+    providers::CompletionRequest request;
+    request.messages.push_back({protocol::Role::User, "Hello there", {}, std::nullopt});
+    request.tools.push_back({"read_file", "Read a file", "{}"});
+    request.params.max_output_tokens = 1000;
+    std::size_t prompt = estimator.count(request.messages[0]) + estimator.count(request.tools[0]);
+    EXPECT_EQ(provider.estimate(request), prompt);
+
+    ASSERT_FALSE(core::errors::is_error(provider.complete(request, {})));
+    std::size_t reply =
+        estimator.count(protocol::Message{protocol::Role::Assistant, "ok", {}, std::nullopt});
+    EXPECT_EQ(scheduler.stats().tokens, prompt + reply);
+
+    // A 429 is not charged, and holds back whatever comes next
+    upstream.error = "HTTP 429: Too Many Requests";
+    EXPECT_TRUE(core::errors::is_error(provider.complete(request, {})));
+    EXPECT_EQ(scheduler.stats().throttled, 1u);
+    EXPECT_EQ(scheduler.stats().tokens, prompt + reply);
+}
+
+TEST(RequestSchedulerTest, OnlyAWholeStatusCountsAsThrottling) {
+    RequestScheduler scheduler(RateLimits{});
+    FixedProvider upstream;
+    core::context::TokenEstimator estimator(byte_tokenizer());
+    providers::ScheduledProvider provider(upstream, scheduler, estimator, "session");
+    providers::CompletionRequest request;
+    request.messages.push_back({protocol::Role::User, "Hi", {}, std::nullopt});
+
+    for (const char* error : {"HTTP 429", "HTTP/1.1 429 Too Many Requests", "status: 429",
+                              "upstream returned status_code=429", "Rate limit reached"}) {
+        upstream.error = error;
+        std::size_t before = scheduler.stats().throttled;
+        EXPECT_TRUE(core::errors::is_error(provider.complete(request, {})));
+        EXPECT_EQ(scheduler.stats().throttled, before + 1) << error;
+    }
+
+    // The digits alone, inside ids, sizes or other statuses, are not a 429
+    for (const char* error : {"request req_4291 failed", "HTTP 4290", "HTTP 500 after 429 bytes",
+                              "context of 1429 tokens is too long", "status 1429"}) {
+        upstream.error = error;
+        std::size_t before = scheduler.stats().throttled;
+        EXPECT_TRUE(core::errors::is_error(provider.complete(request, {})));
+        EXPECT_EQ(scheduler.stats().throttled, before) << error;
+    }
+}
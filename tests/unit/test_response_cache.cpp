@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "providers/canonical_request.hpp"
+#include "providers/mock_provider.hpp"
+#include "providers/response_cache.hpp"
+
+using namespace agent;
+namespace errors = agent::core::errors;
+
+namespace {
+
+    providers::CompletionRequest make_request(const std::string& prompt) {
+        providers::CompletionRequest request;
+        request.params.model = "test-model";
+        request.tools.push_back(
+            protocol::ToolSchema{"read_file", "Read a file", "{\"type\":\"object\"}"});
+        request.messages.push_back(
+            protocol::Message{protocol::Role::User, prompt, {}, std::nullopt});
+        return request;
+    }
+
+    std::string stream_of(providers::Provider& provider,
+                          const providers::CompletionRequest& request, bool& ok) {
+        std::string transcript;
+        auto result = provider.complete(request, [&](const protocol::AgentEvent& event) {
+            if (auto* text = std::get_if<protocol::MessageDeltaEvent>(&event)) {
+                transcript += "T:" + text->delta_text + "|";
+            } else if (auto* call = std::get_if<protocol::ToolCallDeltaEvent>(&event)) {
+                transcript += "C:" + call->name + call->arguments_delta + "|";
+            }
+        });
+        ok = !errors::is_error(result);
+        return transcript;
+    }
+
+    // Streams one event of every type, so each must survive the recording
+    class EveryEventProvider : public providers::Provider {
+    public:
+        std::vector<protocol::AgentEvent> events{
+            protocol::AgentStartEvent{"run-1"},
+            protocol::TurnStartEvent{},
+            protocol::MessageDeltaEvent{"hello"},
+            protocol::ToolCallDeltaEvent{2, "c1", "read_file", "{\"pa"},
+            protocol::PrefixCacheBreakEvent{true, 3},
+            protocol::ContextCompactedEvent{900, 400},
+            protocol::ToolExecutionStartEvent{"read_file"},
+            protocol::ToolExecutionEndEvent{false},
+            protocol::AgentEndEvent{protocol::StopReason::MaxTokens}};
+        std::size_t calls = 0;
+
+        errors::Result<providers::CompletionResponse> complete(
+            const providers::CompletionRequest&, const providers::EventSink& on_event) override {
+            ++calls;
+            for (const auto& event : events) on_event(event);
+            return providers::CompletionResponse{
+                protocol::Message{protocol::Role::Assistant, "hello", {}, std::nullopt},
+                protocol::StopReason::Finished};
+        }
+    };
+
+    // Every field of an event, as text, so two streams compare with ==
+    std::string describe(const protocol::AgentEvent& event) {
+        return std::to_string(event.index()) + ":" + std::visit([](const auto& e) -> std::string {
+            using E = std::decay_t<decltype(e)>;
+            if constexpr (std::is_same_v<E, protocol::AgentStartEvent>) return e.run_id;
+            if constexpr (std::is_same_v<E, protocol::MessageDeltaEvent>) return e.delta_text;
+            if constexpr (std::is_same_v<E, protocol::ToolCallDeltaEvent>) {
+                return std::to_string(e.index) + e.id + e.name + e.arguments_delta;
+            }
+            if constexpr (std::is_same_v<E, protocol::PrefixCacheBreakEvent>) {
+                return std::to_string(e.header_changed) + std::to_string(e.message_index);
+            }
+            if constexpr (std::is_same_v<E, protocol::ContextCompactedEvent>) {
+                return std::to_string(e.tokens_before) + "/" + std::to_string(e.tokens_after);
+            }
+            if constexpr (std::is_same_v<E, protocol::ToolExecutionStartEvent>) return e.tool_name;
+            if constexpr (std::is_same_v<E, protocol::ToolExecutionEndEvent>) {
+                return std::to_string(e.success);
+            }
+            if constexpr (std::is_same_v<E, protocol::AgentEndEvent>) {
+                return providers::to_string(e.reason);
+            }
+            return "";
+        }, event);
+    }
+
+    class ResponseCacheTest : public ::testing::Test {
+    protected:
+        std::string dir = ::testing::TempDir() + "response_cache_test";
+        void SetUp() override { std::filesystem::remove_all(dir); }
+        void TearDown() override { std::filesystem::remove_all(dir); }
+    };
+
+} // namespace
+
+TEST(CanonicalRequestTest, KeyIgnoresArgumentFormattingButNotContent) {
+    auto a = make_request("hi");
+    auto b = make_request("hi");
+    a.messages.push_back(protocol::Message{protocol::Role::Assistant, "",
+                                           {{"c1", "read_file", "{\"b\": 1, \"a\": 2}"}},
+                                           std::nullopt});
+    b.messages.push_back(protocol::Message{protocol::Role::Assistant, "",
+                                           {{"c1", "read_file", "{\"a\":2,\"b\":1}"}},
+                                           std::nullopt});
+    EXPECT_EQ(providers::request_key(a), providers::request_key(b));
+
+    b.params.temperature = 0.7;
+    EXPECT_NE(providers::request_key(a), providers::request_key(b));
+}
+
+TEST_F(ResponseCacheTest, ReplaysRecordedStreamWithoutCallingUpstream) {
+    providers::ScriptedTurn turn{"Looking at it now.",
+                                 {protocol::ToolCall{"c1", "read_file", "{\"path\": \"a.cpp\"}"}},
+                                 protocol::StopReason::ToolCall,
+                                 std::nullopt};
+    // Only one scripted turn: a second upstream call would fail
+    providers::MockProvider upstream({turn});
+    providers::CachingProvider cache(upstream, providers::ResponseCacheOptions{dir});
+
+    bool ok = false;
+    std::string live = stream_of(cache, make_request("fix it"), ok);
+    ASSERT_TRUE(ok);
+    std::string replayed = stream_of(cache, make_request("fix it"), ok);
+    ASSERT_TRUE(ok);
+
+    EXPECT_EQ(live, replayed);
+    EXPECT_EQ(upstream.turns_served(), 1u);
+    EXPECT_EQ(cache.stats().hits, 1u);
+    EXPECT_EQ(cache.stats().writes, 1u);
+    EXPECT_TRUE(std::filesystem::exists(cache.path_for(make_request("fix it"))));
+}
+
+TEST_F(ResponseCacheTest, ReplaysEveryEventType) {
+    EveryEventProvider upstream;
+    providers::CachingProvider cache(upstream, providers::ResponseCacheOptions{dir});
+    ASSERT_EQ(upstream.events.size(), std::variant_size_v<protocol::AgentEvent>);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<std::string> seen;
+        auto result = cache.complete(make_request("all"), [&](const protocol::AgentEvent& event) {
+            seen.push_back(describe(event));
+        });
+        ASSERT_FALSE(errors::is_error(result));
+        ASSERT_EQ(seen.size(), upstream.events.size()) << pass;
+        for (std::size_t i = 0; i < seen.size(); ++i) {
+            EXPECT_EQ(seen[i], describe(upstream.events[i])) << pass;
+        }
+    }
+    EXPECT_EQ(upstream.calls, 1u);
+    EXPECT_EQ(cache.stats().hits, 1u);
+}
+
+TEST_F(ResponseCacheTest, OfflineMissIsAProviderError) {
+    providers::MockProvider upstream({});
+    providers::ResponseCacheOptions options{dir};
+    options.offline = true;
+    providers::CachingProvider cache(upstream, options);
+
+    auto result = cache.complete(make_request("never seen"), [](const protocol::AgentEvent&) {});
+    ASSERT_TRUE(errors::is_error(result));
+    EXPECT_EQ(errors::get_error(result).category, errors::ErrorCategory::Provider);
+}
+
+TEST_F(ResponseCacheTest, DoesNotCacheFailures) {
+    providers::ScriptedTurn failing;
+    failing.error = "overloaded";
+    providers::MockProvider upstream({failing}, {}, true);
+    providers::CachingProvider cache(upstream, providers::ResponseCacheOptions{dir});
+
+    bool ok = true;
+    stream_of(cache, make_request("x"), ok);
+    EXPECT_FALSE(ok);
+    stream_of(cache, make_request("x"), ok);
+    EXPECT_EQ(upstream.turns_served(), 2u);
+    EXPECT_EQ(cache.stats().writes, 0u);
+}
+
+TEST_F(ResponseCacheTest, CorruptEntryIsAMissNotACrash) {
+    providers::ScriptedTurn turn{"Looking.", {}, protocol::StopReason::Finished, std::nullopt};
+    providers::MockProvider upstream({turn}, {}, true);
+    providers::CachingProvider cache(upstream, providers::ResponseCacheOptions{dir});
+    auto request = make_request("fix it");
+    bool ok = false;
+    stream_of(cache, request, ok);
+    ASSERT_TRUE(ok);
+
+    std::string path = cache.path_for(request);
+    std::stringstream original;
+    original << std::ifstream(path).rdbuf();
+    const char* corruptions[][2] = {{"/version", "\"1\""},
+                                    {"/request", "5"},
+                                    {"/stop_reason", "null"},
+                                    {"/message/content", "7"},
+                                    {"/events", "{}"},
+                                    {"/events/0/t", "\"soon\""},
+                                    {"/events/0/text", "[]"},
+                                    {"/events/0/type", "\"bogus\""}};
+    std::size_t served = upstream.turns_served();
+    for (const auto& [pointer, value] : corruptions) {
+        auto json = nlohmann::json::parse(original.str());
+        json[nlohmann::json::json_pointer(pointer)] = nlohmann::json::parse(value);
+        std::ofstream(path, std::ios::trunc) << json.dump();
+
+        std::string replayed = stream_of(cache, request, ok);
+        EXPECT_TRUE(ok) << pointer;
+        EXPECT_EQ(replayed, "T:Looking.|") << pointer;
+        EXPECT_EQ(upstream.turns_served(), ++served) << pointer;  // Upstream answered it
+    }
+    EXPECT_EQ(cache.stats().hits, 0u);
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "core/search/grep.hpp"
+#include "core/search/literal_finder.hpp"
+#include "core/search/regex.hpp"
+#include "core/tools/search_tool.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::TempWorkspace;
+using core::search::LiteralFinder;
+using core::search::Regex;
+using core::search::RegexOptions;
+
+namespace {
+
+    Regex compile(const std::string& pattern, RegexOptions options = {}) {
+        auto regex = Regex::compile(pattern, options);
+        EXPECT_FALSE(core::errors::is_error(regex)) << pattern;
+        return std::move(std::get<Regex>(regex));
+    }
+
+    // Leftmost match start according to std::regex, or npos
+    std::size_t reference_find(const std::string& pattern, const std::string& line,
+                               bool icase = false) {
+        auto flags = std::regex::ECMAScript | (icase ? std::regex::icase : std::regex::flag_type{});
+        std::smatch match;
+        if (!std::regex_search(line, match, std::regex(pattern, flags))) return std::string::npos;
+        return static_cast<std::size_t>(match.position(0));
+    }
+
+} // namespace
+
+TEST(RegexTest, AgreesWithStdRegex) {
+    std::vector<std::string> patterns = {
+        "foo",        "fo+",          "^foo",         "bar$",          "a.c",
+        "[a-c]+x",    "[^a-z ]+",     "\\d{2,3}",     "colou?r",       "(cat|dog)s?",
+        "\\bint\\b",  "\\Bnt",        "\\w+\\(",      "\\s+$",         "(?:ab){2}",
+        "x{3}",       "a{2,}b",       "^$",           "[.]h",          "\\.cpp$",
+        "(a|ab)(c|bcd)", "TODO|FIXME", "^\\s*#include", "[[:digit:]]+", "a*"};
+    std::vector<std::string> lines = {
+        "",           "foo",          "  foo bar",    "xfoo",          "the bar",
+        "abc",        "aac abcx",     "int x = 12345;", "colour color", "cats and dog",
+        "print(int)", "  \t",         "ababab",       "xxxx",          "aab",
+        "main.cpp",   "file.h",       "#include <x>", "  #include",    "abcd",
+        "// TODO: fix", "internal",   "FIXME later",  "a1b22c333",     "dogs"};
+
+    for (const auto& pattern : patterns) {
+        auto regex = compile(pattern);
+        auto matcher = regex.matcher();
+        std::string ecma = pattern == "[[:digit:]]+" ? "[0-9]+" : pattern;
+        for (const auto& line : lines) {
+            EXPECT_EQ(matcher.find(line), reference_find(ecma, line))
+                << "pattern " << pattern << " line \"" << line << "\"";
+        }
+    }
+}
+
+TEST(RegexTest, CaseInsensitiveAndLiteralModes) {
+    RegexOptions icase;
+    icase.case_insensitive = true;
+    auto regex = compile("hello\\s+WORLD", icase);
+    auto matcher = regex.matcher();
+    EXPECT_EQ(matcher.find("say HeLLo   world"), 4u);
+    EXPECT_EQ(matcher.find("hello-world"), std::string::npos);
+
+    RegexOptions literal;
+    literal.literal = true;
+    auto fixed = compile("a.b*(c)", literal);
+    EXPECT_TRUE(fixed.is_literal());
+    EXPECT_EQ(fixed.required_literal(), "a.b*(c)");
+    auto fixed_matcher = fixed.matcher();
+    EXPECT_EQ(fixed_matcher.find("x a.b*(c)"), 2u);
+    EXPECT_EQ(fixed_matcher.find("aXbbc"), std::string::npos);
+}
+
+TEST(RegexTest, ExtractsRequiredLiterals) {
+    EXPECT_EQ(compile("foo.*barbaz").required_literal(), "barbaz");
+    EXPECT_EQ(compile("(a|b)cdef").required_literal(), "cdef");
+    EXPECT_EQ(compile("x+yz").required_literal(), "xyz");
+    EXPECT_EQ(compile("get_\\w+_count").required_literal(), "_count");
+    EXPECT_EQ(compile("a|b").required_literal(), "");
+    EXPECT_TRUE(compile("plain_name").is_literal());
+    EXPECT_FALSE(compile("^plain").is_literal());
+}
+
+TEST(RegexTest, RejectsMalformedPatterns) {
+    for (const char* bad : {"a(b", "a)b", "*a", "[abc", "a{3,2}", "x{5000}", "\\q", "a\\"}) {
+        auto regex = Regex::compile(bad);
+        ASSERT_TRUE(core::errors::is_error(regex)) << bad;
+        EXPECT_EQ(core::errors::get_error(regex).category, core::errors::ErrorCategory::Input);
+    }
+}
+
+TEST(RegexTest, StateExplosionFlushesTheCacheButStaysCorrect) {
+    // The DFA for "the 12th byte from the end is an a" needs thousands of states
+    std::string pattern = "(a|b)*a(a|b){12}$";
+    auto regex = compile(pattern);
+    auto matcher = regex.matcher();
+    std::mt19937 rng(3);
+    for (int i = 0; i < 200; ++i) {
+        std::string line;
+        for (int k = 0; k < 200; ++k) line += rng() % 2 ? 'a' : 'b';
+        ASSERT_EQ(matcher.matches(line), line[line.size() - 13] == 'a');
+        EXPECT_LE(matcher.state_count(), Regex::Matcher::kMaxStates);
+    }
+}
+
+TEST(RegexTest, ScanFindsTheFirstMatchingLine) {
+    std::string text = "alpha\nbeta end\n\ngamma\nend";
+    auto end = compile("end$");
+    auto matcher = end.matcher();
+    std::size_t hit = matcher.scan(text, 0);
+    ASSERT_NE(hit, std::string::npos);
+    EXPECT_GE(hit, text.find("beta"));
+    EXPECT_LE(hit, text.find('\n', text.find("beta")));
+
+    // The last line has no newline and is only settled at the end of the text
+    std::size_t next = matcher.scan(text, text.find("gamma"));
+    EXPECT_EQ(next, text.size() - 1);
+
+    // An empty line matches ^$, but a trailing newline does not add one
+    auto empty = compile("^$");
+    auto empty_matcher = empty.matcher();
+    EXPECT_EQ(empty_matcher.scan(text, 0), text.find("\n\n") + 1);
+    EXPECT_EQ(empty_matcher.scan("a\nb\n", 0), std::string::npos);
+}
+
+TEST(LiteralFinderTest, MatchesStringFind) {
+    std::mt19937 rng(11);
+    std::string hay;
+    for (int i = 0; i < 4000; ++i) hay += static_cast<char>('a' + rng() % 4);
+    for (const char* needle : {"a", "ab", "abc", "dcba", "abcdabcd", "zz"}) {
+        LiteralFinder finder(needle);
+        for (std::size_t from : {0u, 1u, 17u, 1000u, 3990u, 4000u}) {
+            EXPECT_EQ(finder.find(hay, from), hay.find(needle, from)) << needle << " " << from;
+        }
+    }
+}
+
+namespace {
+
+    class SearchToolTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            root_.write("src/a.cpp", "int main() {\n    return compute(1);\n}\n");
+            root_.write("src/b.cpp", "// compute helpers\nint compute(int x) { return x; }\n");
+            root_.write("src/notes.txt", "compute later\n");
+            root_.write("build/gen.cpp", "int compute_generated();\n");
+            root_.write(".gitignore", "build/\n");
+            root_.write("blob.bin", std::string("compute\0\0", 9));
+        }
+
+        nlohmann::json search(const nlohmann::json& args) {
+            core::tools::SearchOptions options;
+            options.root = root_.string();
+            options.threads = 2;
+            core::tools::SearchTool tool(options);
+            auto result = tool.execute({"c1", "search", args.dump()});
+            EXPECT_TRUE(result.success) << result.error_message;
+            return nlohmann::json::parse(result.output);
+        }
+
+        TempWorkspace root_{"search_test"};
+    };
+
+} // namespace
+
+TEST_F(SearchToolTest, ReportsSortedMatchesWithPositions) {
+    auto output = search({{"pattern", "compute\\("}});
+    auto& matches = output["matches"];
+    ASSERT_EQ(matches.size(), 2u);
+    EXPECT_EQ(matches[0]["path"], "src/a.cpp");
+    EXPECT_EQ(matches[0]["line"], 2);
+    EXPECT_EQ(matches[0]["column"], 12);
+    EXPECT_EQ(matches[0]["text"], "    return compute(1);");
+    EXPECT_EQ(matches[1]["path"], "src/b.cpp");
+    EXPECT_EQ(matches[1]["line"], 2);
+    EXPECT_EQ(matches[1]["column"], 5);
+    EXPECT_FALSE(output["truncated"].get<bool>());
+}
+
+TEST_F(SearchToolTest, GlobContextLiteralAndTruncation) {
+    auto output = search({{"pattern", "compute"}, {"glob", "*.txt"}});
+    ASSERT_EQ(output["matches"].size(), 1u);
+    EXPECT_EQ(output["matches"][0]["path"], "src/notes.txt");
+
+    output = search({{"pattern", "return"}, {"glob", "a.cpp"}, {"context", 1}});
+    auto& match = output["matches"][0];
+    EXPECT_EQ(match["before"], nlohmann::json::array({"int main() {"}));
+    EXPECT_EQ(match["after"], nlohmann::json::array({"}"}));
+
+    output = search({{"pattern", "compute(1)"}, {"literal", true}});
+    EXPECT_EQ(output["matches"].size(), 1u);
+
+    output = search({{"pattern", "COMPUTE"}, {"case_insensitive", true}, {"max_results", 2}});
+    EXPECT_EQ(output["matches"].size(), 2u);
+    EXPECT_TRUE(output["truncated"].get<bool>());
+}
+
+TEST_F(SearchToolTest, BadPatternIsAToolFailure) {
+    core::tools::SearchOptions options;
+    options.root = root_.string();
+    core::tools::SearchTool tool(options);
+    auto result = tool.execute({"c1", "search", R"({"pattern":"(unclosed"})"});
+    EXPECT_FALSE(result.success);
+    EXPECT_NE(result.error_message.find("Invalid regex"), std::string::npos);
+}
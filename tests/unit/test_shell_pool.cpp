@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "core/exec/shell_pool.hpp"
+#include "core/tools/run_command_tool.hpp"
+
+using namespace agent;
+using core::exec::CommandResult;
+using core::exec::ShellPool;
+using core::exec::ShellPoolOptions;
+
+namespace {
+
+    CommandResult run(ShellPool& pool, const std::string& command, int timeout_ms = 10000) {
+        auto result = pool.run(command, timeout_ms);
+        EXPECT_FALSE(core::errors::is_error(result));
+        return std::get<CommandResult>(result);
+    }
+
+    // Three pipes fit under the limit, the epoll instance after them does not
+    [[noreturn]] void start_out_of_descriptors() {
+        for (int fd = 3; fd < 1024; ++fd) ::close(fd);
+        rlimit limit{9, 9};
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+        auto session = core::exec::ShellSession::start({});
+        bool ok = core::errors::is_error(session) &&
+                  core::errors::get_error(session).category ==
+                      core::errors::ErrorCategory::Execution &&
+                  core::errors::get_error(session).message.rfind("epoll_create1", 0) == 0;
+        std::_Exit(ok ? 0 : 1);
+    }
+
+} // namespace
+
+TEST(ShellPoolTest, StateCarriesOverBetweenCommands) {
+    ShellPool pool;
+    auto dir = std::filesystem::temp_directory_path().string();
+
+    EXPECT_EQ(run(pool, "cd " + dir + " && export AGENT_TEST_VAR=warm").exit_code, 0);
+    EXPECT_EQ(run(pool, "pwd").stdout_text, dir + "\n");
+    EXPECT_EQ(run(pool, "echo $AGENT_TEST_VAR").stdout_text, "warm\n");
+
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.started, 1u);
+    EXPECT_EQ(stats.reused, 2u);
+}
+
+TEST(ShellPoolTest, CapturesExitCodeAndStreams) {
+    ShellPool pool;
+    auto result = run(pool, "echo out; echo err >&2; false");
+    EXPECT_EQ(result.exit_code, 1);
+    EXPECT_EQ(result.stdout_text, "out\n");
+    EXPECT_EQ(result.stderr_text, "err\n");
+
+    // Output without a trailing newline must not swallow the sentinel
+    result = run(pool, "printf partial; printf oops >&2; (exit 7)");
+    EXPECT_EQ(result.exit_code, 7);
+    EXPECT_EQ(result.stdout_text, "partial");
+    EXPECT_EQ(result.stderr_text, "oops");
+
+    // A syntax error fails the command, not the session
+    result = run(pool, "if then fi");
+    EXPECT_NE(result.exit_code, 0);
+    EXPECT_EQ(run(pool, "echo still here").stdout_text, "still here\n");
+    EXPECT_EQ(pool.stats().started, 1u);
+}
+
+TEST(ShellPoolTest, CommandsDoNotReadTheControlStream) {
+    ShellPool pool;
+    auto result = run(pool, "cat; echo after");
+    EXPECT_EQ(result.stdout_text, "after\n");
+    EXPECT_EQ(result.exit_code, 0);
+}
+
+TEST(ShellPoolTest, ExitReplacesTheSession) {
+    ShellPool pool;
+    auto result = run(pool, "echo bye; exit 4");
+    EXPECT_EQ(result.exit_code, 4);
+    EXPECT_EQ(result.stdout_text, "bye\n");
+
+    EXPECT_EQ(run(pool, "echo fresh").stdout_text, "fresh\n");
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.started, 2u);
+    EXPECT_EQ(stats.replaced, 1u);
+}
+
+TEST(ShellPoolTest, ClosingAStreamRetiresTheSession) {
+    ShellPoolOptions options;
+    options.shell.kill_grace_ms = 200;
+    ShellPool pool(options);
+
+    for (const char* command : {"exec 2>/dev/null; echo hi", "exec 2>&-\necho hi"}) {
+        auto start = std::chrono::steady_clock::now();
+        auto result = run(pool, command, 2000);
+        EXPECT_FALSE(result.timed_out) << command;
+        EXPECT_EQ(result.exit_code, 0) << command;
+        EXPECT_EQ(result.stdout_text, "hi\n") << command;
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2)) << command;
+    }
+
+    // With stdout gone the status comes from the stderr sentinel
+    auto result = run(pool, "exec >/dev/null; echo lost; (exit 3)", 2000);
+    EXPECT_FALSE(result.timed_out);
+    EXPECT_EQ(result.exit_code, 3);
+
+    EXPECT_EQ(run(pool, "echo fresh").stdout_text, "fresh\n");
+    EXPECT_EQ(pool.stats().replaced, 3u);
+}
+
+TEST(ShellPoolTest, TimeoutKillsTheSessionAndItsChildren) {
+    ShellPoolOptions options;
+    options.shell.kill_grace_ms = 200;
+    ShellPool pool(options);
+
+    auto start = std::chrono::steady_clock::now();
+    auto result = run(pool, "sleep 30 & sleep 30", 100);
+    EXPECT_TRUE(result.timed_out);
+    EXPECT_EQ(result.term_signal, SIGTERM);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+
+    EXPECT_EQ(run(pool, "echo next").stdout_text, "next\n");
+    EXPECT_EQ(pool.stats().replaced, 1u);
+}
+
+TEST(ShellPoolTest, TimeoutReportsTheKillWhenTermIsIgnored) {
+    ShellPoolOptions options;
+    options.shell.kill_grace_ms = 100;
+    ShellPool pool(options);
+
+    auto result = run(pool, "trap '' TERM; sleep 30", 100);
+    EXPECT_TRUE(result.timed_out);
+    EXPECT_EQ(result.term_signal, SIGKILL);
+    EXPECT_EQ(result.exit_code, 128 + SIGKILL);
+    EXPECT_EQ(run(pool, "echo next").stdout_text, "next\n");
+}
+
+TEST(ShellPoolTest, DescriptorExhaustionIsAnExecutionError) {
+    EXPECT_EXIT(start_out_of_descriptors(), ::testing::ExitedWithCode(0), "");
+}
+
+TEST(ShellPoolTest, ConcurrentCommandsGetSeparateShells) {
+    ShellPool pool;
+    std::vector<std::string> pids(3);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 0; i < pids.size(); ++i) {
+        threads.emplace_back([&, i] { pids[i] = run(pool, "sleep 0.2; echo $$").stdout_text; });
+    }
+    for (auto& thread : threads) thread.join();
+
+    EXPECT_NE(pids[0], pids[1]);
+    EXPECT_NE(pids[1], pids[2]);
+    EXPECT_NE(pids[0], pids[2]);
+    EXPECT_EQ(pool.stats().started, 3u);
+    EXPECT_EQ(pool.idle_count(), 3u);
+}
+
+TEST(ShellPoolTest, RunCommandToolUsesThePool) {
+    ShellPool pool;
+    core::tools::RunCommandOptions options;
+    options.shells = &pool;
+    core::tools::RunCommandTool tool(options);
+
+    auto dir = std::filesystem::temp_directory_path().string();
+    nlohmann::json args = {{"command", "export STEP=one"}};
+    EXPECT_TRUE(tool.execute({"c1", "run_command", args.dump()}).success);
+
+    args = {{"command", "echo $STEP; pwd"}, {"cwd", dir}};
+    auto result = tool.execute({"c2", "run_command", args.dump()});
+    EXPECT_TRUE(result.success);
+    EXPECT_EQ(result.output, "one\n" + dir + "\n");
+}
@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include "core/loop/agent_loop.hpp"
+#include "core/streaming/argument_parser.hpp"
+
+using namespace agent;
+using agent::core::streaming::IncrementalArgumentParser;
+
+// A read-only tool that counts how many times it actually ran
+class CountingTool : public core::tools::Tool {
+public:
+    CountingTool(std::string name, bool read_only, std::atomic<int>& runs)
+        : schema_{std::move(name), "test tool", "{}"}, read_only_(read_only), runs_(runs) {}
+
+    const protocol::ToolSchema& schema() const override { return schema_; }
+    bool is_side_effect_free() const override { return read_only_; }
+
+    protocol::ToolResult execute(const protocol::ToolCall& call) override {
+        ++runs_;
+        return protocol::ToolResult{call.id, true, "ran " + call.arguments, "", 1.0};
+    }
+
+private:
+    protocol::ToolSchema schema_;
+    bool read_only_;
+    std::atomic<int>& runs_;
+};
+
+// Streams a tool call in fragments, then (turn 2) finishes normally
+class ScriptedProvider : public providers::Provider {
+public:
+    std::string streamed_args = "{\"path\": \"a.txt\"}";
+    std::string final_args = "{\"path\":\"a.txt\"}";
+    std::string tool_name = "read_file";
+    int turns = 0;
+
+    core::errors::Result<providers::CompletionResponse> complete(
+        const providers::CompletionRequest&, const providers::EventSink& on_event) override {
+        if (turns++ > 0) {
+            return providers::CompletionResponse{
+                protocol::Message{protocol::Role::Assistant, "done", {}, std::nullopt},
+                protocol::StopReason::Finished};
+        }
+        on_event(protocol::ToolCallDeltaEvent{0, "call-1", tool_name, ""});
+        for (std::size_t i = 0; i < streamed_args.size(); i += 4) {
+            on_event(protocol::ToolCallDeltaEvent{0, "", "", streamed_args.substr(i, 4)});
+        }
+        on_event(protocol::MessageDeltaEvent{"thinking after the call..."});
+
+        protocol::Message message{protocol::Role::Assistant, "", {}, std::nullopt};
+        message.tool_calls.push_back(protocol::ToolCall{"call-1", tool_name, final_args});
+        return providers::CompletionResponse{message, protocol::StopReason::ToolCall};
+    }
+};
+
+TEST(ArgumentParserTest, DetectsCompletionAcrossFragments) {
+    IncrementalArgumentParser parser;
+    EXPECT_EQ(parser.feed("{\"a\": \"}\\\""), IncrementalArgumentParser::State::Incomplete);
+    EXPECT_EQ(parser.feed("\", \"b\": [1, {\"c\": 2}]"),
+              IncrementalArgumentParser::State::Incomplete);
+    EXPECT_EQ(parser.feed("}  "), IncrementalArgumentParser::State::Complete);
+    EXPECT_EQ(parser.feed("x"), IncrementalArgumentParser::State::Invalid);
+}
+
+TEST(ArgumentParserTest, RejectsMismatchedBrackets) {
+    IncrementalArgumentParser parser;
+    EXPECT_EQ(parser.feed("{\"a\": [1}"), IncrementalArgumentParser::State::Invalid);
+}
+
+TEST(SpeculativeExecutionTest, ReusesResultWhenFinalCallMatches) {
+    std::atomic<int> runs{0};
+    core::tools::ToolDispatcher dispatcher;
+    dispatcher.register_tool(std::make_unique<CountingTool>("read_file", true, runs));
+
+    ScriptedProvider provider;
+    core::loop::AgentLoop loop(provider, dispatcher, core::loop::LoopOptions{});
+
+    std::vector<protocol::Message> history;
+    auto result = loop.run(history, [](const protocol::AgentEvent&) {});
+
+    ASSERT_FALSE(core::errors::is_error(result));
+    EXPECT_EQ(core::errors::get_value(result), protocol::StopReason::Finished);
+    EXPECT_EQ(runs.load(), 1);
+    EXPECT_EQ(loop.speculation_stats().hits, 1u);
+
+    // assistant, tool, assistant
+    ASSERT_EQ(history.size(), 3u);
+    EXPECT_EQ(history[1].role, protocol::Role::Tool);
+    EXPECT_EQ(history[1].tool_call_id, "call-1");
+}
+
+TEST(SpeculativeExecutionTest, DiscardsResultWhenFinalCallDiffers) {
+    std::atomic<int> runs{0};
+    core::tools::ToolDispatcher dispatcher;
+    dispatcher.register_tool(std::make_unique<CountingTool>("read_file", true, runs));
+
+    ScriptedProvider provider;
+    provider.final_args = "{\"path\":\"b.txt\"}";
+    core::loop::AgentLoop loop(provider, dispatcher, core::loop::LoopOptions{});
+
+    std::vector<protocol::Message> history;
+    loop.run(history, [](const protocol::AgentEvent&) {});
+
+    // Once speculatively, once for real with the final arguments
+    EXPECT_EQ(runs.load(), 2);
+    EXPECT_EQ(loop.speculation_stats().hits, 0u);
+    EXPECT_EQ(loop.speculation_stats().discarded, 1u);
+    EXPECT_EQ(history[1].content, "ran {\"path\":\"b.txt\"}");
+}
+
+TEST(SpeculativeExecutionTest, NeverSpeculatesOnToolsWithSideEffects) {
+    std::atomic<int> runs{0};
+    core::tools::ToolDispatcher dispatcher;
+    dispatcher.register_tool(std::make_unique<CountingTool>("write_file", false, runs));
+
+    ScriptedProvider provider;
+    provider.tool_name = "write_file";
+    core::loop::AgentLoop loop(provider, dispatcher, core::loop::LoopOptions{});
+
+    std::vector<protocol::Message> history;
+    loop.run(history, [](const protocol::AgentEvent&) {});
+
+    EXPECT_EQ(runs.load(), 1);
+    EXPECT_EQ(loop.speculation_stats().launched, 0u);
+}
+
+TEST(SpeculativeExecutionTest, DiscardsReadsThatFollowAMutatingCall) {
+    std::atomic<int> reads{0}, writes{0};
+    core::tools::ToolDispatcher dispatcher;
+    dispatcher.register_tool(std::make_unique<CountingTool>("read_file", true, reads));
+    dispatcher.register_tool(std::make_unique<CountingTool>("write_file", false, writes));
+
+    // The read streams in complete, but the final message writes before it reads
+    class WriteThenRead : public providers::Provider {
+    public:
+        int turns = 0;
+        core::errors::Result<providers::CompletionResponse> complete(
+            const providers::CompletionRequest&, const providers::EventSink& on_event) override {
+            if (turns++ > 0) {
+                return providers::CompletionResponse{
+                    protocol::Message{protocol::Role::Assistant, "done", {}, std::nullopt},
+                    protocol::StopReason::Finished};
+            }
+            on_event(protocol::ToolCallDeltaEvent{1, "call-2", "read_file", "{\"path\":\"a\"}"});
+
+            protocol::Message message{protocol::Role::Assistant, "", {}, std::nullopt};
+            message.tool_calls.push_back(protocol::ToolCall{"call-1", "write_file", "{}"});
+            message.tool_calls.push_back(
+                protocol::ToolCall{"call-2", "read_file", "{\"path\":\"a\"}"});
+            return providers::CompletionResponse{message, protocol::StopReason::ToolCall};
+        }
+    } provider;
+    core::loop::AgentLoop loop(provider, dispatcher, core::loop::LoopOptions{});
+
+    std::vector<protocol::Message> history;
+    loop.run(history, [](const protocol::AgentEvent&) {});
+
+    // The speculative read predates the write, so the read runs again after it
+    EXPECT_EQ(loop.speculation_stats().launched, 1u);
+    EXPECT_EQ(loop.speculation_stats().hits, 0u);
+    EXPECT_EQ(loop.speculation_stats().discarded, 1u);
+    EXPECT_EQ(writes.load(), 1);
+    EXPECT_EQ(reads.load(), 2);
+}
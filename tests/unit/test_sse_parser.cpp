@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "providers/sse/delta_extractor.hpp"
+#include "providers/sse/sse_parser.hpp"
+
+using namespace agent::providers::sse;
+using agent::protocol::AgentEvent;
+using agent::protocol::MessageDeltaEvent;
+
+namespace {
+
+    struct Collected {
+        std::string event;
+        std::string data;
+        std::string id;
+    };
+
+    // Feeds the stream in pieces of `step` bytes from a scratch buffer that is
+    // overwritten after every call, the way a socket read buffer would be.
+    std::vector<Collected> parse_in_steps(const std::string& stream, std::size_t step) {
+        std::vector<Collected> out;
+        SseParser parser;
+        std::string scratch;
+        auto handler = [&](const SseEvent& event) {
+            out.push_back(
+                {std::string(event.event), std::string(event.data), std::string(event.id)});
+        };
+        for (std::size_t pos = 0; pos < stream.size(); pos += step) {
+            scratch.assign(stream, pos, step);
+            parser.feed(scratch, handler);
+            scratch.assign(scratch.size(), '#');
+        }
+        parser.finish(handler);
+        return out;
+    }
+
+} // namespace
+
+TEST(SseParserTest, FindsLineEndsAcrossSimdBlocks) {
+    std::string text(40, 'x');
+    EXPECT_EQ(find_line_end(text.data(), text.size()), 40u);
+    text[33] = '\r';
+    EXPECT_EQ(find_line_end(text.data(), text.size()), 33u);
+    text[17] = '\n';
+    EXPECT_EQ(find_line_end(text.data(), text.size()), 17u);
+}
+
+TEST(SseParserTest, ParsesEventsIdenticallyForEverySplit) {
+    std::string stream =
+        ": keep-alive\r\n"
+        "event: content_block_delta\r\n"
+        "id: 7\r\n"
+        "data: {\"text\":\"Hel\"}\r\n\r\n"
+        "data: line one\n"
+        "data: line two\n\n"
+        "data:[DONE]\r\r";
+
+    for (std::size_t step = 1; step <= stream.size(); ++step) {
+        auto events = parse_in_steps(stream, step);
+        ASSERT_EQ(events.size(), 3u) << "step " << step;
+        EXPECT_EQ(events[0].event, "content_block_delta");
+        EXPECT_EQ(events[0].data, "{\"text\":\"Hel\"}");
+        EXPECT_EQ(events[0].id, "7");
+        EXPECT_EQ(events[1].event, "message");
+        EXPECT_EQ(events[1].data, "line one\nline two");
+        EXPECT_EQ(events[1].id, "7");
+        EXPECT_EQ(events[2].data, "[DONE]");
+    }
+}
+
+TEST(SseParserTest, OnlyCopiesWhatStraddlesReads) {
+    SseParser parser;
+    int seen = 0;
+    parser.feed("data: a\n\ndata: b\n\n", [&](const SseEvent&) { ++seen; });
+    EXPECT_EQ(seen, 2);
+    EXPECT_EQ(parser.bytes_carried(), 0u);
+}
+
+TEST(JsonFieldTest, FindsKeysButNotMatchingValues) {
+    std::string chunk =
+        R"({"id":"content","choices":[{"delta":{"role":"assistant","content":"Hi \"you\""}}]})";
+    auto raw = find_string_field(chunk, "content");
+    ASSERT_TRUE(raw.has_value());
+    EXPECT_EQ(*raw, R"(Hi \"you\")");
+
+    EXPECT_FALSE(find_string_field(R"({"content": null})", "content").has_value());
+}
+
+TEST(JsonFieldTest, UnescapesControlAndUnicodeSequences) {
+    std::string out;
+    ASSERT_TRUE(unescape_json_string(R"(a\n\t\"b\" \u00e9 \ud83d\ude00)", out));
+    EXPECT_EQ(out, "a\n\t\"b\" \xC3\xA9 \xF0\x9F\x98\x80");
+    EXPECT_FALSE(unescape_json_string(R"(\x)", out));
+}
+
+TEST(DeltaExtractorTest, EmitsMessageDeltasUntilDone) {
+    DeltaExtractor extractor("text");
+    std::string text;
+    auto sink = [&](const AgentEvent& event) {
+        text += std::get<MessageDeltaEvent>(event).delta_text;
+    };
+
+    SseParser parser;
+    parser.feed(
+        "event: content_block_delta\n"
+        "data: {\"type\":\"content_block_delta\","
+        "\"delta\":{\"type\":\"text_delta\",\"text\":\"Hello\"}}\n\n"
+        "data: {\"delta\":{\"text\":\", world\"}}\n\n"
+        "data: [DONE]\n\n",
+        [&](const SseEvent& event) { extractor.on_event(event, sink); });
+
+    EXPECT_EQ(text, "Hello, world");
+    EXPECT_TRUE(extractor.done());
+}
@@ -0,0 +1,284 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "core/loop/sub_agents.hpp"
+#include "byte_tokenizer.hpp"
+
+using namespace agent;
+using agent::testing::byte_tokenizer;
+using core::loop::SubAgentOptions;
+using core::loop::SubAgentPool;
+using core::loop::SubAgentTask;
+
+namespace {
+
+    // Answers "done: <task>" after a short pause, and records how many
+    // requests were in flight at once and what each one was sent
+    class EchoProvider : public providers::Provider {
+    public:
+        core::errors::Result<providers::CompletionResponse> complete(
+            const providers::CompletionRequest& request, const providers::EventSink&) override {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                peak_ = std::max(peak_, ++inflight_);
+                sent_.push_back(request.messages);
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            std::lock_guard<std::mutex> lock(mutex_);
+            --inflight_;
+            // The task is the last paragraph of the child's user message
+            const std::string& asked = request.messages.back().content;
+            std::size_t split = asked.rfind("\n\n");
+            std::string reply =
+                "done: " + (split == std::string::npos ? asked : asked.substr(split + 2));
+            return providers::CompletionResponse{
+                protocol::Message{protocol::Role::Assistant, reply, {}, std::nullopt},
+                protocol::StopReason::Finished};
+        }
+
+        std::size_t peak() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return peak_;
+        }
+        std::vector<std::vector<protocol::Message>> sent() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return sent_;
+        }
+
+    private:
+        mutable std::mutex mutex_;
+        std::size_t inflight_ = 0;
+        std::size_t peak_ = 0;
+        std::vector<std::vector<protocol::Message>> sent_;
+    };
+
+    // Never called: only its schema matters, which every request carries
+    class IdleTool : public core::tools::Tool {
+    public:
+        explicit IdleTool(std::string description)
+            : schema_{"idle", std::move(description), "{}"} {}
+
+        const protocol::ToolSchema& schema() const override { return schema_; }
+        protocol::ToolResult execute(const protocol::ToolCall& call) override {
+            return protocol::ToolResult{call.id, true, "", "", 0.0};
+        }
+
+    private:
+        protocol::ToolSchema schema_;
+    };
+
+    // The parent asks for the fan-out after reading a file, so the fork
+    // ends on a tool result; without that read it ends on the user's turn
+    std::vector<protocol::Message> parent_history(bool after_tool_use = true) {
+        std::vector<protocol::Message> history{
+            {protocol::Role::System, "You refactor code.", {}, std::nullopt},
+            {protocol::Role::User, "Rename foo to bar everywhere.", {}, std::nullopt}};
+        if (after_tool_use) {
+            protocol::Message read{protocol::Role::Assistant, "", {}, std::nullopt};
+            read.tool_calls.push_back({"read-1", "read_file", "{\"path\":\"foo.h\"}"});
+            history.push_back(read);
+            history.push_back({protocol::Role::Tool, "int foo();", {}, "read-1"});
+        }
+        protocol::Message ask{protocol::Role::Assistant, "Splitting it up.", {}, std::nullopt};
+        ask.tool_calls.push_back({"spawn-1", "spawn_agents", "{}"});
+        history.push_back(ask);
+        return history;
+    }
+
+    // What a child is sent first: the fork, then its task after the
+    // parent's request, or folded into the user's turn the fork ends on
+    std::vector<protocol::Message> child_fork(const std::string& task,
+                                              bool after_tool_use = true) {
+        auto history = parent_history(after_tool_use);
+        history.back().tool_calls.clear();
+        if (!after_tool_use) {
+            history.pop_back();
+            history.back().content += "\n\n" + task;
+        } else {
+            history.push_back({protocol::Role::User, task, {}, std::nullopt});
+        }
+        return history;
+    }
+
+    std::size_t fork_tokens(core::context::TokenEstimator& estimator, const std::string& task) {
+        std::size_t tokens = 0;
+        for (const auto& message : child_fork(task)) tokens += estimator.count(message);
+        return tokens;
+    }
+
+    // No two user-side (user or tool result) or two assistant messages in a row
+    bool alternates(const std::vector<protocol::Message>& history) {
+        for (std::size_t i = 2; i < history.size(); ++i) {  // After the system message
+            bool assistant = history[i].role == protocol::Role::Assistant;
+            if (assistant == (history[i - 1].role == protocol::Role::Assistant)) return false;
+        }
+        return true;
+    }
+
+    std::vector<SubAgentTask> tasks(int count) {
+        std::vector<SubAgentTask> out;
+        for (int i = 0; i < count; ++i) {
+            out.push_back({"call-" + std::to_string(i), "task " + std::to_string(i)});
+        }
+        return out;
+    }
+
+} // namespace
+
+TEST(SubAgentTest, MergesResultsInTaskOrder) {
+    EchoProvider provider;
+    core::tools::ToolDispatcher dispatcher;
+    SubAgentOptions options;
+    options.max_concurrent = 2;
+    core::context::TokenEstimator estimator(byte_tokenizer());
+    SubAgentPool pool(provider, dispatcher, estimator, options);
+
+    for (bool after_tool_use : {true, false}) {
+        auto results = pool.fan_out(parent_history(after_tool_use), tasks(6));
+        ASSERT_EQ(results.size(), 6u);
+        for (int i = 0; i < 6; ++i) {
+            EXPECT_EQ(results[i].role, protocol::Role::Tool);
+            EXPECT_EQ(results[i].tool_call_id, "call-" + std::to_string(i));
+            EXPECT_EQ(results[i].content, "done: task " + std::to_string(i));
+        }
+    }
+
+    // Each child saw the fork and its task, with turns alternating either way
+    auto sent = provider.sent();
+    ASSERT_EQ(sent.size(), 12u);
+    for (std::size_t r = 0; r < sent.size(); ++r) {
+        EXPECT_TRUE(alternates(sent[r])) << r;
+        std::string task = sent[r].back().content;
+        task = task.substr(task.rfind("task "));
+        auto expected = child_fork(task, r < 6);
+        ASSERT_EQ(sent[r].size(), expected.size()) << r;
+        for (std::size_t m = 0; m < expected.size(); ++m) {
+            EXPECT_EQ(sent[r][m].role, expected[m].role) << r << ":" << m;
+            EXPECT_EQ(sent[r][m].content, expected[m].content) << r << ":" << m;
+        }
+    }
+    EXPECT_EQ(provider.peak(), 2u);
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.spawned, 12u);
+    EXPECT_EQ(stats.finished, 12u);
+    EXPECT_EQ(stats.peak_concurrent, 2u);
+}
+
+TEST(SubAgentTest, ConcurrencyLimitHoldsAcrossFanOuts) {
+    EchoProvider provider;
+    core::tools::ToolDispatcher dispatcher;
+    SubAgentOptions options;
+    options.max_concurrent = 3;
+    core::context::TokenEstimator estimator(byte_tokenizer());
+    SubAgentPool pool(provider, dispatcher, estimator, options);
+
+    std::vector<std::thread> parents;
+    for (int i = 0; i < 3; ++i) {
+        parents.emplace_back(
+            [&] { EXPECT_EQ(pool.fan_out(parent_history(), tasks(4)).size(), 4u); });
+    }
+    for (auto& parent : parents) parent.join();
+    EXPECT_LE(provider.peak(), 3u);
+    EXPECT_EQ(pool.stats().finished, 12u);
+}
+
+TEST(SubAgentTest, TokenBudgetStopsChildrenThatDoNotFit) {
+    EchoProvider provider;
+    core::tools::ToolDispatcher dispatcher;
+    SubAgentOptions options;
+    options.max_concurrent = 1;  // One after another, so the arithmetic is exact
+    options.params.max_output_tokens = 20;
+
+    // What one child costs: its prompt, then prompt plus reply once settled
+    core::context::TokenEstimator estimator(byte_tokenizer());
+    std::size_t prompt = fork_tokens(estimator, "task 0");
+    std::size_t child = prompt + estimator.count(protocol::Message{
+                                     protocol::Role::Assistant, "done: task 0", {}, std::nullopt});
+
+    // Room for two children, and almost for a third
+    options.token_budget = 2 * child + prompt + 20 - 1;
+    SubAgentPool pool(provider, dispatcher, estimator, options);
+    auto results = pool.fan_out(parent_history(), tasks(3));
+    EXPECT_EQ(results[1].content, "done: task 1");
+    EXPECT_EQ(results[2].role, protocol::Role::Tool);
+    EXPECT_NE(results[2].content.find("token budget exhausted"), std::string::npos);
+
+    auto stats = pool.stats();
+    EXPECT_EQ(stats.finished, 2u);
+    EXPECT_EQ(stats.failed, 1u);
+    EXPECT_EQ(stats.refused, 1u);
+    EXPECT_EQ(stats.tokens, 2 * child);
+
+    // A per-child budget too small for one request refuses every child
+    options.token_budget = 0;
+    options.child_token_budget = prompt;
+    SubAgentPool strict(provider, dispatcher, estimator, options);
+    strict.fan_out(parent_history(), tasks(2));
+    EXPECT_EQ(strict.stats().refused, 2u);
+    EXPECT_EQ(strict.stats().tokens, 0u);
+}
+
+TEST(SubAgentTest, ToolSchemasAreChargedWithTheMessages) {
+    EchoProvider provider;
+    core::tools::ToolDispatcher dispatcher;
+    ASSERT_FALSE(core::errors::is_error(
+        dispatcher.register_tool(std::make_unique<IdleTool>(std::string(500, 'x')))));
+    SubAgentOptions options;
+    options.params.max_output_tokens = 20;
+
+    core::context::TokenEstimator estimator(byte_tokenizer());
+    std::size_t messages = fork_tokens(estimator, "task 0");
+    std::size_t tools = estimator.count(dispatcher.schemas()[0]);
+    ASSERT_GE(tools, 500u);
+
+    // Room for the messages and the output, but not for the tool schema as well
+    options.child_token_budget = messages + 20 + tools - 1;
+    SubAgentPool tight(provider, dispatcher, estimator, options);
+    auto refused = tight.fan_out(parent_history(), tasks(1));
+    EXPECT_NE(refused[0].content.find("token budget exhausted"), std::string::npos);
+    EXPECT_EQ(tight.stats().refused, 1u);
+
+    options.child_token_budget = messages + 20 + tools;
+    SubAgentPool enough(provider, dispatcher, estimator, options);
+    EXPECT_EQ(enough.fan_out(parent_history(), tasks(1))[0].content, "done: task 0");
+    EXPECT_EQ(enough.stats().tokens,
+              messages + tools +
+                  estimator.count(protocol::Message{protocol::Role::Assistant, "done: task 0", {},
+                                                    std::nullopt}));
+}
+
+TEST(SubAgentTest, TurnLimitAnswersWithTheLastAssistantMessage) {
+    // Every reply asks for another tool call, so only the turn limit stops it
+    class LoopingProvider : public providers::Provider {
+    public:
+        core::errors::Result<providers::CompletionResponse> complete(
+            const providers::CompletionRequest& request, const providers::EventSink&) override {
+            if (!alternates(request.messages)) alternated = false;
+            protocol::Message message{protocol::Role::Assistant,
+                                      "step " + std::to_string(++turns), {}, std::nullopt};
+            message.tool_calls.push_back({"t" + std::to_string(turns), "idle", "{}"});
+            return providers::CompletionResponse{message, protocol::StopReason::ToolCall};
+        }
+        std::atomic<int> turns{0};
+        std::atomic<bool> alternated{true};
+    } provider;
+    core::tools::ToolDispatcher dispatcher;
+    ASSERT_FALSE(core::errors::is_error(
+        dispatcher.register_tool(std::make_unique<IdleTool>("does nothing"))));
+    SubAgentOptions options;
+    options.max_turns = 2;
+    core::context::TokenEstimator estimator(byte_tokenizer());
+    SubAgentPool pool(provider, dispatcher, estimator, options);
+
+    auto results = pool.fan_out(parent_history(), tasks(1));
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].content.rfind("step 2\n[Truncated: ", 0), 0u) << results[0].content;
+    EXPECT_TRUE(provider.alternated);
+    EXPECT_EQ(pool.stats().failed, 1u);
+}
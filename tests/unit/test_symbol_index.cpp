@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "core/search/cpp_symbols.hpp"
+#include "core/search/symbol_index.hpp"
+#include "core/tools/find_symbol_tool.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::eventually;
+using agent::testing::TempWorkspace;
+using core::search::SymbolKind;
+
+namespace {
+
+    // "kind scope::name:line", with " decl" for declarations
+    std::vector<std::string> describe(std::string_view source) {
+        std::vector<std::string> described;
+        for (const auto& symbol : core::search::extract_cpp_symbols(source)) {
+            std::string line(core::search::to_string(symbol.kind));
+            line += ' ';
+            if (!symbol.scope.empty()) line += symbol.scope + "::";
+            line += symbol.name + ":" + std::to_string(symbol.line);
+            if (!symbol.definition) line += " decl";
+            described.push_back(line);
+        }
+        return described;
+    }
+
+    using Lines = std::vector<std::string>;
+
+} // namespace
+
+TEST(CppSymbolsTest, FindsDeclarationsThroughScopes) {
+    const char* source = R"(#include <vector>
+#define MAX_DEPTH 16
+namespace agent::parse {
+    class [[nodiscard]] Parser final : public Base<int> {
+    public:
+        explicit Parser(Lexer& lexer) : lexer_(lexer), depth_{0} {}
+        ~Parser();
+        Node* parse(int flags = 0) const;
+        bool operator==(const Parser& other) const { return this == &other; }
+        struct Frame { int depth; };
+    private:
+        std::vector<int> stack_{1, 2};
+    };
+    enum class Mode : unsigned char { Fast, Slow };
+    using NodeList = std::vector<Node*>;
+    Node* Parser::parse(int flags) const {
+        if (flags) { return nullptr; }
+        return new Node{};
+    }
+    namespace {
+        template <typename T, int N = (3 > 2)>
+        T helper(T value) { return value; }
+    }
+}
+typedef struct { int x, y; } point_t;
+typedef void (*handler_t)(int);
+extern "C" int c_entry(void);
+)";
+    EXPECT_EQ(describe(source), (Lines{
+                                    "macro MAX_DEPTH:2",
+                                    "namespace agent:3",
+                                    "namespace agent::parse:3",
+                                    "class agent::parse::Parser:4",
+                                    "function agent::parse::Parser::Parser:6",
+                                    "function agent::parse::Parser::~Parser:7 decl",
+                                    "function agent::parse::Parser::parse:8 decl",
+                                    "function agent::parse::Parser::operator==:9",
+                                    "struct agent::parse::Parser::Frame:10",
+                                    "enum agent::parse::Mode:14",
+                                    "alias agent::parse::NodeList:15",
+                                    "function agent::parse::Parser::parse:16",
+                                    "function agent::parse::helper:22",
+                                    "alias point_t:25",
+                                    "alias handler_t:26",
+                                    "function c_entry:27 decl",
+                                }));
+}
+
+TEST(CppSymbolsTest, SeesThroughMacrosLiteralsAndConditionals) {
+    const char* source = R"(
+TEST_F(ParserTest, Parses) { int x = call(1); }
+EXPORT_API(v1) void exported();
+static int table[] = {1, 2, 3};
+auto lambda = [](int a) { return a; };
+const char* text = R"raw( void fake() { )raw";
+/* void commented() {} */
+#if 0
+void disabled() {}
+#endif
+#ifdef WINDOWS
+void platform() {
+#else
+void platform(int) {
+#endif
+}
+void after() {}
+#if USE_OLD_API
+#include "old_api.h"
+#else
+void current_api() {}
+#endif
+)";
+    EXPECT_EQ(describe(source), (Lines{"function exported:3 decl", "function platform:12",
+                                       "function after:17", "function current_api:21"}));
+}
+
+namespace {
+
+    class SymbolIndexTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            root_.write("src/lexer.hpp",
+                        "namespace lang {\nclass Lexer {\n  Token next();\n};\n}\n");
+            root_.write("src/lexer.cpp",
+                        "namespace lang {\nToken Lexer::next() { return {}; }\n}\n");
+            root_.write("src/parser.cpp", "namespace lang {\nvoid parse_all(Lexer& lexer) {}\n"
+                                          "void parse_one(Lexer& lexer) {}\n}\n");
+            root_.write("notes.md", "class NotCode {};\n");
+            root_.write("build/gen.cpp", "class Generated {};\n");
+            root_.write(".gitignore", "build/\n");
+        }
+
+        std::unique_ptr<core::search::SymbolIndex> open() {
+            core::search::SymbolIndexOptions options;
+            options.threads = 2;
+            auto index = core::search::SymbolIndex::open(root_.string(), options);
+            EXPECT_FALSE(core::errors::is_error(index));
+            return std::move(std::get<std::unique_ptr<core::search::SymbolIndex>>(index));
+        }
+
+        static std::vector<std::string> where(const core::search::SymbolIndex& index,
+                                              std::string name, bool prefix = false) {
+            core::search::SymbolQuery query;
+            query.name = std::move(name);
+            query.prefix = prefix;
+            std::vector<std::string> found;
+            for (const auto& match : index.find(query)) {
+                found.push_back(match.path + ":" + std::to_string(match.symbol.line));
+            }
+            return found;
+        }
+
+        TempWorkspace root_{"symbol_test"};
+    };
+
+} // namespace
+
+TEST_F(SymbolIndexTest, LooksUpNamesQualifiedOrNot) {
+    auto index = open();
+    EXPECT_EQ(index->stats().files, 3u);  // Not notes.md, nor the ignored build/
+
+    // The definition comes before the declaration
+    EXPECT_EQ(where(*index, "next"), (Lines{"src/lexer.cpp:2", "src/lexer.hpp:3"}));
+    EXPECT_EQ(where(*index, "Lexer::next"), (Lines{"src/lexer.cpp:2", "src/lexer.hpp:3"}));
+    EXPECT_EQ(where(*index, "::lang::Lexer"), Lines{"src/lexer.hpp:2"});
+    EXPECT_TRUE(where(*index, "Parser::next").empty());
+    EXPECT_TRUE(where(*index, "ang::Lexer").empty());  // Whole scope components only
+    EXPECT_EQ(where(*index, "parse_", true),
+              (Lines{"src/parser.cpp:2", "src/parser.cpp:3"}));
+    core::search::SymbolQuery namespaces;
+    namespaces.name = "lang";
+    namespaces.kind = SymbolKind::Namespace;
+    namespaces.max_results = 1;
+    EXPECT_EQ(index->find(namespaces).size(), 1u);
+    EXPECT_TRUE(where(*index, "Generated").empty());
+}
+
+TEST_F(SymbolIndexTest, FollowsEditsFromInotify) {
+    auto index = open();
+    ASSERT_FALSE(core::errors::is_error(index->watch()));
+
+    root_.write("src/parser.cpp", "namespace lang {\nvoid parse_everything() {}\n}\n");
+    EXPECT_TRUE(eventually([&] { return where(*index, "parse_everything").size() == 1; }));
+    EXPECT_TRUE(where(*index, "parse_all").empty());
+
+    root_.write("lib/deep/eval.cc", "int evaluate(const char* text);\n");
+    EXPECT_TRUE(eventually([&] { return where(*index, "evaluate").size() == 1; }));
+
+    std::filesystem::remove_all(root_ / "lib");
+    EXPECT_TRUE(eventually([&] { return where(*index, "evaluate").empty(); }));
+    EXPECT_GT(index->stats().updates, 0u);
+}
+
+TEST_F(SymbolIndexTest, ToolListsOneLinePerDeclaration) {
+    auto index = open();
+    core::tools::FindSymbolTool tool({index.get(), 100});
+    auto result = tool.execute({"c1", "find_symbol", R"({"name":"next"})"});
+    ASSERT_TRUE(result.success) << result.error_message;
+    EXPECT_EQ(result.output, "src/lexer.cpp:2 function lang::Lexer::next\n"
+                             "src/lexer.hpp:3 function lang::Lexer::next (declaration)\n");
+
+    result = tool.execute(
+        {"c2", "find_symbol", R"({"name":"parse","prefix":true,"max_results":1})"});
+    ASSERT_TRUE(result.success);
+    EXPECT_EQ(result.output, "src/parser.cpp:2 function lang::parse_all\n"
+                             "[More than 1 matches; qualify the name or give a kind]\n");
+
+    EXPECT_FALSE(tool.execute({"c3", "find_symbol", R"({"name":"x","kind":"type"})"}).success);
+    EXPECT_FALSE(tool.execute({"c4", "find_symbol", "{}"}).success);
+}
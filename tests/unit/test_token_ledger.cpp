@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "core/context/token_ledger.hpp"
+
+using namespace agent;
+using core::context::BpeTokenizer;
+using core::context::TokenEstimator;
+using core::context::TokenLedger;
+
+namespace {
+
+    BpeTokenizer byte_tokenizer(const std::string& id) {
+        std::vector<std::pair<std::string, std::uint32_t>> ranks;
+        for (int byte = 0; byte < 256; ++byte) {
+            ranks.emplace_back(std::string(1, static_cast<char>(byte)), byte);
+        }
+        ranks.emplace_back(" x", 256);
+        return std::move(std::get<BpeTokenizer>(BpeTokenizer::from_ranks(ranks, id)));
+    }
+
+    protocol::Message tool_message(const std::string& output) {
+        return protocol::Message{protocol::Role::Tool, output, {}, "c1"};
+    }
+
+} // namespace
+
+TEST(TokenLedgerTest, CountsOnlyAppendedMessages) {
+    auto tokenizer = byte_tokenizer("bytes");
+    TokenLedger ledger(tokenizer);
+
+    std::vector<protocol::Message> history{{protocol::Role::User, "ab", {}, std::nullopt}};
+    ledger.sync(history);
+    EXPECT_EQ(ledger.total(), BpeTokenizer::kMessageOverhead + 2);
+
+    history.push_back(tool_message(" x x"));
+    ledger.sync(history);
+    std::size_t tokenized = ledger.stats().tokenized_bytes;
+    EXPECT_EQ(ledger.total(), 2 * BpeTokenizer::kMessageOverhead + 2 + 2);
+
+    // Nothing new: no tokenizer work at all
+    ledger.sync(history);
+    EXPECT_EQ(ledger.stats().tokenized_bytes, tokenized);
+
+    history.pop_back();
+    ledger.sync(history);
+    EXPECT_EQ(ledger.size(), 1u);
+    EXPECT_EQ(ledger.total(), BpeTokenizer::kMessageOverhead + 2);
+}
+
+TEST(TokenLedgerTest, ReplaceKeepsRunningTotalExact) {
+    auto tokenizer = byte_tokenizer("bytes");
+    TokenLedger ledger(tokenizer);
+    std::vector<protocol::Message> history{tool_message("abcdef"), tool_message("gh")};
+    ledger.sync(history);
+
+    history[0] = tool_message("a");
+    ledger.replace(0, history[0]);
+
+    TokenLedger fresh(tokenizer);
+    fresh.sync(history);
+    EXPECT_EQ(ledger.total(), fresh.total());
+    EXPECT_EQ(ledger.at(0), BpeTokenizer::kMessageOverhead + 1);
+}
+
+TEST(TokenLedgerTest, RecountsMessagesMarkedDirty) {
+    auto tokenizer = byte_tokenizer("bytes");
+    TokenLedger ledger(tokenizer);
+    std::vector<protocol::Message> history{tool_message("abcdef"), tool_message("gh")};
+    ledger.sync(history);
+    std::size_t before = ledger.total();
+
+    // sync() does not rescan old messages, so an edit goes unseen until marked
+    history[0].content = "a";
+    history[1].tool_calls.push_back({"c2", "read_file", "{}"});
+    ledger.sync(history);
+    EXPECT_EQ(ledger.total(), before);
+
+    ledger.mark_dirty(0);
+    ledger.mark_dirty(1);
+    ledger.sync(history);
+    TokenLedger fresh(tokenizer);
+    fresh.sync(history);
+    EXPECT_EQ(ledger.total(), fresh.total());
+    EXPECT_EQ(ledger.at(0), BpeTokenizer::kMessageOverhead + 1);
+
+    // A mark past the end of a history that has since shrunk is ignored
+    ledger.mark_dirty(1);
+    history.pop_back();
+    ledger.sync(history);
+    EXPECT_EQ(ledger.total(), BpeTokenizer::kMessageOverhead + 1);
+}
+
+TEST(TokenLedgerTest, LargeOutputsAreTokenizedOnce) {
+    auto tokenizer = byte_tokenizer("bytes");
+    TokenLedger ledger(tokenizer);
+    std::string output(4 * TokenEstimator::kCacheThreshold, 'z');
+
+    std::size_t direct = ledger.count(output);
+    std::size_t tokenized = ledger.stats().tokenized_bytes;
+
+    ledger.sync({tool_message(output)});
+    EXPECT_EQ(ledger.stats().cache_hits, 1u);
+    EXPECT_EQ(ledger.stats().tokenized_bytes, tokenized);
+    EXPECT_EQ(ledger.total(), BpeTokenizer::kMessageOverhead + direct);
+}
+
+TEST(TokenEstimatorTest, ChargesPromptToolsAndOutputAllowance) {
+    auto tokenizer = byte_tokenizer("bytes");
+    TokenEstimator estimator(tokenizer);
+    std::vector<protocol::Message> messages{{protocol::Role::User, "ab", {}, std::nullopt}};
+    std::vector<protocol::ToolSchema> tools{{"ls", "List", "{}"}};
+
+    auto charge = estimator.charge(messages, tools, 100);
+    std::size_t prompt = tokenizer.count(messages[0]) + 2 + 4 + 2;
+    EXPECT_EQ(charge.prompt, prompt);
+    EXPECT_EQ(charge.reserved, prompt + 100);
+    protocol::Message reply{protocol::Role::Assistant, "done", {}, std::nullopt};
+    EXPECT_EQ(estimator.used(charge, reply), prompt + tokenizer.count(reply));
+
+    // The second time round every count comes from the cache
+    std::size_t tokenized = estimator.stats().tokenized_bytes;
+    EXPECT_EQ(estimator.charge(messages, tools, 0).reserved, prompt);
+    EXPECT_EQ(estimator.stats().tokenized_bytes, tokenized);
+    EXPECT_EQ(estimator.stats().cache_hits, 2u);
+}
+
+TEST(TokenEstimatorTest, KeysCoverExactlyWhatIsCounted) {
+    auto tokenizer = byte_tokenizer("bytes");
+    TokenEstimator estimator(tokenizer);
+    protocol::Message a{protocol::Role::Assistant, "", {{"c1", "ab", "c"}}, std::nullopt};
+    protocol::Message b{protocol::Role::Assistant, "", {{"c1", "a", "bc"}}, std::nullopt};
+    EXPECT_NE(estimator.key(a), estimator.key(b));
+
+    // Role and ids are not counted, so they do not split the cache
+    protocol::Message c{protocol::Role::User, "", {{"c9", "ab", "c"}}, std::nullopt};
+    EXPECT_EQ(estimator.key(a), estimator.key(c));
+
+    auto other = byte_tokenizer("other");
+    EXPECT_NE(TokenEstimator(other).key(a), estimator.key(a));
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "core/hash/perfect_hash.hpp"
+#include "core/tools/tool_dispatcher.hpp"
+#include "core/tools/typed_tool.hpp"
+
+using namespace agent;
+namespace tools = core::tools;
+
+namespace {
+
+    constexpr std::array<std::string_view, 2> kModes{"fast", "exact"};
+
+    struct SampleArgs {
+        std::string name;
+        std::optional<long long> limit;
+        bool verbose = false;
+        std::string mode = "fast";
+        std::vector<std::string> tags;
+
+        static constexpr auto fields() {
+            return std::tuple{
+                tools::arg("name", &SampleArgs::name).non_empty().describe("Who to greet"),
+                tools::arg("limit", &SampleArgs::limit).at_least(1),
+                tools::arg("verbose", &SampleArgs::verbose).optional(),
+                tools::arg("mode", &SampleArgs::mode).optional().one_of(kModes),
+                tools::arg("tags", &SampleArgs::tags).optional()};
+        }
+    };
+
+    std::string bind_error(std::string_view json) {
+        auto args = tools::bind_arguments<SampleArgs>(json);
+        if (!core::errors::is_error(args)) return "";
+        EXPECT_EQ(core::errors::get_error(args).category, core::errors::ErrorCategory::Input);
+        return core::errors::get_error(args).message;
+    }
+
+    class EchoTool : public tools::TypedTool<SampleArgs> {
+    public:
+        EchoTool() : TypedTool("echo", "Echo the name back") {}
+
+    protected:
+        protocol::ToolResult run(const protocol::ToolCall& call,
+                                 const SampleArgs& args) override {
+            return protocol::ToolResult{call.id, true, args.name, "", 0.0};
+        }
+    };
+
+} // namespace
+
+TEST(ToolArgsTest, SchemaListsEveryField) {
+    auto schema = nlohmann::json::parse(tools::json_schema<SampleArgs>());
+    EXPECT_EQ(schema["type"], "object");
+    EXPECT_EQ(schema["required"], nlohmann::json::array({"name"}));
+
+    const auto& properties = schema["properties"];
+    EXPECT_EQ(properties["name"]["type"], "string");
+    EXPECT_EQ(properties["name"]["minLength"], 1);
+    EXPECT_EQ(properties["name"]["description"], "Who to greet");
+    EXPECT_EQ(properties["limit"]["type"], "integer");
+    EXPECT_EQ(properties["limit"]["minimum"], 1);
+    EXPECT_EQ(properties["verbose"]["type"], "boolean");
+    EXPECT_EQ(properties["mode"]["enum"], nlohmann::json::array({"fast", "exact"}));
+    EXPECT_EQ(properties["tags"]["items"]["type"], "string");
+}
+
+TEST(ToolArgsTest, BindsIntoTheStruct) {
+    auto args = tools::bind_arguments<SampleArgs>(
+        R"( { "name" : "a\"b\\c\u00e9\ud83d\ude00", "limit": 3, "unknown": {"x": [1, null]},
+              "verbose": true, "tags": ["x", "y"] } )");
+    ASSERT_FALSE(core::errors::is_error(args)) << core::errors::get_error(args).message;
+    const auto& bound = core::errors::get_value(args);
+    EXPECT_EQ(bound.name, "a\"b\\c\xc3\xa9\xf0\x9f\x98\x80");
+    EXPECT_EQ(bound.limit, 3);
+    EXPECT_TRUE(bound.verbose);
+    EXPECT_EQ(bound.mode, "fast");
+    EXPECT_EQ(bound.tags, (std::vector<std::string>{"x", "y"}));
+
+    // null clears an optional
+    auto nulled = tools::bind_arguments<SampleArgs>(R"({"name": "n", "limit": null})");
+    ASSERT_FALSE(core::errors::is_error(nulled));
+    EXPECT_FALSE(core::errors::get_value(nulled).limit.has_value());
+}
+
+TEST(ToolArgsTest, ErrorsNameTheArgument) {
+    EXPECT_EQ(bind_error(R"({"limit": 2})"), "\"name\" is required");
+    EXPECT_EQ(bind_error(R"({"name": 5, "limit": 2})"), "\"name\" must be a string");
+    EXPECT_EQ(bind_error(R"({"name": "", "limit": 2})"), "\"name\" must not be empty");
+    EXPECT_EQ(bind_error(R"({"name": "n", "limit": 0})"), "\"limit\" must be at least 1");
+    EXPECT_EQ(bind_error(R"({"name": "n", "limit": 1.5})"), "\"limit\" must be an integer");
+    EXPECT_EQ(bind_error(R"({"name": "n", "limit": 1, "mode": "slow"})"),
+              "\"mode\" must be one of fast, exact");
+    EXPECT_EQ(bind_error(R"({"name": "n", "limit": 1, "verbose": "yes"})"),
+              "\"verbose\" must be true or false");
+
+    for (std::string_view bad : {"", "[]", R"({"name": "n")", R"({"name": "n"} x)",
+                                 R"({"name": "n\q", "limit": 1})"}) {
+        EXPECT_EQ(bind_error(bad), "the arguments are not a valid JSON object") << bad;
+    }
+}
+
+TEST(ToolArgsTest, TypedToolReportsBindingErrors) {
+    EchoTool tool;
+    auto ok = tool.execute({"call-1", "echo", R"({"name": "hi", "limit": 1})"});
+    EXPECT_TRUE(ok.success);
+    EXPECT_EQ(ok.output, "hi");
+
+    auto bad = tool.execute({"call-2", "echo", R"({"limit": 1})"});
+    EXPECT_FALSE(bad.success);
+    EXPECT_EQ(bad.error_message, "echo: \"name\" is required");
+    EXPECT_EQ(tool.schema().parameters, tools::json_schema<SampleArgs>());
+}
+
+TEST(ToolArgsTest, PerfectHashFindsEveryKey) {
+    std::vector<std::pair<std::string, int>> entries;
+    for (int i = 0; i < 200; ++i) entries.emplace_back("tool_" + std::to_string(i), i);
+    core::hash::PerfectHashMap<int> map(entries);
+    for (const auto& [key, value] : entries) {
+        const int* found = map.find(key);
+        ASSERT_NE(found, nullptr) << key;
+        EXPECT_EQ(*found, value);
+    }
+    EXPECT_EQ(map.find("tool_200"), nullptr);
+    EXPECT_EQ(map.find(""), nullptr);
+    EXPECT_EQ(core::hash::PerfectHashMap<int>().find("tool_1"), nullptr);
+}
+
+TEST(ToolArgsTest, DispatcherRoutesByName) {
+    tools::ToolDispatcher dispatcher;
+    ASSERT_FALSE(core::errors::is_error(dispatcher.register_tool(std::make_unique<EchoTool>())));
+    EXPECT_TRUE(core::errors::is_error(dispatcher.register_tool(std::make_unique<EchoTool>())));
+    EXPECT_NE(dispatcher.find("echo"), nullptr);
+    EXPECT_EQ(dispatcher.find("ech"), nullptr);
+
+    auto result = dispatcher.dispatch({"call-1", "echo", R"({"name": "x", "limit": 2})"});
+    EXPECT_TRUE(result.success);
+    auto unknown = dispatcher.dispatch({"call-2", "missing", "{}"});
+    EXPECT_FALSE(unknown.success);
+    EXPECT_EQ(unknown.error_message, "Unknown tool: missing");
+}
@@ -0,0 +1,148 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "core/fs/path_policy.hpp"
+#include "core/tools/read_file_tool.hpp"
+#include "core/tools/search_tool.hpp"
+#include "core/tools/tool_dispatcher.hpp"
+#include "core/tools/tool_memo.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::eventually;
+using agent::testing::TempWorkspace;
+using core::tools::ToolMemo;
+
+namespace {
+
+    // Writes "x" to the file named by its arguments: a tool with side effects
+    class TouchTool : public core::tools::Tool {
+    public:
+        explicit TouchTool(std::filesystem::path dir) : dir_(std::move(dir)) {}
+
+        const protocol::ToolSchema& schema() const override { return schema_; }
+        protocol::ToolResult execute(const protocol::ToolCall& call) override {
+            std::ofstream(dir_ / call.arguments) << "x";
+            return protocol::ToolResult{call.id, true, "", "", 0.0};
+        }
+
+    private:
+        std::filesystem::path dir_;
+        protocol::ToolSchema schema_{"touch", "Write a file", "{}"};
+    };
+
+    class ToolMemoTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            core::tools::ReadFileOptions read_options;
+            read_options.root = dir_.string();
+            core::tools::SearchOptions search_options;
+            search_options.root = dir_.string();
+            search_options.threads = 1;
+            ASSERT_FALSE(core::errors::is_error(dispatcher_.register_tool(
+                std::make_unique<core::tools::ReadFileTool>(read_options))));
+            ASSERT_FALSE(core::errors::is_error(dispatcher_.register_tool(
+                std::make_unique<core::tools::SearchTool>(search_options))));
+            ASSERT_FALSE(core::errors::is_error(
+                dispatcher_.register_tool(std::make_unique<TouchTool>(dir_.path()))));
+            dispatcher_.set_memo(&memo_);
+        }
+
+        protocol::ToolResult call(const std::string& name, const std::string& arguments) {
+            auto result = dispatcher_.dispatch({"call-" + std::to_string(++calls_), name,
+                                                arguments});
+            EXPECT_EQ(result.tool_call_id, "call-" + std::to_string(calls_));
+            return result;
+        }
+
+        TempWorkspace dir_{"tool_memo_test"};
+        ToolMemo memo_;
+        core::tools::ToolDispatcher dispatcher_;
+        int calls_ = 0;
+    };
+
+} // namespace
+
+TEST_F(ToolMemoTest, ReusesReadsUntilTheFileChanges) {
+    dir_.write("a.txt", "one\ntwo\n");
+    auto first = call("read_file", R"({"path": "a.txt", "start_line": 2})");
+    auto second = call("read_file", R"({ "start_line" : 2, "path" : "a.txt" })");
+    ASSERT_TRUE(first.success) << first.error_message;
+    EXPECT_EQ(second.output, first.output);
+    EXPECT_EQ(memo_.stats().hits, 1u);
+    EXPECT_EQ(memo_.stats().misses, 1u);
+    EXPECT_DOUBLE_EQ(memo_.stats().hit_ratio(), 0.5);
+
+    dir_.write("a.txt", "one\nthree, longer\n");
+    auto third = call("read_file", R"({"path": "a.txt", "start_line": 2})");
+    EXPECT_NE(third.output.find("three, longer"), std::string::npos);
+    EXPECT_EQ(memo_.stats().stale, 1u);
+
+    // Argument errors are never kept
+    call("read_file", R"({"start_line": 2})");
+    call("read_file", R"({"start_line": 2})");
+    EXPECT_EQ(memo_.stats().uncacheable, 2u);
+    EXPECT_EQ(memo_.stats().entries, 1u);
+}
+
+TEST_F(ToolMemoTest, KeepsSearchesOnlyOverWatchedTrees) {
+    dir_.write("a.txt", "needle\n");
+    call("search", R"({"pattern": "needle"})");
+    call("search", R"({"pattern": "needle"})");
+    EXPECT_EQ(memo_.stats().hits, 0u);
+    EXPECT_EQ(memo_.stats().uncacheable, 2u);
+
+    ASSERT_FALSE(core::errors::is_error(memo_.watch(dir_.string())));
+    auto first = call("search", R"({"pattern": "needle"})");
+    call("search", R"({"pattern": "needle"})");
+    EXPECT_EQ(memo_.stats().hits, 1u);
+
+    // A tool with side effects drops it at once
+    call("touch", "b.txt");
+    EXPECT_EQ(memo_.stats().entries, 0u);
+    // Kept again once the touch's own inotify events have landed
+    ASSERT_TRUE(eventually([&] {
+        std::size_t hits = memo_.stats().hits;
+        call("search", R"({"pattern": "needle"})");
+        return memo_.stats().hits > hits;
+    }));
+
+    // And so does a change made behind our back
+    dir_.write("c.txt", "needle again\n");
+    ASSERT_TRUE(eventually([&] { return memo_.stats().entries == 0u; }));
+    auto last = call("search", R"({"pattern": "needle"})");
+    EXPECT_NE(last.output.find("c.txt"), std::string::npos);
+    EXPECT_EQ(first.output.find("c.txt"), std::string::npos);
+}
+
+TEST_F(ToolMemoTest, ToolsOverOtherRootsOrPoliciesDoNotShare) {
+    TempWorkspace other{"tool_memo_other_test"};
+    dir_.write("a.txt", "here\n");
+    other.write("a.txt", "there\n");
+    other.write(".env", "TOKEN=1\n");
+
+    core::tools::ReadFileOptions options;
+    options.root = other.string();
+    core::tools::ReadFileTool open_tool(options);
+    auto compiled = core::fs::PathPolicy::compile({{other.string()}, {}, {".env"}});
+    ASSERT_FALSE(core::errors::is_error(compiled));
+    auto policy = std::move(std::get<core::fs::PathPolicy>(compiled));
+    options.policy = &policy;
+    core::tools::ReadFileTool guarded_tool(options);
+
+    EXPECT_EQ(call("read_file", R"({"path": "a.txt"})").output, "here\n");
+    protocol::ToolCall read_a{"c1", "read_file", R"({"path": "a.txt"})"};
+    EXPECT_EQ(memo_.run(open_tool, read_a).output, "there\n");
+    EXPECT_EQ(memo_.run(guarded_tool, read_a).output, "there\n");
+    EXPECT_EQ(memo_.stats().hits, 0u);
+    EXPECT_EQ(memo_.stats().entries, 3u);
+
+    // Denied for the guarded tool, whatever the open one has remembered
+    protocol::ToolCall read_env{"c2", "read_file", R"({"path": ".env"})"};
+    EXPECT_TRUE(memo_.run(open_tool, read_env).success);
+    EXPECT_TRUE(memo_.run(open_tool, read_env).success);
+    EXPECT_EQ(memo_.stats().hits, 1u);
+    EXPECT_FALSE(memo_.run(guarded_tool, read_env).success);
+}
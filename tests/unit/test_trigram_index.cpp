@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "core/search/trigram_index.hpp"
+#include "core/tools/search_tool.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::eventually;
+using agent::testing::TempWorkspace;
+using core::search::TrigramIndex;
+using core::search::TrigramIndexOptions;
+
+namespace {
+
+    class TrigramIndexTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            root_.write("src/parser.cpp", "Token parse_expression(Lexer& lexer);\n");
+            root_.write("src/lexer.cpp", "Token next_token(Lexer& lexer);\n");
+            root_.write("docs/notes.md", "The PARSER handles expressions.\n");
+            root_.write("build/out.cpp", "Token parse_expression_generated();\n");
+            root_.write(".gitignore", "build/\n");
+            root_.write("blob.bin", std::string("parse_expression\0\0", 18));
+            snapshot_ = root_.string() + ".idx";
+        }
+        void TearDown() override { std::filesystem::remove(snapshot_); }
+
+        std::unique_ptr<TrigramIndex> open(bool persistent = true) {
+            TrigramIndexOptions options;
+            if (persistent) options.path = snapshot_;
+            options.threads = 2;
+            auto index = TrigramIndex::open(root_.string(), options);
+            EXPECT_FALSE(core::errors::is_error(index));
+            return std::move(std::get<std::unique_ptr<TrigramIndex>>(index));
+        }
+
+        static std::vector<std::string> candidates(const TrigramIndex& index,
+                                                   std::string_view literal) {
+            auto files = index.candidates(literal);
+            EXPECT_TRUE(files.has_value()) << literal;
+            return files.value_or(std::vector<std::string>{});
+        }
+
+        TempWorkspace root_{"trigram_test"};
+        std::string snapshot_;
+    };
+
+    using Files = std::vector<std::string>;
+
+} // namespace
+
+TEST_F(TrigramIndexTest, NarrowsToFilesHoldingEveryTrigram) {
+    auto index = open(false);
+    EXPECT_EQ(candidates(*index, "parse_expression"), Files{"src/parser.cpp"});
+    EXPECT_EQ(candidates(*index, "(Lexer& lexer)"), (Files{"src/lexer.cpp", "src/parser.cpp"}));
+    EXPECT_EQ(candidates(*index, "Parser"), (Files{"docs/notes.md"}));  // Case-folded
+    EXPECT_TRUE(candidates(*index, "no such text").empty());
+    EXPECT_FALSE(index->candidates("pa").has_value());
+
+    auto stats = index->stats();
+    EXPECT_EQ(stats.files, 5u);  // Not build/, which is ignored
+    EXPECT_GT(stats.trigrams, 0u);
+}
+
+TEST_F(TrigramIndexTest, SnapshotReloadsAndCatchesUpWithChanges) {
+    open();
+    ASSERT_TRUE(std::filesystem::exists(snapshot_));
+
+    // While nothing was watching: one edit, one deletion, one new file
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    root_.write("src/lexer.cpp", "Token peek_token(Lexer& lexer, int ahead);\n");
+    std::filesystem::remove(root_ / "docs/notes.md");
+    root_.write("src/eval.cpp", "Value evaluate(Expression& expr);\n");
+
+    auto index = open();
+    EXPECT_EQ(index->stats().updates, 3u);  // Only the changes were reindexed
+    EXPECT_EQ(candidates(*index, "peek_token"), Files{"src/lexer.cpp"});
+    EXPECT_TRUE(candidates(*index, "next_token").empty());
+    EXPECT_TRUE(candidates(*index, "PARSER handles").empty());
+    EXPECT_EQ(candidates(*index, "evaluate("), Files{"src/eval.cpp"});
+    EXPECT_EQ(index->stats().files, 5u);
+    EXPECT_EQ(index->stats().pending, 0u);  // Folded into the saved snapshot
+
+    // Another root's snapshot is not reused
+    TrigramIndexOptions options;
+    options.path = snapshot_;
+    auto other = TrigramIndex::open((root_ / "src").string(), options);
+    ASSERT_FALSE(core::errors::is_error(other));
+    EXPECT_EQ(candidates(*std::get<std::unique_ptr<TrigramIndex>>(other), "Value evaluate"),
+              Files{"eval.cpp"});
+}
+
+TEST_F(TrigramIndexTest, CorruptSnapshotIsRebuiltNotRead) {
+    open();
+    std::stringstream saved;
+    saved << std::ifstream(snapshot_, std::ios::binary).rdbuf();
+    const std::string image = saved.str();
+    auto u64 = [&](std::size_t at) {
+        std::uint64_t value;
+        std::memcpy(&value, image.data() + at, sizeof(value));
+        return value;
+    };
+    auto put = [](std::string& bytes, std::size_t at, std::uint64_t value) {
+        std::memcpy(bytes.data() + at, &value, sizeof(value));
+    };
+    // Header: files, directory, postings and paths offsets at 24, 32, 40, 48
+    std::size_t files = u64(24), directory = u64(32), postings = u64(40), paths = u64(48);
+    ASSERT_LT(postings, paths);
+
+    std::vector<std::pair<std::string, std::function<void(std::string&)>>> corruptions = {
+        {"path offset", [&](std::string& b) { put(b, files, std::uint64_t{1} << 40); }},
+        {"path length", [&](std::string& b) { put(b, files + 8, 0xffffffffu); }},
+        {"posting offset", [&](std::string& b) { put(b, directory + 8, paths); }},
+        {"posting count", [&](std::string& b) { b[directory + 4] = '\x7f'; }},
+        {"file id", [&](std::string& b) { b[postings + u64(directory + 8)] = '\x7f'; }},
+        {"last varint", [&](std::string& b) { b[paths - 1] = '\x80'; }},
+    };
+    for (auto& [what, corrupt] : corruptions) {
+        std::string bytes = image;
+        corrupt(bytes);
+        std::ofstream(snapshot_, std::ios::binary | std::ios::trunc) << bytes;
+
+        auto index = open();
+        EXPECT_EQ(index->stats().builds, 1u) << what;
+        EXPECT_EQ(candidates(*index, "parse_expression"), Files{"src/parser.cpp"}) << what;
+        EXPECT_EQ(candidates(*index, "next_token"), Files{"src/lexer.cpp"}) << what;
+    }
+
+    // The snapshot written by the last rebuild loads as it is
+    EXPECT_EQ(open()->stats().builds, 0u);
+}
+
+TEST_F(TrigramIndexTest, UpdatesFollowInotify) {
+    auto index = open();
+    ASSERT_FALSE(core::errors::is_error(index->watch()));
+
+    root_.write("src/new.cpp", "void freshly_written();\n");
+    EXPECT_TRUE(eventually([&] { return candidates(*index, "freshly_written").size() == 1; }));
+
+    std::filesystem::remove(root_ / "src/parser.cpp");
+    EXPECT_TRUE(eventually([&] { return candidates(*index, "parse_expression").empty(); }));
+
+    root_.write("build/late.cpp", "void freshly_ignored();\n");
+    root_.write("lib/deep/util.cpp", "void moved_in_helper();\n");
+    EXPECT_TRUE(eventually([&] { return candidates(*index, "moved_in_helper").size() == 1; }));
+    EXPECT_TRUE(candidates(*index, "freshly_ignored").empty());
+    EXPECT_GT(index->stats().pending, 0u);
+
+    ASSERT_FALSE(core::errors::is_error(index->save()));
+    EXPECT_EQ(index->stats().pending, 0u);
+    EXPECT_EQ(candidates(*index, "freshly_written"), Files{"src/new.cpp"});
+}
+
+TEST_F(TrigramIndexTest, SearchToolGivesTheSameMatchesWithTheIndex) {
+    auto index = open(false);
+    auto search = [&](const nlohmann::json& args, const TrigramIndex* with) {
+        core::tools::SearchOptions options;
+        options.root = root_.string();
+        options.index = with;
+        core::tools::SearchTool tool(options);
+        auto result = tool.execute({"c1", "search", args.dump()});
+        EXPECT_TRUE(result.success) << result.error_message;
+        return nlohmann::json::parse(result.output);
+    };
+
+    for (const auto& args : {nlohmann::json{{"pattern", "parse_[a-z]+\\("}},
+                             nlohmann::json{{"pattern", "parser"}, {"case_insensitive", true}},
+                             nlohmann::json{{"pattern", "Lexer&"}, {"path", "src"}},
+                             nlohmann::json{{"pattern", "T.k"}}}) {
+        auto indexed = search(args, index.get());
+        auto walked = search(args, nullptr);
+        EXPECT_EQ(indexed["matches"], walked["matches"]) << args.dump();
+        EXPECT_LE(indexed["files_searched"], walked["files_searched"]);
+    }
+    EXPECT_EQ(search({{"pattern", "parse_expression"}}, index.get())["files_searched"], 1);
+}
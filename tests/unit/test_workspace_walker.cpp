@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include "core/fs/ignore_rules.hpp"
+#include "core/fs/workspace_walker.hpp"
+#include "temp_workspace.hpp"
+
+using namespace agent;
+using agent::testing::TempWorkspace;
+using core::fs::Glob;
+using core::fs::IgnoreMatch;
+using core::fs::IgnoreRules;
+
+namespace {
+
+    class WalkerTest : public ::testing::Test {
+    protected:
+        std::set<std::string> walk(core::fs::WalkOptions options = {}) {
+            std::mutex mutex;
+            std::set<std::string> seen;
+            auto stats = core::fs::walk(root_.string(), options, [&](const auto& entry) {
+                std::lock_guard<std::mutex> lock(mutex);
+                seen.insert(std::string(entry.path) + (entry.is_dir ? "/" : ""));
+                return true;
+            });
+            EXPECT_FALSE(core::errors::is_error(stats));
+            return seen;
+        }
+
+        TempWorkspace root_{"walker_test"};
+    };
+
+} // namespace
+
+TEST(GlobTest, MatchesGitignoreWildcards) {
+    EXPECT_TRUE(Glob("*.o").matches("main.o"));
+    EXPECT_FALSE(Glob("*.o").matches("src/main.o"));  // '*' stops at '/'
+    EXPECT_TRUE(Glob("f?o").matches("foo"));
+    EXPECT_FALSE(Glob("f?o").matches("f/o"));
+    EXPECT_TRUE(Glob("*.py[cod]").matches("x.pyc"));
+    EXPECT_FALSE(Glob("*.py[cod]").matches("x.pyx"));
+    EXPECT_TRUE(Glob("[!a-c]x").matches("dx"));
+    EXPECT_FALSE(Glob("[!a-c]x").matches("bx"));
+    EXPECT_TRUE(Glob("\\*lit").matches("*lit"));
+
+    EXPECT_TRUE(Glob("**/build").matches("build"));
+    EXPECT_TRUE(Glob("**/build").matches("a/b/build"));
+    EXPECT_TRUE(Glob("a/**/b").matches("a/b"));
+    EXPECT_TRUE(Glob("a/**/b").matches("a/x/y/b"));
+    EXPECT_FALSE(Glob("a/**/b").matches("a/xb"));
+    EXPECT_TRUE(Glob("logs/**").matches("logs/2024/app.log"));
+    EXPECT_FALSE(Glob("logs/**").matches("logs"));
+    EXPECT_TRUE(Glob("a*b*c*d").matches("aXbYcZd"));
+    EXPECT_FALSE(Glob("a*a*a*a*a*b").matches(std::string(200, 'a')));  // No blowup
+}
+
+TEST(IgnoreRulesTest, LastMatchWinsAndAnchoringFollowsSlashes) {
+    IgnoreRules rules("# comment\n*.log\n!keep.log\n/top\nbuild/\ndocs/*.md\n", "");
+    EXPECT_EQ(rules.match("x/app.log", false), IgnoreMatch::Ignore);
+    EXPECT_EQ(rules.match("x/keep.log", false), IgnoreMatch::Include);
+    EXPECT_EQ(rules.match("top", false), IgnoreMatch::Ignore);
+    EXPECT_EQ(rules.match("x/top", false), IgnoreMatch::None);
+    EXPECT_EQ(rules.match("x/build", true), IgnoreMatch::Ignore);
+    EXPECT_EQ(rules.match("x/build", false), IgnoreMatch::None);  // Directories only
+    EXPECT_EQ(rules.match("docs/a.md", false), IgnoreMatch::Ignore);
+    EXPECT_EQ(rules.match("x/docs/a.md", false), IgnoreMatch::None);
+
+    IgnoreRules nested("*.tmp\n/local\n", "sub/dir");
+    EXPECT_EQ(nested.match("sub/dir/a.tmp", false), IgnoreMatch::Ignore);
+    EXPECT_EQ(nested.match("sub/dir/local", false), IgnoreMatch::Ignore);
+    EXPECT_EQ(nested.match("sub/dir/x/local", false), IgnoreMatch::None);
+    EXPECT_EQ(nested.match("other/a.tmp", false), IgnoreMatch::None);
+}
+
+TEST_F(WalkerTest, HonoursNestedGitignoresAndSkipsGit) {
+    root_.write(".gitignore", "*.o\nbuild/\n");
+    root_.write("src/main.cpp");
+    root_.write("src/main.o");
+    root_.write("src/.gitignore", "!main.o\ngen/\n");
+    root_.write("src/gen/out.cpp");
+    root_.write("build/app");
+    root_.write(".git/HEAD");
+    root_.write(".github/ci.yml");
+    root_.write("lib/util.o");
+
+    auto seen = walk();
+    std::set<std::string> expected{".gitignore",     "src/",          "src/main.cpp",
+                                   "src/main.o",     "src/.gitignore", ".github/",
+                                   ".github/ci.yml", "lib/"};
+    EXPECT_EQ(seen, expected);
+
+    core::fs::WalkOptions options;
+    options.respect_gitignore = false;
+    options.include_hidden = false;
+    options.ignore = {"lib/"};
+    seen = walk(options);
+    expected = {"src/", "src/main.cpp", "src/main.o", "src/gen/", "src/gen/out.cpp",
+                "build/", "build/app"};
+    EXPECT_EQ(seen, expected);
+}
+
+TEST_F(WalkerTest, ThreadCountDoesNotChangeTheResult) {
+    for (int d = 0; d < 20; ++d) {
+        for (int f = 0; f < 30; ++f) {
+            root_.write("d" + std::to_string(d) + "/e" + std::to_string(f % 3) + "/f" +
+                        std::to_string(f));
+        }
+    }
+    core::fs::WalkOptions one;
+    one.threads = 1;
+    core::fs::WalkOptions many;
+    many.threads = 8;
+    auto serial = walk(one);
+    EXPECT_EQ(serial.size(), 20u + 60u + 600u);
+    EXPECT_EQ(walk(many), serial);
+}
+
+TEST_F(WalkerTest, SinkCanStopTheWalk) {
+    for (int f = 0; f < 100; ++f) root_.write("d/f" + std::to_string(f));
+    std::atomic<int> calls{0};
+    core::fs::WalkOptions options;
+    options.threads = 4;
+    core::fs::walk(root_.string(), options, [&](const auto&) { return ++calls < 10; });
+    EXPECT_LT(calls.load(), 20);
+
+    auto missing = core::fs::walk((root_ / "nope").string(), options,
+                                  [](const auto&) { return true; });
+    EXPECT_TRUE(core::errors::is_error(missing));
+}